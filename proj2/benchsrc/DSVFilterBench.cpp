@@ -0,0 +1,62 @@
+// Keeps about 5% of the rows of a file, once by reading every row and
+// checking it afterwards and once with the filter pushed into the reader.
+//   bin/DSVFilterBench [rows]
+#include "DSVReader.h"
+#include "DSVRowFilter.h"
+#include "FileDataSource.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <unistd.h>
+
+namespace{
+
+void Measure(const char *name, const std::function<std::size_t()> &run){
+    auto Start = std::chrono::steady_clock::now();
+    std::size_t Kept = run();
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-24s %10zu rows kept %8.3f s\n", name, Kept, Seconds);
+}
+
+}
+
+int main(int argc, char *argv[]){
+    std::size_t Rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    char Path[] = "/tmp/dsvfilterbenchXXXXXX";
+    int Descriptor = mkstemp(Path);
+    std::string Text;
+    for(std::size_t Index = 0; Index < Rows; Index++){
+        Text += std::to_string(Index) + (Index % 20 ? ",FAIL," : ",OK,") + std::to_string(1600000000 + Index) + ",\"free text, with a comma\",plain value\n";
+        if(Text.size() > (1 << 20) || Index + 1 == Rows){
+            if(write(Descriptor, Text.data(), Text.size()) < 0){
+                std::perror("write");
+            }
+            Text.clear();
+        }
+    }
+    close(Descriptor);
+
+    CDSVRowFilter Filter;
+    Filter.Equals(1, "OK");
+    Measure("read then filter", [&]{
+        CDSVReader Reader(std::make_shared<CFileDataSource>(Path), ',');
+        std::vector<std::string> Row;
+        std::size_t Kept = 0;
+        while(Reader.ReadRow(Row)){
+            Kept += Filter.Matches(Row);
+        }
+        return Kept;
+    });
+    Measure("filter in reader", [&]{
+        CDSVReader Reader(std::make_shared<CFileDataSource>(Path), ',');
+        std::vector<std::string> Row;
+        std::size_t Kept = 0;
+        while(Reader.ReadRow(Row, Filter)){
+            Kept++;
+        }
+        return Kept;
+    });
+    std::remove(Path);
+    return 0;
+}
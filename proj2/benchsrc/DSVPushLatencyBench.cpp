@@ -0,0 +1,78 @@
+// Sends rows over a socketpair in small random chunks and reports how long
+// after its last byte was written each row came out of CDSVPushParser.
+//   bin/DSVPushLatencyBench [rows]
+#include "DSVPushParser.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace{
+
+std::uint64_t Now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Measure(std::size_t rows, std::size_t maxchunk){
+    int Sockets[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets)){
+        std::perror("socketpair");
+        return;
+    }
+    // time each row's last byte was written, indexed by row
+    std::vector< std::atomic<std::uint64_t> > Sent(rows);
+    std::thread Sender([&]{
+        std::mt19937 Random(1);
+        for(std::size_t Index = 0; Index < rows; Index++){
+            std::string Line = std::to_string(Index) + ",\"quoted, text\",12345.678,plain value\n";
+            for(std::size_t Position = 0; Position < Line.size();){
+                std::size_t Chunk = std::min<std::size_t>(Random() % maxchunk + 1, Line.size() - Position);
+                if(Position + Chunk == Line.size()){
+                    Sent[Index].store(Now());
+                }
+                if(write(Sockets[0], Line.data() + Position, Chunk) < 0){
+                    std::perror("write");
+                    return;
+                }
+                Position += Chunk;
+            }
+        }
+        close(Sockets[0]);
+    });
+
+    std::vector<std::uint64_t> Latencies;
+    Latencies.reserve(rows);
+    CDSVPushParser Parser(',', [&](std::span<const std::string> row){
+        std::size_t Index = std::strtoul(row[0].c_str(), nullptr, 10);
+        Latencies.push_back(Now() - Sent[Index].load());
+    });
+    char Buffer[4096];
+    ssize_t Length;
+    while((Length = read(Sockets[1], Buffer, sizeof(Buffer))) > 0){
+        Parser.Feed(Buffer, Length);
+    }
+    Parser.Finish();
+    Sender.join();
+    close(Sockets[1]);
+
+    std::sort(Latencies.begin(), Latencies.end());
+    auto Percentile = [&](double fraction){
+        return Latencies.empty() ? 0.0 : Latencies[std::min(Latencies.size() - 1, static_cast<std::size_t>(fraction * Latencies.size()))] / 1000.0;
+    };
+    std::printf("chunks of 1-%-4zu %8zu rows  p50 %8.1f us  p99 %8.1f us  max %8.1f us\n", maxchunk, Latencies.size(), Percentile(0.5), Percentile(0.99), Percentile(1.0));
+}
+
+}
+
+int main(int argc, char *argv[]){
+    std::size_t Rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    for(std::size_t MaxChunk : {1, 7, 64, 512}){
+        Measure(Rows, MaxChunk);
+    }
+    return 0;
+}
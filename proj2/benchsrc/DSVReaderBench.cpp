@@ -0,0 +1,66 @@
+// Parses the same rows with a compiled dialect (',') and with the runtime
+// parser (':', which CDSVReader has no instantiation for), from a file.
+//   bin/DSVReaderBench [rows]
+#include "DSVReader.h"
+#include "FileDataSource.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <unistd.h>
+
+namespace{
+
+void Measure(const char *name, std::size_t bytes, const std::function<std::size_t()> &run){
+    auto Start = std::chrono::steady_clock::now();
+    std::size_t Rows = run();
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-28s %10zu rows %8.1f MB/s\n", name, Rows, bytes / Seconds / (1 << 20));
+}
+
+std::string WriteInput(std::size_t rows, char delimiter){
+    char Path[] = "/tmp/dsvreaderbenchXXXXXX";
+    int Descriptor = mkstemp(Path);
+    std::string Text;
+    for(std::size_t Index = 0; Index < rows; Index++){
+        Text += std::to_string(Index) + delimiter + "\"some text" + delimiter + " quoted\"" + delimiter + "12345.678" + delimiter + "plain value\n";
+        if(Text.size() > (1 << 20) || Index + 1 == rows){
+            if(write(Descriptor, Text.data(), Text.size()) < 0){
+                std::perror("write");
+            }
+            Text.clear();
+        }
+    }
+    close(Descriptor);
+    return Path;
+}
+
+std::size_t ReadFile(const std::string &path, char delimiter){
+    CDSVReader Reader(std::make_shared<CFileDataSource>(path), delimiter);
+    std::vector<std::string> Row;
+    std::size_t Rows = 0;
+    while(Reader.ReadRow(Row)){
+        Rows++;
+    }
+    return Rows;
+}
+
+}
+
+int main(int argc, char *argv[]){
+    std::size_t Rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    std::string Compiled = WriteInput(Rows, ',');
+    std::string Runtime = WriteInput(Rows, ':');
+    std::size_t Bytes = 0;
+    if(FILE *File = std::fopen(Compiled.c_str(), "rb")){
+        std::fseek(File, 0, SEEK_END);
+        Bytes = std::ftell(File);
+        std::fclose(File);
+    }
+
+    Measure("runtime delimiter", Bytes, [&]{ return ReadFile(Runtime, ':'); });
+    Measure("compiled dialect", Bytes, [&]{ return ReadFile(Compiled, ','); });
+    std::remove(Compiled.c_str());
+    std::remove(Runtime.c_str());
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Counts the rows and fields of a file, once by reading every row with
+// CDSVReader and once with the scan-only CDSVScanner.
+//   bin/DSVScanBench [rows]
+#include "DSVReader.h"
+#include "DSVScanner.h"
+#include "FileDataSource.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace{
+
+void Measure(const char *name, std::size_t bytes, const std::function<std::size_t()> &run){
+    auto Start = std::chrono::steady_clock::now();
+    std::size_t Rows = run();
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-16s %10zu rows %8.3f s %8.0f MB/s\n", name, Rows, Seconds, bytes / Seconds / 1e6);
+}
+
+}
+
+int main(int argc, char *argv[]){
+    std::size_t Rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    char Path[] = "/tmp/dsvscanbenchXXXXXX";
+    int Descriptor = mkstemp(Path);
+    std::string Text;
+    for(std::size_t Index = 0; Index < Rows; Index++){
+        Text += std::to_string(Index) + ",name " + std::to_string(Index % 977) + "," + std::to_string(1600000000 + Index) + ",\"free text, with a comma and \"\"quotes\"\"\",plain value\n";
+        if(Text.size() > (1 << 20) || Index + 1 == Rows){
+            if(write(Descriptor, Text.data(), Text.size()) < 0){
+                std::perror("write");
+            }
+            Text.clear();
+        }
+    }
+    close(Descriptor);
+    struct stat Status;
+    stat(Path, &Status);
+
+    Measure("CDSVReader", Status.st_size, [&]{
+        CDSVReader Reader(std::make_shared<CFileDataSource>(Path), ',');
+        std::vector<std::string> Row;
+        std::size_t Count = 0;
+        while(Reader.ReadRow(Row)){
+            Count++;
+        }
+        return Count;
+    });
+    Measure("CDSVScanner", Status.st_size, [&]{
+        SDSVScanStats Stats;
+        CDSVScanner::ScanFile(Path, ',', Stats);
+        return static_cast<std::size_t>(Stats.DRowCount);
+    });
+    std::remove(Path);
+    return 0;
+}
@@ -0,0 +1,69 @@
+// Formats the same rows with CDSVWriter and with CParallelDSVWriter at
+// increasing thread counts and prints the throughput of each.
+//   bin/DSVWriterBench [rows]
+#include "DSVWriter.h"
+#include "ParallelDSVWriter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+
+namespace{
+
+// counts bytes without keeping them so the sink is not the bottleneck
+class CCountingDataSink : public CDataSink{
+    public:
+        std::size_t DBytes = 0;
+
+        bool Put(const char &ch) noexcept override{
+            DBytes++;
+            return true;
+        }
+
+        bool Write(const std::vector<char> &buf) noexcept override{
+            DBytes += buf.size();
+            return true;
+        }
+};
+
+void Measure(const char *name, const std::function<std::size_t()> &run){
+    auto Start = std::chrono::steady_clock::now();
+    std::size_t Bytes = run();
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-28s %12zu bytes %8.1f MB/s\n", name, Bytes, Bytes / Seconds / (1 << 20));
+}
+
+}
+
+int main(int argc, char *argv[]){
+    std::size_t Rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    std::vector< std::vector<std::string> > Batch;
+    for(int Index = 0; Index < 1000; Index++){
+        Batch.push_back({std::to_string(Index), "some text, with a comma", "say \"hi\"", "12345.678", "plain value"});
+    }
+
+    Measure("CDSVWriter", [&]{
+        auto Sink = std::make_shared<CCountingDataSink>();
+        CDSVWriter Writer(Sink, ',');
+        for(std::size_t Index = 0; Index < Rows; Index++){
+            Writer.WriteRow(Batch[Index % Batch.size()]);
+        }
+        return Sink->DBytes;
+    });
+    unsigned Cores = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned Threads = 1; Threads <= Cores; Threads *= 2){
+        char Name[64];
+        std::snprintf(Name, sizeof(Name), "CParallelDSVWriter x%u", Threads);
+        Measure(Name, [&]{
+            auto Sink = std::make_shared<CCountingDataSink>();
+            CParallelDSVWriter Writer(Sink, ',', false, Threads);
+            for(std::size_t Index = 0; Index < Rows; Index += Batch.size()){
+                Writer.WriteRows(Batch);
+            }
+            Writer.Close();
+            return Sink->DBytes;
+        });
+    }
+    return 0;
+}
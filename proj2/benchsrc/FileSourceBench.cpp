@@ -0,0 +1,85 @@
+// Reads one file through CFileDataSource and CURingFileDataSource, byte at a
+// time and in bulk, and prints the throughput of each.
+//   bin/FileSourceBench [file] [megabytes]
+// Without a file argument a scratch file of the given size (default 256MB)
+// is written to /tmp first.
+#include "FileDataSource.h"
+#include "URingFileDataSource.h"
+#include "URingFileDataSink.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+
+namespace{
+
+void Measure(const std::string &name, std::size_t bytes, const std::function<std::size_t()> &run){
+    auto Start = std::chrono::steady_clock::now();
+    std::size_t Total = run();
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-32s %10zu bytes %8.1f MB/s%s\n", name.c_str(), Total, bytes / Seconds / (1 << 20), Total == bytes ? "" : "  (short)");
+}
+
+std::size_t ByteAtATime(CDataSource &source){
+    std::size_t Total = 0;
+    char Ch;
+    while(source.Get(Ch)){
+        Total++;
+    }
+    return Total;
+}
+
+std::size_t Bulk(CDataSource &source){
+    std::size_t Total = 0;
+    std::vector<char> Buffer;
+    while(source.Read(Buffer, 1 << 16)){
+        Total += Buffer.size();
+    }
+    return Total;
+}
+
+}
+
+int main(int argc, char *argv[]){
+    std::string Path = argc > 1 ? argv[1] : "";
+    std::size_t Megabytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+    bool Scratch = Path.empty();
+    if(Scratch){
+        Path = "/tmp/filesourcebench.dat";
+        CURingFileDataSink Sink(Path);
+        std::vector<char> Block(1 << 20);
+        for(std::size_t Index = 0; Index < Block.size(); Index++){
+            Block[Index] = "abcdefgh,\n"[Index % 10];
+        }
+        for(std::size_t Index = 0; Index < Megabytes; Index++){
+            Sink.Write(Block);
+        }
+    }
+    std::size_t Bytes;
+    {
+        CFileDataSource Source(Path);
+        if(!Source.IsOpen()){
+            std::cerr << "cannot open " << Path << std::endl;
+            return 1;
+        }
+        Bytes = Bulk(Source);
+    }
+    {
+        CURingFileDataSource Probe(Path);
+        std::printf("io_uring %s\n", Probe.UsingURing() ? "available" : "unavailable, using pread");
+    }
+
+    Measure("CFileDataSource Get", Bytes, [&]{ CFileDataSource Source(Path); return ByteAtATime(Source); });
+    Measure("CFileDataSource Read", Bytes, [&]{ CFileDataSource Source(Path); return Bulk(Source); });
+    Measure("CURingFileDataSource Get", Bytes, [&]{ CURingFileDataSource Source(Path); return ByteAtATime(Source); });
+    Measure("CURingFileDataSource Read", Bytes, [&]{ CURingFileDataSource Source(Path); return Bulk(Source); });
+    Measure("CURingFileDataSource Read direct", Bytes, [&]{ CURingFileDataSource Source(Path, 1 << 20, 8, true); return Bulk(Source); });
+    Measure("pread fallback Read", Bytes, [&]{ CURingFileDataSource Source(Path, 1 << 20, 4, false, false); return Bulk(Source); });
+
+    if(Scratch){
+        std::remove(Path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Fills structs from a fixed-schema XML feed, once by walking CXMLReader
+// entities and once through TXMLBindingReader.
+//   bin/XMLBindingBench [records]
+#include "StringDataSource.h"
+#include "XMLBinding.h"
+#include "XMLReader.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+struct STrade{
+    std::uint64_t DId = 0;
+    std::string DSymbol;
+    double DPrice = 0;
+    int DQuantity = 0;
+};
+
+template <>
+struct SXMLBinding<STrade>{
+    static constexpr std::string_view Element = "trade";
+    static constexpr auto Fields = std::make_tuple(
+        XMLBinding::Attribute("id", &STrade::DId),
+        XMLBinding::Attribute("symbol", &STrade::DSymbol),
+        XMLBinding::Element("price", &STrade::DPrice),
+        XMLBinding::Element("qty", &STrade::DQuantity));
+};
+
+int main(int argc, char *argv[]){
+    std::size_t Records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    std::string Text = "<feed>\n";
+    for(std::size_t Index = 0; Index < Records; Index++){
+        Text += "<trade id=\"" + std::to_string(Index) + "\" symbol=\"S" + std::to_string(Index % 97) + "\"><price>" + std::to_string(Index % 1000) + ".25</price><qty>" + std::to_string(Index % 50) + "</qty></trade>\n";
+    }
+    Text += "</feed>\n";
+
+    auto Start = std::chrono::steady_clock::now();
+    CXMLReader Reader(std::make_shared<CStringDataSource>(Text));
+    SXMLEntity Entity;
+    STrade Trade;
+    std::string *Target = nullptr;
+    std::string Scratch;
+    double Sum = 0;
+    while(Reader.ReadEntity(Entity)){
+        if(Entity.DType == SXMLEntity::EType::StartElement){
+            if(Entity.DNameData == "trade"){
+                Trade = STrade();
+                Trade.DId = std::strtoull(Entity.AttributeValue("id").c_str(), nullptr, 10);
+                Trade.DSymbol = Entity.AttributeValue("symbol");
+            }
+            Scratch.clear();
+            Target = Entity.DNameData == "price" || Entity.DNameData == "qty" ? &Scratch : nullptr;
+        }
+        else if(Entity.DType == SXMLEntity::EType::CharData && Target){
+            *Target += Entity.DNameData;
+        }
+        else if(Entity.DType == SXMLEntity::EType::EndElement){
+            if(Entity.DNameData == "price"){
+                Trade.DPrice = std::strtod(Scratch.c_str(), nullptr);
+            }
+            else if(Entity.DNameData == "qty"){
+                Trade.DQuantity = std::atoi(Scratch.c_str());
+            }
+            else if(Entity.DNameData == "trade"){
+                Sum += Trade.DPrice * Trade.DQuantity;
+            }
+            Target = nullptr;
+        }
+    }
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-20s %10.3f ms  %.2f MB/s  (%.0f)\n", "entities", Seconds * 1e3, Text.size() / Seconds / 1e6, Sum);
+
+    Start = std::chrono::steady_clock::now();
+    TXMLBindingReader<STrade> BindingReader(std::make_shared<CStringDataSource>(Text));
+    Sum = 0;
+    while(BindingReader.Read(Trade)){
+        Sum += Trade.DPrice * Trade.DQuantity;
+    }
+    Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-20s %10.3f ms  %.2f MB/s  (%.0f)\n", "binding", Seconds * 1e3, Text.size() / Seconds / 1e6, Sum);
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Fetches single records of a large XML file, once by streaming CXMLReader
+// up to the record and once through a CXMLRecordIndex.
+//   bin/XMLRecordBench [records]
+#include "FileDataSource.h"
+#include "XMLReader.h"
+#include "XMLRecordIndex.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+int main(int argc, char *argv[]){
+    std::size_t Records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    char Path[] = "/tmp/xmlrecordbenchXXXXXX";
+    int Descriptor = mkstemp(Path);
+    std::string Text = "<archive xmlns=\"urn:archive\">\n";
+    for(std::size_t Index = 0; Index < Records; Index++){
+        Text += "<record id=\"" + std::to_string(Index) + "\"><name>record " + std::to_string(Index) + "</name><value>" + std::to_string(Index * 31) + "</value></record>\n";
+        if(Text.size() > (1 << 20) || Index + 1 == Records){
+            if(Index + 1 == Records){
+                Text += "</archive>\n";
+            }
+            if(write(Descriptor, Text.data(), Text.size()) < 0){
+                std::perror("write");
+            }
+            Text.clear();
+        }
+    }
+    close(Descriptor);
+
+    auto Start = std::chrono::steady_clock::now();
+    auto Index = std::make_shared<CXMLRecordIndex>();
+    CFileDataSource Source(Path, 1 << 20);
+    Index->Build(Source, "record");
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-20s %10zu records %10.3f ms\n", "build index", Index->RecordCount(), Seconds * 1e3);
+
+    // streaming to the last record is the cost of a fetch without the index
+    Start = std::chrono::steady_clock::now();
+    CXMLReader Reader(std::make_shared<CFileDataSource>(Path));
+    SXMLEntity Entity;
+    std::size_t Seen = 0;
+    while(Reader.ReadEntity(Entity, true)){
+        Seen += Entity.DType == SXMLEntity::EType::StartElement && Entity.DNameData == "record";
+    }
+    Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-20s %10zu records %10.3f ms\n", "stream to last", Seen, Seconds * 1e3);
+
+    CXMLRecordReader RecordReader(std::make_shared<CFileDataSource>(Path), Index);
+    std::vector<SXMLEntity> Entities;
+    std::size_t Fetches = 10000;
+    Start = std::chrono::steady_clock::now();
+    for(std::size_t Fetch = 0; Fetch < Fetches; Fetch++){
+        RecordReader.ReadRecord((Fetch * 7919) % Index->RecordCount(), Entities);
+    }
+    Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::printf("%-20s %10zu fetches %10.3f us each\n", "indexed fetch", Fetches, Seconds * 1e6 / Fetches);
+    std::remove(Path);
+    return 0;
+}
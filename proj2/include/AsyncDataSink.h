@@ -0,0 +1,29 @@
+#ifndef ASYNCDATASINK_H
+#define ASYNCDATASINK_H
+
+#include <memory>
+#include "DataSink.h"
+
+// Write-behind decorator. Put/Write append to a front buffer; when it fills
+// it is swapped with the back buffer, which a background thread drains into
+// the wrapped sink, so formatting and I/O overlap. A failure in the wrapped
+// sink makes every later call return false. Flush() waits until everything
+// written so far has reached the wrapped sink (and flushes it); Close() also
+// stops the thread and is called on destruction.
+class CAsyncDataSink : public CDataSink{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CAsyncDataSink(std::shared_ptr< CDataSink > sink, std::size_t buffersize = 1 << 20);
+        ~CAsyncDataSink();
+
+        bool Close() noexcept;
+
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Flush() noexcept override;
+};
+
+#endif
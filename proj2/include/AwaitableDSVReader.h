@@ -0,0 +1,28 @@
+#ifndef AWAITABLEDSVREADER_H
+#define AWAITABLEDSVREADER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "AwaitableDataSource.h"
+
+// Coroutine DSV reader: bool Ok = co_await Reader.ReadRowAsync(Row).
+// Buffered bytes are parsed with CDSVPushParser's rules (those of
+// CDSVReader), so a row that is already complete is returned without
+// suspending and without starting a coroutine; only when the buffered
+// bytes run out mid-row does the call wait on the source.
+class CAwaitableDSVReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CAwaitableDSVReader(std::shared_ptr< CAwaitableDataSource > src, char delimiter);
+        ~CAwaitableDSVReader();
+
+        bool End() const;
+        // false at end of input
+        TAwaitable<bool> ReadRowAsync(std::vector<std::string> &row);
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef AWAITABLEDSVWRITER_H
+#define AWAITABLEDSVWRITER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "AwaitableDataSink.h"
+
+// Coroutine DSV writer: bool Ok = co_await Writer.WriteRowAsync(Row).
+// Rows are formatted as by CDSVWriter into the sink's buffer; the call
+// completes without suspending until more than highwater bytes are
+// waiting that the destination will not take, and then waits for the sink
+// to drain. FlushAsync() waits until everything has been written.
+class CAwaitableDSVWriter{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CAwaitableDSVWriter(std::shared_ptr< CAwaitableDataSink > sink, char delimiter, bool quoteall = false, std::size_t highwater = 1 << 16);
+        ~CAwaitableDSVWriter();
+
+        TAwaitable<bool> WriteRowAsync(const std::vector<std::string> &row);
+        TAwaitable<bool> FlushAsync();
+};
+
+#endif
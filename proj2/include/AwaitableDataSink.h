@@ -0,0 +1,22 @@
+#ifndef AWAITABLEDATASINK_H
+#define AWAITABLEDATASINK_H
+
+#include <cstddef>
+#include "Task.h"
+
+// Sink for coroutine writers. Write() only buffers and TryFlush() writes
+// what the destination takes without blocking; Flush() is awaited when the
+// buffer has to be emptied and suspends while the destination is full.
+class CAwaitableDataSink{
+    public:
+        virtual ~CAwaitableDataSink(){};
+        // false once a write has failed
+        virtual bool Write(const char *data, std::size_t length) noexcept = 0;
+        // returns the number of bytes still buffered
+        virtual std::size_t TryFlush() noexcept = 0;
+        // a write to the destination has failed
+        virtual bool Failed() const noexcept = 0;
+        virtual TTask<bool> Flush() = 0;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef AWAITABLEDATASOURCE_H
+#define AWAITABLEDATASOURCE_H
+
+#include <string_view>
+#include "Task.h"
+
+// Source for coroutine readers. Buffered() and Consume() work on bytes that
+// have already arrived and never block; Fill() is only awaited when they
+// are used up and suspends until more arrive.
+class CAwaitableDataSource{
+    public:
+        virtual ~CAwaitableDataSource(){};
+        // bytes already buffered, empty when Fill() is needed
+        virtual std::string_view Buffered() noexcept = 0;
+        virtual void Consume(std::size_t count) noexcept = 0;
+        // the input has ended (or failed) and every buffered byte is consumed
+        virtual bool End() const noexcept = 0;
+        // buffers more bytes; false at end of input or on error
+        virtual TTask<bool> Fill() = 0;
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef AWAITABLEFILEDATASINK_H
+#define AWAITABLEFILEDATASINK_H
+
+#include <vector>
+#include "AwaitableDataSink.h"
+#include "Reactor.h"
+
+// Awaitable sink over a file, pipe or socket descriptor. The descriptor is
+// switched to non-blocking mode; Flush() waits on the reactor only while
+// the destination is full. The destructor does not flush.
+class CAwaitableFileDataSink : public CAwaitableDataSink{
+    private:
+        CEpollReactor &DReactor;
+        int DFileDescriptor;
+        bool DOwnsDescriptor;
+        std::vector<char> DBuffer;
+        std::size_t DPosition;
+        bool DFailed;
+
+    public:
+        CAwaitableFileDataSink(CEpollReactor &reactor, int fd, bool ownsfd = false);
+        CAwaitableFileDataSink(const CAwaitableFileDataSink &) = delete;
+        CAwaitableFileDataSink &operator=(const CAwaitableFileDataSink &) = delete;
+        ~CAwaitableFileDataSink();
+
+        bool Write(const char *data, std::size_t length) noexcept override;
+        std::size_t TryFlush() noexcept override;
+        bool Failed() const noexcept override;
+        TTask<bool> Flush() override;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef AWAITABLEFILEDATASOURCE_H
+#define AWAITABLEFILEDATASOURCE_H
+
+#include <vector>
+#include "AwaitableDataSource.h"
+#include "Reactor.h"
+
+// Awaitable source over a file, pipe or socket descriptor. The descriptor
+// is switched to non-blocking mode; Fill() reads what is available and
+// waits on the reactor only when a read would block.
+class CAwaitableFileDataSource : public CAwaitableDataSource{
+    private:
+        CEpollReactor &DReactor;
+        int DFileDescriptor;
+        bool DOwnsDescriptor;
+        std::vector<char> DBuffer;
+        std::size_t DPosition;
+        std::size_t DLength;
+        bool DEndOfFile;
+        bool DFailed;
+
+    public:
+        CAwaitableFileDataSource(CEpollReactor &reactor, int fd, bool ownsfd = false, std::size_t buffersize = 1 << 16);
+        CAwaitableFileDataSource(const CAwaitableFileDataSource &) = delete;
+        CAwaitableFileDataSource &operator=(const CAwaitableFileDataSource &) = delete;
+        ~CAwaitableFileDataSource();
+
+        bool Failed() const noexcept;
+
+        std::string_view Buffered() noexcept override;
+        void Consume(std::size_t count) noexcept override;
+        bool End() const noexcept override;
+        TTask<bool> Fill() override;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef AWAITABLEQUEUE_H
+#define AWAITABLEQUEUE_H
+
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "AwaitableDataSource.h"
+
+// Ready queue and fill loop behind the awaitable readers. A push parser
+// hands each item it completes to a slot from Push(); a read takes the
+// oldest item, and only when none is left feeds the parser the bytes the
+// source has buffered, or waits for the source to buffer more. Slots past
+// the ready count are spare items kept for their strings.
+//
+// Feed returns false on bad input: the items completed before the error
+// are still delivered, then reads report the end. Finish is called once
+// the source has ended.
+template <typename TItem>
+class TAwaitableQueue{
+    public:
+        using TFeed = std::function<bool(const char *data, std::size_t length)>;
+        using TFinish = std::function<void()>;
+
+        struct SAcceptAll{
+            bool operator()(const TItem &) const noexcept{
+                return true;
+            }
+        };
+
+    private:
+        std::shared_ptr<CAwaitableDataSource> DSource;
+        TFeed DFeed;
+        TFinish DFinish;
+        std::vector<TItem> DReady;
+        std::size_t DReadyHead;
+        std::size_t DReadyCount;
+        // Fill() reported the end of the input
+        bool DSourceDone;
+        bool DFinished;
+
+        // the oldest ready item that accept keeps; the ones it rejects are dropped
+        template <typename TAccept>
+        bool Take(TItem &item, TAccept &accept){
+            while(DReadyHead < DReadyCount){
+                TItem &Next = DReady[DReadyHead++];
+                if(DReadyHead == DReadyCount){
+                    DReadyHead = DReadyCount = 0;
+                }
+                if(accept(Next)){
+                    // the caller's old item becomes a spare
+                    std::swap(item, Next);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    public:
+        TAwaitableQueue(std::shared_ptr<CAwaitableDataSource> source, TFeed feed, TFinish finish)
+            : DSource(std::move(source)), DFeed(std::move(feed)), DFinish(std::move(finish)), DReadyHead(0), DReadyCount(0), DSourceDone(false), DFinished(false){
+
+        }
+
+        // the slot for the next completed item, holding a spare's old contents
+        TItem &Push(){
+            if(DReadyCount == DReady.size()){
+                DReady.emplace_back();
+            }
+            return DReady[DReadyCount++];
+        }
+
+        bool End() const noexcept{
+            return DFinished && DReadyHead == DReadyCount;
+        }
+
+        // true when the read could be answered from what is buffered
+        template <typename TAccept = SAcceptAll>
+        bool TryRead(TItem &item, bool &result, TAccept accept = TAccept()){
+            while(true){
+                if(Take(item, accept)){
+                    result = true;
+                    return true;
+                }
+                if(DFinished){
+                    result = false;
+                    return true;
+                }
+                std::string_view Window = DSource->Buffered();
+                if(!Window.empty()){
+                    bool Parsed = DFeed(Window.data(), Window.size());
+                    DSource->Consume(Window.size());
+                    DFinished = !Parsed;
+                }
+                else if(DSourceDone || DSource->End()){
+                    DFinish();
+                    DFinished = true;
+                }
+                else{
+                    return false;
+                }
+            }
+        }
+
+        template <typename TAccept = SAcceptAll>
+        TTask<bool> ReadWaiting(TItem &item, TAccept accept = TAccept()){
+            bool Result;
+            while(!TryRead(item, Result, accept)){
+                if(!co_await DSource->Fill()){
+                    DSourceDone = true;
+                }
+            }
+            co_return Result;
+        }
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef AWAITABLEXMLREADER_H
+#define AWAITABLEXMLREADER_H
+
+#include <memory>
+#include "AwaitableDataSource.h"
+#include "XMLEntity.h"
+
+// Coroutine XML reader: bool Ok = co_await Reader.ReadEntityAsync(Entity).
+// Buffered bytes go straight to CXMLPushParser; an entity that is already
+// complete is returned without suspending, and the call only waits on the
+// source when the buffered bytes have all been parsed. Character data is
+// complete once the markup after it begins.
+class CAwaitableXMLReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        explicit CAwaitableXMLReader(std::shared_ptr< CAwaitableDataSource > src);
+        ~CAwaitableXMLReader();
+
+        bool End() const;
+        // false at end of input or on malformed XML
+        TAwaitable<bool> ReadEntityAsync(SXMLEntity &entity, bool skipcdata = false);
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef COLUMNARCACHE_H
+#define COLUMNARCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DSVReader.h"
+
+// Binary columnar copy of a DSV file, so a file that is loaded over and over
+// is tokenized once. The file holds a header (row count, column names), the
+// cell count of every row, and per column either an offset array into a
+// string heap or, for columns with at most dictionarylimit distinct values,
+// a dictionary plus one 32-bit code per row. All sections are 8-byte
+// aligned so the reader can use them straight from a memory map.
+
+// Builds a cache file. Column data is spilled to temporary files while rows
+// arrive, so memory use does not grow with the input; Close() assembles
+// the final file and is called on destruction.
+class CColumnarCacheWriter{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CColumnarCacheWriter(const std::string &filename, std::size_t dictionarylimit = 1024);
+        ~CColumnarCacheWriter();
+
+        bool IsOpen() const noexcept;
+        // names the columns; must come before the first WriteRow
+        bool WriteHeader(const std::vector<std::string> &names);
+        bool WriteRow(const std::vector<std::string> &row);
+        bool Close();
+
+        // converts everything left in reader; with hasheader the first row
+        // becomes the column names
+        static bool Convert(CDSVReader &reader, const std::string &filename, bool hasheader = true, std::size_t dictionarylimit = 1024);
+};
+
+// Memory-maps a cache file and serves cells as string_views into the
+// mapping; nothing is parsed or copied at open time.
+class CColumnarCacheReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CColumnarCacheReader(const std::string &filename);
+        ~CColumnarCacheReader();
+
+        // false when the file is missing or not a valid cache
+        bool IsOpen() const noexcept;
+        std::size_t RowCount() const noexcept;
+        std::size_t ColumnCount() const noexcept;
+        // names given to the writer; empty strings for unnamed columns
+        const std::vector<std::string_view> &ColumnNames() const noexcept;
+        // column index for a name, or ColumnCount() when there is none
+        std::size_t ColumnIndex(std::string_view name) const noexcept;
+
+        // number of cells the row had in the source
+        std::size_t CellCount(std::size_t row) const noexcept;
+        // empty for cells past the end of the row or out of range, and for
+        // cells whose stored offsets are corrupt
+        std::string_view Cell(std::size_t row, std::size_t column) const noexcept;
+        bool ReadRow(std::size_t row, std::vector<std::string_view> &cells) const;
+        bool ReadRow(std::size_t row, std::vector<std::string> &cells) const;
+        // every value of one column, one per row
+        bool ReadColumn(std::size_t column, std::vector<std::string_view> &values) const;
+
+        // dictionary access for encoded columns, e.g. to group on codes
+        bool IsDictionaryEncoded(std::size_t column) const noexcept;
+        std::size_t DictionarySize(std::size_t column) const noexcept;
+        std::string_view DictionaryValue(std::size_t column, std::uint32_t code) const noexcept;
+        std::uint32_t DictionaryCode(std::size_t row, std::size_t column) const noexcept;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef COMPRESSEDDATASINK_H
+#define COMPRESSEDDATASINK_H
+
+#include <memory>
+#include "DataSink.h"
+#include "CompressedDataSource.h"
+
+// Compresses everything written to it into another sink. Input is cut into
+// blocks that are compressed as independent gzip members / zstd frames by
+// threads background threads and written in order, so compression overlaps
+// with formatting and scales with threads. Flush() ends the current block
+// early; Close() (or destruction) flushes the last block and reports whether
+// every write succeeded.
+class CCompressingDataSink : public CDataSink{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CCompressingDataSink(std::shared_ptr< CDataSink > sink, ECompression format = ECompression::Gzip, int level = 6, std::size_t threads = 1, std::size_t blocksize = 1 << 20);
+        ~CCompressingDataSink();
+
+        bool Close() noexcept;
+
+        bool Flush() noexcept override;
+
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+};
+
+#endif
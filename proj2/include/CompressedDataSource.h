@@ -0,0 +1,35 @@
+#ifndef COMPRESSEDDATASOURCE_H
+#define COMPRESSEDDATASOURCE_H
+
+#include <memory>
+#include "DataSource.h"
+
+// stream formats understood by the compressing sink and decompressing source;
+// zstd needs the tree built with ZSTD=1
+enum class ECompression{None, Gzip, Zstd};
+
+// Decompresses a gzip or zstd stream read from another source, picking the
+// format from the magic bytes; anything else is passed through unchanged.
+// With background set, decompression runs ahead on its own thread (through a
+// CPrefetchDataSource) so it overlaps with parsing.
+class CDecompressingDataSource : public CDataSource{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CDecompressingDataSource(std::shared_ptr< CDataSource > src, bool background = true, std::size_t buffersize = 1 << 18);
+        ~CDecompressingDataSource();
+
+        // detected stream format
+        ECompression Format() const noexcept;
+        // true once a corrupt or unsupported stream has stopped the output
+        bool Failed() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef DSVPUSHPARSER_H
+#define DSVPUSHPARSER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Where a row ended in the input: the offset just past its line ending and
+// whether that ending was a '\r', so a '\n' right after it still belongs
+// to it. Parsing can resume from here with nothing else carried over.
+struct SDSVCheckpoint{
+    std::uint64_t DOffset = 0;
+    bool DPendingReturn = false;
+};
+
+// Incremental DSV parser for input that arrives in pieces, e.g. from a
+// non-blocking socket. Feed() takes whatever bytes are available and emits
+// every row they complete; quote state, the partial cell and a pending
+// quote or "\r" carry over to the next call, so each byte is looked at once
+// however the input is split. Finish() ends the input and emits a last row
+// without a line ending. Rows follow CDSVReader's rules exactly.
+//
+// Completed rows go to the callback as a view of the parser's own cells,
+// which are reused for the next row, so copy what must outlive the call;
+// without a callback they are kept until TakeRows().
+class CDSVPushParser{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        using TRowCallback = std::function<void(std::span<const std::string> row)>;
+
+        explicit CDSVPushParser(char delimiter, TRowCallback callback = nullptr);
+        ~CDSVPushParser();
+
+        // returns the number of rows completed by this call
+        std::size_t Feed(const char *data, std::size_t length);
+        std::size_t Finish();
+        // ready for new input after Finish, dropping any partial row; with a
+        // checkpoint, the next byte fed is the one at checkpoint.DOffset
+        void Reset(const SDSVCheckpoint &checkpoint = SDSVCheckpoint());
+        // just past the row most recently completed (the one being passed
+        // to the callback), or the reset point before any row
+        SDSVCheckpoint Checkpoint() const noexcept;
+
+        // moves the rows kept since the last call into rows, returns how many
+        std::size_t TakeRows(std::vector< std::vector<std::string> > &rows);
+        // rows completed since construction or Reset
+        std::size_t RowCount() const noexcept;
+};
+
+#endif
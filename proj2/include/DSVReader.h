@@ -2,9 +2,14 @@
 #define DSVREADER_H
 
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "DataSource.h"
 
+class CDSVRowFilter;
+
 class CDSVReader{
     private:
         struct SImplementation;
@@ -16,6 +21,15 @@ class CDSVReader{
 
         bool End() const;
         bool ReadRow(std::vector<std::string> &row);
+        // cells are allocated from the row's memory resource (e.g. a CMemoryArena)
+        bool ReadRow(std::pmr::vector<std::pmr::string> &row);
+        // cells point into the reader's own buffer and stay valid until the
+        // next ReadRow call
+        bool ReadRow(std::vector<std::string_view> &row);
+        // reads the next row the filter accepts; rows it rejects are scanned
+        // but their cells are never built, and a row stops being collected
+        // at its first failing predicate
+        bool ReadRow(std::vector<std::string> &row, const CDSVRowFilter &filter);
 };
 
 #endif
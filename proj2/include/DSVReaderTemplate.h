@@ -0,0 +1,237 @@
+#ifndef DSVREADERTEMPLATE_H
+#define DSVREADERTEMPLATE_H
+
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "DataSource.h"
+#include "Metrics.h"
+
+// true for sources that expose their buffer through Buffered() and
+// Consume(), such as CFileDataSource
+template <typename TSource, typename = void>
+struct SDSVBufferedSource : std::false_type{};
+
+template <typename TSource>
+struct SDSVBufferedSource<TSource, std::void_t<decltype(std::declval<TSource &>().Buffered()), decltype(std::declval<TSource &>().Consume(std::size_t()))>> : std::true_type{};
+
+// row helpers shared by TDSVReader and CDSVReader
+namespace DSVReaderDetail{
+
+// returns the cell at index cleared for reuse, growing the row when needed
+template <typename TRow>
+typename TRow::value_type *NextCell(TRow &row, std::size_t index){
+    if(index < row.size()){
+        row[index].clear();
+    }
+    else{
+        row.emplace_back();
+    }
+    return &row[index];
+}
+
+#ifdef DSV_ENABLE_METRICS
+inline void RecordRow(std::size_t bytes, std::size_t cells, std::size_t quoted){
+    DSV_METRIC_ADD(RowsRead, 1);
+    DSV_METRIC_ADD(CellsRead, cells);
+    DSV_METRIC_ADD(QuotedCellsRead, quoted);
+    DSV_METRIC_ADD(BytesRead, bytes);
+}
+#endif
+
+}
+
+// what ends a row outside quotes: Any accepts "\n", "\r" and "\r\n" like
+// CDSVReader, LF only "\n" (a lone '\r' is then cell data)
+enum class EDSVLineEnding{Any, LF};
+
+// DSV parser with the dialect fixed at compile time. Every byte is
+// classified through a constexpr table built for the dialect, so the inner
+// loop does one lookup instead of a chain of runtime comparisons. TSource
+// is the source type the reader holds; with a final class such as
+// CFileDataSource the per-character calls are inlined rather than virtual,
+// and runs of plain bytes are appended straight from the source's buffer.
+// With Trim, spaces and tabs around unquoted cell text are dropped.
+//
+// Quoting, escaping and row rules otherwise match CDSVReader, which
+// dispatches the common dialects to instantiations of this template.
+template <char Delimiter, char Quote = '"', EDSVLineEnding LineEnding = EDSVLineEnding::Any, bool Trim = false, typename TSource = CDataSource>
+class TDSVReader{
+    static_assert(Delimiter != Quote, "the delimiter and quote must differ");
+    static_assert(Delimiter != '\n' && Delimiter != '\r' && Quote != '\n' && Quote != '\r', "line endings cannot delimit or quote");
+
+    private:
+        enum EClass : unsigned char{
+            Plain,
+            DelimiterClass,
+            QuoteClass,
+            NewlineClass,
+            ReturnClass,
+            SpaceClass
+        };
+
+        static constexpr std::array<unsigned char, 256> BuildClasses(){
+            std::array<unsigned char, 256> Classes{};
+            if(Trim){
+                Classes[static_cast<unsigned char>(' ')] = SpaceClass;
+                Classes[static_cast<unsigned char>('\t')] = SpaceClass;
+            }
+            Classes[static_cast<unsigned char>('\n')] = NewlineClass;
+            if(LineEnding == EDSVLineEnding::Any){
+                Classes[static_cast<unsigned char>('\r')] = ReturnClass;
+            }
+            Classes[static_cast<unsigned char>(Delimiter)] = DelimiterClass;
+            Classes[static_cast<unsigned char>(Quote)] = QuoteClass;
+            return Classes;
+        }
+
+        static constexpr std::array<unsigned char, 256> DClasses = BuildClasses();
+
+        std::shared_ptr<TSource> DSource;
+        // row backing the string_view overload, reused between calls
+        std::vector<std::string> DViewRow;
+
+        template <typename TRow>
+        bool Parse(TRow &row){
+            std::size_t CellCount = 0;
+            auto *Cell = DSVReaderDetail::NextCell(row, CellCount);
+            bool InQuotes = false;
+            bool Data = false;
+            // with Trim, the cell length once unquoted trailing spaces are cut
+            std::size_t Keep = 0;
+            char Char;
+            DSV_METRIC_ONLY(std::size_t BytesRead = 0);
+            DSV_METRIC_ONLY(std::size_t QuotedCells = 0);
+            DSV_METRIC_ONLY(bool CellQuoted = false);
+            while(!DSource->End()){
+                if(!DSource->Get(Char)){
+                    row.resize(0);
+                    return false;
+                }
+                Data = true;
+                DSV_METRIC_ONLY(BytesRead++);
+                switch(DClasses[static_cast<unsigned char>(Char)]){
+                    case QuoteClass:{
+                        // a doubled quote is a literal quote, anything else toggles
+                        char Next;
+                        if(DSource->Peek(Next) && Next == Quote){
+                            DSource->Get(Next);
+                            Cell->push_back(Quote);
+                            Keep = Cell->size();
+                            DSV_METRIC_ONLY(BytesRead++);
+                        }
+                        else{
+                            InQuotes = !InQuotes;
+                            DSV_METRIC_ONLY(CellQuoted |= InQuotes);
+                        }
+                        break;
+                    }
+                    case DelimiterClass:
+                        if(InQuotes){
+                            Cell->push_back(Char);
+                            Keep = Cell->size();
+                            break;
+                        }
+                        if(Trim){
+                            Cell->resize(Keep);
+                            Keep = 0;
+                        }
+                        DSV_METRIC_ONLY(QuotedCells += CellQuoted);
+                        DSV_METRIC_ONLY(CellQuoted = false);
+                        Cell = DSVReaderDetail::NextCell(row, ++CellCount);
+                        break;
+                    case NewlineClass:
+                    case ReturnClass:
+                        if(InQuotes){
+                            Cell->push_back(Char);
+                            Keep = Cell->size();
+                            break;
+                        }
+                        if(Trim){
+                            Cell->resize(Keep);
+                        }
+                        if(!Cell->empty() || CellCount > 0){
+                            CellCount++;
+                        }
+                        row.resize(CellCount);
+                        if(LineEnding == EDSVLineEnding::Any && Char == '\r'){
+                            char Next;
+                            if(DSource->Peek(Next) && Next == '\n'){
+                                DSource->Get(Next);
+                                DSV_METRIC_ONLY(BytesRead++);
+                            }
+                        }
+                        DSV_METRIC_ONLY(DSVReaderDetail::RecordRow(BytesRead, CellCount, QuotedCells + CellQuoted));
+                        return true;
+                    case SpaceClass:
+                        // leading spaces are skipped, trailing ones cut at the end
+                        if(InQuotes){
+                            Cell->push_back(Char);
+                            Keep = Cell->size();
+                        }
+                        else if(!Cell->empty()){
+                            Cell->push_back(Char);
+                        }
+                        break;
+                    default:
+                        Cell->push_back(Char);
+                        if constexpr(SDSVBufferedSource<TSource>::value){
+                            // take the rest of the plain run in one append
+                            std::string_view Window = DSource->Buffered();
+                            std::size_t Run = 0;
+                            while(Run < Window.size() && DClasses[static_cast<unsigned char>(Window[Run])] == Plain){
+                                Run++;
+                            }
+                            Cell->append(Window.data(), Run);
+                            DSource->Consume(Run);
+                            DSV_METRIC_ONLY(BytesRead += Run);
+                        }
+                        Keep = Cell->size();
+                        break;
+                }
+            }
+            if(Trim){
+                Cell->resize(Keep);
+            }
+            if(!Cell->empty() || Data){
+                CellCount++;
+            }
+            row.resize(CellCount);
+            if(Data){
+                DSV_METRIC_ONLY(DSVReaderDetail::RecordRow(BytesRead, CellCount, QuotedCells + CellQuoted));
+            }
+            return Data;
+        }
+
+    public:
+        explicit TDSVReader(std::shared_ptr<TSource> src) : DSource(std::move(src)){
+
+        }
+
+        bool End() const{
+            return DSource->End();
+        }
+
+        bool ReadRow(std::vector<std::string> &row){
+            return Parse(row);
+        }
+
+        // cells are allocated from the row's memory resource (e.g. a CMemoryArena)
+        bool ReadRow(std::pmr::vector<std::pmr::string> &row){
+            return Parse(row);
+        }
+
+        // cells point into the reader's own buffer and stay valid until the
+        // next ReadRow call
+        bool ReadRow(std::vector<std::string_view> &row){
+            bool Result = Parse(DViewRow);
+            row.assign(DViewRow.begin(), DViewRow.end());
+            return Result;
+        }
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef DSVROWFILTER_H
+#define DSVROWFILTER_H
+
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Predicates on column indices for CDSVReader::ReadRow(row, filter). A row
+// is kept only when every predicate holds; the reader checks each cell as
+// soon as it is complete, on the parsed bytes, and stops collecting a row
+// at the first failure. A row without a column that has a predicate is
+// rejected. Predicates on the same column are all applied.
+class CDSVRowFilter{
+    private:
+        enum class EKind{Equals, Prefix, Range, OneOf};
+
+        struct SPredicate{
+            EKind DKind;
+            std::size_t DColumn;
+            std::string DValue;
+            double DMinimum;
+            double DMaximum;
+            // sorted, for OneOf
+            std::vector<std::string> DValues;
+        };
+
+        std::vector<SPredicate> DPredicates;
+        // predicate indices for each column, in the order they were added
+        std::vector< std::vector<std::size_t> > DByColumn;
+
+        CDSVRowFilter &Add(SPredicate predicate);
+
+    public:
+        // the cell is exactly value
+        CDSVRowFilter &Equals(std::size_t column, std::string value);
+        // the cell starts with prefix
+        CDSVRowFilter &Prefix(std::size_t column, std::string prefix);
+        // the cell is a number in [minimum, maximum]; cells that are not
+        // numbers are rejected
+        CDSVRowFilter &Range(std::size_t column, double minimum, double maximum = std::numeric_limits<double>::infinity());
+        // the cell is one of values
+        CDSVRowFilter &OneOf(std::size_t column, std::vector<std::string> values);
+
+        bool Empty() const noexcept;
+        // number of leading columns with predicates; a row needs at least this many
+        std::size_t ColumnCount() const noexcept;
+        bool HasPredicates(std::size_t column) const noexcept;
+        // true when every predicate on the column accepts the cell
+        bool Accept(std::size_t column, std::string_view cell) const noexcept;
+        // the whole check on an already parsed row
+        bool Matches(const std::vector<std::string> &row) const noexcept;
+};
+
+#endif
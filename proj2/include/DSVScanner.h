@@ -0,0 +1,56 @@
+#ifndef DSVSCANNER_H
+#define DSVSCANNER_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// What a scan found. Field lengths are raw bytes, quotes included.
+struct SDSVScanStats{
+    std::uint64_t DBytes = 0;
+    std::uint64_t DRowCount = 0;
+    std::size_t DMaxFieldCount = 0;
+    std::size_t DMaxFieldLength = 0;
+    // rows per field count; a blank line is a row of 0 fields
+    std::map<std::size_t, std::uint64_t> DFieldCountHistogram;
+    // rows whose quoting is broken: a quote that does not start a field,
+    // text right after a closing quote, or a quote still open at the end
+    std::uint64_t DMalformedRowCount = 0;
+    // byte offsets where the first of those rows start, up to the limit
+    // given to the scanner
+    std::vector<std::uint64_t> DMalformedRowOffsets;
+
+    // every row has the same number of fields
+    bool Consistent() const noexcept{
+        return DFieldCountHistogram.size() <= 1;
+    };
+};
+
+// Scan-only pass over DSV input for sizing and validating a file before it
+// is loaded. Input is classified 64 bytes at a time with SIMDUtils, quote
+// state is carried through each block as a prefix-xor of the quote bits,
+// and only the unquoted delimiters and line endings are then visited, so
+// no cell is ever copied. Rows and fields are split exactly as CDSVReader
+// splits them.
+class CDSVScanner{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        explicit CDSVScanner(char delimiter, std::size_t maxmalformed = 1024);
+        ~CDSVScanner();
+
+        // input may be split anywhere between calls
+        void Feed(const char *data, std::size_t length);
+        // ends the input; the stats are final from here on
+        const SDSVScanStats &Finish();
+        const SDSVScanStats &Stats() const noexcept;
+
+        // scans a whole file, false when it cannot be opened
+        static bool ScanFile(const std::string &filename, char delimiter, SDSVScanStats &stats, std::size_t maxmalformed = 1024);
+};
+
+#endif
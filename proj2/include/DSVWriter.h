@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "DataSink.h"
 
 class CDSVWriter{
@@ -15,6 +16,10 @@ class CDSVWriter{
         ~CDSVWriter();
 
         bool WriteRow(const std::vector<std::string> &row);
+
+        // appends one formatted row (newline included) to buffer using the
+        // same quoting rules as WriteRow; shared with CParallelDSVWriter
+        static void FormatRow(const std::vector<std::string> &row, char delimiter, bool quoteall, std::vector<char> &buffer);
 };
 
 #endif
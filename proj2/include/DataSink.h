@@ -8,6 +8,9 @@ class CDataSink{
         virtual ~CDataSink(){};
         virtual bool Put(const char &ch) noexcept = 0;
         virtual bool Write(const std::vector<char> &buf) noexcept = 0;
+        // pushes out anything the sink buffers internally; unbuffered sinks
+        // have nothing to do
+        virtual bool Flush() noexcept{ return true; };
 };
 
 #endif
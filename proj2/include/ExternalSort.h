@@ -0,0 +1,39 @@
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "DSVReader.h"
+#include "DSVWriter.h"
+
+// one sort key; numeric keys compare as doubles and cells that are not
+// numbers sort after every number
+struct SSortKey{
+    std::size_t DColumn;
+    bool DNumeric = false;
+    bool DDescending = false;
+};
+
+// Sorts DSV input of any size in bounded memory. Rows are read into runs of
+// at most memorybudget bytes, each run is sorted on threads threads (0 = one
+// per hardware thread) and spilled to a temporary binary file under
+// tempdirectory, and the runs are combined with a loser-tree k-way merge.
+// Input that fits in one run is never spilled. Rows that compare equal keep
+// their input order. Missing cells compare as empty strings.
+class CExternalSort{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CExternalSort(std::vector<SSortKey> keys, std::size_t memorybudget = 256 << 20, std::size_t threads = 0, const std::string &tempdirectory = "/tmp");
+        ~CExternalSort();
+
+        // reads every remaining row of reader and writes them sorted
+        bool Sort(CDSVReader &reader, CDSVWriter &writer);
+        // runs spilled by the last Sort, 0 when it fit in memory
+        std::size_t RunCount() const noexcept;
+};
+
+#endif
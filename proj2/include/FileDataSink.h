@@ -0,0 +1,33 @@
+#ifndef FILEDATASINK_H
+#define FILEDATASINK_H
+
+#include "DataSink.h"
+#include <string>
+
+// Buffered sink over a file descriptor; data reaches the file on Flush(),
+// when the buffer fills, or on destruction.
+class CFileDataSink : public CDataSink{
+    private:
+        int DFileDescriptor;
+        bool DOwnsDescriptor;
+        std::vector<char> DBuffer;
+        std::size_t DLength;
+        bool DFailed;
+
+        bool WriteAll(const char *data, std::size_t length) noexcept;
+
+    public:
+        CFileDataSink(const std::string &filename, bool append = false, std::size_t buffersize = 1 << 16);
+        CFileDataSink(int fd, bool ownsfd = false, std::size_t buffersize = 1 << 16);
+        CFileDataSink(const CFileDataSink &) = delete;
+        CFileDataSink &operator=(const CFileDataSink &) = delete;
+        ~CFileDataSink();
+
+        bool IsOpen() const noexcept;
+        bool Flush() noexcept override;
+
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef FILEDATASOURCE_H
+#define FILEDATASOURCE_H
+
+#include "DataSource.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Buffered source over a file descriptor (regular file, pipe or socket).
+// The class is final and its per-character calls are inline, so parsers
+// holding a CFileDataSource directly (TDSVReader) get no virtual calls.
+class CFileDataSource final : public CDataSource{
+    private:
+        int DFileDescriptor;
+        bool DOwnsDescriptor;
+        std::vector<char> DBuffer;
+        std::size_t DPosition;
+        std::size_t DLength;
+        bool DEndOfFile;
+
+        bool Fill() noexcept;
+
+    public:
+        CFileDataSource(const std::string &filename, std::size_t buffersize = 1 << 16);
+        CFileDataSource(int fd, bool ownsfd = false, std::size_t buffersize = 1 << 16);
+        CFileDataSource(const CFileDataSource &) = delete;
+        CFileDataSource &operator=(const CFileDataSource &) = delete;
+        ~CFileDataSource();
+
+        bool IsOpen() const noexcept;
+        // repositions a regular file, dropping anything buffered
+        bool Seek(std::uint64_t offset) noexcept;
+        // the current size of a regular file, false when it has none
+        bool Size(std::uint64_t &size) const noexcept;
+
+        // the bytes already buffered, refilling first when there are none;
+        // empty at end of file. Consume(count) steps over count of them
+        std::string_view Buffered() noexcept;
+        void Consume(std::size_t count) noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+};
+
+inline bool CFileDataSource::End() const noexcept{
+    // End is const but has to look ahead to know whether the file is done
+    return DPosition >= DLength && !const_cast<CFileDataSource *>(this)->Fill();
+}
+
+inline bool CFileDataSource::Get(char &ch) noexcept{
+    if(DPosition >= DLength && !Fill()){
+        return false;
+    }
+    ch = DBuffer[DPosition++];
+    return true;
+}
+
+inline std::string_view CFileDataSource::Buffered() noexcept{
+    if(DPosition >= DLength && !Fill()){
+        return std::string_view();
+    }
+    return std::string_view(DBuffer.data() + DPosition, DLength - DPosition);
+}
+
+inline void CFileDataSource::Consume(std::size_t count) noexcept{
+    DPosition += count;
+}
+
+inline bool CFileDataSource::Peek(char &ch) noexcept{
+    if(DPosition >= DLength && !Fill()){
+        return false;
+    }
+    ch = DBuffer[DPosition];
+    return true;
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef FOLLOWINGDSVREADER_H
+#define FOLLOWINGDSVREADER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "DSVPushParser.h"
+
+// Reads rows from a DSV file that is still being appended to. Bytes are
+// parsed once, as they are written, through CDSVPushParser; a trailing row
+// without its line ending stays inside the parser until the rest arrives,
+// so ReadRow only ever returns complete rows. Checkpoint() after a row can
+// be saved and handed to a later reader to carry on from the next one.
+class CFollowingDSVReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CFollowingDSVReader(const std::string &filename, char delimiter, const SDSVCheckpoint &checkpoint = SDSVCheckpoint(), std::size_t buffersize = 1 << 16);
+        ~CFollowingDSVReader();
+
+        bool IsOpen() const noexcept;
+
+        // waits up to timeoutms (-1 for no limit) for the next complete row,
+        // false on timeout or Stop
+        bool ReadRow(std::vector<std::string> &row, int timeoutms = -1);
+        // just past the last row ReadRow returned
+        SDSVCheckpoint Checkpoint() const noexcept;
+        // wakes a waiting ReadRow; safe to call from any thread
+        void Stop() noexcept;
+};
+
+#endif
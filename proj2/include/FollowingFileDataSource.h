@@ -0,0 +1,66 @@
+#ifndef FOLLOWINGFILEDATASOURCE_H
+#define FOLLOWINGFILEDATASOURCE_H
+
+#include "DataSource.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Source over a file that other processes are still appending to, like
+// tail -f. Reading starts at a byte offset; at the current end of the file
+// the source sleeps on an inotify watch until more bytes are written, so it
+// wakes as soon as an append lands and never polls.
+//
+// Buffered() and Wait() let a parser take exactly what has been written so
+// far without blocking. Get, Peek, Read and End wait up to the timeout set
+// with SetTimeout (by default until Stop()), which makes the source usable
+// with the blocking readers too. Truncation and rotation are not detected.
+class CFollowingFileDataSource final : public CDataSource{
+    private:
+        int DFileDescriptor;
+        int DNotifyDescriptor;
+        int DStopDescriptor;
+        std::vector<char> DBuffer;
+        std::size_t DPosition;
+        std::size_t DLength;
+        // file offset just past the buffered bytes
+        std::uint64_t DFileOffset;
+        int DTimeout;
+        std::atomic<bool> DStopped;
+
+        bool Fill() noexcept;
+
+    public:
+        CFollowingFileDataSource(const std::string &filename, std::uint64_t offset = 0, std::size_t buffersize = 1 << 16);
+        CFollowingFileDataSource(const CFollowingFileDataSource &) = delete;
+        CFollowingFileDataSource &operator=(const CFollowingFileDataSource &) = delete;
+        ~CFollowingFileDataSource();
+
+        bool IsOpen() const noexcept;
+
+        // milliseconds Get, Peek, Read and End wait for an append, -1 for no limit
+        void SetTimeout(int milliseconds) noexcept;
+        // wakes every waiter and ends the input once the file is drained;
+        // safe to call from any thread
+        void Stop() noexcept;
+        bool Stopped() const noexcept;
+
+        // file offset of the next byte to be consumed
+        std::uint64_t Offset() const noexcept;
+
+        // the bytes written so far and not yet consumed, empty when there are
+        // none right now; never waits
+        std::string_view Buffered() noexcept;
+        void Consume(std::size_t count) noexcept;
+        // waits up to milliseconds (-1 for no limit) for unconsumed bytes,
+        // false on timeout or Stop
+        bool Wait(int milliseconds) noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+};
+
+#endif
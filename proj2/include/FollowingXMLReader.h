@@ -0,0 +1,37 @@
+#ifndef FOLLOWINGXMLREADER_H
+#define FOLLOWINGXMLREADER_H
+
+#include <memory>
+#include <string>
+#include "XMLEntity.h"
+#include "XMLPushParser.h"
+
+// Reads entities from an XML file that is still being appended to, e.g. a
+// log whose root element is never closed. Bytes are parsed once, as they
+// are written, through CXMLPushParser; an element whose tag is cut off
+// stays inside the parser until the rest arrives. Checkpoint() after an
+// entity can be saved and handed to a later reader to carry on from the
+// next one.
+class CFollowingXMLReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CFollowingXMLReader(const std::string &filename, const SXMLCheckpoint &checkpoint = SXMLCheckpoint(), std::size_t buffersize = 1 << 16);
+        ~CFollowingXMLReader();
+
+        bool IsOpen() const noexcept;
+        // the file holds malformed XML
+        bool Failed() const noexcept;
+
+        // waits up to timeoutms (-1 for no limit) for the next entity, false
+        // on timeout, Stop or malformed XML
+        bool ReadEntity(SXMLEntity &entity, bool skipcdata = false, int timeoutms = -1);
+        // just past the last entity ReadEntity returned
+        SXMLCheckpoint Checkpoint() const;
+        // wakes a waiting ReadEntity; safe to call from any thread
+        void Stop() noexcept;
+};
+
+#endif
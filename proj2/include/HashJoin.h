@@ -0,0 +1,42 @@
+#ifndef HASHJOIN_H
+#define HASHJOIN_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "DSVReader.h"
+#include "DSVWriter.h"
+
+enum class EJoinType{Inner, Left};
+
+// Equi-join of two DSV inputs. The build input (the smaller one) is loaded
+// into a flat open-addressing hash table on buildkeys, with its rows kept in
+// a CMemoryArena. The probe input is then streamed through the table and
+// every match is written as the probe row followed by the build row without
+// its key columns. A left join also writes unmatched probe rows, padded with
+// empty cells. Output follows probe order, and matches for one probe row
+// follow build order.
+//
+// When the build side outgrows memorybudget bytes, the join switches to a
+// grace join: both inputs are hashed into partitions spilled under
+// tempdirectory and joined one partition at a time. Output is then grouped
+// by partition instead of following probe order. One partition must fit in
+// memory; heavily skewed keys can exceed the budget.
+class CHashJoin{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CHashJoin(std::vector<std::size_t> buildkeys, std::vector<std::size_t> probekeys, EJoinType type = EJoinType::Inner, std::size_t memorybudget = std::size_t(1) << 30, std::size_t partitions = 64, const std::string &tempdirectory = "/tmp");
+        ~CHashJoin();
+
+        // false when reading, spilling or writing fails, or when buildkeys
+        // and probekeys differ in length
+        bool Join(CDSVReader &build, CDSVReader &probe, CDSVWriter &output);
+        // true when the last Join had to partition to disk
+        bool Spilled() const noexcept;
+        std::size_t OutputRows() const noexcept;
+};
+
+#endif
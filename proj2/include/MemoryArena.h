@@ -0,0 +1,49 @@
+#ifndef MEMORYARENA_H
+#define MEMORYARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Monotonic arena usable anywhere a std::pmr::memory_resource is accepted.
+// Deallocation is a no-op; Reset() rewinds to the first block but keeps every
+// block it has obtained, so once an arena has grown to the size of a row or
+// batch, refilling it never goes back to the upstream resource.
+class CMemoryArena : public std::pmr::memory_resource{
+    private:
+        struct SBlock{
+            char *DData;
+            std::size_t DSize;
+        };
+        std::pmr::memory_resource *DUpstream;
+        std::vector< SBlock > DBlocks;
+        std::size_t DBlockSize;
+        std::size_t DCurrentBlock;
+        std::size_t DOffset;
+        std::size_t DBytesUsed;
+        std::size_t DUpstreamAllocations;
+
+        bool Fits(std::size_t block, std::size_t bytes, std::size_t alignment) const noexcept;
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    public:
+        explicit CMemoryArena(std::size_t blocksize = 64 * 1024, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+        CMemoryArena(const CMemoryArena &) = delete;
+        CMemoryArena &operator=(const CMemoryArena &) = delete;
+        ~CMemoryArena();
+
+        // rewinds the arena; everything allocated from it must already be dead
+        void Reset() noexcept;
+        // rewinds and hands every block back to the upstream resource
+        void Release() noexcept;
+
+        std::size_t BytesUsed() const noexcept;
+        std::size_t BytesReserved() const noexcept;
+        std::size_t UpstreamAllocations() const noexcept;
+};
+
+#endif
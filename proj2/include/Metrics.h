@@ -0,0 +1,123 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Counters and trace spans for the readers, writers, sources and sinks.
+// Instrumentation goes through the DSV_METRIC_* and DSV_TRACE_SPAN macros,
+// which expand to nothing unless the library is built with
+// DSV_ENABLE_METRICS (make METRICS=1). The functions below always exist;
+// without the flag Collect() returns zeros and no trace is recorded.
+//
+// Each thread counts into its own slots, so adding to a counter is a
+// single relaxed store with no sharing. Collect() sums every live thread
+// plus the totals left by threads that have exited. Reset() records the
+// current totals as a baseline that Collect() subtracts, so it may be
+// called while other threads are counting.
+namespace Metrics{
+
+enum class ECounter{
+    BytesRead,
+    BytesWritten,
+    RowsRead,
+    RowsWritten,
+    CellsRead,
+    CellsWritten,
+    QuotedCellsRead,
+    QuotedCellsWritten,
+    EntitiesRead,
+    EntitiesWritten,
+    // extra bytes added by quoting and escaping on output
+    BytesEscaped,
+    // blocks fetched from an upstream allocator by arenas and buffers
+    Allocations,
+    // time a consumer waited for its source, or a producer for its sink
+    SourceWaitNanoseconds,
+    SinkWaitNanoseconds,
+    Count
+};
+
+struct SSnapshot{
+    std::array<std::uint64_t, static_cast<std::size_t>(ECounter::Count)> DValues{};
+
+    std::uint64_t operator[](ECounter counter) const noexcept{
+        return DValues[static_cast<std::size_t>(counter)];
+    };
+
+    // share of cells that were quoted, over both reading and writing
+    double QuotedCellRatio() const noexcept{
+        std::uint64_t Cells = (*this)[ECounter::CellsRead] + (*this)[ECounter::CellsWritten];
+        return Cells ? static_cast<double>((*this)[ECounter::QuotedCellsRead] + (*this)[ECounter::QuotedCellsWritten]) / Cells : 0.0;
+    };
+};
+
+const char *CounterName(ECounter counter) noexcept;
+
+void Add(ECounter counter, std::uint64_t value) noexcept;
+SSnapshot Collect() noexcept;
+void Reset() noexcept;
+// one "name value" line per counter
+std::string Report();
+
+// spans are only recorded between StartTracing and StopTracing
+void StartTracing() noexcept;
+void StopTracing() noexcept;
+// recorded spans in the Chrome trace event format (chrome://tracing,
+// Perfetto); the spans are kept until ClearTrace
+std::string ChromeTraceJSON();
+void ClearTrace() noexcept;
+
+// nanoseconds on a monotonic clock
+std::uint64_t Now() noexcept;
+
+// records a complete event from construction to destruction; name must
+// outlive the trace (string literals)
+class CTraceSpan{
+    private:
+        const char *DName;
+        std::uint64_t DStart;
+
+    public:
+        explicit CTraceSpan(const char *name) noexcept;
+        CTraceSpan(const CTraceSpan &) = delete;
+        CTraceSpan &operator=(const CTraceSpan &) = delete;
+        ~CTraceSpan();
+};
+
+// adds the time between construction and destruction to a counter
+class CScopedTimer{
+    private:
+        ECounter DCounter;
+        std::uint64_t DStart;
+
+    public:
+        explicit CScopedTimer(ECounter counter) noexcept : DCounter(counter), DStart(Now()){};
+        CScopedTimer(const CScopedTimer &) = delete;
+        CScopedTimer &operator=(const CScopedTimer &) = delete;
+        ~CScopedTimer(){
+            Add(DCounter, Now() - DStart);
+        };
+};
+
+}
+
+#define DSV_METRIC_CONCAT_INNER(a, b) a##b
+#define DSV_METRIC_CONCAT(a, b) DSV_METRIC_CONCAT_INNER(a, b)
+
+#ifdef DSV_ENABLE_METRICS
+#define DSV_METRIC_ADD(counter, value) ::Metrics::Add(::Metrics::ECounter::counter, (value))
+#define DSV_METRIC_TIMER(counter) ::Metrics::CScopedTimer DSV_METRIC_CONCAT(MetricTimer, __LINE__)(::Metrics::ECounter::counter)
+#define DSV_TRACE_SPAN(name) ::Metrics::CTraceSpan DSV_METRIC_CONCAT(TraceSpan, __LINE__)(name)
+// code that only feeds counters, such as tallies kept locally in a loop
+// and added once per row
+#define DSV_METRIC_ONLY(...) __VA_ARGS__
+#else
+#define DSV_METRIC_ADD(counter, value) ((void)0)
+#define DSV_METRIC_TIMER(counter) ((void)0)
+#define DSV_TRACE_SPAN(name) ((void)0)
+#define DSV_METRIC_ONLY(...)
+#endif
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef ORDEREDJOBQUEUE_H
+#define ORDEREDJOBQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Metrics.h"
+
+// Worker pool behind CCompressingDataSink and CParallelDSVWriter. Jobs are
+// processed on threads worker threads, the oldest unstarted first, and
+// handed to the write callback one at a time: in submission order, or as
+// each finishes when ordered is false. Whichever worker finishes a job
+// writes whatever is ready, so no thread is spent only on writing. At most
+// maxinflight jobs are queued; Submit waits for room beyond that.
+//
+// Process runs concurrently and gets the index of its worker for any
+// per-thread state; write never overlaps itself. A false from either
+// fails the queue, after which Submit and Drain return false. Finished
+// jobs go back to a pool that Acquire hands out again, so their buffers
+// are reused; clearing them is up to the caller.
+template <typename TJob>
+class TOrderedJobQueue{
+    public:
+        using TProcess = std::function<bool(TJob &job, std::size_t worker)>;
+        using TWrite = std::function<bool(TJob &job)>;
+
+    private:
+        struct SEntry{
+            std::unique_ptr<TJob> DJob;
+            bool DStarted = false;
+            bool DDone = false;
+            bool DSuccess = false;
+        };
+
+        TProcess DProcess;
+        TWrite DWrite;
+        bool DOrdered;
+        std::size_t DMaxInFlight;
+        // submitted jobs in submission order
+        std::deque< std::unique_ptr<SEntry> > DInFlight;
+        // written jobs kept for their buffers
+        std::vector< std::unique_ptr<TJob> > DFree;
+        std::mutex DMutex;
+        std::condition_variable DWork;
+        std::condition_variable DSpace;
+        // only one thread at a time writes, which keeps the jobs in order
+        bool DWriting;
+        bool DStop;
+        // read without the lock by callers checking for failure
+        std::atomic<bool> DFailed;
+        std::vector<std::thread> DThreads;
+
+        void Work(std::size_t worker){
+            std::unique_lock<std::mutex> Lock(DMutex);
+            while(true){
+                SEntry *Next = nullptr;
+                DWork.wait(Lock, [&]{
+                    for(auto &Entry : DInFlight){
+                        if(!Entry->DStarted){
+                            Next = Entry.get();
+                            return true;
+                        }
+                    }
+                    return DStop;
+                });
+                if(!Next){
+                    return;
+                }
+                Next->DStarted = true;
+                Lock.unlock();
+                bool Success = DProcess(*Next->DJob, worker);
+                Lock.lock();
+                Next->DDone = true;
+                Next->DSuccess = Success;
+                DrainLocked(Lock);
+            }
+        }
+
+        // next job that may be written: the front one when ordered, any
+        // finished one otherwise
+        typename std::deque< std::unique_ptr<SEntry> >::iterator NextWritable(){
+            if(DOrdered){
+                return (!DInFlight.empty() && DInFlight.front()->DDone) ? DInFlight.begin() : DInFlight.end();
+            }
+            for(auto Iter = DInFlight.begin(); Iter != DInFlight.end(); ++Iter){
+                if((*Iter)->DDone){
+                    return Iter;
+                }
+            }
+            return DInFlight.end();
+        }
+
+        // writes finished jobs until the next one is not ready
+        void DrainLocked(std::unique_lock<std::mutex> &lock){
+            if(DWriting){
+                return;
+            }
+            DWriting = true;
+            for(auto Iter = NextWritable(); Iter != DInFlight.end(); Iter = NextWritable()){
+                std::unique_ptr<SEntry> Entry = std::move(*Iter);
+                DInFlight.erase(Iter);
+                lock.unlock();
+                bool Success = Entry->DSuccess && !DFailed.load() && DWrite(*Entry->DJob);
+                lock.lock();
+                if(!Success){
+                    DFailed.store(true);
+                }
+                DFree.push_back(std::move(Entry->DJob));
+                DSpace.notify_all();
+            }
+            DWriting = false;
+            DSpace.notify_all();
+        }
+
+    public:
+        TOrderedJobQueue(std::size_t threads, std::size_t maxinflight, bool ordered, TProcess process, TWrite write)
+            : DProcess(std::move(process)), DWrite(std::move(write)), DOrdered(ordered), DMaxInFlight(maxinflight ? maxinflight : 1), DWriting(false), DStop(false), DFailed(false){
+            for(std::size_t Index = 0; Index < (threads ? threads : 1); Index++){
+                DThreads.emplace_back([this, Index]{ Work(Index); });
+            }
+        }
+
+        TOrderedJobQueue(const TOrderedJobQueue &) = delete;
+        TOrderedJobQueue &operator=(const TOrderedJobQueue &) = delete;
+
+        ~TOrderedJobQueue(){
+            Stop();
+        }
+
+        // a pooled job when there is one, else a new one
+        std::unique_ptr<TJob> Acquire(){
+            std::unique_lock<std::mutex> Lock(DMutex);
+            if(DFree.empty()){
+                return std::make_unique<TJob>();
+            }
+            std::unique_ptr<TJob> Job = std::move(DFree.back());
+            DFree.pop_back();
+            return Job;
+        }
+
+        bool Submit(std::unique_ptr<TJob> job){
+            std::unique_lock<std::mutex> Lock(DMutex);
+            {
+                DSV_METRIC_TIMER(SinkWaitNanoseconds);
+                DSpace.wait(Lock, [&]{ return DInFlight.size() < DMaxInFlight; });
+            }
+            auto Entry = std::make_unique<SEntry>();
+            Entry->DJob = std::move(job);
+            DInFlight.push_back(std::move(Entry));
+            DWork.notify_one();
+            return !DFailed.load();
+        }
+
+        // waits until every submitted job has been written
+        bool Drain(){
+            std::unique_lock<std::mutex> Lock(DMutex);
+            DSpace.wait(Lock, [&]{ return DInFlight.empty() && !DWriting; });
+            return !DFailed.load();
+        }
+
+        // drains, then ends the workers; nothing may be submitted after
+        void Stop(){
+            Drain();
+            {
+                std::unique_lock<std::mutex> Lock(DMutex);
+                DStop = true;
+                DWork.notify_all();
+            }
+            for(auto &Thread : DThreads){
+                Thread.join();
+            }
+            DThreads.clear();
+        }
+
+        void Fail() noexcept{
+            DFailed.store(true);
+        }
+
+        bool Failed() const noexcept{
+            return DFailed.load();
+        }
+};
+
+#endif
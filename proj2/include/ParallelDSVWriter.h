@@ -0,0 +1,33 @@
+#ifndef PARALLELDSVWRITER_H
+#define PARALLELDSVWRITER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataSink.h"
+
+// DSV writer for many producer threads. Rows are grouped into batches that
+// worker threads format concurrently with CDSVWriter's quoting rules; the
+// formatted batches are written to the sink in submission order, or as soon
+// as each is ready when ordered is false. All methods may be called from any
+// thread. WriteRows submits its rows as one batch and is the cheap path for
+// producers that already batch; WriteRow collects rows into a shared batch
+// of batchrows. Flush() waits until everything submitted reached the sink;
+// Close() also stops the workers and is called on destruction.
+class CParallelDSVWriter{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        // threads of 0 uses one per hardware thread
+        CParallelDSVWriter(std::shared_ptr< CDataSink > sink, char delimiter, bool quoteall = false, std::size_t threads = 0, bool ordered = true, std::size_t batchrows = 1024);
+        ~CParallelDSVWriter();
+
+        bool WriteRow(const std::vector<std::string> &row);
+        bool WriteRows(std::vector< std::vector<std::string> > rows);
+        bool Flush();
+        bool Close();
+};
+
+#endif
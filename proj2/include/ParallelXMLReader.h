@@ -0,0 +1,35 @@
+#ifndef PARALLELXMLREADER_H
+#define PARALLELXMLREADER_H
+
+#include <memory>
+#include <string>
+#include "XMLEntity.h"
+
+// Reader for large documents made of many sibling records, e.g. one root
+// wrapping millions of <record> elements. The file is memory-mapped and
+// scanned for the start tags of elements at recorddepth (1 = children of
+// the root), skipping comments, CDATA, processing instructions and quoted
+// attribute values. The document is cut at those tags into chunks of about
+// chunksize bytes, each parsed by its own Expat parser on a pool of threads
+// (0 = one per hardware thread). ReadEntity returns the same entities as
+// CXMLReader would, in document order. Documents with an internal DTD
+// subset are parsed as a single chunk since their entities are only defined
+// at the top.
+class CParallelXMLReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CParallelXMLReader(const std::string &filename, std::size_t recorddepth = 1, std::size_t threads = 0, std::size_t chunksize = 1 << 20);
+        ~CParallelXMLReader();
+
+        bool IsOpen() const noexcept;
+        // true once a chunk failed to parse; no entities are returned past it
+        bool Failed() const noexcept;
+
+        bool End() const;
+        bool ReadEntity(SXMLEntity &entity, bool skipcdata = false);
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef PREFETCHDATASOURCE_H
+#define PREFETCHDATASOURCE_H
+
+#include <chrono>
+#include <memory>
+#include "DataSource.h"
+
+// Decorator that reads ahead from any CDataSource on a background thread.
+// The producer fills a ring of buffers with Read() calls on the wrapped
+// source; Get/Peek/Read are served from the ready buffer and only wait when
+// the ring is empty. The wrapped source must not be used by anyone else
+// once it has been handed over.
+class CPrefetchDataSource : public CDataSource{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CPrefetchDataSource(std::shared_ptr< CDataSource > src, std::size_t buffersize = 1 << 20, std::size_t buffercount = 4);
+        ~CPrefetchDataSource();
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+
+        // time and number of times the consumer waited for data (I/O-bound)
+        std::chrono::nanoseconds ConsumerStallTime() const noexcept;
+        std::size_t ConsumerStalls() const noexcept;
+        // time the background thread waited for a free buffer (CPU-bound)
+        std::chrono::nanoseconds ProducerStallTime() const noexcept;
+};
+
+#endif
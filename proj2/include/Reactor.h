@@ -0,0 +1,59 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <coroutine>
+#include <memory>
+#include "Task.h"
+
+// Single-threaded epoll loop that resumes coroutines once a descriptor is
+// readable or writable. co_await Readable(fd) / Writable(fd) suspends the
+// calling coroutine until then; descriptors epoll cannot watch (regular
+// files) are always ready, so awaiting them never suspends. Spawn() adds a
+// top-level task and Run() drives every spawned task to completion.
+class CEpollReactor{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+        // false when the descriptor cannot be watched and the caller should
+        // carry on without suspending
+        bool Watch(int fd, bool write, std::coroutine_handle<> handle) noexcept;
+
+    public:
+        struct SWait{
+            CEpollReactor &DReactor;
+            int DFileDescriptor;
+            bool DWrite;
+
+            bool await_ready() const noexcept{
+                return false;
+            };
+
+            bool await_suspend(std::coroutine_handle<> handle) noexcept{
+                return DReactor.Watch(DFileDescriptor, DWrite, handle);
+            };
+
+            void await_resume() const noexcept{};
+        };
+
+        CEpollReactor();
+        CEpollReactor(const CEpollReactor &) = delete;
+        CEpollReactor &operator=(const CEpollReactor &) = delete;
+        ~CEpollReactor();
+
+        bool IsOpen() const noexcept;
+
+        SWait Readable(int fd) noexcept{
+            return SWait{*this, fd, false};
+        };
+
+        SWait Writable(int fd) noexcept{
+            return SWait{*this, fd, true};
+        };
+
+        void Spawn(TTask<void> task);
+        // returns false if the remaining tasks wait on nothing the loop watches
+        bool Run();
+};
+
+#endif
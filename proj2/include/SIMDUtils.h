@@ -0,0 +1,53 @@
+#ifndef SIMDUTILS_H
+#define SIMDUTILS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Byte-level kernels shared by StringUtils and the readers. Each kernel has a
+// scalar, an SSE2 and an AVX2 version; the widest one the CPU supports is
+// picked once at first use.
+namespace SIMDUtils{
+
+// name of the kernel set chosen at runtime ("avx2", "sse2" or "scalar")
+const char *ActiveInstructionSet() noexcept;
+
+// dst may equal src for in-place conversion; only 'a'-'z' / 'A'-'Z' change
+void UpperASCII(const char *src, char *dst, std::size_t length) noexcept;
+void LowerASCII(const char *src, char *dst, std::size_t length) noexcept;
+
+// index of the first byte where the two buffers differ once ASCII letters are
+// folded to lower case, or length when they are equal
+std::size_t MismatchIgnoreCaseASCII(const char *left, const char *right, std::size_t length) noexcept;
+
+// whitespace here is ' ', '\t', '\n' and '\r', as in StringUtils::Strip;
+// number of leading whitespace bytes, and length once trailing ones are dropped
+std::size_t LeadingWhitespace(const char *data, std::size_t length) noexcept;
+std::size_t TrimTrailingWhitespace(const char *data, std::size_t length) noexcept;
+
+// true when no byte has the high bit set
+bool IsASCII(const char *data, std::size_t length) noexcept;
+
+// number of UTF-8 code points, i.e. bytes that are not 10xxxxxx continuations
+std::size_t CountUTF8CodePoints(const char *data, std::size_t length) noexcept;
+
+// decodes UTF-8 into dst, which must have room for length code points;
+// malformed sequences decode to U+FFFD one byte at a time. Returns the
+// number of code points written.
+std::size_t DecodeUTF8(const char *src, std::size_t length, char32_t *dst) noexcept;
+
+// one 64 byte block of DSV input as bit masks: bit i is set when byte i is
+// a '"', the delimiter, '\n' or '\r'
+struct SDSVBlockMasks{
+    std::uint64_t DQuote;
+    std::uint64_t DDelimiter;
+    std::uint64_t DNewline;
+    std::uint64_t DReturn;
+};
+
+// classifies blocks consecutive 64 byte blocks starting at data
+void ClassifyDSVBlocks(const char *data, std::size_t blocks, char delimiter, SDSVBlockMasks *masks) noexcept;
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SPILLFILE_H
+#define SPILLFILE_H
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Anonymous temporary file of rows, used by the sort and join engines to
+// spill data that does not fit in memory. Each row is stored as a cell
+// count followed by length-prefixed cells. The file is unlinked as soon as
+// it is created, so it disappears with the object. Write rows, Rewind(),
+// then Read them back in the same order. Read() also returns false at the
+// end of the rows; Failed() tells a truncated or unreadable file apart.
+class CSpillFile{
+    private:
+        FILE *DFile;
+        bool DFailed;
+
+    public:
+        explicit CSpillFile(const std::string &directory = "/tmp");
+        CSpillFile(const CSpillFile &) = delete;
+        CSpillFile &operator=(const CSpillFile &) = delete;
+        ~CSpillFile();
+
+        bool Valid() const noexcept;
+
+        bool Write(const std::string_view *cells, std::size_t count) noexcept;
+        bool Write(const std::vector<std::string> &row) noexcept;
+        bool Rewind() noexcept;
+        bool Read(std::vector<std::string> &row) noexcept;
+        // a read stopped partway through a row or hit an I/O error
+        bool Failed() const noexcept;
+};
+
+#endif
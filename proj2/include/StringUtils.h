@@ -1,7 +1,9 @@
 #ifndef STRINGUTILS_H
 #define STRINGUTILS_H
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace StringUtils{
@@ -22,6 +24,48 @@ std::string Join(const std::string &str, const std::vector< std::string > &vect)
 std::string ExpandTabs(const std::string &str, int tabsize = 4) noexcept;
 int EditDistance(const std::string &left, const std::string &right, bool ignorecase=false) noexcept;
 
+// in-place versions of Capitalize/Upper/Lower, no allocation
+void CapitalizeInPlace(std::string &str) noexcept;
+void UpperInPlace(std::string &str) noexcept;
+void LowerInPlace(std::string &str) noexcept;
+
+// ASCII case-insensitive ordering (<0, 0, >0) and a hash consistent with it,
+// neither builds a lowered copy
+int CompareIgnoreCase(std::string_view left, std::string_view right) noexcept;
+std::size_t HashIgnoreCase(std::string_view str) noexcept;
+
+// functors for unordered containers keyed case-insensitively
+struct SIgnoreCaseHash{
+    std::size_t operator()(std::string_view str) const noexcept{
+        return HashIgnoreCase(str);
+    }
+};
+
+struct SIgnoreCaseEqual{
+    bool operator()(std::string_view left, std::string_view right) const noexcept{
+        return left.size() == right.size() && CompareIgnoreCase(left, right) == 0;
+    }
+};
+
+// Code point aware versions of the width and index based functions above.
+// Indices, widths and distances count code points instead of bytes; pure
+// ASCII input takes the byte versions directly.
+namespace UTF8{
+
+bool IsValid(const std::string &str) noexcept;
+std::size_t Length(const std::string &str) noexcept;
+std::u32string Decode(const std::string &str) noexcept;
+std::string Encode(const std::u32string &str) noexcept;
+
+std::string Slice(const std::string &str, ssize_t start, ssize_t end=0) noexcept;
+std::string Center(const std::string &str, int width, char fill = ' ') noexcept;
+std::string LJust(const std::string &str, int width, char fill = ' ') noexcept;
+std::string RJust(const std::string &str, int width, char fill = ' ') noexcept;
+std::string ExpandTabs(const std::string &str, int tabsize = 4) noexcept;
+int EditDistance(const std::string &left, const std::string &right, bool ignorecase=false) noexcept;
+
+}
+
 }
 
 #endif
@@ -0,0 +1,188 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+// Lazily started coroutine returning T. Awaiting a task starts it and the
+// awaiting coroutine is resumed by symmetric transfer when it finishes, so
+// a chain of tasks that never has to wait runs straight through on the
+// caller's stack. Top-level tasks are started by CEpollReactor::Spawn.
+template <typename T>
+class TTask;
+
+namespace TaskDetail{
+
+struct SPromiseBase{
+    std::coroutine_handle<> DContinuation = std::noop_coroutine();
+
+    struct SFinalAwaiter{
+        bool await_ready() const noexcept{
+            return false;
+        };
+
+        template <typename TPromise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> handle) const noexcept{
+            return handle.promise().DContinuation;
+        };
+
+        void await_resume() const noexcept{};
+    };
+
+    std::suspend_always initial_suspend() const noexcept{
+        return {};
+    };
+
+    SFinalAwaiter final_suspend() const noexcept{
+        return {};
+    };
+
+    // the library does not use exceptions; one escaping a task is a bug
+    void unhandled_exception() const noexcept{
+        std::terminate();
+    };
+};
+
+template <typename T>
+struct SPromise : SPromiseBase{
+    std::optional<T> DValue;
+
+    TTask<T> get_return_object() noexcept;
+
+    template <typename TValue>
+    void return_value(TValue &&value){
+        DValue.emplace(std::forward<TValue>(value));
+    };
+
+    T Result(){
+        return std::move(*DValue);
+    };
+};
+
+template <>
+struct SPromise<void> : SPromiseBase{
+    TTask<void> get_return_object() noexcept;
+
+    void return_void() const noexcept{};
+
+    void Result() const noexcept{};
+};
+
+}
+
+template <typename T>
+class TTask{
+    public:
+        using promise_type = TaskDetail::SPromise<T>;
+        using THandle = std::coroutine_handle<promise_type>;
+
+    private:
+        THandle DHandle;
+
+    public:
+        TTask() noexcept : DHandle(nullptr){};
+        explicit TTask(THandle handle) noexcept : DHandle(handle){};
+        TTask(TTask &&other) noexcept : DHandle(std::exchange(other.DHandle, nullptr)){};
+        TTask &operator=(TTask &&other) noexcept{
+            if(this != &other){
+                if(DHandle){
+                    DHandle.destroy();
+                }
+                DHandle = std::exchange(other.DHandle, nullptr);
+            }
+            return *this;
+        };
+        TTask(const TTask &) = delete;
+        TTask &operator=(const TTask &) = delete;
+        ~TTask(){
+            if(DHandle){
+                DHandle.destroy();
+            }
+        };
+
+        bool Valid() const noexcept{
+            return static_cast<bool>(DHandle);
+        };
+
+        bool Done() const noexcept{
+            return !DHandle || DHandle.done();
+        };
+
+        // the coroutine to transfer to; continuation runs once it finishes
+        std::coroutine_handle<> Start(std::coroutine_handle<> continuation) noexcept{
+            DHandle.promise().DContinuation = continuation;
+            return DHandle;
+        };
+
+        // only once Done()
+        T Result(){
+            return DHandle.promise().Result();
+        };
+
+        struct SAwaiter{
+            TTask &DTask;
+
+            bool await_ready() const noexcept{
+                return DTask.Done();
+            };
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept{
+                return DTask.Start(awaiting);
+            };
+
+            T await_resume(){
+                return DTask.Result();
+            };
+        };
+
+        SAwaiter operator co_await() & noexcept{
+            return SAwaiter{*this};
+        };
+
+        SAwaiter operator co_await() && noexcept{
+            return SAwaiter{*this};
+        };
+};
+
+namespace TaskDetail{
+
+template <typename T>
+TTask<T> SPromise<T>::get_return_object() noexcept{
+    return TTask<T>(std::coroutine_handle<SPromise<T>>::from_promise(*this));
+}
+
+inline TTask<void> SPromise<void>::get_return_object() noexcept{
+    return TTask<void>(std::coroutine_handle<SPromise<void>>::from_promise(*this));
+}
+
+}
+
+// What the *Async calls return: either a value that was available at once,
+// in which case co_await completes without suspending or allocating a
+// coroutine frame, or a task that does the waiting.
+template <typename T>
+class TAwaitable{
+    private:
+        std::optional<T> DValue;
+        TTask<T> DTask;
+
+    public:
+        explicit TAwaitable(T value) : DValue(std::move(value)){};
+        explicit TAwaitable(TTask<T> task) noexcept : DTask(std::move(task)){};
+
+        bool await_ready() const noexcept{
+            return DValue.has_value() || DTask.Done();
+        };
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept{
+            return DTask.Start(awaiting);
+        };
+
+        T await_resume(){
+            return DValue ? std::move(*DValue) : DTask.Result();
+        };
+};
+
+#endif
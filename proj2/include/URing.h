@@ -0,0 +1,48 @@
+#ifndef URING_H
+#define URING_H
+
+#include <cstdint>
+#include <cstddef>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+// Minimal io_uring wrapper over the raw system calls (no liburing), enough
+// for the file source and sink to keep several reads or writes in flight.
+// Valid() is false when the kernel or sandbox does not allow io_uring, in
+// which case callers fall back to pread/pwrite.
+class CURing{
+    private:
+        int DRingDescriptor;
+        unsigned DEntries;
+        void *DSubmitRing;
+        std::size_t DSubmitRingSize;
+        void *DCompleteRing;
+        std::size_t DCompleteRingSize;
+        io_uring_sqe *DSubmitEntries;
+        unsigned *DSubmitHead;
+        unsigned *DSubmitTail;
+        unsigned *DSubmitMask;
+        unsigned *DSubmitArray;
+        unsigned *DCompleteHead;
+        unsigned *DCompleteTail;
+        unsigned *DCompleteMask;
+        io_uring_cqe *DCompleteEntries;
+
+        bool Submit(std::uint8_t opcode, int fd, void *buf, unsigned length, std::uint64_t offset, std::uint64_t userdata) noexcept;
+
+    public:
+        explicit CURing(unsigned entries);
+        CURing(const CURing &) = delete;
+        CURing &operator=(const CURing &) = delete;
+        ~CURing();
+
+        bool Valid() const noexcept;
+
+        bool SubmitRead(int fd, void *buf, unsigned length, std::uint64_t offset, std::uint64_t userdata) noexcept;
+        bool SubmitWrite(int fd, const void *buf, unsigned length, std::uint64_t offset, std::uint64_t userdata) noexcept;
+        // blocks for the next completion; result is bytes transferred or -errno
+        bool WaitCompletion(std::uint64_t &userdata, std::int32_t &result) noexcept;
+};
+
+#endif
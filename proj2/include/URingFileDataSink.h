@@ -0,0 +1,29 @@
+#ifndef URINGFILEDATASINK_H
+#define URINGFILEDATASINK_H
+
+#include <memory>
+#include <string>
+#include "DataSink.h"
+
+// File sink that fills large buffers and keeps up to depth writes in flight
+// through io_uring (optionally with O_DIRECT), falling back to pwrite when
+// io_uring is unavailable or useuring is false. Flush() waits for every
+// write and is called on destruction.
+class CURingFileDataSink : public CDataSink{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CURingFileDataSink(const std::string &filename, bool append = false, std::size_t buffersize = 1 << 20, std::size_t depth = 4, bool direct = false, bool useuring = true);
+        ~CURingFileDataSink();
+
+        bool IsOpen() const noexcept;
+        bool UsingURing() const noexcept;
+
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Flush() noexcept override;
+};
+
+#endif
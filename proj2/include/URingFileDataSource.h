@@ -0,0 +1,32 @@
+#ifndef URINGFILEDATASOURCE_H
+#define URINGFILEDATASOURCE_H
+
+#include <memory>
+#include <string>
+#include "DataSource.h"
+
+// Sequential source over a regular file that keeps depth large reads in
+// flight through io_uring (optionally with O_DIRECT) and serves bytes from
+// whichever buffer is next in file order. Falls back to pread when io_uring
+// is unavailable or useuring is false.
+class CURingFileDataSource : public CDataSource{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CURingFileDataSource(const std::string &filename, std::size_t buffersize = 1 << 20, std::size_t depth = 4, bool direct = false, bool useuring = true);
+        ~CURingFileDataSource();
+
+        bool IsOpen() const noexcept;
+        bool UsingURing() const noexcept;
+        // true after a read error; the source then ends early
+        bool Failed() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+};
+
+#endif
@@ -0,0 +1,403 @@
+#ifndef XMLBINDING_H
+#define XMLBINDING_H
+
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "DataSink.h"
+#include "DataSource.h"
+#include "XMLWriter.h"
+
+// How a struct maps onto XML, declared at compile time by specializing
+// SXMLBinding next to the struct:
+//
+//     template <> struct SXMLBinding<SOrder>{
+//         static constexpr std::string_view Element = "order";
+//         static constexpr auto Fields = std::make_tuple(
+//             XMLBinding::Attribute("id", &SOrder::DId),
+//             XMLBinding::Element("customer", &SOrder::DCustomer),
+//             XMLBinding::Elements("item", &SOrder::DItems));
+//     };
+//
+// Element is the name of the struct when it is read or written on its own;
+// nested in another struct it takes the name of the field instead.
+template <typename T>
+struct SXMLBinding;
+
+// true for structs that have a binding
+template <typename T, typename = void>
+struct SXMLBound : std::false_type{};
+
+template <typename T>
+struct SXMLBound<T, std::void_t<decltype(SXMLBinding<T>::Fields)>> : std::true_type{};
+
+namespace XMLBinding{
+
+    enum class EKind{Attribute, Element, Elements, Text};
+
+    template <EKind Kind, typename TObject, typename TMember>
+    struct SField{
+        std::string_view DName;
+        TMember TObject::*DMember;
+    };
+
+    template <typename T>
+    struct SVector : std::false_type{};
+
+    template <typename T>
+    struct SVector<std::vector<T>> : std::true_type{
+        using TValue = T;
+    };
+
+    // strings, bools and the types std::from_chars handles
+    template <typename T>
+    inline constexpr bool Scalar = std::is_same_v<T, std::string> || std::is_arithmetic_v<T>;
+
+    // an attribute of the element; scalars only
+    template <typename TObject, typename TMember>
+    constexpr auto Attribute(std::string_view name, TMember TObject::*member){
+        static_assert(Scalar<TMember>, "attributes hold strings, bools or numbers");
+        return SField<EKind::Attribute, TObject, TMember>{name, member};
+    }
+
+    // one child element: the text of <name> for a scalar, or a bound struct
+    // (a repeated child overwrites what the earlier one set)
+    template <typename TObject, typename TMember>
+    constexpr auto Element(std::string_view name, TMember TObject::*member){
+        static_assert(Scalar<TMember> || SXMLBound<TMember>::value, "elements hold scalars or bound structs");
+        return SField<EKind::Element, TObject, TMember>{name, member};
+    }
+
+    // every child element called name, appended in document order
+    template <typename TObject, typename TMember>
+    constexpr auto Elements(std::string_view name, TMember TObject::*member){
+        static_assert(SVector<TMember>::value, "repeated elements go into a std::vector");
+        return SField<EKind::Elements, TObject, TMember>{name, member};
+    }
+
+    // the element's own character data, joined across any child elements
+    template <typename TObject, typename TMember>
+    constexpr auto Text(TMember TObject::*member){
+        static_assert(Scalar<TMember>, "text is held as a string, bool or number");
+        return SField<EKind::Text, TObject, TMember>{std::string_view(), member};
+    }
+
+    // converts element or attribute text; numbers may have XML whitespace
+    // around them but nothing else
+    template <typename T>
+    bool FromText(std::string_view text, T &value){
+        if constexpr(std::is_same_v<T, std::string>){
+            value.assign(text.data(), text.size());
+            return true;
+        }
+        else{
+            std::size_t First = text.find_first_not_of(" \t\r\n");
+            if(First == std::string_view::npos){
+                return false;
+            }
+            text = text.substr(First, text.find_last_not_of(" \t\r\n") - First + 1);
+            if constexpr(std::is_same_v<T, bool>){
+                if(text == "true" || text == "1"){
+                    value = true;
+                    return true;
+                }
+                if(text == "false" || text == "0"){
+                    value = false;
+                    return true;
+                }
+                return false;
+            }
+            else{
+                auto Result = std::from_chars(text.data(), text.data() + text.size(), value);
+                return Result.ec == std::errc() && Result.ptr == text.data() + text.size();
+            }
+        }
+    }
+
+    inline void Append(std::vector<char> &out, std::string_view text){
+        out.insert(out.end(), text.begin(), text.end());
+    }
+
+    // appends a scalar as XML text, escaped as CXMLWriter escapes it
+    template <typename T>
+    void ToText(const T &value, std::vector<char> &out){
+        if constexpr(std::is_same_v<T, std::string>){
+            CXMLWriter::AppendEscaped(value, out);
+        }
+        else if constexpr(std::is_same_v<T, bool>){
+            Append(out, value ? "true" : "false");
+        }
+        else{
+            char Buffer[64];
+            auto Result = std::to_chars(Buffer, Buffer + sizeof(Buffer), value);
+            out.insert(out.end(), Buffer, Result.ptr);
+        }
+    }
+
+    struct SFrame;
+
+    // What the parser calls into for one bound type. The functions are
+    // instantiated per struct by STypeOf, so the parser itself never sees
+    // the struct's fields.
+    struct SType{
+        std::string_view DElement;
+        // binds the child element called name into frame, false when the
+        // struct does not map it
+        bool (*DChild)(void *object, std::string_view name, SFrame &frame);
+        // false when the value does not convert; unmapped names are ignored
+        bool (*DAttribute)(void *object, std::string_view name, std::string_view value);
+        // takes the element's text, null when no field does
+        bool (*DText)(void *object, std::string_view text);
+    };
+
+    // an element being parsed: a bound struct, a scalar taking the text of
+    // the element, or neither for an element that is skipped
+    struct SFrame{
+        const SType *DType = nullptr;
+        void *DObject = nullptr;
+        bool (*DAssign)(void *object, std::string_view text) = nullptr;
+        // where the element's text starts in the parser's text buffer
+        std::size_t DTextStart = 0;
+    };
+
+    template <typename T>
+    bool Assign(void *object, std::string_view text){
+        return FromText(text, *static_cast<T *>(object));
+    }
+
+    template <EKind Kind, typename TObject, typename TMember>
+    constexpr bool IsText(const SField<Kind, TObject, TMember> &){
+        return Kind == EKind::Text;
+    }
+
+    template <typename T>
+    constexpr bool HasText(){
+        return std::apply([](const auto &...fields){ return (IsText(fields) || ... || false); }, SXMLBinding<T>::Fields);
+    }
+
+    template <typename T>
+    struct STypeOf{
+        static constexpr const auto &Fields = SXMLBinding<T>::Fields;
+
+        template <typename TMember>
+        static void BindValue(TMember &member, SFrame &frame){
+            frame.DObject = &member;
+            if constexpr(SXMLBound<TMember>::value){
+                frame.DType = &STypeOf<TMember>::Type;
+                frame.DAssign = STypeOf<TMember>::Type.DText;
+            }
+            else{
+                frame.DAssign = Assign<TMember>;
+            }
+        }
+
+        template <EKind Kind, typename TMember>
+        static bool BindChild(T &object, const SField<Kind, T, TMember> &field, std::string_view name, SFrame &frame){
+            if constexpr(Kind == EKind::Element){
+                if(field.DName == name){
+                    BindValue(object.*field.DMember, frame);
+                    return true;
+                }
+            }
+            else if constexpr(Kind == EKind::Elements){
+                if(field.DName == name){
+                    BindValue((object.*field.DMember).emplace_back(), frame);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template <EKind Kind, typename TMember>
+        static bool BindAttribute(T &object, const SField<Kind, T, TMember> &field, std::string_view name, std::string_view value, bool &matched){
+            if constexpr(Kind == EKind::Attribute){
+                if(!matched && field.DName == name){
+                    matched = true;
+                    return FromText(value, object.*field.DMember);
+                }
+            }
+            return true;
+        }
+
+        template <EKind Kind, typename TMember>
+        static bool BindText(T &object, const SField<Kind, T, TMember> &field, std::string_view text){
+            if constexpr(Kind == EKind::Text){
+                // indentation around children is no value for a number
+                if(!std::is_same_v<TMember, std::string> && text.find_first_not_of(" \t\r\n") == std::string_view::npos){
+                    return true;
+                }
+                return FromText(text, object.*field.DMember);
+            }
+            return true;
+        }
+
+        static bool Child(void *object, std::string_view name, SFrame &frame){
+            return std::apply([&](const auto &...fields){
+                return (BindChild(*static_cast<T *>(object), fields, name, frame) || ...);
+            }, Fields);
+        }
+
+        static bool Attribute(void *object, std::string_view name, std::string_view value){
+            bool Matched = false;
+            return std::apply([&](const auto &...fields){
+                return (BindAttribute(*static_cast<T *>(object), fields, name, value, Matched) && ...);
+            }, Fields);
+        }
+
+        static bool Text(void *object, std::string_view text){
+            return std::apply([&](const auto &...fields){
+                return (BindText(*static_cast<T *>(object), fields, text) && ...);
+            }, Fields);
+        }
+
+        static const SType Type;
+
+        template <typename TMember>
+        static void WriteValue(const TMember &member, std::string_view name, std::vector<char> &out){
+            if constexpr(SXMLBound<TMember>::value){
+                STypeOf<TMember>::Write(member, name, out);
+            }
+            else{
+                out.push_back('<');
+                Append(out, name);
+                out.push_back('>');
+                ToText(member, out);
+                Append(out, "</");
+                Append(out, name);
+                out.push_back('>');
+            }
+        }
+
+        template <EKind Kind, typename TMember>
+        static void WriteAttribute(const T &object, const SField<Kind, T, TMember> &field, std::vector<char> &out){
+            if constexpr(Kind == EKind::Attribute){
+                out.push_back(' ');
+                Append(out, field.DName);
+                Append(out, "=\"");
+                ToText(object.*field.DMember, out);
+                out.push_back('"');
+            }
+        }
+
+        template <EKind Kind, typename TMember>
+        static void WriteContent(const T &object, const SField<Kind, T, TMember> &field, std::vector<char> &out){
+            if constexpr(Kind == EKind::Text){
+                ToText(object.*field.DMember, out);
+            }
+            else if constexpr(Kind == EKind::Element){
+                WriteValue(object.*field.DMember, field.DName, out);
+            }
+            else if constexpr(Kind == EKind::Elements){
+                for(const auto &Value : object.*field.DMember){
+                    WriteValue(Value, field.DName, out);
+                }
+            }
+        }
+
+        // an element with nothing inside is written <name/>
+        static void Write(const T &object, std::string_view name, std::vector<char> &out){
+            out.push_back('<');
+            Append(out, name);
+            std::apply([&](const auto &...fields){ (WriteAttribute(object, fields, out), ...); }, Fields);
+            std::size_t Open = out.size();
+            out.push_back('>');
+            std::apply([&](const auto &...fields){ (WriteContent(object, fields, out), ...); }, Fields);
+            if(out.size() == Open + 1){
+                out.back() = '/';
+                out.push_back('>');
+            }
+            else{
+                Append(out, "</");
+                Append(out, name);
+                out.push_back('>');
+            }
+        }
+    };
+
+    template <typename T>
+    const SType STypeOf<T>::Type{SXMLBinding<T>::Element, Child, Attribute, HasText<T>() ? Text : nullptr};
+
+}
+
+// The expat side of TXMLBindingReader, shared by every bound type. Element
+// names are matched against the string_views of the binding and values are
+// converted straight into the fields, so no SXMLEntity or attribute vector
+// is built on the way.
+class CXMLBindingParser{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CXMLBindingParser(std::shared_ptr<CDataSource> source, const XMLBinding::SType &type);
+        ~CXMLBindingParser();
+
+        // fills object from the next element of the type, false at the end
+        // of input or once the document or a value is malformed
+        bool Read(void *object);
+        bool Failed() const noexcept;
+        std::string ErrorMessage() const;
+};
+
+// Reads every SXMLBinding<T>::Element element of a document into a T,
+// wherever it is nested; elements and attributes the binding does not map
+// are skipped. Parsing stops inside the end tag of each one, so the rest of
+// the input is only read as further values are asked for.
+template <typename T>
+class TXMLBindingReader{
+    static_assert(SXMLBound<T>::value, "T needs an SXMLBinding specialization");
+
+    private:
+        CXMLBindingParser DParser;
+
+    public:
+        explicit TXMLBindingReader(std::shared_ptr<CDataSource> source)
+            : DParser(std::move(source), XMLBinding::STypeOf<T>::Type){
+
+        }
+
+        bool Read(T &value){
+            value = T();
+            return DParser.Read(&value);
+        }
+
+        bool Failed() const noexcept{
+            return DParser.Failed();
+        }
+
+        std::string ErrorMessage() const{
+            return DParser.ErrorMessage();
+        }
+};
+
+// Writes T values as SXMLBinding<T>::Element elements, with the escaping
+// CXMLWriter applies to text and attribute values. Each value goes to the
+// sink in one Write.
+template <typename T>
+class TXMLBindingWriter{
+    static_assert(SXMLBound<T>::value, "T needs an SXMLBinding specialization");
+
+    private:
+        std::shared_ptr<CDataSink> DSink;
+        // the value's XML, built in the form the sink takes and reused
+        std::vector<char> DBuffer;
+
+    public:
+        explicit TXMLBindingWriter(std::shared_ptr<CDataSink> sink)
+            : DSink(std::move(sink)){
+
+        }
+
+        bool Write(const T &value){
+            DBuffer.clear();
+            XMLBinding::STypeOf<T>::Write(value, SXMLBinding<T>::Element, DBuffer);
+            return DSink->Write(DBuffer);
+        }
+};
+
+#endif
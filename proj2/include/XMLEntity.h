@@ -2,7 +2,9 @@
 #define XMLENTITY_H
 
 #include <utility>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 struct SXMLEntity{
@@ -11,6 +13,8 @@ struct SXMLEntity{
     EType DType;
     std::string DNameData;
     std::vector< TAttribute > DAttributes;
+    // CharData cut short by a reader's chunk limit; the next entity carries on
+    bool DPartial = false;
     
     bool AttributeExists(const std::string &name) const{
         for(auto &Attribute : DAttributes){
@@ -44,5 +48,45 @@ struct SXMLEntity{
         return true;
     };
 };
+
+// Same entity with every string and the attribute list allocated from a
+// std::pmr::memory_resource, so entities can be built in a CMemoryArena.
+struct SPMRXMLEntity{
+    using allocator_type = std::pmr::polymorphic_allocator< char >;
+    using TAttribute = std::pair< std::pmr::string, std::pmr::string >;
+    SXMLEntity::EType DType;
+    std::pmr::string DNameData;
+    std::pmr::vector< TAttribute > DAttributes;
+    bool DPartial;
+
+    explicit SPMRXMLEntity(allocator_type alloc = {}) : DType(SXMLEntity::EType::CharData), DNameData(alloc), DAttributes(alloc), DPartial(false){};
+    SPMRXMLEntity(const SPMRXMLEntity &other, allocator_type alloc = {}) : DType(other.DType), DNameData(other.DNameData, alloc), DAttributes(other.DAttributes, alloc), DPartial(other.DPartial){};
+    SPMRXMLEntity(SPMRXMLEntity &&other, allocator_type alloc) : DType(other.DType), DNameData(std::move(other.DNameData), alloc), DAttributes(std::move(other.DAttributes), alloc), DPartial(other.DPartial){};
+    SPMRXMLEntity(SPMRXMLEntity &&other) noexcept = default;
+    SPMRXMLEntity &operator=(const SPMRXMLEntity &other) = default;
+    SPMRXMLEntity &operator=(SPMRXMLEntity &&other) = default;
+
+    allocator_type get_allocator() const noexcept{
+        return DNameData.get_allocator();
+    };
+
+    bool AttributeExists(std::string_view name) const{
+        for(auto &Attribute : DAttributes){
+            if(std::get<0>(Attribute) == name){
+                return true;   
+            }
+        }
+        return false;
+    };
+
+    std::string_view AttributeValue(std::string_view name) const{
+        for(auto &Attribute : DAttributes){
+            if(std::get<0>(Attribute) == name){
+                return std::get<1>(Attribute);   
+            }
+        }
+        return std::string_view();
+    };
+};
    
 #endif
@@ -0,0 +1,60 @@
+#ifndef XMLPUSHPARSER_H
+#define XMLPUSHPARSER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "XMLEntity.h"
+
+// Where a document can be picked up again: the offset just past an entity
+// and the names of the elements open there, outermost first. When the
+// innermost one was written <name/> and its end has not been delivered,
+// DCloseInnermost is set.
+struct SXMLCheckpoint{
+    std::uint64_t DOffset = 0;
+    std::vector< std::string > DOpenElements;
+    bool DCloseInnermost = false;
+};
+
+// Incremental XML parser for input that arrives in pieces, e.g. from a
+// non-blocking pipe. Feed() hands the caller's bytes straight to expat
+// without copying them and delivers every entity they complete to the
+// callback: start and end elements as soon as their tag is closed,
+// character data once the markup after it begins (or at Finish()). The
+// entity passed to the callback is reused for the next one.
+//
+// Feed and Finish return false once the document is malformed; Reset()
+// starts a new document, e.g. for the next message on the same pipe, or
+// picks one up again mid-way from a checkpoint. Like ParallelXMLReader,
+// resuming replays synthetic start tags for the open elements, so input
+// from a checkpoint must not rely on an encoding or DTD declared earlier.
+class CXMLPushParser{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        using TEntityCallback = std::function<void(const SXMLEntity &entity)>;
+
+        explicit CXMLPushParser(TEntityCallback callback, bool skipcdata = false);
+        ~CXMLPushParser();
+
+        bool Feed(const char *data, std::size_t length);
+        bool Finish();
+        // the next byte fed is the one at checkpoint.DOffset; the end of a
+        // pending <name/> element is delivered before Reset returns
+        void Reset(const SXMLCheckpoint &checkpoint = SXMLCheckpoint());
+
+        // inside the callback, the input offset just past the entity being
+        // delivered; character data ends where the markup after it begins
+        std::uint64_t Offset() const noexcept;
+        // inside the callback for a start element, true when the tag closes
+        // itself (<name/>), so its end follows with no input in between
+        bool EmptyElement() const noexcept;
+
+        bool Failed() const noexcept;
+        // expat's description of the error, empty when there is none
+        std::string ErrorMessage() const;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define XMLREADER_H
 
 #include <memory>
+#include <memory_resource>
 #include "XMLEntity.h"
 #include "DataSource.h"
 
@@ -11,11 +12,19 @@ class CXMLReader{
         std::unique_ptr<SImplementation> DImplementation;
         
     public:
-        CXMLReader(std::shared_ptr< CDataSource > src);
+        // resource backs the reader's internal entity queue and text buffer
+        CXMLReader(std::shared_ptr< CDataSource > src, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
         ~CXMLReader();
         
+        // bounds the memory text needs: character data longer than bytes is
+        // returned as CharData entities of at most bytes each (cut between
+        // UTF-8 characters), all but the last marked DPartial. 0, the
+        // default, returns each run of text whole
+        void SetCharDataLimit(std::size_t bytes) noexcept;
+
         bool End() const;
         bool ReadEntity(SXMLEntity &entity, bool skipcdata = false);
+        bool ReadEntity(SPMRXMLEntity &entity, bool skipcdata = false);
 };
 
 #endif
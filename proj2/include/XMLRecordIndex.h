@@ -0,0 +1,70 @@
+#ifndef XMLRECORDINDEX_H
+#define XMLRECORDINDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataSource.h"
+#include "FileDataSource.h"
+#include "XMLEntity.h"
+
+// Byte offsets of the records in a large XML document, so single records
+// can be parsed again without streaming the document from the start. A
+// record is an element matching a name (outermost matches at any depth) or
+// an absolute path such as /archive/batch/record. Alongside each record the
+// index keeps its context: the elements open around it, with their
+// namespace declarations, shared between records that have the same one.
+//
+// The sidecar file written by Save() stores the offsets as deltas in
+// variable-length integers, a few bytes per record.
+class CXMLRecordIndex{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        struct SRecord{
+            // from the '<' of the start tag to just past the end tag
+            std::uint64_t DOffset;
+            std::uint64_t DLength;
+            std::uint32_t DContext;
+        };
+
+        CXMLRecordIndex();
+        ~CXMLRecordIndex();
+
+        // scans src once; false on malformed XML
+        bool Build(CDataSource &src, const std::string &match);
+        bool Save(const std::string &filename) const;
+        // false when the file is missing or not an index
+        bool Load(const std::string &filename);
+
+        std::size_t RecordCount() const noexcept;
+        const SRecord &Record(std::size_t index) const noexcept;
+        // elements open around the record
+        std::size_t Depth(std::size_t index) const noexcept;
+        // their start tags, outermost first, keeping only xmlns attributes
+        const std::string &Context(std::size_t index) const noexcept;
+        // encoding named in the XML declaration, empty when there is none
+        const std::string &Encoding() const noexcept;
+};
+
+// Parses single records of an indexed document. Each call seeks the source
+// to the record, reads just its bytes and parses them behind the record's
+// context, so names resolve as they did in the whole document.
+class CXMLRecordReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CXMLRecordReader(std::shared_ptr< CFileDataSource > src, std::shared_ptr< const CXMLRecordIndex > index);
+        ~CXMLRecordReader();
+
+        // the record's entities, its start tag to its end tag; false when the
+        // index is out of range or the bytes read are not the record
+        bool ReadRecord(std::size_t index, std::vector< SXMLEntity > &entities, bool skipcdata = false);
+};
+
+#endif
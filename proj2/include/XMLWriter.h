@@ -2,6 +2,9 @@
 #define XMLWRITER_H
 
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "XMLEntity.h"
 #include "DataSink.h"
 
@@ -16,6 +19,11 @@ class CXMLWriter{
         
         bool Flush();
         bool WriteEntity(const SXMLEntity &entity);
+
+        // the escaping WriteEntity applies to character data and attribute
+        // values, for code that builds XML text itself
+        static void AppendEscaped(std::string_view text, std::string &out);
+        static void AppendEscaped(std::string_view text, std::vector<char> &out);
 };
 
 #endif
@@ -0,0 +1,140 @@
+#include "AsyncDataSink.h"
+#include "Metrics.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct CAsyncDataSink::SImplementation{
+    std::shared_ptr<CDataSink> DSink;
+    std::size_t DBufferSize;
+    // filled by the caller without locking
+    std::vector<char> DFront;
+    // drained by the background thread; empty when the thread is idle
+    std::vector<char> DBack;
+    std::mutex DMutex;
+    std::condition_variable DFull;
+    std::condition_variable DDrained;
+    bool DStop;
+    bool DClosed;
+    std::atomic<bool> DFailed;
+    std::thread DThread;
+
+    SImplementation(std::shared_ptr<CDataSink> sink, std::size_t buffersize)
+        : DSink(std::move(sink)), DBufferSize(buffersize ? buffersize : 1), DStop(false), DClosed(false), DFailed(false){
+        DFront.reserve(DBufferSize);
+        DBack.reserve(DBufferSize);
+        DThread = std::thread([this]{ Drain(); });
+    }
+
+    ~SImplementation(){
+        Close();
+    }
+
+    // background thread: write out the back buffer whenever one is handed over
+    void Drain(){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        while(true){
+            DFull.wait(Lock, [&]{ return !DBack.empty() || DStop; });
+            if(DBack.empty()){
+                return;
+            }
+            // the caller only touches DBack under the lock once it is empty
+            Lock.unlock();
+            bool Success = DSink->Write(DBack);
+            Lock.lock();
+            if(!Success){
+                DFailed = true;
+            }
+            DBack.clear();
+            DDrained.notify_all();
+        }
+    }
+
+    // hands the front buffer to the thread once the previous one is written
+    void Swap(){
+        DSV_METRIC_TIMER(SinkWaitNanoseconds);
+        std::unique_lock<std::mutex> Lock(DMutex);
+        DDrained.wait(Lock, [&]{ return DBack.empty(); });
+        if(!DFront.empty()){
+            DFront.swap(DBack);
+            DFull.notify_one();
+        }
+    }
+
+    bool Append(const char *data, std::size_t length){
+        if(DClosed || DFailed.load(std::memory_order_relaxed)){
+            return false;
+        }
+        while(length){
+            if(DFront.size() == DBufferSize){
+                Swap();
+            }
+            std::size_t Chunk = std::min(length, DBufferSize - DFront.size());
+            DFront.insert(DFront.end(), data, data + Chunk);
+            data += Chunk;
+            length -= Chunk;
+        }
+        return !DFailed.load(std::memory_order_relaxed);
+    }
+
+    // waits until both buffers are written; the thread is idle afterwards
+    bool Drained(){
+        Swap();
+        std::unique_lock<std::mutex> Lock(DMutex);
+        DDrained.wait(Lock, [&]{ return DBack.empty(); });
+        return !DFailed;
+    }
+
+    bool Flush(){
+        if(DClosed){
+            return !DFailed;
+        }
+        // the background thread is idle, so the wrapped sink is ours to flush
+        return Drained() && DSink->Flush();
+    }
+
+    bool Close(){
+        if(DClosed){
+            return !DFailed;
+        }
+        bool Success = Flush();
+        {
+            std::lock_guard<std::mutex> Lock(DMutex);
+            DStop = true;
+            DFull.notify_one();
+        }
+        DThread.join();
+        DClosed = true;
+        return Success && !DFailed;
+    }
+};
+
+CAsyncDataSink::CAsyncDataSink(std::shared_ptr< CDataSink > sink, std::size_t buffersize)
+    : DImplementation(std::make_unique<SImplementation>(std::move(sink), buffersize)){
+
+}
+
+CAsyncDataSink::~CAsyncDataSink() = default;
+
+bool CAsyncDataSink::Close() noexcept{
+    return DImplementation->Close();
+}
+
+bool CAsyncDataSink::Put(const char &ch) noexcept{
+    // fast path: room in the front buffer and no failure reported
+    auto &Impl = *DImplementation;
+    if(Impl.DFront.size() < Impl.DBufferSize && !Impl.DClosed && !Impl.DFailed.load(std::memory_order_relaxed)){
+        Impl.DFront.push_back(ch);
+        return true;
+    }
+    return Impl.Append(&ch, 1);
+}
+
+bool CAsyncDataSink::Write(const std::vector<char> &buf) noexcept{
+    return DImplementation->Append(buf.data(), buf.size());
+}
+
+bool CAsyncDataSink::Flush() noexcept{
+    return DImplementation->Flush();
+}
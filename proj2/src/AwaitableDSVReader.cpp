@@ -0,0 +1,33 @@
+#include "AwaitableDSVReader.h"
+#include "AwaitableQueue.h"
+#include "DSVPushParser.h"
+
+struct CAwaitableDSVReader::SImplementation{
+    CDSVPushParser DParser;
+    TAwaitableQueue< std::vector<std::string> > DQueue;
+
+    SImplementation(std::shared_ptr<CAwaitableDataSource> src, char delimiter)
+        : DParser(delimiter, [this](std::span<const std::string> row){ DQueue.Push().assign(row.begin(), row.end()); }),
+          DQueue(std::move(src), [this](const char *data, std::size_t length){ DParser.Feed(data, length); return true; }, [this]{ DParser.Finish(); }){
+
+    }
+};
+
+CAwaitableDSVReader::CAwaitableDSVReader(std::shared_ptr<CAwaitableDataSource> src, char delimiter)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), delimiter)){
+
+}
+
+CAwaitableDSVReader::~CAwaitableDSVReader() = default;
+
+bool CAwaitableDSVReader::End() const{
+    return DImplementation->DQueue.End();
+}
+
+TAwaitable<bool> CAwaitableDSVReader::ReadRowAsync(std::vector<std::string> &row){
+    bool Result;
+    if(DImplementation->DQueue.TryRead(row, Result)){
+        return TAwaitable<bool>(Result);
+    }
+    return TAwaitable<bool>(DImplementation->DQueue.ReadWaiting(row));
+}
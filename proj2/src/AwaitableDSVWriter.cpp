@@ -0,0 +1,64 @@
+#include "AwaitableDSVWriter.h"
+#include "DSVWriter.h"
+
+struct CAwaitableDSVWriter::SImplementation{
+    std::shared_ptr<CAwaitableDataSink> DSink;
+    char DDelimiter;
+    bool DQuoteAll;
+    std::size_t DHighWater;
+    // formatted row, kept between calls so its capacity is reused
+    std::vector<char> DBuffer;
+    // bytes handed to the sink that may not be written yet
+    std::size_t DBuffered;
+
+    SImplementation(std::shared_ptr<CAwaitableDataSink> sink, char delimiter, bool quoteall, std::size_t highwater)
+        : DSink(std::move(sink)), DDelimiter(delimiter), DQuoteAll(quoteall), DHighWater(highwater), DBuffered(0){
+
+    }
+
+    TTask<bool> FlushWaiting(){
+        bool Success = co_await DSink->Flush();
+        DBuffered = 0;
+        co_return Success;
+    }
+};
+
+CAwaitableDSVWriter::CAwaitableDSVWriter(std::shared_ptr<CAwaitableDataSink> sink, char delimiter, bool quoteall, std::size_t highwater)
+    : DImplementation(std::make_unique<SImplementation>(std::move(sink), delimiter, quoteall, highwater)){
+
+}
+
+CAwaitableDSVWriter::~CAwaitableDSVWriter() = default;
+
+TAwaitable<bool> CAwaitableDSVWriter::WriteRowAsync(const std::vector<std::string> &row){
+    SImplementation &Implementation = *DImplementation;
+    Implementation.DBuffer.clear();
+    CDSVWriter::FormatRow(row, Implementation.DDelimiter, Implementation.DQuoteAll, Implementation.DBuffer);
+    if(!Implementation.DSink->Write(Implementation.DBuffer.data(), Implementation.DBuffer.size())){
+        return TAwaitable<bool>(false);
+    }
+    Implementation.DBuffered += Implementation.DBuffer.size();
+    if(Implementation.DBuffered < Implementation.DHighWater){
+        return TAwaitable<bool>(true);
+    }
+    // over the mark: write what the destination takes, wait only if that is not enough
+    Implementation.DBuffered = Implementation.DSink->TryFlush();
+    if(Implementation.DSink->Failed()){
+        return TAwaitable<bool>(false);
+    }
+    if(Implementation.DBuffered < Implementation.DHighWater){
+        return TAwaitable<bool>(true);
+    }
+    return TAwaitable<bool>(Implementation.FlushWaiting());
+}
+
+TAwaitable<bool> CAwaitableDSVWriter::FlushAsync(){
+    DImplementation->DBuffered = DImplementation->DSink->TryFlush();
+    if(DImplementation->DSink->Failed()){
+        return TAwaitable<bool>(false);
+    }
+    if(!DImplementation->DBuffered){
+        return TAwaitable<bool>(true);
+    }
+    return TAwaitable<bool>(DImplementation->FlushWaiting());
+}
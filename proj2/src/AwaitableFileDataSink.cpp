@@ -0,0 +1,65 @@
+#include "AwaitableFileDataSink.h"
+#include "Metrics.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+CAwaitableFileDataSink::CAwaitableFileDataSink(CEpollReactor &reactor, int fd, bool ownsfd)
+    : DReactor(reactor), DFileDescriptor(fd), DOwnsDescriptor(ownsfd), DPosition(0), DFailed(fd < 0){
+    if(fd >= 0){
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+}
+
+CAwaitableFileDataSink::~CAwaitableFileDataSink(){
+    if(DOwnsDescriptor && DFileDescriptor >= 0){
+        close(DFileDescriptor);
+    }
+}
+
+bool CAwaitableFileDataSink::Failed() const noexcept{
+    return DFailed;
+}
+
+bool CAwaitableFileDataSink::Write(const char *data, std::size_t length) noexcept{
+    if(DFailed){
+        return false;
+    }
+    // drop what has been written before growing the buffer
+    if(DPosition && DPosition * 2 >= DBuffer.size()){
+        DBuffer.erase(DBuffer.begin(), DBuffer.begin() + DPosition);
+        DPosition = 0;
+    }
+    DBuffer.insert(DBuffer.end(), data, data + length);
+    return true;
+}
+
+std::size_t CAwaitableFileDataSink::TryFlush() noexcept{
+    while(!DFailed && DPosition < DBuffer.size()){
+        ssize_t Result = write(DFileDescriptor, DBuffer.data() + DPosition, DBuffer.size() - DPosition);
+        if(Result >= 0){
+            DPosition += Result;
+            continue;
+        }
+        if(errno == EINTR){
+            continue;
+        }
+        if(errno != EAGAIN && errno != EWOULDBLOCK){
+            DFailed = true;
+        }
+        break;
+    }
+    if(DPosition == DBuffer.size()){
+        DBuffer.clear();
+        DPosition = 0;
+    }
+    return DBuffer.size() - DPosition;
+}
+
+TTask<bool> CAwaitableFileDataSink::Flush(){
+    while(TryFlush() && !DFailed){
+        DSV_METRIC_TIMER(SinkWaitNanoseconds);
+        co_await DReactor.Writable(DFileDescriptor);
+    }
+    co_return !DFailed;
+}
@@ -0,0 +1,56 @@
+#include "AwaitableFileDataSource.h"
+#include "Metrics.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+CAwaitableFileDataSource::CAwaitableFileDataSource(CEpollReactor &reactor, int fd, bool ownsfd, std::size_t buffersize)
+    : DReactor(reactor), DFileDescriptor(fd), DOwnsDescriptor(ownsfd), DBuffer(buffersize ? buffersize : 1), DPosition(0), DLength(0), DEndOfFile(fd < 0), DFailed(fd < 0){
+    if(fd >= 0){
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+}
+
+CAwaitableFileDataSource::~CAwaitableFileDataSource(){
+    if(DOwnsDescriptor && DFileDescriptor >= 0){
+        close(DFileDescriptor);
+    }
+}
+
+bool CAwaitableFileDataSource::Failed() const noexcept{
+    return DFailed;
+}
+
+std::string_view CAwaitableFileDataSource::Buffered() noexcept{
+    return std::string_view(DBuffer.data() + DPosition, DLength - DPosition);
+}
+
+void CAwaitableFileDataSource::Consume(std::size_t count) noexcept{
+    DPosition += count;
+}
+
+bool CAwaitableFileDataSource::End() const noexcept{
+    return DEndOfFile && DPosition >= DLength;
+}
+
+TTask<bool> CAwaitableFileDataSource::Fill(){
+    while(!DEndOfFile){
+        ssize_t Result = read(DFileDescriptor, DBuffer.data(), DBuffer.size());
+        if(Result > 0){
+            DPosition = 0;
+            DLength = Result;
+            co_return true;
+        }
+        if(Result < 0 && errno == EINTR){
+            continue;
+        }
+        if(Result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+            DSV_METRIC_TIMER(SourceWaitNanoseconds);
+            co_await DReactor.Readable(DFileDescriptor);
+            continue;
+        }
+        DFailed = Result < 0;
+        DEndOfFile = true;
+    }
+    co_return false;
+}
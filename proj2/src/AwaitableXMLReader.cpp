@@ -0,0 +1,35 @@
+#include "AwaitableXMLReader.h"
+#include "AwaitableQueue.h"
+#include "XMLPushParser.h"
+
+struct CAwaitableXMLReader::SImplementation{
+    CXMLPushParser DParser;
+    TAwaitableQueue<SXMLEntity> DQueue;
+
+    explicit SImplementation(std::shared_ptr<CAwaitableDataSource> src)
+        : DParser([this](const SXMLEntity &entity){ DQueue.Push() = entity; }),
+          DQueue(std::move(src), [this](const char *data, std::size_t length){ return DParser.Feed(data, length); }, [this]{ DParser.Finish(); }){
+
+    }
+};
+
+CAwaitableXMLReader::CAwaitableXMLReader(std::shared_ptr<CAwaitableDataSource> src)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src))){
+
+}
+
+CAwaitableXMLReader::~CAwaitableXMLReader() = default;
+
+bool CAwaitableXMLReader::End() const{
+    return DImplementation->DQueue.End();
+}
+
+TAwaitable<bool> CAwaitableXMLReader::ReadEntityAsync(SXMLEntity &entity, bool skipcdata){
+    bool Result;
+    // with skipcdata, character data is taken off the queue and dropped
+    auto Accept = [skipcdata](const SXMLEntity &next){ return !(skipcdata && next.DType == SXMLEntity::EType::CharData); };
+    if(DImplementation->DQueue.TryRead(entity, Result, Accept)){
+        return TAwaitable<bool>(Result);
+    }
+    return TAwaitable<bool>(DImplementation->DQueue.ReadWaiting(entity, Accept));
+}
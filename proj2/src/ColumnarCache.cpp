@@ -0,0 +1,513 @@
+#include "ColumnarCache.h"
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace{
+
+const char CacheMagic[8] = {'D', 'S', 'V', 'C', 'O', 'L', '1', '\0'};
+
+// file header, followed by one SColumnEntry per column
+struct SCacheHeader{
+    char DMagic[8];
+    std::uint64_t DRowCount;
+    std::uint64_t DColumnCount;
+    // uint32 cell count per row
+    std::uint64_t DCellCountsOffset;
+};
+
+enum class EEncoding : std::uint64_t{Plain = 0, Dictionary = 1};
+
+struct SColumnEntry{
+    std::uint64_t DNameOffset;
+    std::uint64_t DNameLength;
+    EEncoding DEncoding;
+    // uint64[entries + 1] into the heap; entries are rows when plain and
+    // dictionary values when encoded
+    std::uint64_t DOffsetsOffset;
+    std::uint64_t DHeapOffset;
+    std::uint64_t DHeapLength;
+    // uint32 per row when encoded
+    std::uint64_t DCodesOffset;
+    std::uint64_t DDictionarySize;
+};
+
+}
+
+struct CColumnarCacheWriter::SImplementation{
+    // everything written for one column so far, spilled to temporary files
+    struct SColumn{
+        std::string DName;
+        FILE *DOffsets = nullptr;
+        FILE *DHeap = nullptr;
+        FILE *DCodes = nullptr;
+        std::uint64_t DHeapLength = 0;
+        // still small enough for a dictionary; dropped for good once not
+        bool DDictionary = true;
+        std::unordered_map<std::string, std::uint32_t> DIndex;
+        std::vector<std::string> DValues;
+    };
+
+    FILE *DFile;
+    std::size_t DDictionaryLimit;
+    std::vector<SColumn> DColumns;
+    FILE *DCellCounts;
+    std::uint64_t DRowCount;
+    bool DFailed;
+    bool DClosed;
+
+    SImplementation(const std::string &filename, std::size_t dictionarylimit)
+        : DFile(std::fopen(filename.c_str(), "wb")), DDictionaryLimit(dictionarylimit), DCellCounts(std::tmpfile()), DRowCount(0), DFailed(false), DClosed(false){
+        if(!DFile || !DCellCounts){
+            DFailed = true;
+        }
+    }
+
+    ~SImplementation(){
+        Close();
+        if(DCellCounts){
+            std::fclose(DCellCounts);
+        }
+    }
+
+    void CloseColumn(SColumn &column){
+        for(FILE *File : {column.DOffsets, column.DHeap, column.DCodes}){
+            if(File){
+                std::fclose(File);
+            }
+        }
+        column.DOffsets = column.DHeap = column.DCodes = nullptr;
+    }
+
+    // a column first seen at a later row is empty for all earlier rows
+    bool AddColumn(){
+        DColumns.emplace_back();
+        SColumn &Column = DColumns.back();
+        Column.DOffsets = std::tmpfile();
+        Column.DHeap = std::tmpfile();
+        Column.DCodes = std::tmpfile();
+        if(!Column.DOffsets || !Column.DHeap || !Column.DCodes){
+            return false;
+        }
+        std::uint64_t Zero = 0;
+        std::uint32_t EmptyCode = 0;
+        for(std::uint64_t Row = 0; Row < DRowCount; Row++){
+            std::fwrite(&Zero, sizeof(Zero), 1, Column.DOffsets);
+            std::fwrite(&EmptyCode, sizeof(EmptyCode), 1, Column.DCodes);
+        }
+        Column.DDictionary = DDictionaryLimit > 0;
+        if(DRowCount && Column.DDictionary){
+            Column.DIndex.emplace(std::string(), 0);
+            Column.DValues.emplace_back();
+        }
+        return true;
+    }
+
+    void AppendCell(SColumn &column, const std::string &value){
+        std::fwrite(&column.DHeapLength, sizeof(column.DHeapLength), 1, column.DOffsets);
+        std::fwrite(value.data(), 1, value.size(), column.DHeap);
+        column.DHeapLength += value.size();
+        if(!column.DDictionary){
+            return;
+        }
+        auto Inserted = column.DIndex.emplace(value, static_cast<std::uint32_t>(column.DValues.size()));
+        if(Inserted.second){
+            if(column.DValues.size() >= DDictionaryLimit){
+                // too many distinct values, stop tracking them
+                column.DDictionary = false;
+                column.DIndex.clear();
+                column.DValues.clear();
+                std::fclose(column.DCodes);
+                column.DCodes = nullptr;
+                return;
+            }
+            column.DValues.push_back(value);
+        }
+        std::fwrite(&Inserted.first->second, sizeof(std::uint32_t), 1, column.DCodes);
+    }
+
+    bool WriteHeader(const std::vector<std::string> &names){
+        if(DFailed || DClosed || DRowCount){
+            return false;
+        }
+        while(DColumns.size() < names.size()){
+            if(!AddColumn()){
+                DFailed = true;
+                return false;
+            }
+        }
+        for(std::size_t Index = 0; Index < names.size(); Index++){
+            DColumns[Index].DName = names[Index];
+        }
+        return true;
+    }
+
+    bool WriteRow(const std::vector<std::string> &row){
+        if(DFailed || DClosed){
+            return false;
+        }
+        while(DColumns.size() < row.size()){
+            if(!AddColumn()){
+                DFailed = true;
+                return false;
+            }
+        }
+        static const std::string Empty;
+        for(std::size_t Index = 0; Index < DColumns.size(); Index++){
+            AppendCell(DColumns[Index], Index < row.size() ? row[Index] : Empty);
+        }
+        std::uint32_t Cells = static_cast<std::uint32_t>(row.size());
+        std::fwrite(&Cells, sizeof(Cells), 1, DCellCounts);
+        DRowCount++;
+        return true;
+    }
+
+    // pads the output to the next multiple of 8 and returns that position
+    std::uint64_t Align(){
+        long Position = std::ftell(DFile);
+        static const char Zeros[8] = {0};
+        std::fwrite(Zeros, 1, (8 - Position % 8) % 8, DFile);
+        return static_cast<std::uint64_t>(std::ftell(DFile));
+    }
+
+    // appends a spilled temporary file to the output
+    std::uint64_t Copy(FILE *from){
+        std::uint64_t Offset = Align();
+        std::fflush(from);
+        std::rewind(from);
+        std::vector<char> Buffer(1 << 20);
+        std::size_t Length;
+        while((Length = std::fread(Buffer.data(), 1, Buffer.size(), from)) > 0){
+            if(std::fwrite(Buffer.data(), 1, Length, DFile) != Length){
+                DFailed = true;
+            }
+        }
+        return Offset;
+    }
+
+    std::uint64_t WriteBytes(const void *data, std::size_t length){
+        std::uint64_t Offset = Align();
+        if(length && std::fwrite(data, 1, length, DFile) != length){
+            DFailed = true;
+        }
+        return Offset;
+    }
+
+    bool Close(){
+        if(DClosed){
+            return !DFailed;
+        }
+        DClosed = true;
+        if(!DFile){
+            return false;
+        }
+        std::vector<SColumnEntry> Entries(DColumns.size());
+        SCacheHeader Header;
+        std::memcpy(Header.DMagic, CacheMagic, sizeof(CacheMagic));
+        Header.DRowCount = DRowCount;
+        Header.DColumnCount = DColumns.size();
+        Header.DCellCountsOffset = 0;
+        // header and directory first, rewritten once the offsets are known
+        WriteBytes(&Header, sizeof(Header));
+        WriteBytes(Entries.data(), Entries.size() * sizeof(SColumnEntry));
+        Header.DCellCountsOffset = Copy(DCellCounts);
+        for(std::size_t Index = 0; Index < DColumns.size(); Index++){
+            SColumn &Column = DColumns[Index];
+            SColumnEntry &Entry = Entries[Index];
+            Entry.DNameLength = Column.DName.size();
+            Entry.DNameOffset = WriteBytes(Column.DName.data(), Column.DName.size());
+            if(Column.DDictionary){
+                Entry.DEncoding = EEncoding::Dictionary;
+                Entry.DDictionarySize = Column.DValues.size();
+                std::vector<std::uint64_t> Offsets;
+                std::string Heap;
+                for(auto &Value : Column.DValues){
+                    Offsets.push_back(Heap.size());
+                    Heap += Value;
+                }
+                Offsets.push_back(Heap.size());
+                Entry.DOffsetsOffset = WriteBytes(Offsets.data(), Offsets.size() * sizeof(std::uint64_t));
+                Entry.DHeapOffset = WriteBytes(Heap.data(), Heap.size());
+                Entry.DHeapLength = Heap.size();
+                Entry.DCodesOffset = Copy(Column.DCodes);
+            }
+            else{
+                Entry.DEncoding = EEncoding::Plain;
+                Entry.DDictionarySize = 0;
+                Entry.DOffsetsOffset = Copy(Column.DOffsets);
+                // closing offset of the last row
+                std::fwrite(&Column.DHeapLength, sizeof(Column.DHeapLength), 1, DFile);
+                Entry.DHeapOffset = Copy(Column.DHeap);
+                Entry.DHeapLength = Column.DHeapLength;
+                Entry.DCodesOffset = 0;
+            }
+            CloseColumn(Column);
+        }
+        Align();
+        std::rewind(DFile);
+        WriteBytes(&Header, sizeof(Header));
+        WriteBytes(Entries.data(), Entries.size() * sizeof(SColumnEntry));
+        if(std::fclose(DFile) != 0){
+            DFailed = true;
+        }
+        DFile = nullptr;
+        return !DFailed;
+    }
+};
+
+CColumnarCacheWriter::CColumnarCacheWriter(const std::string &filename, std::size_t dictionarylimit)
+    : DImplementation(std::make_unique<SImplementation>(filename, dictionarylimit)){
+
+}
+
+CColumnarCacheWriter::~CColumnarCacheWriter() = default;
+
+bool CColumnarCacheWriter::IsOpen() const noexcept{
+    return DImplementation->DFile != nullptr;
+}
+
+bool CColumnarCacheWriter::WriteHeader(const std::vector<std::string> &names){
+    return DImplementation->WriteHeader(names);
+}
+
+bool CColumnarCacheWriter::WriteRow(const std::vector<std::string> &row){
+    return DImplementation->WriteRow(row);
+}
+
+bool CColumnarCacheWriter::Close(){
+    return DImplementation->Close();
+}
+
+bool CColumnarCacheWriter::Convert(CDSVReader &reader, const std::string &filename, bool hasheader, std::size_t dictionarylimit){
+    CColumnarCacheWriter Writer(filename, dictionarylimit);
+    std::vector<std::string> Row;
+    if(hasheader && reader.ReadRow(Row) && !Writer.WriteHeader(Row)){
+        return false;
+    }
+    while(reader.ReadRow(Row)){
+        if(!Writer.WriteRow(Row)){
+            return false;
+        }
+    }
+    return Writer.Close();
+}
+
+struct CColumnarCacheReader::SImplementation{
+    int DFileDescriptor;
+    const char *DData;
+    std::size_t DLength;
+    bool DValid;
+    const SCacheHeader *DHeader;
+    const SColumnEntry *DColumns;
+    const std::uint32_t *DCellCounts;
+    std::vector<std::string_view> DNames;
+
+    SImplementation(const std::string &filename)
+        : DFileDescriptor(open(filename.c_str(), O_RDONLY | O_CLOEXEC)), DData(nullptr), DLength(0), DValid(false), DHeader(nullptr), DColumns(nullptr), DCellCounts(nullptr){
+        struct stat Status;
+        if(DFileDescriptor < 0 || fstat(DFileDescriptor, &Status) < 0 || static_cast<std::size_t>(Status.st_size) < sizeof(SCacheHeader)){
+            return;
+        }
+        DLength = Status.st_size;
+        void *Mapping = mmap(nullptr, DLength, PROT_READ, MAP_SHARED, DFileDescriptor, 0);
+        if(Mapping == MAP_FAILED){
+            return;
+        }
+        DData = static_cast<const char *>(Mapping);
+        DValid = Validate();
+    }
+
+    ~SImplementation(){
+        if(DData){
+            munmap(const_cast<char *>(DData), DLength);
+        }
+        if(DFileDescriptor >= 0){
+            close(DFileDescriptor);
+        }
+    }
+
+    bool InBounds(std::uint64_t offset, std::uint64_t count, std::uint64_t size) const{
+        return offset <= DLength && count <= (DLength - offset) / size;
+    }
+
+    // arrays are read in place, so they must start on their type's alignment
+    template <typename T>
+    static bool Aligned(std::uint64_t offset){
+        return offset % alignof(T) == 0;
+    }
+
+    // checks every section lies inside the file and is aligned for what it
+    // holds, and that each column's last offset lies inside its heap; the
+    // work is per column, the offsets in between are checked by Entry()
+    bool Validate(){
+        DHeader = reinterpret_cast<const SCacheHeader *>(DData);
+        if(std::memcmp(DHeader->DMagic, CacheMagic, sizeof(CacheMagic))){
+            return false;
+        }
+        std::uint64_t Rows = DHeader->DRowCount;
+        if(!InBounds(sizeof(SCacheHeader), DHeader->DColumnCount, sizeof(SColumnEntry)) || !InBounds(DHeader->DCellCountsOffset, Rows, sizeof(std::uint32_t)) || !Aligned<std::uint32_t>(DHeader->DCellCountsOffset)){
+            return false;
+        }
+        DColumns = reinterpret_cast<const SColumnEntry *>(DData + sizeof(SCacheHeader));
+        DCellCounts = reinterpret_cast<const std::uint32_t *>(DData + DHeader->DCellCountsOffset);
+        for(std::uint64_t Index = 0; Index < DHeader->DColumnCount; Index++){
+            const SColumnEntry &Entry = DColumns[Index];
+            bool Dictionary = Entry.DEncoding == EEncoding::Dictionary;
+            std::uint64_t Entries = Dictionary ? Entry.DDictionarySize : Rows;
+            // Entries + 1 offsets are read
+            if(Entries == std::numeric_limits<std::uint64_t>::max()){
+                return false;
+            }
+            if(!InBounds(Entry.DNameOffset, Entry.DNameLength, 1) || !InBounds(Entry.DOffsetsOffset, Entries + 1, sizeof(std::uint64_t)) || !Aligned<std::uint64_t>(Entry.DOffsetsOffset) || !InBounds(Entry.DHeapOffset, Entry.DHeapLength, 1)){
+                return false;
+            }
+            if(Dictionary && (!InBounds(Entry.DCodesOffset, Rows, sizeof(std::uint32_t)) || !Aligned<std::uint32_t>(Entry.DCodesOffset))){
+                return false;
+            }
+            if(Offsets(Entry)[Entries] > Entry.DHeapLength){
+                return false;
+            }
+            DNames.emplace_back(DData + Entry.DNameOffset, Entry.DNameLength);
+        }
+        return true;
+    }
+
+    const std::uint64_t *Offsets(const SColumnEntry &entry) const{
+        return reinterpret_cast<const std::uint64_t *>(DData + entry.DOffsetsOffset);
+    }
+
+    const std::uint32_t *Codes(const SColumnEntry &entry) const{
+        return reinterpret_cast<const std::uint32_t *>(DData + entry.DCodesOffset);
+    }
+
+    // empty when the offsets run backwards or past the heap
+    std::string_view Entry(const SColumnEntry &entry, std::uint64_t index) const{
+        const std::uint64_t *Offsets = this->Offsets(entry);
+        if(Offsets[index] > Offsets[index + 1] || Offsets[index + 1] > entry.DHeapLength){
+            return std::string_view();
+        }
+        return std::string_view(DData + entry.DHeapOffset + Offsets[index], Offsets[index + 1] - Offsets[index]);
+    }
+
+    std::string_view Cell(std::size_t row, std::size_t column) const{
+        if(!DValid || row >= DHeader->DRowCount || column >= DHeader->DColumnCount){
+            return std::string_view();
+        }
+        const SColumnEntry &Column = DColumns[column];
+        if(Column.DEncoding == EEncoding::Dictionary){
+            std::uint32_t Code = Codes(Column)[row];
+            return Code < Column.DDictionarySize ? Entry(Column, Code) : std::string_view();
+        }
+        return Entry(Column, row);
+    }
+
+    std::size_t Rows() const{
+        return DValid ? DHeader->DRowCount : 0;
+    }
+
+    std::size_t Columns() const{
+        return DValid ? DHeader->DColumnCount : 0;
+    }
+};
+
+CColumnarCacheReader::CColumnarCacheReader(const std::string &filename)
+    : DImplementation(std::make_unique<SImplementation>(filename)){
+
+}
+
+CColumnarCacheReader::~CColumnarCacheReader() = default;
+
+bool CColumnarCacheReader::IsOpen() const noexcept{
+    return DImplementation->DValid;
+}
+
+std::size_t CColumnarCacheReader::RowCount() const noexcept{
+    return DImplementation->Rows();
+}
+
+std::size_t CColumnarCacheReader::ColumnCount() const noexcept{
+    return DImplementation->Columns();
+}
+
+const std::vector<std::string_view> &CColumnarCacheReader::ColumnNames() const noexcept{
+    return DImplementation->DNames;
+}
+
+std::size_t CColumnarCacheReader::ColumnIndex(std::string_view name) const noexcept{
+    auto &Names = DImplementation->DNames;
+    for(std::size_t Index = 0; Index < Names.size(); Index++){
+        if(Names[Index] == name){
+            return Index;
+        }
+    }
+    return Names.size();
+}
+
+std::size_t CColumnarCacheReader::CellCount(std::size_t row) const noexcept{
+    return row < RowCount() ? DImplementation->DCellCounts[row] : 0;
+}
+
+std::string_view CColumnarCacheReader::Cell(std::size_t row, std::size_t column) const noexcept{
+    return column < CellCount(row) ? DImplementation->Cell(row, column) : std::string_view();
+}
+
+bool CColumnarCacheReader::ReadRow(std::size_t row, std::vector<std::string_view> &cells) const{
+    if(row >= RowCount()){
+        return false;
+    }
+    cells.resize(CellCount(row));
+    for(std::size_t Index = 0; Index < cells.size(); Index++){
+        cells[Index] = DImplementation->Cell(row, Index);
+    }
+    return true;
+}
+
+bool CColumnarCacheReader::ReadRow(std::size_t row, std::vector<std::string> &cells) const{
+    if(row >= RowCount()){
+        return false;
+    }
+    cells.resize(CellCount(row));
+    for(std::size_t Index = 0; Index < cells.size(); Index++){
+        std::string_view Value = DImplementation->Cell(row, Index);
+        cells[Index].assign(Value.data(), Value.size());
+    }
+    return true;
+}
+
+bool CColumnarCacheReader::ReadColumn(std::size_t column, std::vector<std::string_view> &values) const{
+    if(column >= ColumnCount()){
+        return false;
+    }
+    values.resize(RowCount());
+    for(std::size_t Row = 0; Row < values.size(); Row++){
+        values[Row] = DImplementation->Cell(Row, column);
+    }
+    return true;
+}
+
+bool CColumnarCacheReader::IsDictionaryEncoded(std::size_t column) const noexcept{
+    return column < ColumnCount() && DImplementation->DColumns[column].DEncoding == EEncoding::Dictionary;
+}
+
+std::size_t CColumnarCacheReader::DictionarySize(std::size_t column) const noexcept{
+    return IsDictionaryEncoded(column) ? DImplementation->DColumns[column].DDictionarySize : 0;
+}
+
+std::string_view CColumnarCacheReader::DictionaryValue(std::size_t column, std::uint32_t code) const noexcept{
+    if(code >= DictionarySize(column)){
+        return std::string_view();
+    }
+    return DImplementation->Entry(DImplementation->DColumns[column], code);
+}
+
+std::uint32_t CColumnarCacheReader::DictionaryCode(std::size_t row, std::size_t column) const noexcept{
+    if(!IsDictionaryEncoded(column) || row >= RowCount()){
+        return 0;
+    }
+    return DImplementation->Codes(DImplementation->DColumns[column])[row];
+}
@@ -0,0 +1,184 @@
+#include "CompressedDataSink.h"
+#include "Metrics.h"
+#include "OrderedJobQueue.h"
+#include <cstring>
+#include <zlib.h>
+#ifdef DSV_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+struct CCompressingDataSink::SImplementation{
+    // one block of input and, once a worker is done with it, its compressed form
+    struct SJob{
+        std::vector<char> DInput;
+        std::vector<char> DOutput;
+    };
+
+    // compresses one block as a self-contained gzip member or zstd frame
+    struct SCompressor{
+        ECompression DFormat;
+        int DLevel;
+        z_stream DZlib;
+#ifdef DSV_HAVE_ZSTD
+        ZSTD_CCtx *DZstd;
+#endif
+
+        SCompressor(ECompression format, int level) : DFormat(format), DLevel(level){
+            std::memset(&DZlib, 0, sizeof(DZlib));
+            deflateInit2(&DZlib, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+#ifdef DSV_HAVE_ZSTD
+            DZstd = ZSTD_createCCtx();
+#endif
+        }
+
+        ~SCompressor(){
+            deflateEnd(&DZlib);
+#ifdef DSV_HAVE_ZSTD
+            ZSTD_freeCCtx(DZstd);
+#endif
+        }
+
+        bool Compress(const std::vector<char> &input, std::vector<char> &output){
+            if(DFormat == ECompression::None){
+                output = input;
+                return true;
+            }
+            if(DFormat == ECompression::Gzip){
+                deflateReset(&DZlib);
+                output.resize(deflateBound(&DZlib, input.size()));
+                DZlib.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+                DZlib.avail_in = static_cast<uInt>(input.size());
+                DZlib.next_out = reinterpret_cast<Bytef *>(output.data());
+                DZlib.avail_out = static_cast<uInt>(output.size());
+                if(deflate(&DZlib, Z_FINISH) != Z_STREAM_END){
+                    return false;
+                }
+                output.resize(output.size() - DZlib.avail_out);
+                return true;
+            }
+#ifdef DSV_HAVE_ZSTD
+            output.resize(ZSTD_compressBound(input.size()));
+            std::size_t Result = ZSTD_compressCCtx(DZstd, output.data(), output.size(), input.data(), input.size(), DLevel);
+            if(ZSTD_isError(Result)){
+                return false;
+            }
+            output.resize(Result);
+            return true;
+#else
+            return false;
+#endif
+        }
+    };
+
+    std::shared_ptr<CDataSink> DSink;
+    std::size_t DBlockSize;
+    // one per worker, indexed by the worker the queue runs a job on
+    std::vector< std::unique_ptr<SCompressor> > DCompressors;
+    // block currently being filled by Put/Write
+    std::unique_ptr<SJob> DCurrent;
+    TOrderedJobQueue<SJob> DQueue;
+    bool DClosed;
+    bool DAnyBlock;
+
+    SImplementation(std::shared_ptr<CDataSink> sink, ECompression format, int level, std::size_t threads, std::size_t blocksize)
+        : DSink(std::move(sink)), DBlockSize(blocksize ? blocksize : 1), DCompressors(MakeCompressors(format, level, threads)), DCurrent(std::make_unique<SJob>()),
+          DQueue(threads, 2 * (threads ? threads : 1), true,
+                 [this](SJob &job, std::size_t worker){
+                     DSV_TRACE_SPAN("CompressingDataSink::Compress");
+                     return DCompressors[worker]->Compress(job.DInput, job.DOutput);
+                 },
+                 [this](SJob &job){ return DSink->Write(job.DOutput); }),
+          DClosed(false), DAnyBlock(false){
+#ifndef DSV_HAVE_ZSTD
+        if(format == ECompression::Zstd){
+            DQueue.Fail();
+        }
+#endif
+        DCurrent->DInput.reserve(DBlockSize);
+    }
+
+    ~SImplementation(){
+        Close();
+    }
+
+    static std::vector< std::unique_ptr<SCompressor> > MakeCompressors(ECompression format, int level, std::size_t threads){
+        std::vector< std::unique_ptr<SCompressor> > Compressors;
+        for(std::size_t Index = 0; Index < (threads ? threads : 1); Index++){
+            Compressors.push_back(std::make_unique<SCompressor>(format, level));
+        }
+        return Compressors;
+    }
+
+    // queues the filling block and starts a fresh one, waiting for room
+    bool Submit(){
+        DAnyBlock = true;
+        bool Success = DQueue.Submit(std::move(DCurrent));
+        DCurrent = DQueue.Acquire();
+        DCurrent->DInput.clear();
+        DCurrent->DInput.reserve(DBlockSize);
+        return Success;
+    }
+
+    bool Append(const char *data, std::size_t length){
+        if(DClosed || DQueue.Failed()){
+            return false;
+        }
+        while(length){
+            std::size_t Chunk = std::min(length, DBlockSize - DCurrent->DInput.size());
+            DCurrent->DInput.insert(DCurrent->DInput.end(), data, data + Chunk);
+            data += Chunk;
+            length -= Chunk;
+            if(DCurrent->DInput.size() == DBlockSize && !Submit()){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // submits the partial block and waits until everything reached the sink
+    bool Flush(){
+        if(DClosed || DQueue.Failed()){
+            return !DQueue.Failed();
+        }
+        if(!DCurrent->DInput.empty()){
+            Submit();
+        }
+        return DQueue.Drain() && DSink->Flush();
+    }
+
+    bool Close(){
+        if(DClosed){
+            return !DQueue.Failed();
+        }
+        // an empty stream still gets one (empty) member so the output is valid
+        if(!DCurrent->DInput.empty() || !DAnyBlock){
+            Submit();
+        }
+        DQueue.Stop();
+        DClosed = true;
+        return DSink->Flush() && !DQueue.Failed();
+    }
+};
+
+CCompressingDataSink::CCompressingDataSink(std::shared_ptr< CDataSink > sink, ECompression format, int level, std::size_t threads, std::size_t blocksize)
+    : DImplementation(std::make_unique<SImplementation>(std::move(sink), format, level, threads, blocksize)){
+
+}
+
+CCompressingDataSink::~CCompressingDataSink() = default;
+
+bool CCompressingDataSink::Close() noexcept{
+    return DImplementation->Close();
+}
+
+bool CCompressingDataSink::Flush() noexcept{
+    return DImplementation->Flush();
+}
+
+bool CCompressingDataSink::Put(const char &ch) noexcept{
+    return DImplementation->Append(&ch, 1);
+}
+
+bool CCompressingDataSink::Write(const std::vector<char> &buf) noexcept{
+    return DImplementation->Append(buf.data(), buf.size());
+}
@@ -0,0 +1,236 @@
+#include "CompressedDataSource.h"
+#include "PrefetchDataSource.h"
+#include <atomic>
+#include <cstring>
+#include <zlib.h>
+#ifdef DSV_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace{
+
+// synchronous decoder; the public class optionally puts a prefetcher in front
+class CDecoderDataSource : public CDataSource{
+    private:
+        std::shared_ptr<CDataSource> DSource;
+        std::size_t DBufferSize;
+        ECompression DFormat;
+        std::vector<char> DInput;
+        std::size_t DInputPosition;
+        bool DInputDone;
+        std::vector<char> DOutput;
+        std::size_t DOutputPosition;
+        std::size_t DOutputLength;
+        bool DFinished;
+        // a gzip member or zstd frame is still open
+        bool DInsideStream;
+        std::atomic<bool> DFailed;
+        z_stream DZlib;
+#ifdef DSV_HAVE_ZSTD
+        ZSTD_DStream *DZstd;
+#endif
+
+        // makes sure there is unconsumed input, false once the source is dry
+        bool FillInput() noexcept{
+            if(DInputPosition < DInput.size()){
+                return true;
+            }
+            DInputPosition = 0;
+            if(DInputDone || !DSource->Read(DInput, DBufferSize)){
+                DInput.clear();
+                DInputDone = true;
+                return false;
+            }
+            return true;
+        }
+
+        void Fail() noexcept{
+            DFailed = true;
+            DFinished = true;
+        }
+
+        // runs the decoder until some output is produced or the stream ends
+        void Decode() noexcept{
+            while(DOutputPosition == DOutputLength && !DFinished){
+                DOutputPosition = DOutputLength = 0;
+                if(!FillInput()){
+                    // running out of input inside a member means truncation
+                    if(DInsideStream){
+                        Fail();
+                    }
+                    DFinished = true;
+                    return;
+                }
+                if(DFormat == ECompression::None){
+                    // pass through by swapping buffers
+                    std::swap(DInput, DOutput);
+                    DOutputPosition = DInputPosition;
+                    DOutputLength = DOutput.size();
+                    DInput.clear();
+                    DInputPosition = 0;
+                    continue;
+                }
+                if(DFormat == ECompression::Gzip){
+                    if(!DInsideStream){
+                        // the next member of a multi-member file starts here
+                        inflateReset(&DZlib);
+                        DInsideStream = true;
+                    }
+                    DZlib.next_in = reinterpret_cast<Bytef *>(DInput.data() + DInputPosition);
+                    DZlib.avail_in = static_cast<uInt>(DInput.size() - DInputPosition);
+                    DZlib.next_out = reinterpret_cast<Bytef *>(DOutput.data());
+                    DZlib.avail_out = static_cast<uInt>(DOutput.size());
+                    int Result = inflate(&DZlib, Z_NO_FLUSH);
+                    DInputPosition = DInput.size() - DZlib.avail_in;
+                    DOutputLength = DOutput.size() - DZlib.avail_out;
+                    if(Result == Z_STREAM_END){
+                        DInsideStream = false;
+                    }
+                    else if(Result != Z_OK && Result != Z_BUF_ERROR){
+                        Fail();
+                    }
+                }
+#ifdef DSV_HAVE_ZSTD
+                else if(DFormat == ECompression::Zstd){
+                    ZSTD_inBuffer In = {DInput.data(), DInput.size(), DInputPosition};
+                    ZSTD_outBuffer Out = {DOutput.data(), DOutput.size(), 0};
+                    std::size_t Result = ZSTD_decompressStream(DZstd, &Out, &In);
+                    DInputPosition = In.pos;
+                    DOutputLength = Out.pos;
+                    if(ZSTD_isError(Result)){
+                        Fail();
+                    }
+                    else{
+                        // zero means a frame just ended and nothing is pending
+                        DInsideStream = Result != 0;
+                    }
+                }
+#endif
+                else{
+                    Fail();
+                }
+            }
+        }
+
+    public:
+        CDecoderDataSource(std::shared_ptr<CDataSource> src, std::size_t buffersize)
+            : DSource(std::move(src)), DBufferSize(buffersize ? buffersize : 1), DFormat(ECompression::None), DInputPosition(0), DInputDone(false),
+              DOutput(DBufferSize), DOutputPosition(0), DOutputLength(0), DFinished(false), DInsideStream(false), DFailed(false){
+            std::memset(&DZlib, 0, sizeof(DZlib));
+            // 15 + 32 lets zlib take both gzip and zlib headers
+            inflateInit2(&DZlib, 15 + 32);
+#ifdef DSV_HAVE_ZSTD
+            DZstd = ZSTD_createDStream();
+            ZSTD_initDStream(DZstd);
+#endif
+            // sniff the magic bytes from the first chunk
+            if(FillInput()){
+                const unsigned char *Magic = reinterpret_cast<const unsigned char *>(DInput.data());
+                std::size_t Length = DInput.size();
+                if(Length >= 2 && Magic[0] == 0x1F && Magic[1] == 0x8B){
+                    DFormat = ECompression::Gzip;
+                }
+                else if(Length >= 4 && Magic[0] == 0x28 && Magic[1] == 0xB5 && Magic[2] == 0x2F && Magic[3] == 0xFD){
+                    DFormat = ECompression::Zstd;
+                }
+            }
+        }
+
+        ~CDecoderDataSource(){
+            inflateEnd(&DZlib);
+#ifdef DSV_HAVE_ZSTD
+            ZSTD_freeDStream(DZstd);
+#endif
+        }
+
+        ECompression Format() const noexcept{
+            return DFormat;
+        }
+
+        bool Failed() const noexcept{
+            return DFailed;
+        }
+
+        bool End() const noexcept override{
+            const_cast<CDecoderDataSource *>(this)->Decode();
+            return DOutputPosition == DOutputLength;
+        }
+
+        bool Get(char &ch) noexcept override{
+            if(End()){
+                return false;
+            }
+            ch = DOutput[DOutputPosition++];
+            return true;
+        }
+
+        bool Peek(char &ch) noexcept override{
+            if(End()){
+                return false;
+            }
+            ch = DOutput[DOutputPosition];
+            return true;
+        }
+
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+            buf.resize(count);
+            std::size_t Copied = 0;
+            while(Copied < count && !End()){
+                std::size_t Chunk = std::min(count - Copied, DOutputLength - DOutputPosition);
+                std::memcpy(buf.data() + Copied, DOutput.data() + DOutputPosition, Chunk);
+                DOutputPosition += Chunk;
+                Copied += Chunk;
+            }
+            buf.resize(Copied);
+            return Copied > 0;
+        }
+};
+
+}
+
+struct CDecompressingDataSource::SImplementation{
+    std::shared_ptr<CDecoderDataSource> DDecoder;
+    // the decoder itself, or a prefetcher running it on another thread
+    std::shared_ptr<CDataSource> DActive;
+
+    SImplementation(std::shared_ptr<CDataSource> src, bool background, std::size_t buffersize)
+        : DDecoder(std::make_shared<CDecoderDataSource>(std::move(src), buffersize)){
+        if(background){
+            DActive = std::make_shared<CPrefetchDataSource>(DDecoder, buffersize, 4);
+        }
+        else{
+            DActive = DDecoder;
+        }
+    }
+};
+
+CDecompressingDataSource::CDecompressingDataSource(std::shared_ptr< CDataSource > src, bool background, std::size_t buffersize)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), background, buffersize)){
+
+}
+
+CDecompressingDataSource::~CDecompressingDataSource() = default;
+
+ECompression CDecompressingDataSource::Format() const noexcept{
+    return DImplementation->DDecoder->Format();
+}
+
+bool CDecompressingDataSource::Failed() const noexcept{
+    return DImplementation->DDecoder->Failed();
+}
+
+bool CDecompressingDataSource::End() const noexcept{
+    return DImplementation->DActive->End();
+}
+
+bool CDecompressingDataSource::Get(char &ch) noexcept{
+    return DImplementation->DActive->Get(ch);
+}
+
+bool CDecompressingDataSource::Peek(char &ch) noexcept{
+    return DImplementation->DActive->Peek(ch);
+}
+
+bool CDecompressingDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    return DImplementation->DActive->Read(buf, count);
+}
@@ -0,0 +1,187 @@
+#include "DSVPushParser.h"
+#include "Metrics.h"
+#include <array>
+
+struct CDSVPushParser::SImplementation{
+    char DDelimiter;
+    TRowCallback DCallback;
+    // bytes that end a run of plain cell text
+    std::array<bool, 256> DSpecial;
+    // row being filled; cells past DCellCount are spare strings
+    std::vector<std::string> DRow;
+    std::size_t DCellCount;
+    std::vector< std::vector<std::string> > DRows;
+    bool DInQuotes;
+    // a quote was the last byte fed, its meaning depends on the next one
+    bool DPendingQuote;
+    // a row ended on '\r', a '\n' right after it belongs to that ending
+    bool DPendingReturn;
+    // any byte of the current row has been seen
+    bool DData;
+    std::size_t DRowCount;
+    // input offset of the first byte of the current Feed call
+    std::uint64_t DOffset;
+    SDSVCheckpoint DCheckpoint;
+
+    SImplementation(char delimiter, TRowCallback callback)
+        : DDelimiter(delimiter), DCallback(std::move(callback)), DSpecial{}{
+        DSpecial[static_cast<unsigned char>(delimiter)] = true;
+        DSpecial[static_cast<unsigned char>('"')] = true;
+        DSpecial[static_cast<unsigned char>('\n')] = true;
+        DSpecial[static_cast<unsigned char>('\r')] = true;
+        Reset(SDSVCheckpoint());
+    }
+
+    void Reset(const SDSVCheckpoint &checkpoint){
+        DCellCount = 0;
+        DInQuotes = false;
+        DPendingQuote = false;
+        DPendingReturn = checkpoint.DPendingReturn;
+        DData = false;
+        DRowCount = 0;
+        DOffset = checkpoint.DOffset;
+        DCheckpoint = checkpoint;
+        StartCell();
+    }
+
+    std::string &Cell(){
+        return DRow[DCellCount];
+    }
+
+    // clears the cell at DCellCount for reuse, growing the row when needed
+    void StartCell(){
+        if(DCellCount < DRow.size()){
+            DRow[DCellCount].clear();
+        }
+        else{
+            DRow.emplace_back();
+        }
+    }
+
+    // the spare strings stay in DRow for the next, possibly wider, row
+    void EmitRow(){
+        DSV_METRIC_ADD(RowsRead, 1);
+        DSV_METRIC_ADD(CellsRead, DCellCount);
+        if(DCallback){
+            DCallback(std::span<const std::string>(DRow.data(), DCellCount));
+        }
+        else{
+            DRows.emplace_back(DRow.begin(), DRow.begin() + DCellCount);
+        }
+        DRowCount++;
+        DCellCount = 0;
+        DData = false;
+        StartCell();
+    }
+
+    std::size_t Feed(const char *data, std::size_t length){
+        DSV_METRIC_ADD(BytesRead, length);
+        std::size_t Before = DRowCount;
+        const char *Position = data;
+        const char *Stop = data + length;
+        while(Position < Stop){
+            if(DPendingReturn){
+                DPendingReturn = false;
+                if(*Position == '\n'){
+                    Position++;
+                    continue;
+                }
+            }
+            if(DPendingQuote){
+                DPendingQuote = false;
+                if(*Position == '"'){
+                    // a doubled quote is a literal quote, in or out of quotes
+                    Cell() += '"';
+                    Position++;
+                    continue;
+                }
+                DInQuotes = !DInQuotes;
+            }
+            DData = true;
+            char Char = *Position;
+            if(!DSpecial[static_cast<unsigned char>(Char)]){
+                // copy the whole run of plain text in one go
+                const char *Run = Position + 1;
+                while(Run < Stop && !DSpecial[static_cast<unsigned char>(*Run)]){
+                    Run++;
+                }
+                Cell().append(Position, Run);
+                Position = Run;
+                continue;
+            }
+            Position++;
+            if(Char == '"'){
+                DPendingQuote = true;
+            }
+            else if(DInQuotes){
+                Cell() += Char;
+            }
+            else if(Char == DDelimiter){
+                DCellCount++;
+                StartCell();
+            }
+            else{
+                // '\n' or '\r' outside quotes; a blank line is an empty row
+                if(!Cell().empty() || DCellCount > 0){
+                    DCellCount++;
+                }
+                DPendingReturn = Char == '\r';
+                DCheckpoint.DOffset = DOffset + (Position - data);
+                DCheckpoint.DPendingReturn = DPendingReturn;
+                EmitRow();
+            }
+        }
+        DOffset += length;
+        return DRowCount - Before;
+    }
+
+    std::size_t Finish(){
+        std::size_t Before = DRowCount;
+        if(DPendingQuote){
+            DPendingQuote = false;
+            DInQuotes = !DInQuotes;
+        }
+        DPendingReturn = false;
+        if(DData){
+            DCellCount++;
+            DCheckpoint.DOffset = DOffset;
+            DCheckpoint.DPendingReturn = false;
+            EmitRow();
+        }
+        DInQuotes = false;
+        return DRowCount - Before;
+    }
+};
+
+CDSVPushParser::CDSVPushParser(char delimiter, TRowCallback callback)
+    : DImplementation(std::make_unique<SImplementation>(delimiter, std::move(callback))){
+
+}
+
+CDSVPushParser::~CDSVPushParser() = default;
+
+std::size_t CDSVPushParser::Feed(const char *data, std::size_t length){
+    return DImplementation->Feed(data, length);
+}
+
+std::size_t CDSVPushParser::Finish(){
+    return DImplementation->Finish();
+}
+
+void CDSVPushParser::Reset(const SDSVCheckpoint &checkpoint){
+    DImplementation->Reset(checkpoint);
+}
+
+SDSVCheckpoint CDSVPushParser::Checkpoint() const noexcept{
+    return DImplementation->DCheckpoint;
+}
+
+std::size_t CDSVPushParser::TakeRows(std::vector< std::vector<std::string> > &rows){
+    rows.clear();
+    rows.swap(DImplementation->DRows);
+    return rows.size();
+}
+
+std::size_t CDSVPushParser::RowCount() const noexcept{
+    return DImplementation->DRowCount;
+}
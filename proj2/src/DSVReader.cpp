@@ -1,4 +1,52 @@
 #include "DSVReader.h" // including header file for CDSVReader class usage
+#include "DSVReaderTemplate.h"
+#include "DSVRowFilter.h"
+#include "FileDataSource.h"
+#include "Metrics.h"
+#include <array>
+#include <cstring>
+
+namespace {
+
+// a compiled dialect behind one virtual call per row
+struct SDialectParser {
+    virtual ~SDialectParser() = default;
+    virtual bool ReadRow(std::vector<std::string>& row) = 0;
+    virtual bool ReadRow(std::pmr::vector<std::pmr::string>& row) = 0;
+    virtual bool ReadRow(std::vector<std::string_view>& row) = 0;
+};
+
+template <typename TReader>
+struct SDialectParserFor : SDialectParser {
+    TReader Reader;
+
+    template <typename TSource>
+    explicit SDialectParserFor(std::shared_ptr<TSource> src) : Reader(std::move(src)) {}
+
+    bool ReadRow(std::vector<std::string>& row) override { return Reader.ReadRow(row); }
+    bool ReadRow(std::pmr::vector<std::pmr::string>& row) override { return Reader.ReadRow(row); }
+    bool ReadRow(std::vector<std::string_view>& row) override { return Reader.ReadRow(row); }
+};
+
+template <char Delimiter, typename TSource>
+std::unique_ptr<SDialectParser> MakeParser(std::shared_ptr<TSource> src) {
+    return std::make_unique<SDialectParserFor<TDSVReader<Delimiter, '"', EDSVLineEnding::Any, false, TSource>>>(std::move(src));
+}
+
+// the common dialects get a compiled parser, anything else uses the
+// runtime one below
+template <typename TSource>
+std::unique_ptr<SDialectParser> MakeParser(std::shared_ptr<TSource> src, char delimiter) {
+    switch (delimiter) {
+        case ',': return MakeParser<','>(std::move(src));
+        case '\t': return MakeParser<'\t'>(std::move(src));
+        case '|': return MakeParser<'|'>(std::move(src));
+        case ';': return MakeParser<';'>(std::move(src));
+        default: return nullptr;
+    }
+}
+
+}
 
 // implementing details of DSV Reader into struct function
 struct CDSVReader::SImplementation {
@@ -6,34 +54,71 @@ struct CDSVReader::SImplementation {
     std::shared_ptr<CDataSource> DataSource;
     // char variable used to separate values in the file
     char Delimiter;
+    // row backing the string_view overload, reused between calls
+    std::vector<std::string> ViewRow;
+    // compiled parser for a common dialect, null when the runtime one is used;
+    // file sources get an instantiation that calls them without virtual dispatch
+    std::unique_ptr<SDialectParser> Parser;
+    // the source when it is a file, for the filtered scan's bulk copies
+    CFileDataSource* FileSource = nullptr;
+    // bytes that end a run of plain cell text
+    std::array<bool, 256> Special{};
+    // the same without the delimiter, for rows that already failed
+    std::array<bool, 256> RowEndSpecial{};
+    // cells of the row being filtered, back to back, and where each one ends
+    std::string FilterCells;
+    std::vector<size_t> FilterEnds;
 
     // initialize my source and delimiter before moving on any further
     SImplementation(std::shared_ptr<CDataSource> src, char delimiter)
-        : DataSource(std::move(src)), Delimiter(delimiter) {}
-
-    // reading the row which is most likely a vector of strings
-    bool ReadRow(std::vector<std::string>& currentRow) {
-        // begin with an empty row
-        currentRow.clear();
-        
-        // a string to get data for each cell
-        std::string currentCell;
+        : DataSource(std::move(src)), Delimiter(delimiter) {
+        Special[static_cast<unsigned char>(delimiter)] = true;
+        Special[static_cast<unsigned char>('"')] = true;
+        Special[static_cast<unsigned char>('\n')] = true;
+        Special[static_cast<unsigned char>('\r')] = true;
+        RowEndSpecial = Special;
+        RowEndSpecial[static_cast<unsigned char>(delimiter)] = false;
+        RowEndSpecial[static_cast<unsigned char>('"')] = true;
+        if (auto file = std::dynamic_pointer_cast<CFileDataSource>(DataSource)) {
+            FileSource = file.get();
+            Parser = MakeParser(std::move(file), delimiter);
+        } else if (DataSource) {
+            Parser = MakeParser(DataSource, delimiter);
+        }
+    }
+
+    // reading the row which is most likely a vector of strings; works for any
+    // vector of strings so the pmr overload shares the same parser. Cells are
+    // written straight into the row's existing strings, so a row vector that
+    // is reused between calls stops allocating once its cells are big enough
+    template <typename TRow>
+    bool ReadRow(TRow& currentRow) {
+        // number of cells filled so far, the row keeps its old strings around
+        size_t cellCount = 0;
+        // the cell being filled, created lazily on the first character
+        auto* currentCell = DSVReaderDetail::NextCell(currentRow, cellCount);
         // a variable to store the character read from the data source
         char currentChar;
         // determines if we are inside a quoted string
         bool isInQuotes = false;
         // to track whether any data has been read
         bool data = false;
+        // tallied locally and added once per row
+        DSV_METRIC_ONLY(size_t bytesRead = 0);
+        DSV_METRIC_ONLY(size_t quotedCells = 0);
+        DSV_METRIC_ONLY(bool cellQuoted = false);
     
         // read characters until reaching the end of the data source
         while (!DataSource->End()) {
             // if unable to read a charcter return false
             if (!DataSource->Get(currentChar)) {
+                currentRow.resize(0);
                 return false;
             }
     
             // if a character was successfully read then we've encountered data
             data = true;
+            DSV_METRIC_ONLY(bytesRead++);
     
             // having quotes for the current characters
             if (currentChar == '"') {
@@ -45,13 +130,15 @@ struct CDSVReader::SImplementation {
                     if (peekResult && nextChar == '"') {
                         // if the next character is another quote treat it as an escaped quote
                         DataSource->Get(nextChar); // Takes the second quote
-                        currentCell += '"'; // add a single quote to the current cell
+                        DSV_METRIC_ONLY(bytesRead++);
+                        *currentCell += '"'; // add a single quote to the current cell
                     } else if (isInQuotes) {
                         // we are inside quotes and find another quote, it’s the end of the quoted section
                         isInQuotes = false;
                     } else {
                         // we are starting a new quoted section
                         isInQuotes = true;
+                        DSV_METRIC_ONLY(cellQuoted = true);
                     }
                 } else if (isInQuotes) {
                     // if we are at the end of the file and inside quotes, close quote section
@@ -63,14 +150,17 @@ struct CDSVReader::SImplementation {
             }
             // if we hit a delimiter and we're not inside quotes, it marks the end of the current cell
             else if (currentChar == Delimiter && !isInQuotes) {
-                currentRow.push_back(currentCell); // add the completed cell to the row
-                currentCell.clear(); // prepare for the next cell by clearing the cell
+                cellCount++; // keep the completed cell in the row
+                DSV_METRIC_ONLY(quotedCells += cellQuoted);
+                DSV_METRIC_ONLY(cellQuoted = false);
+                currentCell = DSVReaderDetail::NextCell(currentRow, cellCount); // and move on to a fresh one
             }
             // end of the row detected (\n or \r return), unless inside quotes
             else if ((currentChar == '\n' || currentChar == '\r') && !isInQuotes) {
-                if (!currentCell.empty() || !currentRow.empty()) {
-                    currentRow.push_back(currentCell); // Add any remaining data in the cell with this line
+                if (!currentCell->empty() || cellCount > 0) {
+                    cellCount++; // Add any remaining data in the cell with this line
                 }
+                currentRow.resize(cellCount);
     
                 // \r\n handling
                 if (currentChar == '\r' && !DataSource->End()) {
@@ -79,25 +169,137 @@ struct CDSVReader::SImplementation {
                     if (peekResult && nextChar == '\n') {
                         // if the next character is '\n', take it in to avoid treating it as part of the next row
                         DataSource->Get(nextChar);
+                        DSV_METRIC_ONLY(bytesRead++);
                     }
                 }
+                DSV_METRIC_ONLY(DSVReaderDetail::RecordRow(bytesRead, cellCount, quotedCells + cellQuoted));
     
                 return true; // successfully read the row and returns true
             }
             // adding regular character to the current cell
             else {
-                currentCell += currentChar;
+                *currentCell += currentChar;
             }
         }
     
         // any remaining data in the current cell push it into the row
-        if (!currentCell.empty() || data) {
-            currentRow.push_back(currentCell);
+        if (!currentCell->empty() || data) {
+            cellCount++;
+        }
+        currentRow.resize(cellCount);
+        if (data) {
+            DSV_METRIC_ONLY(DSVReaderDetail::RecordRow(bytesRead, cellCount, quotedCells + cellQuoted));
         }
     
         // return true if any content was read
         return data;
     }
+
+    // same rules as ReadRow, but cells are collected into one buffer and
+    // checked as they complete; once a predicate fails the rest of the row
+    // is only scanned for its end
+    template <typename TSource>
+    bool ReadFilteredRow(TSource& source, const CDSVRowFilter& filter, std::vector<std::string>& row) {
+        while (true) {
+            FilterCells.clear();
+            FilterEnds.clear();
+            size_t cellStart = 0;
+            bool isInQuotes = false;
+            bool data = false;
+            bool rejected = false;
+            bool rowEnded = false;
+            char currentChar;
+
+            // closes the cell being collected, checking it unless the row already failed
+            auto endCell = [&]() {
+                if (!rejected && !filter.Accept(FilterEnds.size(), std::string_view(FilterCells).substr(cellStart))) {
+                    rejected = true;
+                }
+                FilterEnds.push_back(FilterCells.size());
+                cellStart = FilterCells.size();
+            };
+
+            while (!source.End()) {
+                if (!source.Get(currentChar)) {
+                    row.resize(0);
+                    return false;
+                }
+                data = true;
+                if (currentChar == '"') {
+                    char nextChar;
+                    if (source.Peek(nextChar) && nextChar == '"') {
+                        source.Get(nextChar);
+                        if (!rejected) {
+                            FilterCells += '"';
+                        }
+                    } else {
+                        isInQuotes = !isInQuotes;
+                    }
+                } else if (currentChar == Delimiter && !isInQuotes) {
+                    endCell();
+                } else if ((currentChar == '\n' || currentChar == '\r') && !isInQuotes) {
+                    if (FilterCells.size() > cellStart || !FilterEnds.empty()) {
+                        endCell();
+                    }
+                    if (currentChar == '\r') {
+                        char nextChar;
+                        if (source.Peek(nextChar) && nextChar == '\n') {
+                            source.Get(nextChar);
+                        }
+                    }
+                    rowEnded = true;
+                    break;
+                } else {
+                    if (!rejected) {
+                        FilterCells += currentChar;
+                    }
+                    if constexpr (SDSVBufferedSource<TSource>::value) {
+                        // step over the rest of the plain run in one go; inside
+                        // quotes only a quote ends it, and once the row failed
+                        // delimiters no longer matter either
+                        std::string_view window = source.Buffered();
+                        size_t run = 0;
+                        if (isInQuotes) {
+                            const void* quote = std::memchr(window.data(), '"', window.size());
+                            run = quote ? static_cast<const char*>(quote) - window.data() : window.size();
+                        } else if (rejected) {
+                            while (run < window.size() && !RowEndSpecial[static_cast<unsigned char>(window[run])]) {
+                                run++;
+                            }
+                        } else {
+                            while (run < window.size() && !Special[static_cast<unsigned char>(window[run])]) {
+                                run++;
+                            }
+                        }
+                        if (!rejected) {
+                            FilterCells.append(window.data(), run);
+                        }
+                        source.Consume(run);
+                    }
+                }
+            }
+            if (!rowEnded) {
+                if (!data) {
+                    row.resize(0);
+                    return false;
+                }
+                endCell();
+            }
+            if (!rejected && FilterEnds.size() >= filter.ColumnCount()) {
+                row.resize(FilterEnds.size());
+                size_t start = 0;
+                for (size_t index = 0; index < FilterEnds.size(); index++) {
+                    row[index].assign(FilterCells, start, FilterEnds[index] - start);
+                    start = FilterEnds[index];
+                }
+                return true;
+            }
+            if (!rowEnded) {
+                row.resize(0);
+                return false;
+            }
+        }
+    }
 };
 
 // constructor for DSV Reader class
@@ -114,5 +316,34 @@ bool CDSVReader::End() const {
 
 // read a row of data from the source
 bool CDSVReader::ReadRow(std::vector<std::string> &row) {
+    if (DImplementation->Parser) {
+        return DImplementation->Parser->ReadRow(row);
+    }
+    return DImplementation->ReadRow(row);
+}
+
+// read a row into arena backed strings
+bool CDSVReader::ReadRow(std::pmr::vector<std::pmr::string> &row) {
+    if (DImplementation->Parser) {
+        return DImplementation->Parser->ReadRow(row);
+    }
     return DImplementation->ReadRow(row);
 }
+
+// read the next row the filter accepts
+bool CDSVReader::ReadRow(std::vector<std::string> &row, const CDSVRowFilter &filter) {
+    if (DImplementation->FileSource) {
+        return DImplementation->ReadFilteredRow(*DImplementation->FileSource, filter, row);
+    }
+    return DImplementation->ReadFilteredRow(*DImplementation->DataSource, filter, row);
+}
+
+// read a row as views into the reader's buffer
+bool CDSVReader::ReadRow(std::vector<std::string_view> &row) {
+    if (DImplementation->Parser) {
+        return DImplementation->Parser->ReadRow(row);
+    }
+    bool result = DImplementation->ReadRow(DImplementation->ViewRow);
+    row.assign(DImplementation->ViewRow.begin(), DImplementation->ViewRow.end());
+    return result;
+}
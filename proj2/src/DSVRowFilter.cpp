@@ -0,0 +1,102 @@
+#include "DSVRowFilter.h"
+#include <algorithm>
+#include <charconv>
+
+CDSVRowFilter &CDSVRowFilter::Add(SPredicate predicate){
+    if(predicate.DColumn >= DByColumn.size()){
+        DByColumn.resize(predicate.DColumn + 1);
+    }
+    DByColumn[predicate.DColumn].push_back(DPredicates.size());
+    DPredicates.push_back(std::move(predicate));
+    return *this;
+}
+
+CDSVRowFilter &CDSVRowFilter::Equals(std::size_t column, std::string value){
+    return Add({EKind::Equals, column, std::move(value), 0.0, 0.0, {}});
+}
+
+CDSVRowFilter &CDSVRowFilter::Prefix(std::size_t column, std::string prefix){
+    return Add({EKind::Prefix, column, std::move(prefix), 0.0, 0.0, {}});
+}
+
+CDSVRowFilter &CDSVRowFilter::Range(std::size_t column, double minimum, double maximum){
+    return Add({EKind::Range, column, std::string(), minimum, maximum, {}});
+}
+
+CDSVRowFilter &CDSVRowFilter::OneOf(std::size_t column, std::vector<std::string> values){
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return Add({EKind::OneOf, column, std::string(), 0.0, 0.0, std::move(values)});
+}
+
+bool CDSVRowFilter::Empty() const noexcept{
+    return DPredicates.empty();
+}
+
+std::size_t CDSVRowFilter::ColumnCount() const noexcept{
+    return DByColumn.size();
+}
+
+bool CDSVRowFilter::HasPredicates(std::size_t column) const noexcept{
+    return column < DByColumn.size() && !DByColumn[column].empty();
+}
+
+bool CDSVRowFilter::Accept(std::size_t column, std::string_view cell) const noexcept{
+    if(column >= DByColumn.size()){
+        return true;
+    }
+    for(std::size_t Index : DByColumn[column]){
+        const SPredicate &Predicate = DPredicates[Index];
+        switch(Predicate.DKind){
+            case EKind::Equals:
+                if(cell != Predicate.DValue){
+                    return false;
+                }
+                break;
+            case EKind::Prefix:
+                if(cell.substr(0, Predicate.DValue.size()) != Predicate.DValue){
+                    return false;
+                }
+                break;
+            case EKind::Range:{
+                // from_chars takes neither leading spaces nor a '+'
+                std::string_view Number = cell;
+                while(!Number.empty() && (Number.front() == ' ' || Number.front() == '\t')){
+                    Number.remove_prefix(1);
+                }
+                if(!Number.empty() && Number.front() == '+'){
+                    Number.remove_prefix(1);
+                }
+                double Value;
+                auto Result = std::from_chars(Number.data(), Number.data() + Number.size(), Value);
+                if(Number.empty() || Result.ec != std::errc() || Result.ptr != Number.data() + Number.size() || Value < Predicate.DMinimum || Value > Predicate.DMaximum){
+                    return false;
+                }
+                break;
+            }
+            case EKind::OneOf:
+                if(!std::binary_search(Predicate.DValues.begin(), Predicate.DValues.end(), cell, [](std::string_view left, std::string_view right){ return left < right; })){
+                    return false;
+                }
+                break;
+        }
+    }
+    return true;
+}
+
+bool CDSVRowFilter::Matches(const std::vector<std::string> &row) const noexcept{
+    if(row.size() < DByColumn.size()){
+        // the missing columns fail only if they have predicates
+        for(std::size_t Column = row.size(); Column < DByColumn.size(); Column++){
+            if(!DByColumn[Column].empty()){
+                return false;
+            }
+        }
+    }
+    for(std::size_t Column = 0; Column < row.size() && Column < DByColumn.size(); Column++){
+        if(!Accept(Column, row[Column])){
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,221 @@
+#include "DSVScanner.h"
+#include "FileDataSource.h"
+#include "SIMDUtils.h"
+#include <cstring>
+#include <limits>
+
+struct CDSVScanner::SImplementation{
+    static constexpr std::size_t BlockSize = 64;
+    // blocks classified per call into the kernel
+    static constexpr std::size_t BatchBlocks = 64;
+
+    char DDelimiter;
+    std::size_t DMaxMalformed;
+    SDSVScanStats DStats;
+    SIMDUtils::SDSVBlockMasks DMasks[BatchBlocks];
+    // input short of a whole block, held until more arrives or Finish
+    char DPending[BlockSize];
+    std::size_t DPendingLength;
+    // offset of the first byte of the next block
+    std::uint64_t DOffset;
+    // carried from the last byte of the previous block
+    bool DInQuotes;
+    bool DAfterSeparator;
+    bool DAfterClose;
+    std::uint64_t DRowStart;
+    std::uint64_t DFieldStart;
+    std::size_t DDelimiters;
+    bool DRowMalformed;
+    // offset just past the '\r' that ended the last row; a '\n' there is
+    // part of that ending
+    std::uint64_t DAfterReturn;
+    // histogram slot of the previous row, as most rows have the same count
+    std::size_t DLastFieldCount;
+    std::uint64_t *DLastSlot;
+    bool DFinished;
+
+    SImplementation(char delimiter, std::size_t maxmalformed)
+        : DDelimiter(delimiter), DMaxMalformed(maxmalformed), DPendingLength(0), DOffset(0), DInQuotes(false), DAfterSeparator(true), DAfterClose(false), DRowStart(0), DFieldStart(0), DDelimiters(0), DRowMalformed(false), DAfterReturn(std::numeric_limits<std::uint64_t>::max()), DLastFieldCount(0), DLastSlot(nullptr), DFinished(false){
+
+    }
+
+    // bit i is the parity of the bits up to and including i
+    static std::uint64_t PrefixXor(std::uint64_t bits){
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+    void EndField(std::uint64_t position){
+        std::size_t Length = position - DFieldStart;
+        if(Length > DStats.DMaxFieldLength){
+            DStats.DMaxFieldLength = Length;
+        }
+        DFieldStart = position + 1;
+    }
+
+    void EndRow(std::uint64_t position){
+        std::size_t Fields = 0;
+        if(position > DRowStart){
+            EndField(position);
+            Fields = DDelimiters + 1;
+        }
+        if(!DLastSlot || Fields != DLastFieldCount){
+            DLastSlot = &DStats.DFieldCountHistogram[Fields];
+            DLastFieldCount = Fields;
+        }
+        (*DLastSlot)++;
+        if(Fields > DStats.DMaxFieldCount){
+            DStats.DMaxFieldCount = Fields;
+        }
+        DStats.DRowCount++;
+        if(DRowMalformed){
+            DStats.DMalformedRowCount++;
+            if(DStats.DMalformedRowOffsets.size() < DMaxMalformed){
+                DStats.DMalformedRowOffsets.push_back(DRowStart);
+            }
+        }
+        DRowStart = DFieldStart = position + 1;
+        DDelimiters = 0;
+        DRowMalformed = false;
+    }
+
+    // visits one block, of which the first length bytes are input
+    void ScanBlock(const SIMDUtils::SDSVBlockMasks &masks, std::size_t length){
+        std::uint64_t Valid = length == BlockSize ? ~std::uint64_t(0) : (std::uint64_t(1) << length) - 1;
+        std::uint64_t Quotes = masks.DQuote & Valid;
+        // set for bytes inside quotes once the byte itself is taken into
+        // account; an opening quote is inside, a closing one outside
+        std::uint64_t Inside = PrefixXor(Quotes) ^ (DInQuotes ? ~std::uint64_t(0) : 0);
+        std::uint64_t Returns = masks.DReturn & ~Inside & Valid;
+        std::uint64_t Separators = (masks.DDelimiter | masks.DNewline | masks.DReturn) & ~Inside & Valid;
+        std::uint64_t Opens = Quotes & Inside;
+        std::uint64_t Closes = Quotes & ~Inside;
+        // an opening quote starts a field or continues a "" pair, and a
+        // closing one is followed by a separator or the rest of the pair
+        std::uint64_t AfterSeparator = (Separators << 1) | DAfterSeparator;
+        std::uint64_t AfterClose = (Closes << 1) | DAfterClose;
+        std::uint64_t Bad = (Opens & ~(AfterSeparator | AfterClose)) | (AfterClose & ~(Separators | Opens) & Valid);
+
+        std::uint64_t Events = Separators | Bad;
+        while(Events){
+            unsigned Index = __builtin_ctzll(Events);
+            std::uint64_t Bit = std::uint64_t(1) << Index;
+            Events &= Events - 1;
+            std::uint64_t Position = DOffset + Index;
+            if(Bad & Bit){
+                DRowMalformed = true;
+            }
+            else if(masks.DDelimiter & Bit){
+                EndField(Position);
+                DDelimiters++;
+            }
+            else if((Returns & Bit) || Position != DAfterReturn){
+                EndRow(Position);
+                if(Returns & Bit){
+                    DAfterReturn = Position + 1;
+                }
+            }
+            else{
+                // the '\n' of a "\r\n" ending
+                DRowStart = DFieldStart = Position + 1;
+            }
+        }
+
+        DInQuotes = (Inside >> (length - 1)) & 1;
+        DAfterSeparator = (Separators >> (length - 1)) & 1;
+        DAfterClose = (Closes >> (length - 1)) & 1;
+        DOffset += length;
+    }
+
+    void ScanBlocks(const char *data, std::size_t blocks){
+        while(blocks){
+            std::size_t Batch = std::min(blocks, BatchBlocks);
+            SIMDUtils::ClassifyDSVBlocks(data, Batch, DDelimiter, DMasks);
+            for(std::size_t Block = 0; Block < Batch; Block++){
+                ScanBlock(DMasks[Block], BlockSize);
+            }
+            data += Batch * BlockSize;
+            blocks -= Batch;
+        }
+    }
+
+    void Feed(const char *data, std::size_t length){
+        DStats.DBytes += length;
+        if(DPendingLength){
+            std::size_t Taken = std::min(length, BlockSize - DPendingLength);
+            std::memcpy(DPending + DPendingLength, data, Taken);
+            DPendingLength += Taken;
+            data += Taken;
+            length -= Taken;
+            if(DPendingLength < BlockSize){
+                return;
+            }
+            ScanBlocks(DPending, 1);
+            DPendingLength = 0;
+        }
+        ScanBlocks(data, length / BlockSize);
+        DPendingLength = length % BlockSize;
+        std::memcpy(DPending, data + length - DPendingLength, DPendingLength);
+    }
+
+    void Finish(){
+        if(DFinished){
+            return;
+        }
+        DFinished = true;
+        if(DPendingLength){
+            // zero padding is never special unless it is the delimiter, and
+            // ScanBlock masks off everything past the input anyway
+            std::memset(DPending + DPendingLength, 0, BlockSize - DPendingLength);
+            SIMDUtils::ClassifyDSVBlocks(DPending, 1, DDelimiter, DMasks);
+            ScanBlock(DMasks[0], DPendingLength);
+            DPendingLength = 0;
+        }
+        if(DInQuotes){
+            DRowMalformed = true;
+        }
+        // a last row without a line ending
+        if(DOffset > DRowStart){
+            EndRow(DOffset);
+        }
+    }
+};
+
+CDSVScanner::CDSVScanner(char delimiter, std::size_t maxmalformed)
+    : DImplementation(std::make_unique<SImplementation>(delimiter, maxmalformed)){
+
+}
+
+CDSVScanner::~CDSVScanner() = default;
+
+void CDSVScanner::Feed(const char *data, std::size_t length){
+    DImplementation->Feed(data, length);
+}
+
+const SDSVScanStats &CDSVScanner::Finish(){
+    DImplementation->Finish();
+    return DImplementation->DStats;
+}
+
+const SDSVScanStats &CDSVScanner::Stats() const noexcept{
+    return DImplementation->DStats;
+}
+
+bool CDSVScanner::ScanFile(const std::string &filename, char delimiter, SDSVScanStats &stats, std::size_t maxmalformed){
+    CFileDataSource Source(filename, 1 << 20);
+    if(!Source.IsOpen()){
+        return false;
+    }
+    CDSVScanner Scanner(delimiter, maxmalformed);
+    for(std::string_view Window = Source.Buffered(); !Window.empty(); Window = Source.Buffered()){
+        Scanner.Feed(Window.data(), Window.size());
+        Source.Consume(Window.size());
+    }
+    stats = Scanner.Finish();
+    return true;
+}
@@ -1,5 +1,7 @@
 #include "DSVWriter.h" //use header file of dsvwriter to implement WriteRow
-#include "DataSink.h" //use datasink to implement Put()
+#include "DataSink.h" //use datasink to implement Write()
+#include "Metrics.h"
+#include <cstring>
 
 // implementing details of DSV Writer into struct function
 struct CDSVWriter::SImplementation {
@@ -9,48 +11,18 @@ struct CDSVWriter::SImplementation {
     char Delimiter;
     // determine if all values should be quoted, regardless of content
     bool QuoteAll;
+    // formatted row, kept between calls so its capacity is reused
+    std::vector<char> Buffer;
 
     // initialize the data sink, delimiter, and quote-all option
     SImplementation(std::shared_ptr<CDataSink> sink, char delimiter, bool quoteall)
         : Sink(sink), Delimiter(delimiter), QuoteAll(quoteall) {}
     
-    // writes a row of data to the sink, ensuring proper DSV formatting
+    // formats the whole row first and hands it to the sink in one write
     bool WriteRow(const std::vector<std::string>& row) {
-        // iterate through each cell in the row
-        for (size_t i = 0; i < row.size(); ++i) {
-            // to determine if the cell needs to be enclosed in quotes
-            // a cell needs quotes if: QuoteAll is true, the cell contains the delimiter, the cell contains quotes
-            bool quotes = QuoteAll || row[i].find(Delimiter) != std::string::npos || row[i].find('"') != std::string::npos;
-
-            // create an if statement here if a cell needs quotes
-            if (quotes) {
-                // start the quoted cell by writing an opening quote
-                Sink->Put('"');
-                // write each character of the cell with a for loop
-                for (char ch : row[i]) {
-                    // check if the character is a quote and escape it
-                    if (ch == '"') {
-                        Sink->Put('"'); // escape quotes by writing two quotes
-                    }
-                    Sink->Put(ch);
-                }
-                // close the quoted cell with a quote
-                Sink->Put('"');
-            } else {
-                // if the cell doesn't need quotes, write it directly
-                // use a for loop to iterate through the characters
-                for (const char& ch : row[i]) {
-                    Sink->Put(ch);
-                }
-            }
-
-            // if this is not the last cell, write the delimiter to separate the cells
-            if (i < row.size() - 1) {
-                Sink->Put(Delimiter);
-            }
-        }
-        // write a newline to indicate the end of the row
-        return Sink->Put('\n');
+        Buffer.clear();
+        FormatRow(row, Delimiter, QuoteAll, Buffer);
+        return Sink->Write(Buffer);
     }
 };
 
@@ -65,3 +37,53 @@ CDSVWriter::~CDSVWriter() = default;
 bool CDSVWriter::WriteRow(const std::vector<std::string>& row) { 
     return DImplementation->WriteRow(row);
 }
+
+// appends a row in DSV form, copying runs of the cells in bulk
+void CDSVWriter::FormatRow(const std::vector<std::string>& row, char delimiter, bool quoteall, std::vector<char>& buffer) {
+    DSV_METRIC_ONLY(size_t startSize = buffer.size());
+    DSV_METRIC_ONLY(size_t cellBytes = 0);
+    DSV_METRIC_ONLY(size_t quotedCells = 0);
+    // iterate through each cell in the row
+    for (size_t i = 0; i < row.size(); ++i) {
+        const std::string& cell = row[i];
+        // a cell needs quotes if: quoteall is true, the cell contains the delimiter, the cell contains quotes
+        const char* quote = static_cast<const char*>(std::memchr(cell.data(), '"', cell.size()));
+        bool quotes = quoteall || quote || cell.find(delimiter) != std::string::npos;
+        DSV_METRIC_ONLY(cellBytes += cell.size());
+        DSV_METRIC_ONLY(quotedCells += quotes);
+
+        if (quotes) {
+            // start the quoted cell by writing an opening quote
+            buffer.push_back('"');
+            // copy up to and including each quote, then escape it with a second one
+            const char* run = cell.data();
+            const char* stop = run + cell.size();
+            while (quote) {
+                buffer.insert(buffer.end(), run, quote + 1);
+                buffer.push_back('"');
+                run = quote + 1;
+                quote = static_cast<const char*>(std::memchr(run, '"', stop - run));
+            }
+            buffer.insert(buffer.end(), run, stop);
+            // close the quoted cell with a quote
+            buffer.push_back('"');
+        } else {
+            // if the cell doesn't need quotes, copy it directly
+            buffer.insert(buffer.end(), cell.begin(), cell.end());
+        }
+
+        // if this is not the last cell, write the delimiter to separate the cells
+        if (i < row.size() - 1) {
+            buffer.push_back(delimiter);
+        }
+    }
+    // write a newline to indicate the end of the row
+    buffer.push_back('\n');
+    // everything beyond the cell text and the separators is quoting
+    DSV_METRIC_ONLY(size_t separators = row.empty() ? 1 : row.size());
+    DSV_METRIC_ADD(RowsWritten, 1);
+    DSV_METRIC_ADD(CellsWritten, row.size());
+    DSV_METRIC_ADD(QuotedCellsWritten, quotedCells);
+    DSV_METRIC_ADD(BytesEscaped, buffer.size() - startSize - cellBytes - separators);
+    DSV_METRIC_ADD(BytesWritten, buffer.size() - startSize);
+}
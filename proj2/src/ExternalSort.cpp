@@ -0,0 +1,352 @@
+#include "ExternalSort.h"
+#include "Metrics.h"
+#include "SpillFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <thread>
+
+namespace{
+
+// runs are merged at most this many at a time to bound open files
+const std::size_t MaxFanIn = 128;
+
+double ParseNumeric(std::string_view text){
+    while(!text.empty() && (text.front() == ' ' || text.front() == '\t')){
+        text.remove_prefix(1);
+    }
+    if(!text.empty() && text.front() == '+'){
+        text.remove_prefix(1);
+    }
+    double Value;
+    auto Result = std::from_chars(text.data(), text.data() + text.size(), Value);
+    if(Result.ec != std::errc() || text.empty()){
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return Value;
+}
+
+// compares two rows on the keys; numeric values are parsed up front and
+// passed in alongside the cells. NaN (not a number) sorts last.
+template <typename TLeft, typename TRight>
+int CompareRows(const std::vector<SSortKey> &keys, const TLeft &left, const double *leftnumbers, const TRight &right, const double *rightnumbers){
+    std::size_t Numeric = 0;
+    for(auto &Key : keys){
+        int Result;
+        if(Key.DNumeric){
+            double Left = leftnumbers[Numeric], Right = rightnumbers[Numeric];
+            Numeric++;
+            bool LeftNaN = std::isnan(Left), RightNaN = std::isnan(Right);
+            if(LeftNaN || RightNaN){
+                Result = LeftNaN == RightNaN ? 0 : (LeftNaN ? 1 : -1);
+            }
+            else{
+                Result = Left < Right ? -1 : (Right < Left ? 1 : 0);
+            }
+        }
+        else{
+            Result = left(Key.DColumn).compare(right(Key.DColumn));
+        }
+        if(Result){
+            return Key.DDescending ? -Result : Result;
+        }
+    }
+    return 0;
+}
+
+}
+
+struct CExternalSort::SImplementation{
+    std::vector<SSortKey> DKeys;
+    std::size_t DNumericKeys;
+    std::size_t DMemoryBudget;
+    std::size_t DThreads;
+    std::string DTempDirectory;
+    std::vector< std::unique_ptr<CSpillFile> > DRuns;
+    std::size_t DRunCount;
+
+    // one run held in memory as flat arrays rather than strings per cell
+    struct SRunBuffer{
+        struct SCell{
+            std::size_t DOffset;
+            std::size_t DLength;
+        };
+        std::vector<char> DHeap;
+        std::vector<SCell> DCells;
+        // first cell of each row, plus one past the last row
+        std::vector<std::size_t> DRowStarts{0};
+        std::vector<double> DNumbers;
+        std::vector<std::size_t> DOrder;
+
+        std::size_t Rows() const{
+            return DRowStarts.size() - 1;
+        }
+
+        std::size_t Bytes() const{
+            return DHeap.size() + DCells.size() * sizeof(SCell) + DRowStarts.size() * (sizeof(std::size_t) * 2) + DNumbers.size() * sizeof(double);
+        }
+
+        std::string_view Cell(std::size_t row, std::size_t column) const{
+            std::size_t Index = DRowStarts[row] + column;
+            if(Index >= DRowStarts[row + 1]){
+                return std::string_view();
+            }
+            return std::string_view(DHeap.data() + DCells[Index].DOffset, DCells[Index].DLength);
+        }
+
+        void Clear(){
+            DHeap.clear();
+            DCells.clear();
+            DRowStarts.assign(1, 0);
+            DNumbers.clear();
+            DOrder.clear();
+        }
+    };
+
+    SImplementation(std::vector<SSortKey> keys, std::size_t memorybudget, std::size_t threads, const std::string &tempdirectory)
+        : DKeys(std::move(keys)), DNumericKeys(0), DMemoryBudget(memorybudget), DThreads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+          DTempDirectory(tempdirectory), DRunCount(0){
+        for(auto &Key : DKeys){
+            DNumericKeys += Key.DNumeric;
+        }
+    }
+
+    void Append(SRunBuffer &run, const std::vector<std::string> &row){
+        for(auto &Cell : row){
+            run.DCells.push_back({run.DHeap.size(), Cell.size()});
+            run.DHeap.insert(run.DHeap.end(), Cell.begin(), Cell.end());
+        }
+        run.DRowStarts.push_back(run.DCells.size());
+        for(auto &Key : DKeys){
+            if(Key.DNumeric){
+                run.DNumbers.push_back(ParseNumeric(Key.DColumn < row.size() ? std::string_view(row[Key.DColumn]) : std::string_view()));
+            }
+        }
+    }
+
+    bool RunLess(const SRunBuffer &run, std::size_t left, std::size_t right) const{
+        int Result = CompareRows(DKeys,
+            [&](std::size_t column){ return run.Cell(left, column); }, run.DNumbers.data() + left * DNumericKeys,
+            [&](std::size_t column){ return run.Cell(right, column); }, run.DNumbers.data() + right * DNumericKeys);
+        // equal keys keep input order
+        return Result ? Result < 0 : left < right;
+    }
+
+    // sorts slices of the row order on separate threads, then merges them
+    // pairwise, also in parallel
+    void SortRun(SRunBuffer &run){
+        DSV_TRACE_SPAN("ExternalSort::SortRun");
+        run.DOrder.resize(run.Rows());
+        for(std::size_t Index = 0; Index < run.DOrder.size(); Index++){
+            run.DOrder[Index] = Index;
+        }
+        auto Less = [&](std::size_t left, std::size_t right){ return RunLess(run, left, right); };
+        std::size_t Slices = std::min(DThreads, std::max<std::size_t>(1, run.Rows() / 4096));
+        std::vector<std::size_t> Bounds;
+        for(std::size_t Index = 0; Index <= Slices; Index++){
+            Bounds.push_back(run.Rows() * Index / Slices);
+        }
+        auto Begin = run.DOrder.begin();
+        std::vector<std::thread> Threads;
+        for(std::size_t Index = 0; Index + 1 < Bounds.size(); Index++){
+            Threads.emplace_back([&, Index]{ std::sort(Begin + Bounds[Index], Begin + Bounds[Index + 1], Less); });
+        }
+        for(auto &Thread : Threads){
+            Thread.join();
+        }
+        while(Bounds.size() > 2){
+            std::vector<std::size_t> Merged;
+            Threads.clear();
+            for(std::size_t Index = 0; Index + 2 < Bounds.size(); Index += 2){
+                Threads.emplace_back([&, Index]{ std::inplace_merge(Begin + Bounds[Index], Begin + Bounds[Index + 1], Begin + Bounds[Index + 2], Less); });
+            }
+            for(auto &Thread : Threads){
+                Thread.join();
+            }
+            for(std::size_t Index = 0; Index < Bounds.size(); Index += 2){
+                Merged.push_back(Bounds[Index]);
+            }
+            if(Merged.back() != Bounds.back()){
+                Merged.push_back(Bounds.back());
+            }
+            Bounds.swap(Merged);
+        }
+    }
+
+    bool Spill(SRunBuffer &run){
+        SortRun(run);
+        DSV_TRACE_SPAN("ExternalSort::Spill");
+        auto File = std::make_unique<CSpillFile>(DTempDirectory);
+        if(!File->Valid()){
+            return false;
+        }
+        std::vector<std::string_view> Cells;
+        for(std::size_t Row : run.DOrder){
+            Cells.resize(run.DRowStarts[Row + 1] - run.DRowStarts[Row]);
+            for(std::size_t Column = 0; Column < Cells.size(); Column++){
+                Cells[Column] = run.Cell(Row, Column);
+            }
+            if(!File->Write(Cells.data(), Cells.size())){
+                return false;
+            }
+        }
+        DRuns.push_back(std::move(File));
+        DRunCount++;
+        run.Clear();
+        return true;
+    }
+
+    // one input of the merge with its current row
+    struct SMergeInput{
+        CSpillFile *DFile;
+        std::vector<std::string> DRow;
+        std::vector<double> DNumbers;
+        bool DDone;
+    };
+
+    // false when the run could not be read; the end of the run only sets DDone
+    bool Advance(SMergeInput &input){
+        if(!input.DFile->Read(input.DRow)){
+            input.DDone = true;
+            return !input.DFile->Failed();
+        }
+        input.DNumbers.clear();
+        for(auto &Key : DKeys){
+            if(Key.DNumeric){
+                input.DNumbers.push_back(ParseNumeric(Key.DColumn < input.DRow.size() ? std::string_view(input.DRow[Key.DColumn]) : std::string_view()));
+            }
+        }
+        return true;
+    }
+
+    // merges runs with a loser tree: the internal nodes hold the loser of
+    // each match, so replacing the winner replays only one leaf-to-root path
+    template <typename TOutput>
+    bool Merge(std::vector<CSpillFile *> runs, TOutput &&output){
+        DSV_TRACE_SPAN("ExternalSort::Merge");
+        std::size_t Count = runs.size();
+        std::vector<SMergeInput> Inputs(Count);
+        for(std::size_t Index = 0; Index < Count; Index++){
+            Inputs[Index].DFile = runs[Index];
+            Inputs[Index].DDone = false;
+            // Rewind writes out the tail of the run, so a failure loses rows
+            if(!runs[Index]->Rewind() || !Advance(Inputs[Index])){
+                return false;
+            }
+        }
+        auto Less = [&](std::size_t left, std::size_t right){
+            if(Inputs[left].DDone || Inputs[right].DDone){
+                return !Inputs[left].DDone;
+            }
+            auto &Left = Inputs[left], &Right = Inputs[right];
+            int Result = CompareRows(DKeys,
+                [&](std::size_t column){ return column < Left.DRow.size() ? std::string_view(Left.DRow[column]) : std::string_view(); }, Left.DNumbers.data(),
+                [&](std::size_t column){ return column < Right.DRow.size() ? std::string_view(Right.DRow[column]) : std::string_view(); }, Right.DNumbers.data());
+            // earlier runs hold earlier input
+            return Result ? Result < 0 : left < right;
+        };
+        std::vector<std::size_t> Tree(Count);
+        std::vector<std::size_t> Winners(2 * Count);
+        for(std::size_t Index = 0; Index < Count; Index++){
+            Winners[Count + Index] = Index;
+        }
+        for(std::size_t Node = Count - 1; Node > 0; Node--){
+            std::size_t Left = Winners[2 * Node], Right = Winners[2 * Node + 1];
+            bool LeftWins = Less(Left, Right);
+            Winners[Node] = LeftWins ? Left : Right;
+            Tree[Node] = LeftWins ? Right : Left;
+        }
+        Tree[0] = Winners[1];
+        while(!Inputs[Tree[0]].DDone){
+            std::size_t Winner = Tree[0];
+            if(!output(Inputs[Winner].DRow)){
+                return false;
+            }
+            if(!Advance(Inputs[Winner])){
+                return false;
+            }
+            for(std::size_t Node = (Winner + Count) / 2; Node > 0; Node /= 2){
+                if(Less(Tree[Node], Winner)){
+                    std::swap(Tree[Node], Winner);
+                }
+            }
+            Tree[0] = Winner;
+        }
+        return true;
+    }
+
+    bool Sort(CDSVReader &reader, CDSVWriter &writer){
+        DRuns.clear();
+        DRunCount = 0;
+        SRunBuffer Run;
+        std::vector<std::string> Row;
+        while(reader.ReadRow(Row)){
+            Append(Run, Row);
+            if(Run.Bytes() >= DMemoryBudget && !Spill(Run)){
+                return false;
+            }
+        }
+        // everything fit, no files needed
+        if(DRuns.empty()){
+            SortRun(Run);
+            for(std::size_t Index : Run.DOrder){
+                Row.resize(Run.DRowStarts[Index + 1] - Run.DRowStarts[Index]);
+                for(std::size_t Column = 0; Column < Row.size(); Column++){
+                    std::string_view Value = Run.Cell(Index, Column);
+                    Row[Column].assign(Value.data(), Value.size());
+                }
+                if(!writer.WriteRow(Row)){
+                    return false;
+                }
+            }
+            return true;
+        }
+        if(Run.Rows() && !Spill(Run)){
+            return false;
+        }
+        // too many runs to open at once: merge the oldest ones into one run
+        // first, keeping the runs in input order
+        while(DRuns.size() > MaxFanIn){
+            auto Merged = std::make_unique<CSpillFile>(DTempDirectory);
+            if(!Merged->Valid()){
+                return false;
+            }
+            std::vector<CSpillFile *> Group;
+            for(std::size_t Index = 0; Index < MaxFanIn; Index++){
+                Group.push_back(DRuns[Index].get());
+            }
+            bool Success = Merge(Group, [&](const std::vector<std::string> &row){ return Merged->Write(row); });
+            if(!Success){
+                return false;
+            }
+            DRuns.erase(DRuns.begin(), DRuns.begin() + MaxFanIn);
+            DRuns.insert(DRuns.begin(), std::move(Merged));
+        }
+        std::vector<CSpillFile *> All;
+        for(auto &Run : DRuns){
+            All.push_back(Run.get());
+        }
+        bool Success = Merge(All, [&](const std::vector<std::string> &row){ return writer.WriteRow(row); });
+        DRuns.clear();
+        return Success;
+    }
+};
+
+CExternalSort::CExternalSort(std::vector<SSortKey> keys, std::size_t memorybudget, std::size_t threads, const std::string &tempdirectory)
+    : DImplementation(std::make_unique<SImplementation>(std::move(keys), memorybudget, threads, tempdirectory)){
+
+}
+
+CExternalSort::~CExternalSort() = default;
+
+bool CExternalSort::Sort(CDSVReader &reader, CDSVWriter &writer){
+    return DImplementation->Sort(reader, writer);
+}
+
+std::size_t CExternalSort::RunCount() const noexcept{
+    return DImplementation->DRunCount;
+}
@@ -0,0 +1,76 @@
+#include "FileDataSink.h"
+#include "Metrics.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+CFileDataSink::CFileDataSink(const std::string &filename, bool append, std::size_t buffersize)
+    : CFileDataSink(open(filename.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644), true, buffersize){
+
+}
+
+CFileDataSink::CFileDataSink(int fd, bool ownsfd, std::size_t buffersize)
+    : DFileDescriptor(fd), DOwnsDescriptor(ownsfd), DBuffer(buffersize ? buffersize : 1), DLength(0), DFailed(fd < 0){
+
+}
+
+CFileDataSink::~CFileDataSink(){
+    Flush();
+    if(DOwnsDescriptor && DFileDescriptor >= 0){
+        close(DFileDescriptor);
+    }
+}
+
+bool CFileDataSink::IsOpen() const noexcept{
+    return DFileDescriptor >= 0;
+}
+
+// writes everything, retrying short writes; a failure sticks to the sink
+bool CFileDataSink::WriteAll(const char *data, std::size_t length) noexcept{
+    while(!DFailed && length){
+        ssize_t Result;
+        {
+            DSV_METRIC_TIMER(SinkWaitNanoseconds);
+            Result = write(DFileDescriptor, data, length);
+        }
+        if(Result < 0){
+            if(errno != EINTR){
+                DFailed = true;
+            }
+            continue;
+        }
+        data += Result;
+        length -= Result;
+    }
+    return !DFailed;
+}
+
+bool CFileDataSink::Flush() noexcept{
+    bool Success = WriteAll(DBuffer.data(), DLength);
+    DLength = 0;
+    return Success;
+}
+
+bool CFileDataSink::Put(const char &ch) noexcept{
+    if(DLength == DBuffer.size() && !Flush()){
+        return false;
+    }
+    DBuffer[DLength++] = ch;
+    return !DFailed;
+}
+
+bool CFileDataSink::Write(const std::vector<char> &buf) noexcept{
+    // large writes skip the buffer once it has been drained
+    if(DLength + buf.size() > DBuffer.size()){
+        if(!Flush()){
+            return false;
+        }
+        if(buf.size() >= DBuffer.size()){
+            return WriteAll(buf.data(), buf.size());
+        }
+    }
+    std::memcpy(DBuffer.data() + DLength, buf.data(), buf.size());
+    DLength += buf.size();
+    return !DFailed;
+}
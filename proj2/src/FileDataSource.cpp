@@ -0,0 +1,80 @@
+#include "FileDataSource.h"
+#include "Metrics.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CFileDataSource::CFileDataSource(const std::string &filename, std::size_t buffersize)
+    : CFileDataSource(open(filename.c_str(), O_RDONLY | O_CLOEXEC), true, buffersize){
+
+}
+
+CFileDataSource::CFileDataSource(int fd, bool ownsfd, std::size_t buffersize)
+    : DFileDescriptor(fd), DOwnsDescriptor(ownsfd), DBuffer(buffersize ? buffersize : 1), DPosition(0), DLength(0), DEndOfFile(fd < 0){
+
+}
+
+CFileDataSource::~CFileDataSource(){
+    if(DOwnsDescriptor && DFileDescriptor >= 0){
+        close(DFileDescriptor);
+    }
+}
+
+bool CFileDataSource::IsOpen() const noexcept{
+    return DFileDescriptor >= 0;
+}
+
+bool CFileDataSource::Seek(std::uint64_t offset) noexcept{
+    if(DFileDescriptor < 0 || lseek(DFileDescriptor, static_cast<off_t>(offset), SEEK_SET) < 0){
+        return false;
+    }
+    DPosition = DLength = 0;
+    DEndOfFile = false;
+    return true;
+}
+
+bool CFileDataSource::Size(std::uint64_t &size) const noexcept{
+    struct stat Status;
+    if(DFileDescriptor < 0 || fstat(DFileDescriptor, &Status) < 0 || !S_ISREG(Status.st_mode)){
+        return false;
+    }
+    size = Status.st_size;
+    return true;
+}
+
+// refills the buffer once it has been consumed, false at end of file or error
+bool CFileDataSource::Fill() noexcept{
+    if(DPosition < DLength){
+        return true;
+    }
+    while(!DEndOfFile){
+        ssize_t Result;
+        {
+            DSV_METRIC_TIMER(SourceWaitNanoseconds);
+            Result = read(DFileDescriptor, DBuffer.data(), DBuffer.size());
+        }
+        if(Result > 0){
+            DPosition = 0;
+            DLength = Result;
+            return true;
+        }
+        if(Result < 0 && errno == EINTR){
+            continue;
+        }
+        DEndOfFile = true;
+    }
+    return false;
+}
+
+// grows buf only by what arrives, so a huge count costs nothing up front
+bool CFileDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while(buf.size() < count && Fill()){
+        std::size_t Chunk = std::min(count - buf.size(), DLength - DPosition);
+        buf.insert(buf.end(), DBuffer.data() + DPosition, DBuffer.data() + DPosition + Chunk);
+        DPosition += Chunk;
+    }
+    return !buf.empty();
+}
@@ -0,0 +1,71 @@
+#include "FollowingDSVReader.h"
+#include "FollowingFileDataSource.h"
+#include <chrono>
+#include <deque>
+
+struct CFollowingDSVReader::SImplementation{
+    // a completed row and the checkpoint just past it
+    struct SReadyRow{
+        std::vector<std::string> DRow;
+        SDSVCheckpoint DCheckpoint;
+    };
+
+    CFollowingFileDataSource DSource;
+    CDSVPushParser DParser;
+    std::deque<SReadyRow> DReady;
+    SDSVCheckpoint DCheckpoint;
+
+    SImplementation(const std::string &filename, char delimiter, const SDSVCheckpoint &checkpoint, std::size_t buffersize)
+        : DSource(filename, checkpoint.DOffset, buffersize), DParser(delimiter, [this](std::span<const std::string> row){
+            DReady.push_back({std::vector<std::string>(row.begin(), row.end()), DParser.Checkpoint()});
+        }), DCheckpoint(checkpoint){
+        DParser.Reset(checkpoint);
+    }
+
+    bool ReadRow(std::vector<std::string> &row, int timeoutms){
+        auto Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutms);
+        while(DReady.empty()){
+            // parse everything written so far, then sleep until the next append
+            std::string_view Window = DSource.Buffered();
+            if(!Window.empty()){
+                DParser.Feed(Window.data(), Window.size());
+                DSource.Consume(Window.size());
+                continue;
+            }
+            int Remaining = -1;
+            if(timeoutms >= 0){
+                Remaining = static_cast<int>(std::max<long long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(Deadline - std::chrono::steady_clock::now()).count()));
+            }
+            if(!DSource.Wait(Remaining)){
+                return false;
+            }
+        }
+        row.swap(DReady.front().DRow);
+        DCheckpoint = DReady.front().DCheckpoint;
+        DReady.pop_front();
+        return true;
+    }
+};
+
+CFollowingDSVReader::CFollowingDSVReader(const std::string &filename, char delimiter, const SDSVCheckpoint &checkpoint, std::size_t buffersize)
+    : DImplementation(std::make_unique<SImplementation>(filename, delimiter, checkpoint, buffersize)){
+
+}
+
+CFollowingDSVReader::~CFollowingDSVReader() = default;
+
+bool CFollowingDSVReader::IsOpen() const noexcept{
+    return DImplementation->DSource.IsOpen();
+}
+
+bool CFollowingDSVReader::ReadRow(std::vector<std::string> &row, int timeoutms){
+    return DImplementation->ReadRow(row, timeoutms);
+}
+
+SDSVCheckpoint CFollowingDSVReader::Checkpoint() const noexcept{
+    return DImplementation->DCheckpoint;
+}
+
+void CFollowingDSVReader::Stop() noexcept{
+    DImplementation->DSource.Stop();
+}
@@ -0,0 +1,164 @@
+#include "FollowingFileDataSource.h"
+#include "Metrics.h"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+CFollowingFileDataSource::CFollowingFileDataSource(const std::string &filename, std::uint64_t offset, std::size_t buffersize)
+    : DFileDescriptor(open(filename.c_str(), O_RDONLY | O_CLOEXEC)), DNotifyDescriptor(-1), DStopDescriptor(-1), DBuffer(buffersize ? buffersize : 1), DPosition(0), DLength(0), DFileOffset(offset), DTimeout(-1), DStopped(false){
+    if(DFileDescriptor < 0){
+        return;
+    }
+    // the watch exists before the first read, so no append can slip in
+    // between finding the end of the file and going to sleep
+    DNotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    DStopDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(DNotifyDescriptor < 0 || DStopDescriptor < 0 || inotify_add_watch(DNotifyDescriptor, filename.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0){
+        close(DFileDescriptor);
+        DFileDescriptor = -1;
+    }
+}
+
+CFollowingFileDataSource::~CFollowingFileDataSource(){
+    for(int Descriptor : {DFileDescriptor, DNotifyDescriptor, DStopDescriptor}){
+        if(Descriptor >= 0){
+            close(Descriptor);
+        }
+    }
+}
+
+bool CFollowingFileDataSource::IsOpen() const noexcept{
+    return DFileDescriptor >= 0;
+}
+
+void CFollowingFileDataSource::SetTimeout(int milliseconds) noexcept{
+    DTimeout = milliseconds;
+}
+
+void CFollowingFileDataSource::Stop() noexcept{
+    DStopped.store(true);
+    if(DStopDescriptor >= 0){
+        std::uint64_t One = 1;
+        [[maybe_unused]] ssize_t Result = write(DStopDescriptor, &One, sizeof(One));
+    }
+}
+
+bool CFollowingFileDataSource::Stopped() const noexcept{
+    return DStopped.load();
+}
+
+std::uint64_t CFollowingFileDataSource::Offset() const noexcept{
+    return DFileOffset - (DLength - DPosition);
+}
+
+// refills the buffer with whatever has been appended, never waiting
+bool CFollowingFileDataSource::Fill() noexcept{
+    if(DPosition < DLength){
+        return true;
+    }
+    if(DFileDescriptor < 0){
+        return false;
+    }
+    while(true){
+        ssize_t Result = pread(DFileDescriptor, DBuffer.data(), DBuffer.size(), DFileOffset);
+        if(Result > 0){
+            DPosition = 0;
+            DLength = Result;
+            DFileOffset += Result;
+            return true;
+        }
+        if(Result < 0 && errno == EINTR){
+            continue;
+        }
+        return false;
+    }
+}
+
+bool CFollowingFileDataSource::Wait(int milliseconds) noexcept{
+    auto Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+    while(!Fill()){
+        if(DFileDescriptor < 0 || DStopped.load()){
+            return false;
+        }
+        int Remaining = -1;
+        if(milliseconds >= 0){
+            auto Left = std::chrono::duration_cast<std::chrono::milliseconds>(Deadline - std::chrono::steady_clock::now()).count();
+            if(Left < 0){
+                return false;
+            }
+            Remaining = static_cast<int>(Left);
+        }
+        pollfd Descriptors[2] = {{DNotifyDescriptor, POLLIN, 0}, {DStopDescriptor, POLLIN, 0}};
+        int Ready;
+        {
+            DSV_METRIC_TIMER(SourceWaitNanoseconds);
+            Ready = poll(Descriptors, 2, Remaining);
+        }
+        if(Ready < 0 && errno != EINTR){
+            return false;
+        }
+        if(Ready == 0 && Remaining >= 0){
+            // one last look, an append may have landed right at the deadline
+            return Fill();
+        }
+        if(Descriptors[0].revents & POLLIN){
+            // the events only say something changed, the next pread finds out what
+            char Events[4096];
+            while(read(DNotifyDescriptor, Events, sizeof(Events)) > 0){
+
+            }
+        }
+    }
+    return true;
+}
+
+std::string_view CFollowingFileDataSource::Buffered() noexcept{
+    if(!Fill()){
+        return std::string_view();
+    }
+    return std::string_view(DBuffer.data() + DPosition, DLength - DPosition);
+}
+
+void CFollowingFileDataSource::Consume(std::size_t count) noexcept{
+    DPosition += count;
+}
+
+bool CFollowingFileDataSource::End() const noexcept{
+    // End is const but has to wait for an append to know whether input is done
+    return DPosition >= DLength && !const_cast<CFollowingFileDataSource *>(this)->Wait(DTimeout);
+}
+
+bool CFollowingFileDataSource::Get(char &ch) noexcept{
+    if(DPosition >= DLength && !Wait(DTimeout)){
+        return false;
+    }
+    ch = DBuffer[DPosition++];
+    return true;
+}
+
+bool CFollowingFileDataSource::Peek(char &ch) noexcept{
+    if(DPosition >= DLength && !Wait(DTimeout)){
+        return false;
+    }
+    ch = DBuffer[DPosition];
+    return true;
+}
+
+bool CFollowingFileDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.resize(count);
+    std::size_t Copied = 0;
+    // wait only for the first byte, then take what is there
+    while(Copied < count && (Copied ? Fill() : Wait(DTimeout))){
+        std::size_t Chunk = std::min(count - Copied, DLength - DPosition);
+        std::memcpy(buf.data() + Copied, DBuffer.data() + DPosition, Chunk);
+        DPosition += Chunk;
+        Copied += Chunk;
+    }
+    buf.resize(Copied);
+    return Copied > 0;
+}
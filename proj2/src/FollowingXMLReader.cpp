@@ -0,0 +1,101 @@
+#include "FollowingXMLReader.h"
+#include "FollowingFileDataSource.h"
+#include <chrono>
+#include <deque>
+
+struct CFollowingXMLReader::SImplementation{
+    // a delivered entity and where it ends in the file
+    struct SReadyEntity{
+        SXMLEntity DEntity;
+        std::uint64_t DOffset;
+        bool DEmptyElement;
+    };
+
+    CFollowingFileDataSource DSource;
+    CXMLPushParser DParser;
+    std::deque<SReadyEntity> DReady;
+    // kept in step with the entities handed out, not the ones parsed
+    SXMLCheckpoint DCheckpoint;
+
+    SImplementation(const std::string &filename, const SXMLCheckpoint &checkpoint, std::size_t buffersize)
+        : DSource(filename, checkpoint.DOffset, buffersize), DParser([this](const SXMLEntity &entity){
+            DReady.push_back({entity, DParser.Offset(), DParser.EmptyElement()});
+        }), DCheckpoint(checkpoint){
+        DParser.Reset(checkpoint);
+    }
+
+    // moves the checkpoint past entity
+    void Advance(const SReadyEntity &ready){
+        DCheckpoint.DOffset = ready.DOffset;
+        DCheckpoint.DCloseInnermost = false;
+        if(ready.DEntity.DType == SXMLEntity::EType::StartElement){
+            DCheckpoint.DOpenElements.push_back(ready.DEntity.DNameData);
+            DCheckpoint.DCloseInnermost = ready.DEmptyElement;
+        }
+        else if(ready.DEntity.DType == SXMLEntity::EType::EndElement && !DCheckpoint.DOpenElements.empty()){
+            DCheckpoint.DOpenElements.pop_back();
+        }
+    }
+
+    bool ReadEntity(SXMLEntity &entity, bool skipcdata, int timeoutms){
+        auto Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutms);
+        while(true){
+            while(!DReady.empty()){
+                SReadyEntity &Ready = DReady.front();
+                Advance(Ready);
+                bool Skip = skipcdata && Ready.DEntity.DType == SXMLEntity::EType::CharData;
+                if(!Skip){
+                    std::swap(entity, Ready.DEntity);
+                }
+                DReady.pop_front();
+                if(!Skip){
+                    return true;
+                }
+            }
+            if(DParser.Failed()){
+                return false;
+            }
+            // parse everything written so far, then sleep until the next append
+            std::string_view Window = DSource.Buffered();
+            if(!Window.empty()){
+                DParser.Feed(Window.data(), Window.size());
+                DSource.Consume(Window.size());
+                continue;
+            }
+            int Remaining = -1;
+            if(timeoutms >= 0){
+                Remaining = static_cast<int>(std::max<long long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(Deadline - std::chrono::steady_clock::now()).count()));
+            }
+            if(!DSource.Wait(Remaining)){
+                return false;
+            }
+        }
+    }
+};
+
+CFollowingXMLReader::CFollowingXMLReader(const std::string &filename, const SXMLCheckpoint &checkpoint, std::size_t buffersize)
+    : DImplementation(std::make_unique<SImplementation>(filename, checkpoint, buffersize)){
+
+}
+
+CFollowingXMLReader::~CFollowingXMLReader() = default;
+
+bool CFollowingXMLReader::IsOpen() const noexcept{
+    return DImplementation->DSource.IsOpen();
+}
+
+bool CFollowingXMLReader::Failed() const noexcept{
+    return DImplementation->DParser.Failed();
+}
+
+bool CFollowingXMLReader::ReadEntity(SXMLEntity &entity, bool skipcdata, int timeoutms){
+    return DImplementation->ReadEntity(entity, skipcdata, timeoutms);
+}
+
+SXMLCheckpoint CFollowingXMLReader::Checkpoint() const{
+    return DImplementation->DCheckpoint;
+}
+
+void CFollowingXMLReader::Stop() noexcept{
+    DImplementation->DSource.Stop();
+}
@@ -0,0 +1,464 @@
+#include "GroupByAggregator.h"
+#include "MemoryArena.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace{
+
+const std::uint32_t NoGroup = UINT32_MAX;
+
+std::uint64_t Mix(std::uint64_t hash){
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+std::uint64_t HashCell(std::string_view cell){
+    return Mix(std::hash<std::string_view>()(cell));
+}
+
+bool ParseNumber(std::string_view text, double &value){
+    if(!text.empty() && text.front() == '+'){
+        text.remove_prefix(1);
+    }
+    auto Result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return Result.ec == std::errc() && Result.ptr == text.data() + text.size() && !text.empty();
+}
+
+std::string FormatNumber(double value){
+    char Buffer[64];
+    auto Result = std::to_chars(Buffer, Buffer + sizeof(Buffer), value);
+    return std::string(Buffer, Result.ptr);
+}
+
+// rows read by the producer: the text of the cells the aggregation uses,
+// back to back, in the order of the aggregator's used columns
+struct SBatch{
+    std::vector<char> DText;
+    // end offset of each cell in DText
+    std::vector<std::uint32_t> DCellEnds;
+    // end index of each row in DCellEnds
+    std::vector<std::uint32_t> DRowEnds;
+
+    void Clear(){
+        DText.clear();
+        DCellEnds.clear();
+        DRowEnds.clear();
+    }
+
+    std::size_t Rows() const{
+        return DRowEnds.size();
+    }
+};
+
+}
+
+struct CGroupByAggregator::SImplementation{
+    // running state of one aggregate of one group; DistinctCount keeps the
+    // offset of its registers in DCount
+    struct SAccumulator{
+        std::uint64_t DCount;
+        double DValue;
+    };
+
+    // one thread's groups. Key cells live in the arena, accumulators and
+    // HyperLogLog registers in flat arrays indexed by group
+    struct STable{
+        struct SSlot{
+            std::uint64_t DHash;
+            std::uint32_t DGroup;
+        };
+        CMemoryArena DArena{1 << 20};
+        std::vector<SSlot> DSlots;
+        std::vector<const std::string_view *> DKeys;
+        std::vector<std::uint64_t> DHashes;
+        std::vector<SAccumulator> DAccumulators;
+        std::vector<std::uint8_t> DRegisters;
+
+        STable() : DSlots(1024, SSlot{0, NoGroup}){
+
+        }
+    };
+
+    std::vector<std::size_t> DKeyColumns;
+    std::vector<SAggregateSpec> DAggregates;
+    // column each aggregate reads, in row numbering
+    std::vector<std::size_t> DAggregateColumns;
+    // the key columns and then the aggregated ones, each once: the only
+    // cells the producer copies into a batch
+    std::vector<std::size_t> DUsedColumns;
+    // the same columns numbered by their place in a batch row
+    std::vector<std::size_t> DBatchKeyColumns;
+    std::vector<std::size_t> DBatchAggregateColumns;
+    std::size_t DThreads;
+    unsigned DPrecision;
+    std::size_t DRegisterCount;
+    std::size_t DDistinctCount;
+    std::vector< std::unique_ptr<STable> > DTables;
+
+    SImplementation(std::vector<std::size_t> keycolumns, std::vector<SAggregateSpec> aggregates, std::size_t threads, unsigned hllprecision)
+        : DKeyColumns(std::move(keycolumns)), DAggregates(std::move(aggregates)), DThreads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+          DPrecision(std::min(16u, std::max(4u, hllprecision))), DRegisterCount(std::size_t(1) << DPrecision), DDistinctCount(0){
+        for(auto Column : DKeyColumns){
+            DBatchKeyColumns.push_back(UseColumn(Column));
+        }
+        for(auto &Aggregate : DAggregates){
+            DDistinctCount += Aggregate.DFunction == EAggregate::DistinctCount;
+            DAggregateColumns.push_back(Aggregate.DColumn);
+            // Count reads no cell
+            DBatchAggregateColumns.push_back(Aggregate.DFunction == EAggregate::Count ? 0 : UseColumn(Aggregate.DColumn));
+        }
+        DTables.push_back(std::make_unique<STable>());
+    }
+
+    // place of column in a batch row, adding it when new
+    std::size_t UseColumn(std::size_t column){
+        auto Found = std::find(DUsedColumns.begin(), DUsedColumns.end(), column);
+        if(Found != DUsedColumns.end()){
+            return Found - DUsedColumns.begin();
+        }
+        DUsedColumns.push_back(column);
+        return DUsedColumns.size() - 1;
+    }
+
+    template <typename TCells>
+    static std::string_view CellAt(const TCells &cells, std::size_t count, std::size_t column){
+        return column < count ? std::string_view(cells[column]) : std::string_view();
+    }
+
+    template <typename TCells>
+    std::uint64_t HashKey(const TCells &cells, std::size_t count, const std::vector<std::size_t> &columns) const{
+        std::uint64_t Hash = 0;
+        for(auto Column : columns){
+            Hash = Mix(Hash ^ HashCell(CellAt(cells, count, Column)));
+        }
+        return Hash;
+    }
+
+    template <typename TCells>
+    bool KeyEquals(const std::string_view *key, const TCells &cells, std::size_t count, const std::vector<std::size_t> &columns) const{
+        for(std::size_t Index = 0; Index < columns.size(); Index++){
+            if(key[Index] != CellAt(cells, count, columns[Index])){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Grow(STable &table) const{
+        std::vector<STable::SSlot> Old(table.DSlots.size() * 2, STable::SSlot{0, NoGroup});
+        Old.swap(table.DSlots);
+        std::size_t Mask = table.DSlots.size() - 1;
+        for(auto &Slot : Old){
+            if(Slot.DGroup != NoGroup){
+                std::size_t Index = Slot.DHash & Mask;
+                while(table.DSlots[Index].DGroup != NoGroup){
+                    Index = (Index + 1) & Mask;
+                }
+                table.DSlots[Index] = Slot;
+            }
+        }
+    }
+
+    // group for the key found at columns of cells, created empty if new
+    template <typename TCells>
+    std::uint32_t FindOrAdd(STable &table, std::uint64_t hash, const TCells &cells, std::size_t count, const std::vector<std::size_t> &columns) const{
+        std::size_t Mask = table.DSlots.size() - 1;
+        std::size_t Index = hash & Mask;
+        for(;; Index = (Index + 1) & Mask){
+            auto &Slot = table.DSlots[Index];
+            if(Slot.DGroup == NoGroup){
+                break;
+            }
+            if(Slot.DHash == hash && KeyEquals(table.DKeys[Slot.DGroup], cells, count, columns)){
+                return Slot.DGroup;
+            }
+        }
+        std::uint32_t Group = static_cast<std::uint32_t>(table.DKeys.size());
+        auto *Key = static_cast<std::string_view *>(table.DArena.allocate(DKeyColumns.size() * sizeof(std::string_view), alignof(std::string_view)));
+        for(std::size_t Column = 0; Column < DKeyColumns.size(); Column++){
+            std::string_view Cell = CellAt(cells, count, columns[Column]);
+            char *Text = static_cast<char *>(table.DArena.allocate(Cell.size() ? Cell.size() : 1, 1));
+            std::memcpy(Text, Cell.data(), Cell.size());
+            Key[Column] = std::string_view(Text, Cell.size());
+        }
+        table.DKeys.push_back(Key);
+        table.DHashes.push_back(hash);
+        table.DSlots[Index] = STable::SSlot{hash, Group};
+        for(auto &Aggregate : DAggregates){
+            if(Aggregate.DFunction == EAggregate::DistinctCount){
+                table.DAccumulators.push_back({table.DRegisters.size(), 0});
+                table.DRegisters.resize(table.DRegisters.size() + DRegisterCount);
+            }
+            else if(Aggregate.DFunction == EAggregate::Min){
+                table.DAccumulators.push_back({0, std::numeric_limits<double>::infinity()});
+            }
+            else if(Aggregate.DFunction == EAggregate::Max){
+                table.DAccumulators.push_back({0, -std::numeric_limits<double>::infinity()});
+            }
+            else{
+                table.DAccumulators.push_back({0, 0});
+            }
+        }
+        if(2 * table.DKeys.size() > table.DSlots.size()){
+            Grow(table);
+        }
+        return Group;
+    }
+
+    void AddToRegisters(std::uint8_t *registers, std::uint64_t hash) const{
+        std::size_t Index = hash >> (64 - DPrecision);
+        std::uint64_t Rest = (hash << DPrecision) | (std::uint64_t(1) << (DPrecision - 1));
+        std::uint8_t Rank = static_cast<std::uint8_t>(__builtin_clzll(Rest) + 1);
+        registers[Index] = std::max(registers[Index], Rank);
+    }
+
+    double Estimate(const std::uint8_t *registers) const{
+        double Sum = 0;
+        std::size_t Zeros = 0;
+        for(std::size_t Index = 0; Index < DRegisterCount; Index++){
+            Sum += std::ldexp(1.0, -registers[Index]);
+            Zeros += registers[Index] == 0;
+        }
+        double M = static_cast<double>(DRegisterCount);
+        double Alpha = 0.7213 / (1 + 1.079 / M);
+        double Raw = Alpha * M * M / Sum;
+        // small cardinalities are better served by linear counting
+        if(Raw <= 2.5 * M && Zeros){
+            return M * std::log(M / Zeros);
+        }
+        return Raw;
+    }
+
+    // keys and aggregatecolumns say where the cells are: the columns of a
+    // whole row, or the places in a batch row
+    template <typename TCells>
+    void AddRow(STable &table, const TCells &cells, std::size_t count, const std::vector<std::size_t> &keys, const std::vector<std::size_t> &aggregatecolumns) const{
+        std::uint32_t Group = FindOrAdd(table, HashKey(cells, count, keys), cells, count, keys);
+        SAccumulator *State = &table.DAccumulators[Group * DAggregates.size()];
+        for(std::size_t Index = 0; Index < DAggregates.size(); Index++){
+            const SAggregateSpec &Aggregate = DAggregates[Index];
+            if(Aggregate.DFunction == EAggregate::Count){
+                State[Index].DCount++;
+                continue;
+            }
+            std::string_view Cell = CellAt(cells, count, aggregatecolumns[Index]);
+            if(Aggregate.DFunction == EAggregate::DistinctCount){
+                AddToRegisters(&table.DRegisters[State[Index].DCount], HashCell(Cell));
+                continue;
+            }
+            double Value;
+            if(!ParseNumber(Cell, Value)){
+                continue;
+            }
+            State[Index].DCount++;
+            if(Aggregate.DFunction == EAggregate::Sum){
+                State[Index].DValue += Value;
+            }
+            else if(Aggregate.DFunction == EAggregate::Min){
+                State[Index].DValue = std::min(State[Index].DValue, Value);
+            }
+            else{
+                State[Index].DValue = std::max(State[Index].DValue, Value);
+            }
+        }
+    }
+
+    // folds another thread's table into this one
+    void Merge(STable &into, const STable &from) const{
+        DSV_TRACE_SPAN("GroupByAggregator::Merge");
+        std::vector<std::size_t> Identity(DKeyColumns.size());
+        for(std::size_t Index = 0; Index < Identity.size(); Index++){
+            Identity[Index] = Index;
+        }
+        for(std::size_t FromGroup = 0; FromGroup < from.DKeys.size(); FromGroup++){
+            // stored keys hold their cells at positions 0..n-1
+            std::uint32_t Group = FindOrAdd(into, from.DHashes[FromGroup], from.DKeys[FromGroup], DKeyColumns.size(), Identity);
+            SAccumulator *State = &into.DAccumulators[Group * DAggregates.size()];
+            const SAccumulator *Other = &from.DAccumulators[FromGroup * DAggregates.size()];
+            for(std::size_t Index = 0; Index < DAggregates.size(); Index++){
+                switch(DAggregates[Index].DFunction){
+                    case EAggregate::DistinctCount:
+                        for(std::size_t Register = 0; Register < DRegisterCount; Register++){
+                            std::uint8_t &Mine = into.DRegisters[State[Index].DCount + Register];
+                            Mine = std::max(Mine, from.DRegisters[Other[Index].DCount + Register]);
+                        }
+                        break;
+                    case EAggregate::Min:
+                        State[Index].DCount += Other[Index].DCount;
+                        State[Index].DValue = std::min(State[Index].DValue, Other[Index].DValue);
+                        break;
+                    case EAggregate::Max:
+                        State[Index].DCount += Other[Index].DCount;
+                        State[Index].DValue = std::max(State[Index].DValue, Other[Index].DValue);
+                        break;
+                    default:
+                        State[Index].DCount += Other[Index].DCount;
+                        State[Index].DValue += Other[Index].DValue;
+                        break;
+                }
+            }
+        }
+    }
+
+    bool Aggregate(CDSVReader &reader){
+        DSV_TRACE_SPAN("GroupByAggregator::Aggregate");
+        std::vector<std::string_view> Row;
+        STable &Main = *DTables.front();
+        if(DThreads == 1){
+            while(reader.ReadRow(Row)){
+                AddRow(Main, Row, Row.size(), DKeyColumns, DAggregateColumns);
+            }
+            return true;
+        }
+        // batches go round a small pool: the reader fills free ones, the
+        // workers aggregate full ones into their own tables
+        std::mutex Mutex;
+        std::condition_variable Changed;
+        std::deque< std::unique_ptr<SBatch> > Full, Free;
+        bool Done = false;
+        for(std::size_t Index = 0; Index < 2 * DThreads; Index++){
+            Free.push_back(std::make_unique<SBatch>());
+        }
+        std::vector< std::unique_ptr<STable> > Tables;
+        std::vector<std::thread> Workers;
+        for(std::size_t Index = 0; Index < DThreads; Index++){
+            Tables.push_back(std::make_unique<STable>());
+            STable *Table = Tables.back().get();
+            Workers.emplace_back([&, Table]{
+                std::vector<std::string_view> Cells;
+                std::unique_lock<std::mutex> Lock(Mutex);
+                while(true){
+                    Changed.wait(Lock, [&]{ return !Full.empty() || Done; });
+                    if(Full.empty()){
+                        return;
+                    }
+                    std::unique_ptr<SBatch> Batch = std::move(Full.front());
+                    Full.pop_front();
+                    Lock.unlock();
+                    std::uint32_t Cell = 0, Start = 0;
+                    for(std::uint32_t RowEnd : Batch->DRowEnds){
+                        Cells.clear();
+                        for(; Cell < RowEnd; Cell++){
+                            Cells.emplace_back(Batch->DText.data() + Start, Batch->DCellEnds[Cell] - Start);
+                            Start = Batch->DCellEnds[Cell];
+                        }
+                        AddRow(*Table, Cells, Cells.size(), DBatchKeyColumns, DBatchAggregateColumns);
+                    }
+                    Batch->Clear();
+                    Lock.lock();
+                    Free.push_back(std::move(Batch));
+                    Changed.notify_all();
+                }
+            });
+        }
+        std::unique_ptr<SBatch> Current;
+        auto Submit = [&]{
+            std::unique_lock<std::mutex> Lock(Mutex);
+            if(Current && Current->Rows()){
+                Full.push_back(std::move(Current));
+                Changed.notify_all();
+            }
+            Changed.wait(Lock, [&]{ return !Free.empty(); });
+            Current = std::move(Free.front());
+            Free.pop_front();
+        };
+        Submit();
+        while(reader.ReadRow(Row)){
+            // only the cells the aggregation reads; a missing one is empty,
+            // which CellAt treats the same as a short row
+            for(auto Column : DUsedColumns){
+                std::string_view Cell = Column < Row.size() ? Row[Column] : std::string_view();
+                Current->DText.insert(Current->DText.end(), Cell.begin(), Cell.end());
+                Current->DCellEnds.push_back(static_cast<std::uint32_t>(Current->DText.size()));
+            }
+            Current->DRowEnds.push_back(static_cast<std::uint32_t>(Current->DCellEnds.size()));
+            if(Current->Rows() >= 4096 || Current->DText.size() >= (1 << 20)){
+                Submit();
+            }
+        }
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            if(Current->Rows()){
+                Full.push_back(std::move(Current));
+            }
+            Done = true;
+            Changed.notify_all();
+        }
+        for(auto &Worker : Workers){
+            Worker.join();
+        }
+        for(auto &Table : Tables){
+            Merge(Main, *Table);
+        }
+        return true;
+    }
+
+    bool WriteResults(CDSVWriter &writer){
+        const STable &Main = *DTables.front();
+        std::vector<std::uint32_t> Order(Main.DKeys.size());
+        for(std::uint32_t Index = 0; Index < Order.size(); Index++){
+            Order[Index] = Index;
+        }
+        std::sort(Order.begin(), Order.end(), [&](std::uint32_t left, std::uint32_t right){
+            return std::lexicographical_compare(Main.DKeys[left], Main.DKeys[left] + DKeyColumns.size(), Main.DKeys[right], Main.DKeys[right] + DKeyColumns.size());
+        });
+        std::vector<std::string> Row;
+        for(std::uint32_t Group : Order){
+            Row.assign(Main.DKeys[Group], Main.DKeys[Group] + DKeyColumns.size());
+            const SAccumulator *State = &Main.DAccumulators[Group * DAggregates.size()];
+            for(std::size_t Index = 0; Index < DAggregates.size(); Index++){
+                switch(DAggregates[Index].DFunction){
+                    case EAggregate::Count:
+                        Row.push_back(std::to_string(State[Index].DCount));
+                        break;
+                    case EAggregate::DistinctCount:
+                        Row.push_back(std::to_string(std::llround(Estimate(&Main.DRegisters[State[Index].DCount]))));
+                        break;
+                    case EAggregate::Sum:
+                        Row.push_back(FormatNumber(State[Index].DValue));
+                        break;
+                    default:
+                        Row.push_back(State[Index].DCount ? FormatNumber(State[Index].DValue) : std::string());
+                        break;
+                }
+            }
+            if(!writer.WriteRow(Row)){
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+CGroupByAggregator::CGroupByAggregator(std::vector<std::size_t> keycolumns, std::vector<SAggregateSpec> aggregates, std::size_t threads, unsigned hllprecision)
+    : DImplementation(std::make_unique<SImplementation>(std::move(keycolumns), std::move(aggregates), threads, hllprecision)){
+
+}
+
+CGroupByAggregator::~CGroupByAggregator() = default;
+
+bool CGroupByAggregator::Aggregate(CDSVReader &reader){
+    return DImplementation->Aggregate(reader);
+}
+
+std::size_t CGroupByAggregator::GroupCount() const noexcept{
+    return DImplementation->DTables.front()->DKeys.size();
+}
+
+bool CGroupByAggregator::WriteResults(CDSVWriter &writer){
+    return DImplementation->WriteResults(writer);
+}
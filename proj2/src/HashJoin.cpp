@@ -0,0 +1,315 @@
+#include "HashJoin.h"
+#include "MemoryArena.h"
+#include "Metrics.h"
+#include "SpillFile.h"
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace{
+
+const std::uint32_t NoRow = UINT32_MAX;
+
+}
+
+struct CHashJoin::SImplementation{
+    // a build row; the cells and their text live in the arena. Rows with
+    // the same key are chained in build order
+    struct SStoredRow{
+        const std::string_view *DCells;
+        std::uint32_t DCount;
+        std::uint32_t DNext;
+    };
+
+    // one distinct key: its hash and the first and last row carrying it
+    struct SSlot{
+        std::uint64_t DHash;
+        std::uint32_t DHead;
+        std::uint32_t DTail;
+    };
+
+    std::vector<std::size_t> DBuildKeys;
+    std::vector<std::size_t> DProbeKeys;
+    EJoinType DType;
+    std::size_t DMemoryBudget;
+    std::size_t DPartitions;
+    std::string DTempDirectory;
+    CMemoryArena DArena;
+    std::vector<SStoredRow> DRows;
+    std::vector<SSlot> DSlots;
+    std::size_t DUsedSlots;
+    // widest build row seen, which fixes the shape of the output
+    std::size_t DBuildWidth;
+    bool DSpilled;
+    std::size_t DOutputRows;
+    std::vector<std::string> DOutput;
+
+    SImplementation(std::vector<std::size_t> buildkeys, std::vector<std::size_t> probekeys, EJoinType type, std::size_t memorybudget, std::size_t partitions, const std::string &tempdirectory)
+        : DBuildKeys(std::move(buildkeys)), DProbeKeys(std::move(probekeys)), DType(type), DMemoryBudget(memorybudget), DPartitions(partitions ? partitions : 1),
+          DTempDirectory(tempdirectory), DArena(1 << 20), DUsedSlots(0), DBuildWidth(0), DSpilled(false), DOutputRows(0){
+
+    }
+
+    void ClearTable(){
+        DRows.clear();
+        DSlots.assign(1024, SSlot{0, NoRow, NoRow});
+        DUsedSlots = 0;
+        DArena.Reset();
+    }
+
+    std::size_t MemoryUsed() const{
+        return DArena.BytesUsed() + DRows.capacity() * sizeof(SStoredRow) + DSlots.capacity() * sizeof(SSlot);
+    }
+
+    template <typename TRow>
+    static std::string_view KeyCell(const TRow &row, std::size_t count, std::size_t column){
+        return column < count ? std::string_view(row[column]) : std::string_view();
+    }
+
+    template <typename TRow>
+    std::uint64_t Hash(const TRow &row, std::size_t count, const std::vector<std::size_t> &keys) const{
+        std::uint64_t Hash = 0x9E3779B97F4A7C15ULL;
+        for(auto Column : keys){
+            Hash ^= std::hash<std::string_view>()(KeyCell(row, count, Column)) + 0x9E3779B97F4A7C15ULL + (Hash << 6) + (Hash >> 2);
+        }
+        // final mix so the low bits used for the slot index are well spread
+        Hash ^= Hash >> 33;
+        Hash *= 0xFF51AFD7ED558CCDULL;
+        Hash ^= Hash >> 33;
+        return Hash;
+    }
+
+    template <typename TRow>
+    bool KeysEqual(const SStoredRow &stored, const TRow &row, std::size_t count) const{
+        for(std::size_t Index = 0; Index < DBuildKeys.size(); Index++){
+            if(KeyCell(stored.DCells, stored.DCount, DBuildKeys[Index]) != KeyCell(row, count, DProbeKeys[Index])){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool BuildKeysEqual(const SStoredRow &left, const SStoredRow &right) const{
+        for(auto Column : DBuildKeys){
+            if(KeyCell(left.DCells, left.DCount, Column) != KeyCell(right.DCells, right.DCount, Column)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Grow(){
+        std::vector<SSlot> Old(DSlots.size() * 2, SSlot{0, NoRow, NoRow});
+        Old.swap(DSlots);
+        std::size_t Mask = DSlots.size() - 1;
+        for(auto &Slot : Old){
+            if(Slot.DHead != NoRow){
+                std::size_t Index = Slot.DHash & Mask;
+                while(DSlots[Index].DHead != NoRow){
+                    Index = (Index + 1) & Mask;
+                }
+                DSlots[Index] = Slot;
+            }
+        }
+    }
+
+    // copies a build row into the arena and links it under its key
+    void Insert(const std::vector<std::string> &row){
+        auto *Cells = static_cast<std::string_view *>(DArena.allocate(row.size() * sizeof(std::string_view), alignof(std::string_view)));
+        for(std::size_t Index = 0; Index < row.size(); Index++){
+            char *Text = static_cast<char *>(DArena.allocate(row[Index].size() ? row[Index].size() : 1, 1));
+            std::memcpy(Text, row[Index].data(), row[Index].size());
+            Cells[Index] = std::string_view(Text, row[Index].size());
+        }
+        std::uint32_t RowIndex = static_cast<std::uint32_t>(DRows.size());
+        DRows.push_back({Cells, static_cast<std::uint32_t>(row.size()), NoRow});
+        std::uint64_t Hash = this->Hash(Cells, row.size(), DBuildKeys);
+        std::size_t Mask = DSlots.size() - 1;
+        std::size_t Index = Hash & Mask;
+        for(; DSlots[Index].DHead != NoRow; Index = (Index + 1) & Mask){
+            SSlot &Slot = DSlots[Index];
+            if(Slot.DHash == Hash && BuildKeysEqual(DRows[Slot.DHead], DRows[RowIndex])){
+                DRows[Slot.DTail].DNext = RowIndex;
+                Slot.DTail = RowIndex;
+                return;
+            }
+        }
+        // only a new key claims a slot, so only it can make the table grow
+        if(2 * (DUsedSlots + 1) > DSlots.size()){
+            Grow();
+            Mask = DSlots.size() - 1;
+            for(Index = Hash & Mask; DSlots[Index].DHead != NoRow; Index = (Index + 1) & Mask){
+
+            }
+        }
+        DSlots[Index] = SSlot{Hash, RowIndex, RowIndex};
+        DUsedSlots++;
+    }
+
+    // first build row matching the probe row, or NoRow
+    std::uint32_t Find(const std::vector<std::string> &row) const{
+        std::uint64_t Hash = this->Hash(row, row.size(), DProbeKeys);
+        std::size_t Mask = DSlots.size() - 1;
+        for(std::size_t Index = Hash & Mask;; Index = (Index + 1) & Mask){
+            const SSlot &Slot = DSlots[Index];
+            if(Slot.DHead == NoRow){
+                return NoRow;
+            }
+            if(Slot.DHash == Hash && KeysEqual(DRows[Slot.DHead], row, row.size())){
+                return Slot.DHead;
+            }
+        }
+    }
+
+    bool IsBuildKey(std::size_t column) const{
+        for(auto Key : DBuildKeys){
+            if(Key == column){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // probe row followed by the build row's other columns (or blanks)
+    bool Emit(const std::vector<std::string> &probe, const SStoredRow *build, CDSVWriter &output){
+        DOutput.resize(probe.size());
+        std::copy(probe.begin(), probe.end(), DOutput.begin());
+        for(std::size_t Column = 0; Column < DBuildWidth; Column++){
+            if(!IsBuildKey(Column)){
+                std::string_view Value = build ? KeyCell(build->DCells, build->DCount, Column) : std::string_view();
+                DOutput.emplace_back(Value);
+            }
+        }
+        DOutputRows++;
+        return output.WriteRow(DOutput);
+    }
+
+    bool Probe(const std::vector<std::string> &row, CDSVWriter &output){
+        std::uint32_t Match = Find(row);
+        if(Match == NoRow){
+            return DType == EJoinType::Inner || Emit(row, nullptr, output);
+        }
+        for(; Match != NoRow; Match = DRows[Match].DNext){
+            if(!Emit(row, &DRows[Match], output)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::size_t Partition(std::uint64_t hash) const{
+        // the high half, since the table indexes with the low bits
+        return (hash >> 32) % DPartitions;
+    }
+
+    // moves the rows loaded so far into build partitions
+    bool StartSpilling(std::vector< std::unique_ptr<CSpillFile> > &partitions){
+        for(std::size_t Index = 0; Index < DPartitions; Index++){
+            partitions.push_back(std::make_unique<CSpillFile>(DTempDirectory));
+            if(!partitions.back()->Valid()){
+                return false;
+            }
+        }
+        for(auto &Row : DRows){
+            if(!partitions[Partition(Hash(Row.DCells, Row.DCount, DBuildKeys))]->Write(Row.DCells, Row.DCount)){
+                return false;
+            }
+        }
+        ClearTable();
+        DSpilled = true;
+        return true;
+    }
+
+    bool Join(CDSVReader &build, CDSVReader &probe, CDSVWriter &output){
+        DSV_TRACE_SPAN("HashJoin::Join");
+        // every build key is compared with the probe key at the same place
+        if(DBuildKeys.size() != DProbeKeys.size()){
+            return false;
+        }
+        ClearTable();
+        DBuildWidth = 0;
+        DSpilled = false;
+        DOutputRows = 0;
+        std::vector< std::unique_ptr<CSpillFile> > BuildPartitions;
+        std::vector<std::string> Row;
+        while(build.ReadRow(Row)){
+            DBuildWidth = std::max(DBuildWidth, Row.size());
+            if(DSpilled){
+                if(!BuildPartitions[Partition(Hash(Row, Row.size(), DBuildKeys))]->Write(Row)){
+                    return false;
+                }
+                continue;
+            }
+            Insert(Row);
+            if(MemoryUsed() > DMemoryBudget && !StartSpilling(BuildPartitions)){
+                return false;
+            }
+        }
+        if(!DSpilled){
+            while(probe.ReadRow(Row)){
+                if(!Probe(Row, output)){
+                    return false;
+                }
+            }
+            return true;
+        }
+        // grace join: partition the probe side the same way, then join
+        // partition pairs
+        std::vector< std::unique_ptr<CSpillFile> > ProbePartitions;
+        for(std::size_t Index = 0; Index < DPartitions; Index++){
+            ProbePartitions.push_back(std::make_unique<CSpillFile>(DTempDirectory));
+            if(!ProbePartitions.back()->Valid()){
+                return false;
+            }
+        }
+        while(probe.ReadRow(Row)){
+            if(!ProbePartitions[Partition(Hash(Row, Row.size(), DProbeKeys))]->Write(Row)){
+                return false;
+            }
+        }
+        for(std::size_t Index = 0; Index < DPartitions; Index++){
+            ClearTable();
+            if(!BuildPartitions[Index]->Rewind() || !ProbePartitions[Index]->Rewind()){
+                return false;
+            }
+            while(BuildPartitions[Index]->Read(Row)){
+                Insert(Row);
+            }
+            // a partition that stops short would drop its rows silently
+            if(BuildPartitions[Index]->Failed()){
+                return false;
+            }
+            BuildPartitions[Index].reset();
+            while(ProbePartitions[Index]->Read(Row)){
+                if(!Probe(Row, output)){
+                    return false;
+                }
+            }
+            if(ProbePartitions[Index]->Failed()){
+                return false;
+            }
+            ProbePartitions[Index].reset();
+        }
+        ClearTable();
+        return true;
+    }
+};
+
+CHashJoin::CHashJoin(std::vector<std::size_t> buildkeys, std::vector<std::size_t> probekeys, EJoinType type, std::size_t memorybudget, std::size_t partitions, const std::string &tempdirectory)
+    : DImplementation(std::make_unique<SImplementation>(std::move(buildkeys), std::move(probekeys), type, memorybudget, partitions, tempdirectory)){
+
+}
+
+CHashJoin::~CHashJoin() = default;
+
+bool CHashJoin::Join(CDSVReader &build, CDSVReader &probe, CDSVWriter &output){
+    return DImplementation->Join(build, probe, output);
+}
+
+bool CHashJoin::Spilled() const noexcept{
+    return DImplementation->DSpilled;
+}
+
+std::size_t CHashJoin::OutputRows() const noexcept{
+    return DImplementation->DOutputRows;
+}
@@ -0,0 +1,79 @@
+#include "MemoryArena.h"
+#include "Metrics.h"
+
+// start with no blocks, the first allocation fetches one
+CMemoryArena::CMemoryArena(std::size_t blocksize, std::pmr::memory_resource *upstream)
+    : DUpstream(upstream), DBlockSize(blocksize ? blocksize : 1), DCurrentBlock(0), DOffset(0), DBytesUsed(0), DUpstreamAllocations(0) {}
+
+CMemoryArena::~CMemoryArena() {
+    Release();
+}
+
+// checks whether bytes at the given alignment fit in the remaining space of a block
+bool CMemoryArena::Fits(std::size_t block, std::size_t bytes, std::size_t alignment) const noexcept {
+    std::size_t Offset = block == DCurrentBlock ? DOffset : 0;
+    std::size_t Address = reinterpret_cast<std::size_t>(DBlocks[block].DData) + Offset;
+    std::size_t Padding = (alignment - Address % alignment) % alignment;
+    return Offset + Padding + bytes <= DBlocks[block].DSize;
+}
+
+void *CMemoryArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    // move forward through the retained blocks until one has room
+    while (DCurrentBlock < DBlocks.size() && !Fits(DCurrentBlock, bytes, alignment)) {
+        DCurrentBlock++;
+        DOffset = 0;
+    }
+    // out of retained blocks, grow; oversized requests get a block of their own
+    if (DCurrentBlock == DBlocks.size()) {
+        std::size_t Size = bytes + alignment > DBlockSize ? bytes + alignment : DBlockSize;
+        char *Data = static_cast<char *>(DUpstream->allocate(Size, alignof(std::max_align_t)));
+        DBlocks.push_back({Data, Size});
+        DUpstreamAllocations++;
+        DSV_METRIC_ADD(Allocations, 1);
+        DOffset = 0;
+    }
+    SBlock &Block = DBlocks[DCurrentBlock];
+    std::size_t Address = reinterpret_cast<std::size_t>(Block.DData) + DOffset;
+    std::size_t Padding = (alignment - Address % alignment) % alignment;
+    void *Result = Block.DData + DOffset + Padding;
+    DOffset += Padding + bytes;
+    DBytesUsed += Padding + bytes;
+    return Result;
+}
+
+// individual frees are ignored, memory comes back on Reset/Release
+void CMemoryArena::do_deallocate(void *, std::size_t, std::size_t) {}
+
+bool CMemoryArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+void CMemoryArena::Reset() noexcept {
+    DCurrentBlock = 0;
+    DOffset = 0;
+    DBytesUsed = 0;
+}
+
+void CMemoryArena::Release() noexcept {
+    for (auto &Block : DBlocks) {
+        DUpstream->deallocate(Block.DData, Block.DSize, alignof(std::max_align_t));
+    }
+    DBlocks.clear();
+    Reset();
+}
+
+std::size_t CMemoryArena::BytesUsed() const noexcept {
+    return DBytesUsed;
+}
+
+std::size_t CMemoryArena::BytesReserved() const noexcept {
+    std::size_t Total = 0;
+    for (auto &Block : DBlocks) {
+        Total += Block.DSize;
+    }
+    return Total;
+}
+
+std::size_t CMemoryArena::UpstreamAllocations() const noexcept {
+    return DUpstreamAllocations;
+}
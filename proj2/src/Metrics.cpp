@@ -0,0 +1,246 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace Metrics{
+
+namespace{
+
+const char *CounterNames[] = {
+    "BytesRead", "BytesWritten", "RowsRead", "RowsWritten", "CellsRead", "CellsWritten",
+    "QuotedCellsRead", "QuotedCellsWritten", "EntitiesRead", "EntitiesWritten", "BytesEscaped",
+    "Allocations", "SourceWaitNanoseconds", "SinkWaitNanoseconds"
+};
+static_assert(sizeof(CounterNames) / sizeof(CounterNames[0]) == static_cast<std::size_t>(ECounter::Count), "a counter is missing its name");
+
+#ifdef DSV_ENABLE_METRICS
+
+const std::size_t CounterCount = static_cast<std::size_t>(ECounter::Count);
+
+struct SSpan{
+    const char *DName;
+    std::uint64_t DStart;
+    std::uint64_t DDuration;
+};
+
+struct SThreadState;
+
+// every thread's state plus the totals of threads that have exited
+struct SRegistry{
+    std::mutex DMutex;
+    std::vector<SThreadState *> DThreads;
+    std::array<std::uint64_t, CounterCount> DRetired{};
+    // totals at the last Reset, which Collect subtracts; the thread slots
+    // are never zeroed, since their owners update them without the lock
+    std::array<std::uint64_t, CounterCount> DBaseline{};
+    std::vector< std::pair<std::uint32_t, SSpan> > DRetiredSpans;
+    std::atomic<bool> DTracing{false};
+    std::uint32_t DNextThread = 1;
+};
+
+SRegistry &Registry(){
+    // never destroyed, so threads exiting during shutdown can still use it
+    static SRegistry *Instance = new SRegistry;
+    return *Instance;
+}
+
+struct SThreadState{
+    // written only by the owning thread, read by Collect
+    std::array<std::atomic<std::uint64_t>, CounterCount> DCounters{};
+    // the owner appends, the dumper reads; both under DSpanMutex, which is
+    // uncontended unless a dump is running
+    std::mutex DSpanMutex;
+    std::vector<SSpan> DSpans;
+    std::uint32_t DThreadId;
+
+    SThreadState(){
+        SRegistry &Registry = Metrics::Registry();
+        std::lock_guard<std::mutex> Lock(Registry.DMutex);
+        DThreadId = Registry.DNextThread++;
+        Registry.DThreads.push_back(this);
+    }
+
+    ~SThreadState(){
+        SRegistry &Registry = Metrics::Registry();
+        std::lock_guard<std::mutex> Lock(Registry.DMutex);
+        for(std::size_t Index = 0; Index < CounterCount; Index++){
+            Registry.DRetired[Index] += DCounters[Index].load(std::memory_order_relaxed);
+        }
+        for(auto &Span : DSpans){
+            Registry.DRetiredSpans.emplace_back(DThreadId, Span);
+        }
+        Registry.DThreads.erase(std::find(Registry.DThreads.begin(), Registry.DThreads.end(), this));
+    }
+};
+
+// retired plus live totals; the caller holds DMutex
+std::array<std::uint64_t, CounterCount> Totals(SRegistry &registry) noexcept{
+    std::array<std::uint64_t, CounterCount> Values = registry.DRetired;
+    for(auto *Thread : registry.DThreads){
+        for(std::size_t Index = 0; Index < CounterCount; Index++){
+            Values[Index] += Thread->DCounters[Index].load(std::memory_order_relaxed);
+        }
+    }
+    return Values;
+}
+
+SThreadState &ThreadState(){
+    thread_local SThreadState State;
+    return State;
+}
+
+void AppendSpan(std::string &json, bool &first, std::uint32_t thread, const SSpan &span){
+    char Buffer[128];
+    std::snprintf(Buffer, sizeof(Buffer), "%s{\"name\":\"", first ? "" : ",\n");
+    json += Buffer;
+    // span names are literals from this library, but keep the JSON valid
+    for(const char *Char = span.DName; *Char; Char++){
+        if(*Char == '"' || *Char == '\\'){
+            json += '\\';
+        }
+        json += *Char;
+    }
+    std::snprintf(Buffer, sizeof(Buffer), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", thread, span.DStart / 1000.0, span.DDuration / 1000.0);
+    json += Buffer;
+    first = false;
+}
+
+#endif
+
+}
+
+const char *CounterName(ECounter counter) noexcept{
+    std::size_t Index = static_cast<std::size_t>(counter);
+    return Index < static_cast<std::size_t>(ECounter::Count) ? CounterNames[Index] : "";
+}
+
+std::uint64_t Now() noexcept{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string Report(){
+    SSnapshot Snapshot = Collect();
+    std::string Text;
+    for(std::size_t Index = 0; Index < static_cast<std::size_t>(ECounter::Count); Index++){
+        Text += std::string(CounterNames[Index]) + " " + std::to_string(Snapshot.DValues[Index]) + "\n";
+    }
+    return Text;
+}
+
+#ifdef DSV_ENABLE_METRICS
+
+void Add(ECounter counter, std::uint64_t value) noexcept{
+    auto &Slot = ThreadState().DCounters[static_cast<std::size_t>(counter)];
+    Slot.store(Slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+SSnapshot Collect() noexcept{
+    SRegistry &Registry = Metrics::Registry();
+    std::lock_guard<std::mutex> Lock(Registry.DMutex);
+    SSnapshot Snapshot;
+    Snapshot.DValues = Totals(Registry);
+    for(std::size_t Index = 0; Index < CounterCount; Index++){
+        Snapshot.DValues[Index] -= Registry.DBaseline[Index];
+    }
+    return Snapshot;
+}
+
+void Reset() noexcept{
+    SRegistry &Registry = Metrics::Registry();
+    std::lock_guard<std::mutex> Lock(Registry.DMutex);
+    Registry.DBaseline = Totals(Registry);
+}
+
+void StartTracing() noexcept{
+    Registry().DTracing.store(true, std::memory_order_relaxed);
+}
+
+void StopTracing() noexcept{
+    Registry().DTracing.store(false, std::memory_order_relaxed);
+}
+
+std::string ChromeTraceJSON(){
+    SRegistry &Registry = Metrics::Registry();
+    std::lock_guard<std::mutex> Lock(Registry.DMutex);
+    std::string Json = "{\"traceEvents\":[\n";
+    bool First = true;
+    for(auto &Retired : Registry.DRetiredSpans){
+        AppendSpan(Json, First, Retired.first, Retired.second);
+    }
+    for(auto *Thread : Registry.DThreads){
+        std::lock_guard<std::mutex> SpanLock(Thread->DSpanMutex);
+        for(auto &Span : Thread->DSpans){
+            AppendSpan(Json, First, Thread->DThreadId, Span);
+        }
+    }
+    Json += "\n],\"displayTimeUnit\":\"ns\"}\n";
+    return Json;
+}
+
+void ClearTrace() noexcept{
+    SRegistry &Registry = Metrics::Registry();
+    std::lock_guard<std::mutex> Lock(Registry.DMutex);
+    Registry.DRetiredSpans.clear();
+    for(auto *Thread : Registry.DThreads){
+        std::lock_guard<std::mutex> SpanLock(Thread->DSpanMutex);
+        Thread->DSpans.clear();
+    }
+}
+
+CTraceSpan::CTraceSpan(const char *name) noexcept : DName(name), DStart(Registry().DTracing.load(std::memory_order_relaxed) ? Now() : 0){
+
+}
+
+CTraceSpan::~CTraceSpan(){
+    if(DStart){
+        SThreadState &State = ThreadState();
+        std::lock_guard<std::mutex> Lock(State.DSpanMutex);
+        State.DSpans.push_back({DName, DStart, Now() - DStart});
+    }
+}
+
+#else
+
+void Add(ECounter, std::uint64_t) noexcept{
+
+}
+
+SSnapshot Collect() noexcept{
+    return SSnapshot();
+}
+
+void Reset() noexcept{
+
+}
+
+void StartTracing() noexcept{
+
+}
+
+void StopTracing() noexcept{
+
+}
+
+std::string ChromeTraceJSON(){
+    return "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void ClearTrace() noexcept{
+
+}
+
+CTraceSpan::CTraceSpan(const char *name) noexcept : DName(name), DStart(0){
+
+}
+
+CTraceSpan::~CTraceSpan(){
+
+}
+
+#endif
+
+}
@@ -0,0 +1,136 @@
+#include "ParallelDSVWriter.h"
+#include "DSVWriter.h"
+#include "Metrics.h"
+#include "OrderedJobQueue.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+struct CParallelDSVWriter::SImplementation{
+    // one batch of rows and, once a worker is done with it, its formatted text
+    struct SJob{
+        std::vector< std::vector<std::string> > DRows;
+        std::vector<char> DOutput;
+    };
+
+    std::shared_ptr<CDataSink> DSink;
+    char DDelimiter;
+    bool DQuoteAll;
+    std::size_t DBatchRows;
+    TOrderedJobQueue<SJob> DQueue;
+    // guards the batch WriteRow is filling and DClosed against other
+    // producers; the queue has its own lock
+    std::mutex DMutex;
+    std::unique_ptr<SJob> DCurrent;
+    bool DClosed;
+
+    SImplementation(std::shared_ptr<CDataSink> sink, char delimiter, bool quoteall, std::size_t threads, bool ordered, std::size_t batchrows)
+        : DSink(std::move(sink)), DDelimiter(delimiter), DQuoteAll(quoteall), DBatchRows(batchrows ? batchrows : 1),
+          DQueue(Threads(threads), 2 * Threads(threads), ordered,
+                 [this](SJob &job, std::size_t){
+                     DSV_TRACE_SPAN("ParallelDSVWriter::Format");
+                     job.DOutput.clear();
+                     for(auto &Row : job.DRows){
+                         CDSVWriter::FormatRow(Row, DDelimiter, DQuoteAll, job.DOutput);
+                     }
+                     return true;
+                 },
+                 [this](SJob &job){
+                     job.DRows.clear();
+                     return DSink->Write(job.DOutput);
+                 }),
+          DCurrent(std::make_unique<SJob>()), DClosed(false){
+
+    }
+
+    ~SImplementation(){
+        Close();
+    }
+
+    // threads of 0 uses one per hardware thread
+    static std::size_t Threads(std::size_t threads){
+        return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    bool WriteRow(const std::vector<std::string> &row){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        if(DClosed || DQueue.Failed()){
+            return false;
+        }
+        DCurrent->DRows.push_back(row);
+        if(DCurrent->DRows.size() >= DBatchRows){
+            std::unique_ptr<SJob> Full = std::move(DCurrent);
+            DCurrent = DQueue.Acquire();
+            return DQueue.Submit(std::move(Full));
+        }
+        return true;
+    }
+
+    bool WriteRows(std::vector< std::vector<std::string> > rows){
+        // held while submitting so Close cannot stop the queue in between
+        std::unique_lock<std::mutex> Lock(DMutex);
+        if(DClosed || DQueue.Failed()){
+            return false;
+        }
+        if(rows.empty()){
+            return true;
+        }
+        std::unique_ptr<SJob> Job = DQueue.Acquire();
+        Job->DRows = std::move(rows);
+        return DQueue.Submit(std::move(Job));
+    }
+
+    // submits the partial batch and waits until everything reached the sink
+    bool DrainAll(){
+        if(!DCurrent->DRows.empty()){
+            std::unique_ptr<SJob> Partial = std::move(DCurrent);
+            DCurrent = DQueue.Acquire();
+            DQueue.Submit(std::move(Partial));
+        }
+        return DQueue.Drain();
+    }
+
+    bool Flush(){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        if(DClosed){
+            return !DQueue.Failed();
+        }
+        return DrainAll() && DSink->Flush();
+    }
+
+    bool Close(){
+        {
+            std::unique_lock<std::mutex> Lock(DMutex);
+            if(DClosed){
+                return !DQueue.Failed();
+            }
+            DrainAll();
+            DClosed = true;
+        }
+        DQueue.Stop();
+        return DSink->Flush() && !DQueue.Failed();
+    }
+};
+
+CParallelDSVWriter::CParallelDSVWriter(std::shared_ptr< CDataSink > sink, char delimiter, bool quoteall, std::size_t threads, bool ordered, std::size_t batchrows)
+    : DImplementation(std::make_unique<SImplementation>(std::move(sink), delimiter, quoteall, threads, ordered, batchrows)){
+
+}
+
+CParallelDSVWriter::~CParallelDSVWriter() = default;
+
+bool CParallelDSVWriter::WriteRow(const std::vector<std::string> &row){
+    return DImplementation->WriteRow(row);
+}
+
+bool CParallelDSVWriter::WriteRows(std::vector< std::vector<std::string> > rows){
+    return DImplementation->WriteRows(std::move(rows));
+}
+
+bool CParallelDSVWriter::Flush(){
+    return DImplementation->Flush();
+}
+
+bool CParallelDSVWriter::Close(){
+    return DImplementation->Close();
+}
@@ -0,0 +1,476 @@
+#include "ParallelXMLReader.h"
+#include "Metrics.h"
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <expat.h>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace{
+
+// Finds the start tags of records without building anything. It knows just
+// enough XML to not be fooled by markup characters inside comments, CDATA,
+// processing instructions, the doctype or quoted attribute values.
+class CRecordScanner{
+    private:
+        const char *DPosition;
+        const char *DEnd;
+        std::size_t DRecordDepth;
+        std::vector<std::string> DStack;
+        bool DInternalSubset;
+
+        const char *Find(const char *from, const char *pattern) const{
+            std::size_t Length = std::strlen(pattern);
+            while(from + Length <= DEnd){
+                const char *Next = static_cast<const char *>(std::memchr(from, pattern[0], DEnd - from));
+                if(!Next || Next + Length > DEnd){
+                    return nullptr;
+                }
+                if(!std::memcmp(Next, pattern, Length)){
+                    return Next;
+                }
+                from = Next + 1;
+            }
+            return nullptr;
+        }
+
+        // end of a tag starting at from, stepping over quoted values
+        const char *TagEnd(const char *from) const{
+            char Quote = 0;
+            for(; from < DEnd; from++){
+                if(Quote){
+                    const char *Close = static_cast<const char *>(std::memchr(from, Quote, DEnd - from));
+                    if(!Close){
+                        return nullptr;
+                    }
+                    from = Close;
+                    Quote = 0;
+                }
+                else if(*from == '"' || *from == '\''){
+                    Quote = *from;
+                }
+                else if(*from == '>'){
+                    return from;
+                }
+            }
+            return nullptr;
+        }
+
+        // the doctype may hold an internal subset in [...] with its own markup
+        const char *DoctypeEnd(const char *from){
+            char Quote = 0;
+            int Brackets = 0;
+            for(; from < DEnd; from++){
+                if(Quote){
+                    if(*from == Quote){
+                        Quote = 0;
+                    }
+                }
+                else if(*from == '"' || *from == '\''){
+                    Quote = *from;
+                }
+                else if(*from == '['){
+                    Brackets++;
+                    DInternalSubset = true;
+                }
+                else if(*from == ']'){
+                    Brackets--;
+                }
+                else if(*from == '<' && from + 4 <= DEnd && !std::memcmp(from, "<!--", 4)){
+                    const char *Close = Find(from + 4, "-->");
+                    if(!Close){
+                        return nullptr;
+                    }
+                    from = Close + 2;
+                }
+                else if(*from == '>' && Brackets <= 0){
+                    return from;
+                }
+            }
+            return nullptr;
+        }
+
+    public:
+        CRecordScanner(const char *data, std::size_t length, std::size_t recorddepth)
+            : DPosition(data), DEnd(data + length), DRecordDepth(recorddepth), DInternalSubset(false){
+
+        }
+
+        // elements open at the last record start returned
+        const std::vector<std::string> &OpenElements() const{
+            return DStack;
+        }
+
+        bool InternalSubset() const{
+            return DInternalSubset;
+        }
+
+        // returns the '<' of the next record's start tag, or nullptr when
+        // there are no more (or the markup is too broken to scan further)
+        const char *NextRecord(){
+            while(DPosition < DEnd){
+                const char *Open = static_cast<const char *>(std::memchr(DPosition, '<', DEnd - DPosition));
+                if(!Open || Open + 1 >= DEnd){
+                    break;
+                }
+                const char *Close = nullptr;
+                if(Open[1] == '!'){
+                    if(Open + 4 <= DEnd && !std::memcmp(Open, "<!--", 4)){
+                        Close = Find(Open + 4, "-->");
+                        Close = Close ? Close + 2 : nullptr;
+                    }
+                    else if(Open + 9 <= DEnd && !std::memcmp(Open, "<![CDATA[", 9)){
+                        Close = Find(Open + 9, "]]>");
+                        Close = Close ? Close + 2 : nullptr;
+                    }
+                    else{
+                        Close = DoctypeEnd(Open + 2);
+                    }
+                }
+                else if(Open[1] == '?'){
+                    Close = Find(Open + 2, "?>");
+                    Close = Close ? Close + 1 : nullptr;
+                }
+                else if(Open[1] == '/'){
+                    Close = TagEnd(Open + 2);
+                    if(!DStack.empty()){
+                        DStack.pop_back();
+                    }
+                }
+                else{
+                    Close = TagEnd(Open + 1);
+                    if(Close && Close[-1] != '/'){
+                        const char *Name = Open + 1;
+                        const char *NameEnd = Name;
+                        while(NameEnd < Close && !std::strchr(" \t\r\n/>", *NameEnd)){
+                            NameEnd++;
+                        }
+                        if(DStack.size() == DRecordDepth){
+                            // the record's own tag is handled on the next call
+                            DStack.emplace_back(Name, NameEnd);
+                            DPosition = Close + 1;
+                            return Open;
+                        }
+                        DStack.emplace_back(Name, NameEnd);
+                    }
+                    else if(Close && DStack.size() == DRecordDepth){
+                        DPosition = Close + 1;
+                        return Open;
+                    }
+                }
+                if(!Close){
+                    break;
+                }
+                DPosition = Close + 1;
+            }
+            DPosition = DEnd;
+            return nullptr;
+        }
+};
+
+}
+
+struct CParallelXMLReader::SImplementation{
+    // a run of whole records plus what it takes to parse them on their own
+    struct SChunk{
+        const char *DBegin;
+        const char *DEnd;
+        // elements opened before the chunk and still open after it
+        std::vector<std::string> DOpenBefore;
+        std::vector<std::string> DOpenAfter;
+        std::vector<SXMLEntity> DEntities;
+        bool DStarted = false;
+        bool DDone = false;
+        bool DSuccess = false;
+    };
+
+    int DFileDescriptor;
+    char *DData;
+    std::size_t DLength;
+    std::string DEncoding;
+    std::size_t DRecordDepth;
+    std::size_t DChunkSize;
+    std::size_t DMaxInFlight;
+    std::unique_ptr<CRecordScanner> DScanner;
+    // start of the chunk being scanned and the elements open there
+    const char *DChunkBegin;
+    std::vector<std::string> DChunkOpen;
+    bool DScanDone;
+    // chunks in document order; the front one is being read
+    std::deque< std::unique_ptr<SChunk> > DChunks;
+    std::size_t DEntityIndex;
+    bool DFailed;
+    std::mutex DMutex;
+    std::condition_variable DWork;
+    std::condition_variable DReady;
+    bool DStop;
+    std::vector<std::thread> DThreads;
+
+    SImplementation(const std::string &filename, std::size_t recorddepth, std::size_t threads, std::size_t chunksize)
+        : DFileDescriptor(-1), DData(nullptr), DLength(0), DRecordDepth(recorddepth ? recorddepth : 1), DChunkSize(chunksize ? chunksize : 1),
+          DChunkBegin(nullptr), DScanDone(true), DEntityIndex(0), DFailed(false), DStop(false){
+        DFileDescriptor = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat Status;
+        if(DFileDescriptor < 0 || fstat(DFileDescriptor, &Status) < 0){
+            return;
+        }
+        DLength = Status.st_size;
+        if(DLength){
+            void *Mapping = mmap(nullptr, DLength, PROT_READ, MAP_PRIVATE, DFileDescriptor, 0);
+            if(Mapping == MAP_FAILED){
+                close(DFileDescriptor);
+                DFileDescriptor = -1;
+                return;
+            }
+            DData = static_cast<char *>(Mapping);
+            madvise(DData, DLength, MADV_SEQUENTIAL);
+        }
+        DEncoding = DeclaredEncoding();
+        DScanner = std::make_unique<CRecordScanner>(DData, DLength, DRecordDepth);
+        DChunkBegin = DData;
+        DScanDone = DLength == 0;
+        if(!threads){
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        DMaxInFlight = 2 * threads;
+        for(std::size_t Index = 0; Index < threads; Index++){
+            DThreads.emplace_back([this]{ Work(); });
+        }
+    }
+
+    ~SImplementation(){
+        {
+            std::unique_lock<std::mutex> Lock(DMutex);
+            DStop = true;
+            DWork.notify_all();
+        }
+        for(auto &Thread : DThreads){
+            Thread.join();
+        }
+        if(DData){
+            munmap(DData, DLength);
+        }
+        if(DFileDescriptor >= 0){
+            close(DFileDescriptor);
+        }
+    }
+
+    // encoding named in the XML declaration; later chunks have no
+    // declaration of their own so their parsers are told explicitly
+    std::string DeclaredEncoding() const{
+        if(DLength < 5 || std::memcmp(DData, "<?xml", 5)){
+            return std::string();
+        }
+        const char *End = static_cast<const char *>(std::memchr(DData, '>', DLength));
+        std::string Declaration(DData, End ? End - DData : DLength);
+        std::size_t Position = Declaration.find("encoding");
+        if(Position == std::string::npos){
+            return std::string();
+        }
+        Position = Declaration.find_first_of("\"'", Position);
+        if(Position == std::string::npos){
+            return std::string();
+        }
+        std::size_t Close = Declaration.find(Declaration[Position], Position + 1);
+        return Close == std::string::npos ? std::string() : Declaration.substr(Position + 1, Close - Position - 1);
+    }
+
+    // collects entities the way CXMLReader does
+    struct SParseState{
+        std::vector<SXMLEntity> *DEntities;
+        std::string DCharData;
+
+        void FlushCharData(){
+            if(!DCharData.empty()){
+                DEntities->emplace_back();
+                DEntities->back().DType = SXMLEntity::EType::CharData;
+                DEntities->back().DNameData.swap(DCharData);
+                DCharData.clear();
+            }
+        }
+
+        static void StartElementHandler(void *userdata, const char *name, const char **attributes){
+            auto *State = static_cast<SParseState *>(userdata);
+            State->FlushCharData();
+            State->DEntities->emplace_back();
+            SXMLEntity &Entity = State->DEntities->back();
+            Entity.DType = SXMLEntity::EType::StartElement;
+            Entity.DNameData = name;
+            for(int Index = 0; attributes && attributes[Index]; Index += 2){
+                if(attributes[Index + 1]){
+                    Entity.DAttributes.emplace_back(attributes[Index], attributes[Index + 1]);
+                }
+            }
+        }
+
+        static void EndElementHandler(void *userdata, const char *name){
+            auto *State = static_cast<SParseState *>(userdata);
+            State->FlushCharData();
+            State->DEntities->emplace_back();
+            State->DEntities->back().DType = SXMLEntity::EType::EndElement;
+            State->DEntities->back().DNameData = name;
+        }
+
+        static void CharDataHandler(void *userdata, const char *data, int length){
+            static_cast<SParseState *>(userdata)->DCharData.append(data, length);
+        }
+    };
+
+    // parses a chunk wrapped in synthetic tags for the elements open around
+    // it, then drops the entities those tags produced
+    bool Parse(SChunk &chunk) const{
+        DSV_TRACE_SPAN("ParallelXMLReader::Parse");
+        bool First = chunk.DBegin == DData;
+        XML_Parser Parser = XML_ParserCreate(First || DEncoding.empty() ? nullptr : DEncoding.c_str());
+        SParseState State;
+        State.DEntities = &chunk.DEntities;
+        XML_SetUserData(Parser, &State);
+        XML_SetElementHandler(Parser, SParseState::StartElementHandler, SParseState::EndElementHandler);
+        XML_SetCharacterDataHandler(Parser, SParseState::CharDataHandler);
+        std::string Prefix, Suffix;
+        for(auto &Name : chunk.DOpenBefore){
+            Prefix += "<" + Name + ">";
+        }
+        for(auto Iter = chunk.DOpenAfter.rbegin(); Iter != chunk.DOpenAfter.rend(); ++Iter){
+            Suffix += "</" + *Iter + ">";
+        }
+        bool Success = XML_Parse(Parser, Prefix.data(), static_cast<int>(Prefix.size()), 0) != XML_STATUS_ERROR;
+        // Expat takes an int length, so very large chunks go in pieces
+        const char *Position = chunk.DBegin;
+        while(Success && Position < chunk.DEnd){
+            std::size_t Piece = std::min<std::size_t>(chunk.DEnd - Position, 1 << 30);
+            Success = XML_Parse(Parser, Position, static_cast<int>(Piece), 0) != XML_STATUS_ERROR;
+            Position += Piece;
+        }
+        Success = Success && XML_Parse(Parser, Suffix.data(), static_cast<int>(Suffix.size()), 1) != XML_STATUS_ERROR;
+        XML_ParserFree(Parser);
+        if(!Success){
+            return false;
+        }
+        auto &Entities = chunk.DEntities;
+        Entities.erase(Entities.end() - chunk.DOpenAfter.size(), Entities.end());
+        Entities.erase(Entities.begin(), Entities.begin() + chunk.DOpenBefore.size());
+        return true;
+    }
+
+    // worker thread: parse the oldest unstarted chunk
+    void Work(){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        while(true){
+            SChunk *Next = nullptr;
+            DWork.wait(Lock, [&]{
+                for(auto &Chunk : DChunks){
+                    if(!Chunk->DStarted){
+                        Next = Chunk.get();
+                        return true;
+                    }
+                }
+                return DStop;
+            });
+            if(!Next){
+                return;
+            }
+            Next->DStarted = true;
+            Lock.unlock();
+            bool Success = Parse(*Next);
+            Lock.lock();
+            Next->DSuccess = Success;
+            Next->DDone = true;
+            DReady.notify_all();
+        }
+    }
+
+    // scans ahead and queues chunks until enough are in flight; the scan
+    // state belongs to the reading thread, so the lock is only held to look
+    // at and add to the queue and workers are never stuck behind a scan
+    void Refill(std::unique_lock<std::mutex> &lock){
+        while(!DScanDone && DChunks.size() < DMaxInFlight){
+            lock.unlock();
+            auto Chunk = std::make_unique<SChunk>();
+            Chunk->DBegin = DChunkBegin;
+            Chunk->DOpenBefore = DChunkOpen;
+            while(true){
+                const char *Record = DScanner->NextRecord();
+                if(!Record || DScanner->InternalSubset()){
+                    Chunk->DEnd = DData + DLength;
+                    DScanDone = true;
+                    break;
+                }
+                if(Record > DChunkBegin && static_cast<std::size_t>(Record - DChunkBegin) >= DChunkSize){
+                    Chunk->DEnd = Record;
+                    // the record's own tag was already pushed by the scanner
+                    Chunk->DOpenAfter.assign(DScanner->OpenElements().begin(), DScanner->OpenElements().begin() + DRecordDepth);
+                    DChunkBegin = Record;
+                    DChunkOpen = Chunk->DOpenAfter;
+                    break;
+                }
+            }
+            lock.lock();
+            DChunks.push_back(std::move(Chunk));
+            DWork.notify_one();
+        }
+    }
+
+    // waits until the front chunk is parsed; false once everything is read
+    bool NextReady(std::unique_lock<std::mutex> &lock){
+        while(!DFailed){
+            Refill(lock);
+            if(DChunks.empty()){
+                return false;
+            }
+            SChunk &Front = *DChunks.front();
+            DReady.wait(lock, [&]{ return Front.DDone; });
+            if(!Front.DSuccess){
+                DFailed = true;
+                return false;
+            }
+            if(DEntityIndex < Front.DEntities.size()){
+                return true;
+            }
+            DChunks.pop_front();
+            DEntityIndex = 0;
+        }
+        return false;
+    }
+
+    bool ReadEntity(SXMLEntity &entity, bool skipcdata){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        while(NextReady(Lock)){
+            SXMLEntity &Next = DChunks.front()->DEntities[DEntityIndex++];
+            if(!(skipcdata && Next.DType == SXMLEntity::EType::CharData)){
+                entity = std::move(Next);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+CParallelXMLReader::CParallelXMLReader(const std::string &filename, std::size_t recorddepth, std::size_t threads, std::size_t chunksize)
+    : DImplementation(std::make_unique<SImplementation>(filename, recorddepth, threads, chunksize)){
+
+}
+
+CParallelXMLReader::~CParallelXMLReader() = default;
+
+bool CParallelXMLReader::IsOpen() const noexcept{
+    return DImplementation->DFileDescriptor >= 0;
+}
+
+bool CParallelXMLReader::Failed() const noexcept{
+    return DImplementation->DFailed;
+}
+
+bool CParallelXMLReader::End() const{
+    std::unique_lock<std::mutex> Lock(DImplementation->DMutex);
+    return !DImplementation->NextReady(Lock);
+}
+
+bool CParallelXMLReader::ReadEntity(SXMLEntity &entity, bool skipcdata){
+    return DImplementation->ReadEntity(entity, skipcdata);
+}
@@ -0,0 +1,178 @@
+#include "PrefetchDataSource.h"
+#include "Metrics.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+struct CPrefetchDataSource::SImplementation{
+    std::shared_ptr<CDataSource> DSource;
+    std::size_t DBufferSize;
+    // ring of buffers; slots in [DHead, DTail) are full, the rest are free.
+    // Each side only advances its own index, so the handoff itself is two
+    // atomics; the mutex and condition variable are only for sleeping
+    std::vector< std::vector<char> > DBuffers;
+    std::atomic<std::size_t> DHead;
+    std::atomic<std::size_t> DTail;
+    // set by the producer once the source is exhausted
+    std::atomic<bool> DFinished;
+    std::atomic<bool> DStop;
+    std::atomic<bool> DConsumerWaiting;
+    std::atomic<bool> DProducerWaiting;
+    std::mutex DMutex;
+    std::condition_variable DConsumerReady;
+    std::condition_variable DProducerReady;
+    // read position in the head buffer, only touched by the consumer
+    std::size_t DOffset;
+    std::chrono::nanoseconds DConsumerStall;
+    std::size_t DConsumerStalls;
+    std::atomic<std::int64_t> DProducerStall;
+    std::thread DThread;
+
+    SImplementation(std::shared_ptr<CDataSource> src, std::size_t buffersize, std::size_t buffercount)
+        : DSource(std::move(src)), DBufferSize(buffersize ? buffersize : 1), DBuffers(buffercount > 1 ? buffercount : 2),
+          DHead(0), DTail(0), DFinished(false), DStop(false), DConsumerWaiting(false), DProducerWaiting(false),
+          DOffset(0), DConsumerStall(0), DConsumerStalls(0), DProducerStall(0){
+        DThread = std::thread([this]{ Produce(); });
+    }
+
+    ~SImplementation(){
+        DStop = true;
+        {
+            std::lock_guard<std::mutex> Lock(DMutex);
+            DProducerReady.notify_all();
+        }
+        DThread.join();
+    }
+
+    // background thread: keep every free slot filled until the source ends
+    void Produce(){
+        while(!DStop){
+            std::size_t Tail = DTail.load(std::memory_order_relaxed);
+            if(Tail - DHead.load(std::memory_order_acquire) == DBuffers.size()){
+                auto Start = std::chrono::steady_clock::now();
+                std::unique_lock<std::mutex> Lock(DMutex);
+                DProducerWaiting = true;
+                DProducerReady.wait(Lock, [&]{ return DStop || Tail - DHead.load() < DBuffers.size(); });
+                DProducerWaiting = false;
+                DProducerStall += (std::chrono::steady_clock::now() - Start).count();
+                continue;
+            }
+            std::vector<char> &Buffer = DBuffers[Tail % DBuffers.size()];
+            bool More = DSource->Read(Buffer, DBufferSize);
+            if(!More){
+                Buffer.clear();
+            }
+            if(!Buffer.empty()){
+                DTail.store(Tail + 1);
+            }
+            if(!More){
+                DFinished = true;
+            }
+            if(DConsumerWaiting){
+                std::lock_guard<std::mutex> Lock(DMutex);
+                DConsumerReady.notify_one();
+            }
+            if(!More){
+                return;
+            }
+        }
+    }
+
+    // makes sure the head buffer has unread bytes; false at end of data
+    bool Fill(){
+        std::size_t Head = DHead.load(std::memory_order_relaxed);
+        if(Head != DTail.load(std::memory_order_acquire)){
+            if(DOffset < DBuffers[Head % DBuffers.size()].size()){
+                return true;
+            }
+            // hand the drained buffer back to the producer
+            DOffset = 0;
+            DHead.store(++Head);
+            if(DProducerWaiting){
+                std::lock_guard<std::mutex> Lock(DMutex);
+                DProducerReady.notify_one();
+            }
+        }
+        if(Head != DTail.load(std::memory_order_acquire)){
+            return true;
+        }
+        if(DFinished && Head == DTail.load()){
+            return false;
+        }
+        // nothing ready, wait for the producer
+        auto Start = std::chrono::steady_clock::now();
+        {
+            std::unique_lock<std::mutex> Lock(DMutex);
+            DConsumerWaiting = true;
+            DConsumerReady.wait(Lock, [&]{ return Head != DTail.load() || DFinished; });
+            DConsumerWaiting = false;
+        }
+        auto Stall = std::chrono::steady_clock::now() - Start;
+        DConsumerStall += Stall;
+        DSV_METRIC_ADD(SourceWaitNanoseconds, std::chrono::duration_cast<std::chrono::nanoseconds>(Stall).count());
+        DConsumerStalls++;
+        return Head != DTail.load();
+    }
+
+    const char *Current() const{
+        return DBuffers[DHead.load(std::memory_order_relaxed) % DBuffers.size()].data() + DOffset;
+    }
+
+    std::size_t Available() const{
+        return DBuffers[DHead.load(std::memory_order_relaxed) % DBuffers.size()].size() - DOffset;
+    }
+};
+
+CPrefetchDataSource::CPrefetchDataSource(std::shared_ptr< CDataSource > src, std::size_t buffersize, std::size_t buffercount)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), buffersize, buffercount)){
+
+}
+
+CPrefetchDataSource::~CPrefetchDataSource() = default;
+
+// End has to know whether more data is coming, so it may wait like Peek
+bool CPrefetchDataSource::End() const noexcept{
+    return !DImplementation->Fill();
+}
+
+bool CPrefetchDataSource::Get(char &ch) noexcept{
+    if(!DImplementation->Fill()){
+        return false;
+    }
+    ch = *DImplementation->Current();
+    DImplementation->DOffset++;
+    return true;
+}
+
+bool CPrefetchDataSource::Peek(char &ch) noexcept{
+    if(!DImplementation->Fill()){
+        return false;
+    }
+    ch = *DImplementation->Current();
+    return true;
+}
+
+// copies whole runs out of the ready buffers
+bool CPrefetchDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while(buf.size() < count && DImplementation->Fill()){
+        std::size_t Chunk = std::min(count - buf.size(), DImplementation->Available());
+        buf.insert(buf.end(), DImplementation->Current(), DImplementation->Current() + Chunk);
+        DImplementation->DOffset += Chunk;
+    }
+    return !buf.empty();
+}
+
+std::chrono::nanoseconds CPrefetchDataSource::ConsumerStallTime() const noexcept{
+    return DImplementation->DConsumerStall;
+}
+
+std::size_t CPrefetchDataSource::ConsumerStalls() const noexcept{
+    return DImplementation->DConsumerStalls;
+}
+
+std::chrono::nanoseconds CPrefetchDataSource::ProducerStallTime() const noexcept{
+    return std::chrono::nanoseconds(DImplementation->DProducerStall.load());
+}
@@ -0,0 +1,156 @@
+#include "Reactor.h"
+#include <cerrno>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+struct CEpollReactor::SImplementation{
+    // coroutines waiting on one descriptor, at most one per direction
+    struct SWaiters{
+        std::coroutine_handle<> DReader;
+        std::coroutine_handle<> DWriter;
+    };
+
+    int DEpoll;
+    std::unordered_map<int, SWaiters> DWaiters;
+    std::vector< TTask<void> > DTasks;
+    std::vector< TTask<void> > DStarting;
+
+    SImplementation() : DEpoll(epoll_create1(EPOLL_CLOEXEC)){
+
+    }
+
+    ~SImplementation(){
+        if(DEpoll >= 0){
+            close(DEpoll);
+        }
+    }
+
+    // registers interest matching the waiters, removing the descriptor
+    // once nobody waits on it
+    bool Update(int fd, const SWaiters &waiters, bool added){
+        epoll_event Event{};
+        Event.events = (waiters.DReader ? static_cast<std::uint32_t>(EPOLLIN) : 0u) | (waiters.DWriter ? static_cast<std::uint32_t>(EPOLLOUT) : 0u);
+        Event.data.fd = fd;
+        if(!Event.events){
+            epoll_ctl(DEpoll, EPOLL_CTL_DEL, fd, nullptr);
+            return true;
+        }
+        return epoll_ctl(DEpoll, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &Event) == 0;
+    }
+
+    bool Watch(int fd, bool write, std::coroutine_handle<> handle){
+        auto Found = DWaiters.find(fd);
+        bool Added = Found == DWaiters.end();
+        SWaiters &Waiters = Added ? DWaiters[fd] : Found->second;
+        (write ? Waiters.DWriter : Waiters.DReader) = handle;
+        if(!Update(fd, Waiters, Added)){
+            // EPERM for regular files, which never block anyway
+            (write ? Waiters.DWriter : Waiters.DReader) = nullptr;
+            if(!Waiters.DReader && !Waiters.DWriter){
+                DWaiters.erase(fd);
+            }
+            return false;
+        }
+        return true;
+    }
+
+    void Dispatch(const epoll_event &event){
+        auto Found = DWaiters.find(event.data.fd);
+        if(Found == DWaiters.end()){
+            return;
+        }
+        // errors and hang ups wake both sides so they see the failure
+        bool Failed = event.events & (EPOLLERR | EPOLLHUP);
+        std::coroutine_handle<> Reader, Writer;
+        if(Found->second.DReader && (Failed || (event.events & EPOLLIN))){
+            Reader = std::exchange(Found->second.DReader, nullptr);
+        }
+        if(Found->second.DWriter && (Failed || (event.events & EPOLLOUT))){
+            Writer = std::exchange(Found->second.DWriter, nullptr);
+        }
+        Update(event.data.fd, Found->second, false);
+        if(!Found->second.DReader && !Found->second.DWriter){
+            DWaiters.erase(Found);
+        }
+        // resuming may register the descriptor again, so it happens last
+        if(Reader){
+            Reader.resume();
+        }
+        if(Writer){
+            Writer.resume();
+        }
+    }
+
+    void StartSpawned(){
+        while(!DStarting.empty()){
+            std::vector< TTask<void> > Starting;
+            Starting.swap(DStarting);
+            for(auto &Task : Starting){
+                Task.Start(std::noop_coroutine()).resume();
+                DTasks.push_back(std::move(Task));
+            }
+        }
+    }
+
+    void Reap(){
+        std::size_t Kept = 0;
+        for(std::size_t Index = 0; Index < DTasks.size(); Index++){
+            if(!DTasks[Index].Done()){
+                if(Kept != Index){
+                    DTasks[Kept] = std::move(DTasks[Index]);
+                }
+                Kept++;
+            }
+        }
+        DTasks.resize(Kept);
+    }
+
+    bool Run(){
+        epoll_event Events[64];
+        while(true){
+            StartSpawned();
+            Reap();
+            if(DTasks.empty()){
+                return true;
+            }
+            if(DWaiters.empty()){
+                return false;
+            }
+            int Count = epoll_wait(DEpoll, Events, 64, -1);
+            if(Count < 0){
+                if(errno == EINTR){
+                    continue;
+                }
+                return false;
+            }
+            for(int Index = 0; Index < Count; Index++){
+                Dispatch(Events[Index]);
+            }
+        }
+    }
+};
+
+CEpollReactor::CEpollReactor() : DImplementation(std::make_unique<SImplementation>()){
+
+}
+
+CEpollReactor::~CEpollReactor() = default;
+
+bool CEpollReactor::IsOpen() const noexcept{
+    return DImplementation->DEpoll >= 0;
+}
+
+bool CEpollReactor::Watch(int fd, bool write, std::coroutine_handle<> handle) noexcept{
+    return DImplementation->Watch(fd, write, handle);
+}
+
+void CEpollReactor::Spawn(TTask<void> task){
+    DImplementation->DStarting.push_back(std::move(task));
+}
+
+bool CEpollReactor::Run(){
+    return DImplementation->Run();
+}
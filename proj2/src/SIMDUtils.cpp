@@ -0,0 +1,495 @@
+#include "SIMDUtils.h"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define SIMDUTILS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace SIMDUtils{
+
+namespace{
+
+// scalar fallbacks, also used for the tails of the vector loops
+inline char UpperChar(char ch) noexcept{
+    return (ch >= 'a' && ch <= 'z') ? static_cast<char>(ch - ('a' - 'A')) : ch;
+}
+
+inline char LowerChar(char ch) noexcept{
+    return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch + ('a' - 'A')) : ch;
+}
+
+void UpperScalar(const char *src, char *dst, std::size_t length) noexcept{
+    for(std::size_t Index = 0; Index < length; Index++){
+        dst[Index] = UpperChar(src[Index]);
+    }
+}
+
+void LowerScalar(const char *src, char *dst, std::size_t length) noexcept{
+    for(std::size_t Index = 0; Index < length; Index++){
+        dst[Index] = LowerChar(src[Index]);
+    }
+}
+
+std::size_t MismatchScalar(const char *left, const char *right, std::size_t length) noexcept{
+    for(std::size_t Index = 0; Index < length; Index++){
+        if(LowerChar(left[Index]) != LowerChar(right[Index])){
+            return Index;
+        }
+    }
+    return length;
+}
+
+inline bool IsWhitespace(char ch) noexcept{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+std::size_t LeadingScalar(const char *data, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    while(Index < length && IsWhitespace(data[Index])){
+        Index++;
+    }
+    return Index;
+}
+
+std::size_t TrailingScalar(const char *data, std::size_t length) noexcept{
+    while(length > 0 && IsWhitespace(data[length - 1])){
+        length--;
+    }
+    return length;
+}
+
+bool IsASCIIScalar(const char *data, std::size_t length) noexcept{
+    for(std::size_t Index = 0; Index < length; Index++){
+        if(static_cast<unsigned char>(data[Index]) & 0x80){
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t CountScalar(const char *data, std::size_t length) noexcept{
+    std::size_t Count = 0;
+    for(std::size_t Index = 0; Index < length; Index++){
+        Count += (static_cast<unsigned char>(data[Index]) & 0xC0) != 0x80;
+    }
+    return Count;
+}
+
+// decodes the sequence starting at src, rejecting overlong forms, surrogates
+// and values past U+10FFFF; returns the number of bytes consumed
+std::size_t DecodeOne(const unsigned char *src, std::size_t length, char32_t &codepoint) noexcept{
+    unsigned char Lead = src[0];
+    std::size_t Needed;
+    unsigned char Low = 0x80, High = 0xBF;
+    if(Lead < 0x80){
+        codepoint = Lead;
+        return 1;
+    }
+    else if(Lead >= 0xC2 && Lead <= 0xDF){
+        Needed = 1;
+        codepoint = Lead & 0x1F;
+    }
+    else if(Lead >= 0xE0 && Lead <= 0xEF){
+        Needed = 2;
+        codepoint = Lead & 0x0F;
+        Low = Lead == 0xE0 ? 0xA0 : 0x80;
+        High = Lead == 0xED ? 0x9F : 0xBF;
+    }
+    else if(Lead >= 0xF0 && Lead <= 0xF4){
+        Needed = 3;
+        codepoint = Lead & 0x07;
+        Low = Lead == 0xF0 ? 0x90 : 0x80;
+        High = Lead == 0xF4 ? 0x8F : 0xBF;
+    }
+    else{
+        codepoint = 0xFFFD;
+        return 1;
+    }
+    if(length <= Needed || src[1] < Low || src[1] > High){
+        codepoint = 0xFFFD;
+        return 1;
+    }
+    for(std::size_t Index = 1; Index <= Needed; Index++){
+        if((src[Index] & 0xC0) != 0x80){
+            codepoint = 0xFFFD;
+            return 1;
+        }
+        codepoint = (codepoint << 6) | (src[Index] & 0x3F);
+    }
+    return Needed + 1;
+}
+
+#ifndef SIMDUTILS_X86
+void ClassifyScalar(const char *data, std::size_t blocks, char delimiter, SDSVBlockMasks *masks) noexcept{
+    for(std::size_t Block = 0; Block < blocks; Block++, data += 64){
+        SDSVBlockMasks Masks{0, 0, 0, 0};
+        for(unsigned Index = 0; Index < 64; Index++){
+            std::uint64_t Bit = std::uint64_t(1) << Index;
+            char Char = data[Index];
+            Masks.DQuote |= Char == '"' ? Bit : 0;
+            Masks.DDelimiter |= Char == delimiter ? Bit : 0;
+            Masks.DNewline |= Char == '\n' ? Bit : 0;
+            Masks.DReturn |= Char == '\r' ? Bit : 0;
+        }
+        masks[Block] = Masks;
+    }
+}
+
+std::size_t DecodeScalar(const char *src, std::size_t length, char32_t *dst) noexcept{
+    const unsigned char *Bytes = reinterpret_cast<const unsigned char *>(src);
+    std::size_t Index = 0, Count = 0;
+    while(Index < length){
+        Index += DecodeOne(Bytes + Index, length - Index, dst[Count++]);
+    }
+    return Count;
+}
+#else
+
+// a byte is in [first, first + 25] when (byte + 0x80 - first) as a signed
+// value is below -128 + 26, which is a single compare per vector
+inline __m128i LetterMask128(__m128i bytes, char first) noexcept{
+    __m128i Shifted = _mm_add_epi8(bytes, _mm_set1_epi8(static_cast<char>(0x80 - first)));
+    return _mm_cmplt_epi8(Shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+}
+
+inline __m128i FlipCase128(__m128i bytes, char first) noexcept{
+    return _mm_xor_si128(bytes, _mm_and_si128(LetterMask128(bytes, first), _mm_set1_epi8(0x20)));
+}
+
+void UpperSSE2(const char *src, char *dst, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    for(; Index + 16 <= length; Index += 16){
+        __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + Index));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + Index), FlipCase128(Bytes, 'a'));
+    }
+    UpperScalar(src + Index, dst + Index, length - Index);
+}
+
+void LowerSSE2(const char *src, char *dst, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    for(; Index + 16 <= length; Index += 16){
+        __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + Index));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + Index), FlipCase128(Bytes, 'A'));
+    }
+    LowerScalar(src + Index, dst + Index, length - Index);
+}
+
+std::size_t MismatchSSE2(const char *left, const char *right, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    for(; Index + 16 <= length; Index += 16){
+        __m128i Left = FlipCase128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(left + Index)), 'A');
+        __m128i Right = FlipCase128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(right + Index)), 'A');
+        unsigned Equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(Left, Right)));
+        if(Equal != 0xFFFFu){
+            return Index + __builtin_ctz(~Equal);
+        }
+    }
+    return Index + MismatchScalar(left + Index, right + Index, length - Index);
+}
+
+inline unsigned WhitespaceMask128(const char *data) noexcept{
+    __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    __m128i Mask = _mm_or_si128(_mm_cmpeq_epi8(Bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('\t')));
+    Mask = _mm_or_si128(Mask, _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('\n')));
+    Mask = _mm_or_si128(Mask, _mm_cmpeq_epi8(Bytes, _mm_set1_epi8('\r')));
+    return static_cast<unsigned>(_mm_movemask_epi8(Mask));
+}
+
+std::size_t LeadingSSE2(const char *data, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    for(; Index + 16 <= length; Index += 16){
+        unsigned Other = ~WhitespaceMask128(data + Index) & 0xFFFFu;
+        if(Other){
+            return Index + __builtin_ctz(Other);
+        }
+    }
+    return Index + LeadingScalar(data + Index, length - Index);
+}
+
+std::size_t TrailingSSE2(const char *data, std::size_t length) noexcept{
+    for(; length >= 16; length -= 16){
+        unsigned Other = ~WhitespaceMask128(data + length - 16) & 0xFFFFu;
+        if(Other){
+            return length - 16 + (32 - __builtin_clz(Other));
+        }
+    }
+    return TrailingScalar(data, length);
+}
+
+bool IsASCIISSE2(const char *data, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    __m128i Accumulated = _mm_setzero_si128();
+    for(; Index + 16 <= length; Index += 16){
+        Accumulated = _mm_or_si128(Accumulated, _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + Index)));
+    }
+    return _mm_movemask_epi8(Accumulated) == 0 && IsASCIIScalar(data + Index, length - Index);
+}
+
+std::size_t CountSSE2(const char *data, std::size_t length) noexcept{
+    std::size_t Index = 0, Count = 0;
+    // continuation bytes are -128..-65 as signed chars
+    const __m128i Threshold = _mm_set1_epi8(-65);
+    for(; Index + 16 <= length; Index += 16){
+        __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + Index));
+        Count += __builtin_popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(Bytes, Threshold))));
+    }
+    return Count + CountScalar(data + Index, length - Index);
+}
+
+// bit mask of the bytes in the 64 at data equal to match, 16 at a time
+inline std::uint64_t EqualMask64SSE2(const char *data, __m128i match) noexcept{
+    std::uint64_t Mask = 0;
+    for(unsigned Lane = 0; Lane < 4; Lane++){
+        __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + Lane * 16));
+        Mask |= static_cast<std::uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(Bytes, match)))) << (Lane * 16);
+    }
+    return Mask;
+}
+
+void ClassifySSE2(const char *data, std::size_t blocks, char delimiter, SDSVBlockMasks *masks) noexcept{
+    const __m128i Quote = _mm_set1_epi8('"');
+    const __m128i Delimiter = _mm_set1_epi8(delimiter);
+    const __m128i Newline = _mm_set1_epi8('\n');
+    const __m128i Return = _mm_set1_epi8('\r');
+    for(std::size_t Block = 0; Block < blocks; Block++, data += 64){
+        masks[Block] = {EqualMask64SSE2(data, Quote), EqualMask64SSE2(data, Delimiter), EqualMask64SSE2(data, Newline), EqualMask64SSE2(data, Return)};
+    }
+}
+
+// widens eight 16-bit lanes to 32-bit code points
+inline void Store16As32(__m128i lanes, char32_t *dst) noexcept{
+    const __m128i Zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi16(lanes, Zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4), _mm_unpackhi_epi16(lanes, Zero));
+}
+
+// vector paths for the two common run types, all-ASCII blocks and blocks of
+// eight 2-byte sequences (Latin, Greek, Cyrillic, Hebrew, Arabic ...); any
+// other block decodes its ASCII prefix then one sequence at a time
+std::size_t DecodeSSE2(const char *src, std::size_t length, char32_t *dst) noexcept{
+    const unsigned char *Bytes = reinterpret_cast<const unsigned char *>(src);
+    const __m128i Zero = _mm_setzero_si128();
+    std::size_t Index = 0, Count = 0;
+    while(Index < length){
+        if(Index + 16 <= length){
+            __m128i Block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + Index));
+            unsigned HighBits = static_cast<unsigned>(_mm_movemask_epi8(Block));
+            if(!HighBits){
+                Store16As32(_mm_unpacklo_epi8(Block, Zero), dst + Count);
+                Store16As32(_mm_unpackhi_epi8(Block, Zero), dst + Count + 8);
+                Index += 16;
+                Count += 16;
+                continue;
+            }
+            // little endian lanes hold lead in the low byte, continuation in the high
+            __m128i Shape = _mm_cmpeq_epi16(_mm_and_si128(Block, _mm_set1_epi16(static_cast<short>(0xC0E0))), _mm_set1_epi16(static_cast<short>(0x80C0)));
+            __m128i Overlong = _mm_cmpeq_epi16(_mm_and_si128(Block, _mm_set1_epi16(0x001E)), Zero);
+            if(_mm_movemask_epi8(_mm_andnot_si128(Overlong, Shape)) == 0xFFFF){
+                __m128i Lead = _mm_slli_epi16(_mm_and_si128(Block, _mm_set1_epi16(0x001F)), 6);
+                __m128i Trail = _mm_and_si128(_mm_srli_epi16(Block, 8), _mm_set1_epi16(0x003F));
+                Store16As32(_mm_or_si128(Lead, Trail), dst + Count);
+                Index += 16;
+                Count += 8;
+                continue;
+            }
+            std::size_t Prefix = __builtin_ctz(HighBits);
+            for(std::size_t Offset = 0; Offset < Prefix; Offset++){
+                dst[Count++] = Bytes[Index + Offset];
+            }
+            Index += Prefix;
+        }
+        Index += DecodeOne(Bytes + Index, length - Index, dst[Count++]);
+    }
+    return Count;
+}
+
+__attribute__((target("avx2")))
+inline __m256i FlipCase256(__m256i bytes, char first) noexcept{
+    __m256i Shifted = _mm256_add_epi8(bytes, _mm256_set1_epi8(static_cast<char>(0x80 - first)));
+    __m256i Mask = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + 26)), Shifted);
+    return _mm256_xor_si256(bytes, _mm256_and_si256(Mask, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2")))
+void UpperAVX2(const char *src, char *dst, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    for(; Index + 32 <= length; Index += 32){
+        __m256i Bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + Index));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + Index), FlipCase256(Bytes, 'a'));
+    }
+    UpperSSE2(src + Index, dst + Index, length - Index);
+}
+
+__attribute__((target("avx2")))
+void LowerAVX2(const char *src, char *dst, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    for(; Index + 32 <= length; Index += 32){
+        __m256i Bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + Index));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + Index), FlipCase256(Bytes, 'A'));
+    }
+    LowerSSE2(src + Index, dst + Index, length - Index);
+}
+
+__attribute__((target("avx2")))
+std::size_t MismatchAVX2(const char *left, const char *right, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    for(; Index + 32 <= length; Index += 32){
+        __m256i Left = FlipCase256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(left + Index)), 'A');
+        __m256i Right = FlipCase256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + Index)), 'A');
+        unsigned Equal = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(Left, Right)));
+        if(Equal != 0xFFFFFFFFu){
+            return Index + __builtin_ctz(~Equal);
+        }
+    }
+    return Index + MismatchSSE2(left + Index, right + Index, length - Index);
+}
+
+__attribute__((target("avx2")))
+inline unsigned WhitespaceMask256(const char *data) noexcept{
+    __m256i Bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+    __m256i Mask = _mm256_or_si256(_mm256_cmpeq_epi8(Bytes, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(Bytes, _mm256_set1_epi8('\t')));
+    Mask = _mm256_or_si256(Mask, _mm256_cmpeq_epi8(Bytes, _mm256_set1_epi8('\n')));
+    Mask = _mm256_or_si256(Mask, _mm256_cmpeq_epi8(Bytes, _mm256_set1_epi8('\r')));
+    return static_cast<unsigned>(_mm256_movemask_epi8(Mask));
+}
+
+__attribute__((target("avx2")))
+std::size_t LeadingAVX2(const char *data, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    for(; Index + 32 <= length; Index += 32){
+        unsigned Other = ~WhitespaceMask256(data + Index);
+        if(Other){
+            return Index + __builtin_ctz(Other);
+        }
+    }
+    return Index + LeadingSSE2(data + Index, length - Index);
+}
+
+__attribute__((target("avx2")))
+std::size_t TrailingAVX2(const char *data, std::size_t length) noexcept{
+    for(; length >= 32; length -= 32){
+        unsigned Other = ~WhitespaceMask256(data + length - 32);
+        if(Other){
+            return length - 32 + (32 - __builtin_clz(Other));
+        }
+    }
+    return TrailingSSE2(data, length);
+}
+
+__attribute__((target("avx2")))
+bool IsASCIIAVX2(const char *data, std::size_t length) noexcept{
+    std::size_t Index = 0;
+    __m256i Accumulated = _mm256_setzero_si256();
+    for(; Index + 32 <= length; Index += 32){
+        Accumulated = _mm256_or_si256(Accumulated, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + Index)));
+    }
+    return _mm256_movemask_epi8(Accumulated) == 0 && IsASCIISSE2(data + Index, length - Index);
+}
+
+__attribute__((target("avx2")))
+std::size_t CountAVX2(const char *data, std::size_t length) noexcept{
+    std::size_t Index = 0, Count = 0;
+    const __m256i Threshold = _mm256_set1_epi8(-65);
+    for(; Index + 32 <= length; Index += 32){
+        __m256i Bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + Index));
+        Count += __builtin_popcount(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(Bytes, Threshold))));
+    }
+    return Count + CountSSE2(data + Index, length - Index);
+}
+
+__attribute__((target("avx2")))
+inline std::uint64_t EqualMask64AVX2(__m256i low, __m256i high, __m256i match) noexcept{
+    std::uint64_t Low = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, match)));
+    std::uint64_t High = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, match)));
+    return Low | (High << 32);
+}
+
+__attribute__((target("avx2")))
+void ClassifyAVX2(const char *data, std::size_t blocks, char delimiter, SDSVBlockMasks *masks) noexcept{
+    const __m256i Quote = _mm256_set1_epi8('"');
+    const __m256i Delimiter = _mm256_set1_epi8(delimiter);
+    const __m256i Newline = _mm256_set1_epi8('\n');
+    const __m256i Return = _mm256_set1_epi8('\r');
+    for(std::size_t Block = 0; Block < blocks; Block++, data += 64){
+        __m256i Low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+        __m256i High = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 32));
+        masks[Block] = {EqualMask64AVX2(Low, High, Quote), EqualMask64AVX2(Low, High, Delimiter), EqualMask64AVX2(Low, High, Newline), EqualMask64AVX2(Low, High, Return)};
+    }
+}
+
+#endif
+
+// the kernel set picked for this CPU
+struct SKernels{
+    const char *DName;
+    void (*DUpper)(const char *, char *, std::size_t) noexcept;
+    void (*DLower)(const char *, char *, std::size_t) noexcept;
+    std::size_t (*DMismatch)(const char *, const char *, std::size_t) noexcept;
+    std::size_t (*DLeading)(const char *, std::size_t) noexcept;
+    std::size_t (*DTrailing)(const char *, std::size_t) noexcept;
+    bool (*DIsASCII)(const char *, std::size_t) noexcept;
+    std::size_t (*DCount)(const char *, std::size_t) noexcept;
+    std::size_t (*DDecode)(const char *, std::size_t, char32_t *) noexcept;
+    void (*DClassify)(const char *, std::size_t, char, SDSVBlockMasks *) noexcept;
+};
+
+SKernels ResolveKernels() noexcept{
+#ifdef SIMDUTILS_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")){
+        return {"avx2", UpperAVX2, LowerAVX2, MismatchAVX2, LeadingAVX2, TrailingAVX2, IsASCIIAVX2, CountAVX2, DecodeSSE2, ClassifyAVX2};
+    }
+    return {"sse2", UpperSSE2, LowerSSE2, MismatchSSE2, LeadingSSE2, TrailingSSE2, IsASCIISSE2, CountSSE2, DecodeSSE2, ClassifySSE2};
+#else
+    return {"scalar", UpperScalar, LowerScalar, MismatchScalar, LeadingScalar, TrailingScalar, IsASCIIScalar, CountScalar, DecodeScalar, ClassifyScalar};
+#endif
+}
+
+const SKernels &Kernels() noexcept{
+    static const SKernels Resolved = ResolveKernels();
+    return Resolved;
+}
+
+}
+
+const char *ActiveInstructionSet() noexcept{
+    return Kernels().DName;
+}
+
+void UpperASCII(const char *src, char *dst, std::size_t length) noexcept{
+    Kernels().DUpper(src, dst, length);
+}
+
+void LowerASCII(const char *src, char *dst, std::size_t length) noexcept{
+    Kernels().DLower(src, dst, length);
+}
+
+std::size_t MismatchIgnoreCaseASCII(const char *left, const char *right, std::size_t length) noexcept{
+    return Kernels().DMismatch(left, right, length);
+}
+
+std::size_t LeadingWhitespace(const char *data, std::size_t length) noexcept{
+    return Kernels().DLeading(data, length);
+}
+
+std::size_t TrimTrailingWhitespace(const char *data, std::size_t length) noexcept{
+    return Kernels().DTrailing(data, length);
+}
+
+bool IsASCII(const char *data, std::size_t length) noexcept{
+    return Kernels().DIsASCII(data, length);
+}
+
+std::size_t CountUTF8CodePoints(const char *data, std::size_t length) noexcept{
+    return Kernels().DCount(data, length);
+}
+
+std::size_t DecodeUTF8(const char *src, std::size_t length, char32_t *dst) noexcept{
+    return Kernels().DDecode(src, length, dst);
+}
+
+void ClassifyDSVBlocks(const char *data, std::size_t blocks, char delimiter, SDSVBlockMasks *masks) noexcept{
+    Kernels().DClassify(data, blocks, delimiter, masks);
+}
+
+}
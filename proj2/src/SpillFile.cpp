@@ -0,0 +1,84 @@
+#include "SpillFile.h"
+#include <cstdint>
+#include <unistd.h>
+
+CSpillFile::CSpillFile(const std::string &directory) : DFile(nullptr), DFailed(false){
+    std::string Path = directory + "/dsvspillXXXXXX";
+    int Descriptor = mkstemp(&Path[0]);
+    if(Descriptor < 0){
+        return;
+    }
+    // nobody else needs the name, so the file goes away with us
+    unlink(Path.c_str());
+    DFile = fdopen(Descriptor, "w+b");
+    if(!DFile){
+        close(Descriptor);
+        return;
+    }
+    std::setvbuf(DFile, nullptr, _IOFBF, 1 << 16);
+}
+
+CSpillFile::~CSpillFile(){
+    if(DFile){
+        std::fclose(DFile);
+    }
+}
+
+bool CSpillFile::Valid() const noexcept{
+    return DFile != nullptr;
+}
+
+bool CSpillFile::Write(const std::string_view *cells, std::size_t count) noexcept{
+    std::uint32_t Count = static_cast<std::uint32_t>(count);
+    bool Success = std::fwrite(&Count, sizeof(Count), 1, DFile) == 1;
+    for(std::size_t Index = 0; Index < count && Success; Index++){
+        std::uint32_t Length = static_cast<std::uint32_t>(cells[Index].size());
+        Success = std::fwrite(&Length, sizeof(Length), 1, DFile) == 1 && std::fwrite(cells[Index].data(), 1, Length, DFile) == Length;
+    }
+    return Success;
+}
+
+bool CSpillFile::Write(const std::vector<std::string> &row) noexcept{
+    std::uint32_t Count = static_cast<std::uint32_t>(row.size());
+    bool Success = std::fwrite(&Count, sizeof(Count), 1, DFile) == 1;
+    for(std::size_t Index = 0; Index < row.size() && Success; Index++){
+        std::uint32_t Length = static_cast<std::uint32_t>(row[Index].size());
+        Success = std::fwrite(&Length, sizeof(Length), 1, DFile) == 1 && std::fwrite(row[Index].data(), 1, Length, DFile) == Length;
+    }
+    return Success;
+}
+
+bool CSpillFile::Rewind() noexcept{
+    return std::fflush(DFile) == 0 && std::fseek(DFile, 0, SEEK_SET) == 0;
+}
+
+bool CSpillFile::Read(std::vector<std::string> &row) noexcept{
+    if(DFailed){
+        return false;
+    }
+    std::uint32_t Count;
+    std::size_t Got = std::fread(&Count, 1, sizeof(Count), DFile);
+    if(Got != sizeof(Count)){
+        // only nothing at all where a row would start is the end
+        DFailed = Got || std::ferror(DFile);
+        return false;
+    }
+    row.resize(Count);
+    for(auto &Cell : row){
+        std::uint32_t Length;
+        if(std::fread(&Length, sizeof(Length), 1, DFile) != 1){
+            DFailed = true;
+            return false;
+        }
+        Cell.resize(Length);
+        if(Length && std::fread(&Cell[0], 1, Length, DFile) != Length){
+            DFailed = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CSpillFile::Failed() const noexcept{
+    return DFailed;
+}
@@ -1,4 +1,5 @@
 #include "StringDataSource.h"
+#include <algorithm>
 
 CStringDataSource::CStringDataSource(const std::string &str) : DString(str), DIndex(0){
 
@@ -26,15 +27,8 @@ bool CStringDataSource::Peek(char &ch) noexcept{
 }
 
 bool CStringDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
-    buf.clear();
-    while(buf.size() < count){
-        char TempChar;
-        if(Get(TempChar)){
-            buf.push_back(TempChar);
-        }
-        else{
-            break;
-        }
-    }
+    std::size_t Available = DIndex < DString.length() ? std::min(count, DString.length() - DIndex) : 0;
+    buf.assign(DString.data() + DIndex, DString.data() + DIndex + Available);
+    DIndex += Available;
     return !buf.empty();
 }
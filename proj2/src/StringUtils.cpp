@@ -4,8 +4,14 @@
 
 #include <cctype>
 
+#include <cstdint>
+
+#include <cstring>
+
 #include <vector>
 
+#include "SIMDUtils.h"
+
 
 namespace StringUtils {
 
@@ -49,33 +55,11 @@ std::string Slice(const std::string &str, ssize_t start, ssize_t end) noexcept {
 
 std::string Capitalize(const std::string &str) noexcept {
 
-    //return the string if its empty
-
-    if (str.empty()){
-
-    return str;
-
-    } 
-
-    //storing input string here
+    //copy once and convert the copy in place
 
     std::string result = str;
 
-    //capatilize the first character
-
-    result[0] = std::toupper(result[0]);
-
-    //i created a for loop here based on size of result to make sure everything
-
-    //else is lower case
-
-    for (size_t i = 1; i < result.size(); ++i) {
-
-        result[i] = std::tolower(result[i]);
-
-    }
-
-    //return all characters
+    CapitalizeInPlace(result);
 
     return result;
 
@@ -84,19 +68,11 @@ std::string Capitalize(const std::string &str) noexcept {
 
 std::string Upper(const std::string &str) noexcept {
 
-    //input string here as result
-
-    std::string result = str;
-
-    //iterate to make all characters uppercase
-
-    for (size_t i = 0; i < result.size(); ++i) {
+    //size the result once, then let the vector kernel write straight into it
 
-        result[i] = std::toupper(result[i]);
-
-    }
+    std::string result(str.size(), '\0');
 
-    //return all characters remaining
+    SIMDUtils::UpperASCII(str.data(), &result[0], str.size());
 
     return result;
 
@@ -105,86 +81,69 @@ std::string Upper(const std::string &str) noexcept {
 
 std::string Lower(const std::string &str) noexcept {
 
-    //input string here
-
-    std::string result = str;
-
-    //iterate to make all characters lowercase
-
-    for (size_t i = 0; i < result.size(); ++i) {
+    //same as Upper but folding the other way
 
-        result[i] = std::tolower(result[i]);
+    std::string result(str.size(), '\0');
 
-    }
-
-    //return all characters remaining
+    SIMDUtils::LowerASCII(str.data(), &result[0], str.size());
 
     return result;
 
 }
 
 
-std::string LStrip(const std::string &str) noexcept {
-
-    size_t start = 0;
-
-
-    // go through each character from the start
-
-    while (start < str.size()) {
-
-        char currentChar = str[start];
-
+void CapitalizeInPlace(std::string &str) noexcept {
 
-        // if the current character is not a whitespace we stop the code
+    //nothing to do for an empty string
 
-        if (currentChar != ' ' && currentChar != '\t' && currentChar != '\n' && currentChar != '\r') {
+    if (str.empty()){
 
-            break;
+    return;
 
-        }
+    }
 
+    //lower everything, then raise the first character
 
-        //move to next character if it is a whitespace
+    SIMDUtils::LowerASCII(str.data(), &str[0], str.size());
 
-        start++;
+    SIMDUtils::UpperASCII(str.data(), &str[0], 1);
 
-    }
+}
 
 
-    // retuurn everything from first non white space and forward
+void UpperInPlace(std::string &str) noexcept {
 
-    return str.substr(start);
+    SIMDUtils::UpperASCII(str.data(), &str[0], str.size());
 
 }
 
 
-std::string RStrip(const std::string &str) noexcept {
+void LowerInPlace(std::string &str) noexcept {
 
-    size_t end = str.size();
+    SIMDUtils::LowerASCII(str.data(), &str[0], str.size());
 
+}
 
-    // go through each character from the end
 
-    while (end > 0) {
+std::string LStrip(const std::string &str) noexcept {
 
-        char currentChar = str[end - 1];
+    // find the first non whitespace character a vector at a time
 
+    size_t start = SIMDUtils::LeadingWhitespace(str.data(), str.size());
 
-        //if the current character is not a whitespace we stop the code
 
-        if (currentChar != ' ' && currentChar != '\t' && currentChar != '\n' && currentChar != '\r') {
+    // retuurn everything from first non white space and forward
 
-            break;
+    return str.substr(start);
 
-        }
+}
 
 
-        // move a position backward
+std::string RStrip(const std::string &str) noexcept {
 
-        end--;
+    // find the last non whitespace character scanning back from the end
 
-    }
+    size_t end = SIMDUtils::TrimTrailingWhitespace(str.data(), str.size());
 
 
     // return everything to the last non whitespace character
@@ -197,17 +156,14 @@ std::string RStrip(const std::string &str) noexcept {
 
 std::string Strip(const std::string &str) noexcept {
 
-    // first, i am removing trailing whitespace using RStrip
+    // find both ends on the original string so only the final result is copied
 
-    std::string rstripResult = RStrip(str);
+    size_t start = SIMDUtils::LeadingWhitespace(str.data(), str.size());
 
+    size_t end = start + SIMDUtils::TrimTrailingWhitespace(str.data() + start, str.size() - start);
 
-    // then i am removing leading whitespace from the result using LStrip
 
-    return LStrip(rstripResult);
-
-
-    //return Lstrip(Rstrip(str)) works here but im trying to see my thoughts worked out
+    return str.substr(start, end - start);
 
 }
 
@@ -490,64 +446,95 @@ std::string ExpandTabs(const std::string &str, int tabsize) noexcept {
 
     std::string result;  
 
-    // current column position in the string
+    const char *data = str.data();
 
-    size_t column = 0;   
+    const char *stop = data + str.size();
 
 
-    // if tab size is 0, remove all tabs from the string
+    // if tab size is 0 (or negative), remove all tabs from the string
 
-    if (tabsize == 0) {
+    if (tabsize <= 0) {
 
-        for (char c : str) {
+        result.reserve(str.size());
 
-            if (c != '\t') {
+        // copy the runs between tabs in bulk
 
-            // append non-tab characters to the result
+        for (const char *run = data; run < stop;) {
 
-                result += c;  
+            const char *tab = static_cast<const char *>(std::memchr(run, '\t', stop - run));
 
-            }
+            const char *runEnd = tab ? tab : stop;
 
-        }
+            result.append(run, runEnd - run);
 
-        // return the string with tabs removed
+            run = tab ? tab + 1 : stop;
+
+        }
 
         return result;  
 
     }
 
 
-    // process the input string and expand tabs
+    // first pass: walk the tabs to work out the exact output length
+
+    size_t column = 0;
+
+    for (const char *run = data; run < stop;) {
+
+        const char *tab = static_cast<const char *>(std::memchr(run, '\t', stop - run));
+
+        if (!tab) {
+
+            column += stop - run;
+
+            break;
+
+        }
+
+        column += tab - run;
+
+        column += tabsize - (column % tabsize);
 
-    for (char c : str) {
+        run = tab + 1;
 
-        if (c == '\t') {
+    }
 
-            // calculate the number of spaces needed to reach the next tab 
 
-            size_t spaces = tabsize - (column % tabsize);
+    // second pass: fill the presized buffer, copying the runs between tabs
 
- // append the spaces to the result
+    result.resize(column);
 
-            result.append(spaces, ' '); 
+    char *out = &result[0];
 
-// update the column position
+    column = 0;
 
-            column += spaces;  
+    for (const char *run = data; run < stop;) {
 
-        } else {
+        const char *tab = static_cast<const char *>(std::memchr(run, '\t', stop - run));
 
-            // append non-tab characters to the result
+        const char *runEnd = tab ? tab : stop;
 
-            result += c;  
+        std::memcpy(out + column, run, runEnd - run);
 
- // increment the column position
+        column += runEnd - run;
 
-            column++;    
+        if (!tab) {
+
+            break;
 
         }
 
+        // calculate the number of spaces needed to reach the next tab 
+
+        size_t spaces = tabsize - (column % tabsize);
+
+        std::memset(out + column, ' ', spaces);
+
+        column += spaces;
+
+        run = tab + 1;
+
     }
 
 // return the string with expanded tabs
@@ -568,19 +555,19 @@ std::string ExpandTabs(const std::string &str, int tabsize) noexcept {
     // and coding it is much easier this way
 
 
-    std::string l = left;
+    //compare the originals directly, folding case per character when asked
 
-    std::string r = right;
+    //instead of building lowered copies of both strings
 
-// convert to lowercase if ignorecase is true
+    const std::string &l = left;
 
-    if (ignorecase) {
+    const std::string &r = right;
 
-        l = Lower(left);
+    auto fold = [ignorecase](char ch) {
 
-        r = Lower(right);
+        return (ignorecase && ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch + ('a' - 'A')) : ch;
 
-    }
+    };
 
 //lengths of both strings
 
@@ -618,7 +605,7 @@ std::string ExpandTabs(const std::string &str, int tabsize) noexcept {
 
             int cost = 1;
 
-        if(l[i-1] == r[j-1]){
+        if(fold(l[i-1]) == fold(r[j-1])){
 
             cost = 0;
 
@@ -647,4 +634,107 @@ std::string ExpandTabs(const std::string &str, int tabsize) noexcept {
 }
 
 
+namespace {
+
+//folds the ASCII upper case letters in 8 bytes at once: a byte gets 0x20 added
+
+//when it is below 0x80 and lands in 'A'..'Z'
+
+inline std::uint64_t FoldWord(std::uint64_t word) {
+
+    const std::uint64_t high = 0x8080808080808080ULL;
+
+    const std::uint64_t ones = 0x0101010101010101ULL;
+
+    std::uint64_t heptets = word & ~high;
+
+    std::uint64_t aboveZ = heptets + ones * (0x7F - 'Z');
+
+    std::uint64_t atLeastA = heptets + ones * (0x80 - 'A');
+
+    std::uint64_t upper = (atLeastA ^ aboveZ) & ~word & high;
+
+    return word | (upper >> 2);
+
+}
+
+}
+
+
+int CompareIgnoreCase(std::string_view left, std::string_view right) noexcept {
+
+    //find the first folded difference in the shared prefix
+
+    size_t common = std::min(left.size(), right.size());
+
+    size_t index = SIMDUtils::MismatchIgnoreCaseASCII(left.data(), right.data(), common);
+
+    if (index < common) {
+
+        unsigned char l = static_cast<unsigned char>(left[index]);
+
+        unsigned char r = static_cast<unsigned char>(right[index]);
+
+        l = (l >= 'A' && l <= 'Z') ? l + ('a' - 'A') : l;
+
+        r = (r >= 'A' && r <= 'Z') ? r + ('a' - 'A') : r;
+
+        return l < r ? -1 : 1;
+
+    }
+
+    //equal prefix, the shorter string orders first
+
+    if (left.size() == right.size()) {
+
+        return 0;
+
+    }
+
+    return left.size() < right.size() ? -1 : 1;
+
+}
+
+
+std::size_t HashIgnoreCase(std::string_view str) noexcept {
+
+    //multiply-xorshift over folded 8 byte words, seeded with the length
+
+    const std::uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+
+    std::uint64_t hash = str.size() * multiplier;
+
+    size_t index = 0;
+
+    for (; index + 8 <= str.size(); index += 8) {
+
+        std::uint64_t word;
+
+        std::memcpy(&word, str.data() + index, 8);
+
+        hash = (hash ^ FoldWord(word)) * multiplier;
+
+        hash ^= hash >> 29;
+
+    }
+
+    //zero padded tail word
+
+    if (index < str.size()) {
+
+        std::uint64_t word = 0;
+
+        std::memcpy(&word, str.data() + index, str.size() - index);
+
+        hash = (hash ^ FoldWord(word)) * multiplier;
+
+        hash ^= hash >> 29;
+
+    }
+
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
+
+}
+
+
 }
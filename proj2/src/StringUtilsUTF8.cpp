@@ -0,0 +1,186 @@
+#include "StringUtils.h"
+#include "SIMDUtils.h"
+
+#include <algorithm>
+
+namespace StringUtils {
+
+namespace UTF8 {
+
+namespace {
+
+// byte offset of the code point at index, skipping over whole sequences
+size_t ByteOffset(const std::string &str, size_t index) noexcept {
+    size_t offset = 0;
+    while (index > 0 && offset < str.size()) {
+        offset++;
+        // continuation bytes belong to the code point we just stepped past
+        while (offset < str.size() && (static_cast<unsigned char>(str[offset]) & 0xC0) == 0x80) {
+            offset++;
+        }
+        index--;
+    }
+    return offset;
+}
+
+void AppendCodePoint(std::string &out, char32_t codepoint) noexcept {
+    if (codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+bool IsASCII(const std::string &str) noexcept {
+    return SIMDUtils::IsASCII(str.data(), str.size());
+}
+
+}
+
+bool IsValid(const std::string &str) noexcept {
+    if (IsASCII(str)) {
+        return true;
+    }
+    // a valid string re-encodes to exactly the same bytes
+    return Encode(Decode(str)) == str;
+}
+
+size_t Length(const std::string &str) noexcept {
+    return SIMDUtils::CountUTF8CodePoints(str.data(), str.size());
+}
+
+std::u32string Decode(const std::string &str) noexcept {
+    std::u32string result(str.size(), U'\0');
+    result.resize(SIMDUtils::DecodeUTF8(str.data(), str.size(), &result[0]));
+    return result;
+}
+
+std::string Encode(const std::u32string &str) noexcept {
+    std::string result;
+    result.reserve(str.size());
+    for (char32_t codepoint : str) {
+        // surrogates and out of range values cannot be encoded
+        if ((codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF) {
+            codepoint = 0xFFFD;
+        }
+        AppendCodePoint(result, codepoint);
+    }
+    return result;
+}
+
+std::string Slice(const std::string &str, ssize_t start, ssize_t end) noexcept {
+    ssize_t length = static_cast<ssize_t>(Length(str));
+    // same index rules as the byte version, clamped to the string
+    if (end == 0) {
+        end = length;
+    }
+    if (start < 0) {
+        start += length;
+    }
+    if (end < 0) {
+        end += length;
+    }
+    start = std::clamp<ssize_t>(start, 0, length);
+    end = std::clamp<ssize_t>(end, start, length);
+    if (length == static_cast<ssize_t>(str.size())) {
+        return str.substr(start, end - start);
+    }
+    size_t first = ByteOffset(str, start);
+    size_t last = first + ByteOffset(str.substr(first), end - start);
+    return str.substr(first, last - first);
+}
+
+std::string Center(const std::string &str, int width, char fill) noexcept {
+    if (IsASCII(str)) {
+        return StringUtils::Center(str, width, fill);
+    }
+    int padding = width - static_cast<int>(Length(str));
+    if (padding <= 0) {
+        return str;
+    }
+    int left_pad = padding / 2;
+    return std::string(left_pad, fill) + str + std::string(padding - left_pad, fill);
+}
+
+std::string LJust(const std::string &str, int width, char fill) noexcept {
+    if (IsASCII(str)) {
+        return StringUtils::LJust(str, width, fill);
+    }
+    int padding = width - static_cast<int>(Length(str));
+    if (padding <= 0) {
+        return str;
+    }
+    return str + std::string(padding, fill);
+}
+
+std::string RJust(const std::string &str, int width, char fill) noexcept {
+    if (IsASCII(str)) {
+        return StringUtils::RJust(str, width, fill);
+    }
+    int padding = width - static_cast<int>(Length(str));
+    if (padding <= 0) {
+        return str;
+    }
+    return std::string(padding, fill) + str;
+}
+
+std::string ExpandTabs(const std::string &str, int tabsize) noexcept {
+    if (IsASCII(str) || tabsize <= 0) {
+        // removing tabs does not depend on the column
+        return StringUtils::ExpandTabs(str, tabsize);
+    }
+    std::string result;
+    result.reserve(str.size());
+    size_t column = 0;
+    for (char c : str) {
+        if (c == '\t') {
+            size_t spaces = tabsize - (column % tabsize);
+            result.append(spaces, ' ');
+            column += spaces;
+        } else {
+            result += c;
+            // only lead bytes start a new column
+            column += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+        }
+    }
+    return result;
+}
+
+int EditDistance(const std::string &left, const std::string &right, bool ignorecase) noexcept {
+    if (IsASCII(left) && IsASCII(right)) {
+        return StringUtils::EditDistance(left, right, ignorecase);
+    }
+    std::u32string l = Decode(left);
+    std::u32string r = Decode(right);
+    auto fold = [ignorecase](char32_t ch) {
+        return (ignorecase && ch >= U'A' && ch <= U'Z') ? ch + (U'a' - U'A') : ch;
+    };
+    // two rolling rows of the usual dp table
+    std::vector<int> previous(r.size() + 1), current(r.size() + 1);
+    for (size_t j = 0; j <= r.size(); ++j) {
+        previous[j] = static_cast<int>(j);
+    }
+    for (size_t i = 1; i <= l.size(); ++i) {
+        current[0] = static_cast<int>(i);
+        for (size_t j = 1; j <= r.size(); ++j) {
+            int cost = fold(l[i - 1]) == fold(r[j - 1]) ? 0 : 1;
+            current[j] = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+        }
+        std::swap(previous, current);
+    }
+    return previous[r.size()];
+}
+
+}
+
+}
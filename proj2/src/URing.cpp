@@ -0,0 +1,121 @@
+#include "URing.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+CURing::CURing(unsigned entries)
+    : DRingDescriptor(-1), DEntries(0), DSubmitRing(MAP_FAILED), DSubmitRingSize(0), DCompleteRing(MAP_FAILED), DCompleteRingSize(0), DSubmitEntries(nullptr){
+    io_uring_params Params;
+    std::memset(&Params, 0, sizeof(Params));
+    DRingDescriptor = static_cast<int>(syscall(__NR_io_uring_setup, entries, &Params));
+    if(DRingDescriptor < 0){
+        return;
+    }
+    DEntries = Params.sq_entries;
+    DSubmitRingSize = Params.sq_off.array + Params.sq_entries * sizeof(unsigned);
+    DCompleteRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+    bool SingleMap = Params.features & IORING_FEAT_SINGLE_MMAP;
+    if(SingleMap){
+        DSubmitRingSize = DCompleteRingSize = std::max(DSubmitRingSize, DCompleteRingSize);
+    }
+    DSubmitRing = mmap(nullptr, DSubmitRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, DRingDescriptor, IORING_OFF_SQ_RING);
+    if(SingleMap){
+        DCompleteRing = DSubmitRing;
+    }
+    else if(DSubmitRing != MAP_FAILED){
+        DCompleteRing = mmap(nullptr, DCompleteRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, DRingDescriptor, IORING_OFF_CQ_RING);
+    }
+    void *Entries = MAP_FAILED;
+    if(DCompleteRing != MAP_FAILED){
+        Entries = mmap(nullptr, Params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, DRingDescriptor, IORING_OFF_SQES);
+    }
+    if(Entries == MAP_FAILED){
+        // leave the object invalid; the destructor undoes whatever was mapped
+        close(DRingDescriptor);
+        DRingDescriptor = -1;
+        return;
+    }
+    DSubmitEntries = static_cast<io_uring_sqe *>(Entries);
+    char *Submit = static_cast<char *>(DSubmitRing);
+    DSubmitHead = reinterpret_cast<unsigned *>(Submit + Params.sq_off.head);
+    DSubmitTail = reinterpret_cast<unsigned *>(Submit + Params.sq_off.tail);
+    DSubmitMask = reinterpret_cast<unsigned *>(Submit + Params.sq_off.ring_mask);
+    DSubmitArray = reinterpret_cast<unsigned *>(Submit + Params.sq_off.array);
+    char *Complete = static_cast<char *>(DCompleteRing);
+    DCompleteHead = reinterpret_cast<unsigned *>(Complete + Params.cq_off.head);
+    DCompleteTail = reinterpret_cast<unsigned *>(Complete + Params.cq_off.tail);
+    DCompleteMask = reinterpret_cast<unsigned *>(Complete + Params.cq_off.ring_mask);
+    DCompleteEntries = reinterpret_cast<io_uring_cqe *>(Complete + Params.cq_off.cqes);
+}
+
+CURing::~CURing(){
+    if(DSubmitEntries){
+        munmap(DSubmitEntries, DEntries * sizeof(io_uring_sqe));
+    }
+    if(DCompleteRing != MAP_FAILED && DCompleteRing != DSubmitRing){
+        munmap(DCompleteRing, DCompleteRingSize);
+    }
+    if(DSubmitRing != MAP_FAILED){
+        munmap(DSubmitRing, DSubmitRingSize);
+    }
+    if(DRingDescriptor >= 0){
+        close(DRingDescriptor);
+    }
+}
+
+bool CURing::Valid() const noexcept{
+    return DRingDescriptor >= 0;
+}
+
+// fills the next submission entry and tells the kernel about it
+bool CURing::Submit(std::uint8_t opcode, int fd, void *buf, unsigned length, std::uint64_t offset, std::uint64_t userdata) noexcept{
+    unsigned Tail = *DSubmitTail;
+    if(Tail - __atomic_load_n(DSubmitHead, __ATOMIC_ACQUIRE) >= DEntries){
+        return false;
+    }
+    unsigned Index = Tail & *DSubmitMask;
+    io_uring_sqe &Entry = DSubmitEntries[Index];
+    std::memset(&Entry, 0, sizeof(Entry));
+    Entry.opcode = opcode;
+    Entry.fd = fd;
+    Entry.addr = reinterpret_cast<std::uint64_t>(buf);
+    Entry.len = length;
+    Entry.off = offset;
+    Entry.user_data = userdata;
+    DSubmitArray[Index] = Index;
+    __atomic_store_n(DSubmitTail, Tail + 1, __ATOMIC_RELEASE);
+    while(syscall(__NR_io_uring_enter, DRingDescriptor, 1, 0, 0, nullptr, 0) < 0){
+        if(errno != EINTR && errno != EAGAIN){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CURing::SubmitRead(int fd, void *buf, unsigned length, std::uint64_t offset, std::uint64_t userdata) noexcept{
+    return Submit(IORING_OP_READ, fd, buf, length, offset, userdata);
+}
+
+bool CURing::SubmitWrite(int fd, const void *buf, unsigned length, std::uint64_t offset, std::uint64_t userdata) noexcept{
+    return Submit(IORING_OP_WRITE, fd, const_cast<void *>(buf), length, offset, userdata);
+}
+
+bool CURing::WaitCompletion(std::uint64_t &userdata, std::int32_t &result) noexcept{
+    while(true){
+        unsigned Head = *DCompleteHead;
+        if(Head != __atomic_load_n(DCompleteTail, __ATOMIC_ACQUIRE)){
+            io_uring_cqe &Entry = DCompleteEntries[Head & *DCompleteMask];
+            userdata = Entry.user_data;
+            result = Entry.res;
+            __atomic_store_n(DCompleteHead, Head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+        if(syscall(__NR_io_uring_enter, DRingDescriptor, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR){
+            return false;
+        }
+    }
+}
@@ -0,0 +1,228 @@
+#include "URingFileDataSink.h"
+#include "URing.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace{
+const std::size_t DirectAlignment = 4096;
+}
+
+struct CURingFileDataSink::SImplementation{
+    struct SBuffer{
+        char *DData;
+        bool DInFlight;
+        std::size_t DLength;
+        std::uint64_t DOffset;
+    };
+
+    int DFileDescriptor;
+    bool DDirect;
+    std::size_t DBufferSize;
+    std::unique_ptr<CURing> DRing;
+    std::vector<SBuffer> DBuffers;
+    // buffer being filled and how much of it is used
+    std::size_t DCurrent;
+    std::size_t DFill;
+    std::uint64_t DOffset;
+    std::size_t DInFlight;
+    bool DFailed;
+
+    SImplementation(const std::string &filename, bool append, std::size_t buffersize, std::size_t depth, bool direct, bool useuring)
+        : DFileDescriptor(-1), DDirect(false), DCurrent(0), DFill(0), DOffset(0), DInFlight(0), DFailed(false){
+        DBufferSize = (std::max<std::size_t>(buffersize, 1) + DirectAlignment - 1) / DirectAlignment * DirectAlignment;
+        int Flags = O_WRONLY | O_CREAT | O_CLOEXEC | (append ? 0 : O_TRUNC);
+        if(direct){
+            DFileDescriptor = open(filename.c_str(), Flags | O_DIRECT, 0644);
+            DDirect = DFileDescriptor >= 0;
+        }
+        if(DFileDescriptor < 0){
+            DFileDescriptor = open(filename.c_str(), Flags, 0644);
+        }
+        if(DFileDescriptor < 0){
+            DFailed = true;
+            return;
+        }
+        if(append){
+            off_t End = lseek(DFileDescriptor, 0, SEEK_END);
+            DOffset = End < 0 ? 0 : End;
+            // direct writes need an aligned starting offset
+            if(DOffset % DirectAlignment){
+                DisableDirect();
+            }
+        }
+        depth = std::max<std::size_t>(depth, 1);
+        if(useuring){
+            DRing = std::make_unique<CURing>(static_cast<unsigned>(depth));
+            if(!DRing->Valid()){
+                DRing.reset();
+            }
+        }
+        for(std::size_t Index = 0; Index < depth; Index++){
+            DBuffers.push_back({static_cast<char *>(std::aligned_alloc(DirectAlignment, DBufferSize)), false, 0, 0});
+        }
+    }
+
+    ~SImplementation(){
+        Flush();
+        for(auto &Buffer : DBuffers){
+            // a write that was never reaped may still be reading the
+            // buffer, so it is leaked rather than freed under the kernel
+            if(!Buffer.DInFlight){
+                std::free(Buffer.DData);
+            }
+        }
+        if(DFileDescriptor >= 0){
+            close(DFileDescriptor);
+        }
+    }
+
+    void DisableDirect(){
+        if(DDirect){
+            fcntl(DFileDescriptor, F_SETFL, fcntl(DFileDescriptor, F_GETFL) & ~O_DIRECT);
+            DDirect = false;
+        }
+    }
+
+    // synchronous write of a whole range, used for the fallback and for
+    // finishing short writes
+    bool WriteAt(const char *data, std::size_t length, std::uint64_t offset){
+        while(length){
+            ssize_t Result = pwrite(DFileDescriptor, data, length, offset);
+            if(Result < 0){
+                if(errno == EINTR){
+                    continue;
+                }
+                return false;
+            }
+            data += Result;
+            length -= Result;
+            offset += Result;
+        }
+        return true;
+    }
+
+    // reaps one write completion; false when none could be reaped, which
+    // leaves the in-flight buffers owned by the kernel for good
+    bool Complete(){
+        std::uint64_t Index;
+        std::int32_t Result;
+        if(!DRing->WaitCompletion(Index, Result)){
+            DFailed = true;
+            return false;
+        }
+        SBuffer &Buffer = DBuffers[Index];
+        if(Result < 0){
+            DFailed = true;
+        }
+        else if(static_cast<std::size_t>(Result) < Buffer.DLength){
+            DisableDirect();
+            if(!WriteAt(Buffer.DData + Result, Buffer.DLength - Result, Buffer.DOffset + Result)){
+                DFailed = true;
+            }
+        }
+        Buffer.DInFlight = false;
+        DInFlight--;
+        return true;
+    }
+
+    // sends the current buffer off and moves on to the next free one
+    void SubmitCurrent(){
+        SBuffer &Buffer = DBuffers[DCurrent];
+        Buffer.DLength = DFill;
+        Buffer.DOffset = DOffset;
+        DOffset += DFill;
+        DFill = 0;
+        if(DRing && DRing->SubmitWrite(DFileDescriptor, Buffer.DData, static_cast<unsigned>(Buffer.DLength), Buffer.DOffset, DCurrent)){
+            Buffer.DInFlight = true;
+            DInFlight++;
+        }
+        else if(!WriteAt(Buffer.DData, Buffer.DLength, Buffer.DOffset)){
+            DFailed = true;
+        }
+        DCurrent = (DCurrent + 1) % DBuffers.size();
+        while(DBuffers[DCurrent].DInFlight){
+            if(!Complete()){
+                return;
+            }
+        }
+    }
+
+    bool Append(const char *data, std::size_t length){
+        if(DFailed){
+            return false;
+        }
+        while(length){
+            if(DFill == DBufferSize){
+                SubmitCurrent();
+                // the next buffer may still be in flight after a failed reap
+                if(DFailed){
+                    return false;
+                }
+            }
+            std::size_t Chunk = std::min(length, DBufferSize - DFill);
+            std::memcpy(DBuffers[DCurrent].DData + DFill, data, Chunk);
+            DFill += Chunk;
+            data += Chunk;
+            length -= Chunk;
+        }
+        return !DFailed;
+    }
+
+    bool Flush(){
+        if(DFileDescriptor < 0){
+            return false;
+        }
+        while(DInFlight){
+            if(!Complete()){
+                return false;
+            }
+        }
+        if(DFill){
+            // a partial block cannot go through O_DIRECT, and neither can
+            // anything after it
+            DisableDirect();
+            if(!WriteAt(DBuffers[DCurrent].DData, DFill, DOffset)){
+                DFailed = true;
+            }
+            DOffset += DFill;
+            DFill = 0;
+        }
+        return !DFailed;
+    }
+};
+
+CURingFileDataSink::CURingFileDataSink(const std::string &filename, bool append, std::size_t buffersize, std::size_t depth, bool direct, bool useuring)
+    : DImplementation(std::make_unique<SImplementation>(filename, append, buffersize, depth, direct, useuring)){
+
+}
+
+CURingFileDataSink::~CURingFileDataSink() = default;
+
+bool CURingFileDataSink::IsOpen() const noexcept{
+    return DImplementation->DFileDescriptor >= 0;
+}
+
+bool CURingFileDataSink::UsingURing() const noexcept{
+    return DImplementation->DRing != nullptr;
+}
+
+bool CURingFileDataSink::Put(const char &ch) noexcept{
+    auto &Impl = *DImplementation;
+    if(Impl.DFill < Impl.DBufferSize && !Impl.DFailed){
+        Impl.DBuffers[Impl.DCurrent].DData[Impl.DFill++] = ch;
+        return true;
+    }
+    return Impl.Append(&ch, 1);
+}
+
+bool CURingFileDataSink::Write(const std::vector<char> &buf) noexcept{
+    return DImplementation->Append(buf.data(), buf.size());
+}
+
+bool CURingFileDataSink::Flush() noexcept{
+    return DImplementation->Flush();
+}
@@ -0,0 +1,244 @@
+#include "URingFileDataSource.h"
+#include "URing.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace{
+// O_DIRECT needs block aligned buffers, sizes and offsets
+const std::size_t DirectAlignment = 4096;
+}
+
+struct CURingFileDataSource::SImplementation{
+    enum class EState{Idle, InFlight, Ready};
+    struct SBuffer{
+        char *DData;
+        EState DState;
+        // result of the latest read, not yet added to DFilled
+        std::int32_t DResult;
+        // file offset of the block and the bytes of it read so far
+        std::uint64_t DOffset;
+        std::size_t DFilled;
+    };
+
+    int DFileDescriptor;
+    std::size_t DBufferSize;
+    std::unique_ptr<CURing> DRing;
+    // buffer i holds file blocks i, i + depth, i + 2 * depth ...
+    std::vector<SBuffer> DBuffers;
+    std::size_t DHead;
+    std::size_t DPosition;
+    // cached view of the head buffer once its read has completed
+    const char *DHeadData;
+    std::size_t DHeadLength;
+    std::uint64_t DNextOffset;
+    // size at open; a short read before it is retried rather than taken
+    // for the end of the file
+    std::uint64_t DFileSize;
+    std::size_t DInFlight;
+    bool DEndOfFile;
+    bool DFailed;
+
+    SImplementation(const std::string &filename, std::size_t buffersize, std::size_t depth, bool direct, bool useuring)
+        : DFileDescriptor(-1), DHead(0), DPosition(0), DHeadData(nullptr), DHeadLength(0), DNextOffset(0), DFileSize(0), DInFlight(0), DEndOfFile(false), DFailed(false){
+        DBufferSize = (std::max<std::size_t>(buffersize, 1) + DirectAlignment - 1) / DirectAlignment * DirectAlignment;
+        if(direct){
+            DFileDescriptor = open(filename.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+        }
+        // filesystems without O_DIRECT (tmpfs, ...) get buffered reads
+        if(DFileDescriptor < 0){
+            DFileDescriptor = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        if(DFileDescriptor < 0){
+            DEndOfFile = true;
+            return;
+        }
+        struct stat Status;
+        if(fstat(DFileDescriptor, &Status) == 0){
+            DFileSize = Status.st_size;
+        }
+        depth = std::max<std::size_t>(depth, 1);
+        if(useuring){
+            DRing = std::make_unique<CURing>(static_cast<unsigned>(depth));
+            if(!DRing->Valid()){
+                DRing.reset();
+            }
+        }
+        for(std::size_t Index = 0; Index < depth; Index++){
+            DBuffers.push_back({static_cast<char *>(std::aligned_alloc(DirectAlignment, DBufferSize)), EState::Idle, 0, 0, 0});
+        }
+        for(std::size_t Index = 0; Index < depth; Index++){
+            Issue(Index);
+        }
+    }
+
+    ~SImplementation(){
+        // the kernel may still be writing into buffers past the end of file
+        while(DInFlight){
+            if(!Complete()){
+                // nothing tells when those reads are done, so the buffers
+                // are leaked rather than freed under the kernel
+                DBuffers.clear();
+                break;
+            }
+        }
+        for(auto &Buffer : DBuffers){
+            std::free(Buffer.DData);
+        }
+        if(DFileDescriptor >= 0){
+            close(DFileDescriptor);
+        }
+    }
+
+    // starts reading the next file block into a buffer
+    void Issue(std::size_t index){
+        SBuffer &Buffer = DBuffers[index];
+        Buffer.DOffset = DNextOffset;
+        Buffer.DFilled = 0;
+        DNextOffset += DBufferSize;
+        Submit(index);
+    }
+
+    // reads the part of a buffer's block that is still missing
+    void Submit(std::size_t index){
+        SBuffer &Buffer = DBuffers[index];
+        char *Data = Buffer.DData + Buffer.DFilled;
+        std::size_t Length = DBufferSize - Buffer.DFilled;
+        std::uint64_t Offset = Buffer.DOffset + Buffer.DFilled;
+        if(DRing && DRing->SubmitRead(DFileDescriptor, Data, static_cast<unsigned>(Length), Offset, index)){
+            Buffer.DState = EState::InFlight;
+            DInFlight++;
+            return;
+        }
+        // synchronous fallback
+        ssize_t Result;
+        do{
+            Result = pread(DFileDescriptor, Data, Length, Offset);
+        }while(Result < 0 && errno == EINTR);
+        Buffer.DResult = Result < 0 ? -errno : static_cast<std::int32_t>(Result);
+        Buffer.DState = EState::Ready;
+    }
+
+    // reaps one completion
+    bool Complete(){
+        std::uint64_t Index;
+        std::int32_t Result;
+        if(!DRing->WaitCompletion(Index, Result)){
+            return false;
+        }
+        DBuffers[Index].DResult = Result;
+        DBuffers[Index].DState = EState::Ready;
+        DInFlight--;
+        return true;
+    }
+
+    // makes sure the head buffer has unread bytes; false at end of file
+    bool Fill(){
+        if(DHeadData && DPosition < DHeadLength){
+            return true;
+        }
+        DHeadData = nullptr;
+        while(!DEndOfFile){
+            SBuffer &Buffer = DBuffers[DHead];
+            while(Buffer.DState == EState::InFlight){
+                if(!Complete()){
+                    DFailed = DEndOfFile = true;
+                    return false;
+                }
+            }
+            if(Buffer.DResult < 0){
+                DFailed = DEndOfFile = true;
+                return false;
+            }
+            if(Buffer.DResult > 0){
+                Buffer.DFilled += Buffer.DResult;
+                Buffer.DResult = 0;
+                // short of the end of the file, so the rest is still to come;
+                // with O_DIRECT a misaligned remainder fails instead
+                if(Buffer.DFilled < DBufferSize && Buffer.DOffset + Buffer.DFilled < DFileSize){
+                    Submit(DHead);
+                    continue;
+                }
+            }
+            if(DPosition < Buffer.DFilled){
+                DHeadData = Buffer.DData;
+                DHeadLength = Buffer.DFilled;
+                return true;
+            }
+            // a short block is the last one in the file
+            if(Buffer.DFilled < DBufferSize){
+                DEndOfFile = true;
+                return false;
+            }
+            Issue(DHead);
+            DHead = (DHead + 1) % DBuffers.size();
+            DPosition = 0;
+        }
+        return false;
+    }
+
+    const char *Current() const{
+        return DHeadData + DPosition;
+    }
+
+    std::size_t Available() const{
+        return DHeadLength - DPosition;
+    }
+};
+
+CURingFileDataSource::CURingFileDataSource(const std::string &filename, std::size_t buffersize, std::size_t depth, bool direct, bool useuring)
+    : DImplementation(std::make_unique<SImplementation>(filename, buffersize, depth, direct, useuring)){
+
+}
+
+CURingFileDataSource::~CURingFileDataSource() = default;
+
+bool CURingFileDataSource::IsOpen() const noexcept{
+    return DImplementation->DFileDescriptor >= 0;
+}
+
+bool CURingFileDataSource::UsingURing() const noexcept{
+    return DImplementation->DRing != nullptr;
+}
+
+bool CURingFileDataSource::Failed() const noexcept{
+    return DImplementation->DFailed;
+}
+
+bool CURingFileDataSource::End() const noexcept{
+    return !DImplementation->Fill();
+}
+
+bool CURingFileDataSource::Get(char &ch) noexcept{
+    if(!DImplementation->Fill()){
+        return false;
+    }
+    ch = *DImplementation->Current();
+    DImplementation->DPosition++;
+    return true;
+}
+
+bool CURingFileDataSource::Peek(char &ch) noexcept{
+    if(!DImplementation->Fill()){
+        return false;
+    }
+    ch = *DImplementation->Current();
+    return true;
+}
+
+bool CURingFileDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.resize(count);
+    std::size_t Copied = 0;
+    while(Copied < count && DImplementation->Fill()){
+        std::size_t Chunk = std::min(count - Copied, DImplementation->Available());
+        std::memcpy(buf.data() + Copied, DImplementation->Current(), Chunk);
+        DImplementation->DPosition += Chunk;
+        Copied += Chunk;
+    }
+    buf.resize(Copied);
+    return Copied > 0;
+}
@@ -0,0 +1,161 @@
+#include "XMLBinding.h"
+#include "Metrics.h"
+#include <cstring>
+#include <expat.h>
+
+struct CXMLBindingParser::SImplementation{
+    static constexpr std::size_t ReadSize = 1 << 16;
+
+    std::shared_ptr<CDataSource> DSource;
+    const XMLBinding::SType &DType;
+    XML_Parser DParser;
+    std::vector<char> DReadBuffer;
+    // elements open inside the value being read, empty between values
+    std::vector<XMLBinding::SFrame> DFrames;
+    // text of the open elements that take it, innermost last
+    std::string DText;
+    void *DObject;
+    bool DComplete;
+    bool DFailed;
+    bool DBadValue;
+
+    SImplementation(std::shared_ptr<CDataSource> source, const XMLBinding::SType &type)
+        : DSource(std::move(source)), DType(type), DParser(XML_ParserCreate(nullptr)), DObject(nullptr), DComplete(false), DFailed(false), DBadValue(false){
+        XML_SetUserData(DParser, this);
+        XML_SetElementHandler(DParser, StartElementHandler, EndElementHandler);
+        XML_SetCharacterDataHandler(DParser, CharDataHandler);
+    }
+
+    ~SImplementation(){
+        XML_ParserFree(DParser);
+    }
+
+    // a value that does not convert ends the document like a syntax error
+    void Abort(){
+        DBadValue = true;
+        XML_StopParser(DParser, XML_FALSE);
+    }
+
+    static void StartElementHandler(void *userdata, const char *name, const char **attributes){
+        auto *Implementation = static_cast<SImplementation *>(userdata);
+        XMLBinding::SFrame Frame;
+        if(Implementation->DFrames.empty()){
+            if(Implementation->DType.DElement != name){
+                return;
+            }
+            Frame.DType = &Implementation->DType;
+            Frame.DObject = Implementation->DObject;
+            Frame.DAssign = Implementation->DType.DText;
+        }
+        else{
+            const XMLBinding::SFrame &Parent = Implementation->DFrames.back();
+            // children of skipped elements and of scalars are skipped too
+            if(Parent.DType){
+                Parent.DType->DChild(Parent.DObject, name, Frame);
+            }
+        }
+        if(Frame.DType){
+            for(const char **Attribute = attributes; *Attribute; Attribute += 2){
+                if(!Frame.DType->DAttribute(Frame.DObject, Attribute[0], Attribute[1])){
+                    Implementation->Abort();
+                    return;
+                }
+            }
+        }
+        Frame.DTextStart = Implementation->DText.size();
+        Implementation->DFrames.push_back(Frame);
+    }
+
+    static void EndElementHandler(void *userdata, const char *){
+        auto *Implementation = static_cast<SImplementation *>(userdata);
+        if(Implementation->DFrames.empty()){
+            return;
+        }
+        XMLBinding::SFrame Frame = Implementation->DFrames.back();
+        Implementation->DFrames.pop_back();
+        if(Frame.DAssign){
+            std::string_view Text(Implementation->DText);
+            if(!Frame.DAssign(Frame.DObject, Text.substr(Frame.DTextStart))){
+                Implementation->Abort();
+                return;
+            }
+            Implementation->DText.resize(Frame.DTextStart);
+        }
+        if(Implementation->DFrames.empty()){
+            // the value is whole; the rest of the input waits for the next Read
+            DSV_METRIC_ADD(EntitiesRead, 1);
+            Implementation->DComplete = true;
+            XML_StopParser(Implementation->DParser, XML_TRUE);
+        }
+    }
+
+    static void CharDataHandler(void *userdata, const char *data, int length){
+        auto *Implementation = static_cast<SImplementation *>(userdata);
+        if(!Implementation->DFrames.empty() && Implementation->DFrames.back().DAssign){
+            Implementation->DText.append(data, length);
+        }
+    }
+
+    bool Read(void *object){
+        if(DFailed){
+            return false;
+        }
+        DObject = object;
+        DComplete = false;
+        while(!DComplete){
+            XML_ParsingStatus Status;
+            XML_GetParsingStatus(DParser, &Status);
+            XML_Status Result;
+            if(Status.parsing == XML_FINISHED){
+                return false;
+            }
+            if(Status.parsing == XML_SUSPENDED){
+                Result = XML_ResumeParser(DParser);
+            }
+            else if(DSource->Read(DReadBuffer, ReadSize)){
+                DSV_METRIC_ADD(BytesRead, DReadBuffer.size());
+                // expat keeps unparsed input in its own buffer while suspended
+                void *Buffer = XML_GetBuffer(DParser, static_cast<int>(DReadBuffer.size()));
+                if(!Buffer){
+                    DFailed = true;
+                    return false;
+                }
+                std::memcpy(Buffer, DReadBuffer.data(), DReadBuffer.size());
+                Result = XML_ParseBuffer(DParser, static_cast<int>(DReadBuffer.size()), XML_FALSE);
+            }
+            else{
+                Result = XML_ParseBuffer(DParser, 0, XML_TRUE);
+            }
+            if(Result == XML_STATUS_ERROR){
+                DFailed = true;
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+CXMLBindingParser::CXMLBindingParser(std::shared_ptr<CDataSource> source, const XMLBinding::SType &type)
+    : DImplementation(std::make_unique<SImplementation>(std::move(source), type)){
+
+}
+
+CXMLBindingParser::~CXMLBindingParser() = default;
+
+bool CXMLBindingParser::Read(void *object){
+    return DImplementation->Read(object);
+}
+
+bool CXMLBindingParser::Failed() const noexcept{
+    return DImplementation->DFailed;
+}
+
+std::string CXMLBindingParser::ErrorMessage() const{
+    if(DImplementation->DBadValue){
+        return "value does not convert to its field";
+    }
+    if(!DImplementation->DFailed){
+        return std::string();
+    }
+    return XML_ErrorString(XML_GetErrorCode(DImplementation->DParser));
+}
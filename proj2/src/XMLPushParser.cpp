@@ -0,0 +1,211 @@
+#include "XMLPushParser.h"
+#include "Metrics.h"
+#include <climits>
+#include <expat.h>
+
+struct CXMLPushParser::SImplementation{
+    TEntityCallback DCallback;
+    bool DSkipCharData;
+    XML_Parser DParser;
+    // entity handed to the callback, its strings keep their capacity
+    SXMLEntity DEntity;
+    // character data arrives from expat in pieces and is joined here
+    std::string DCharData;
+    bool DFailed;
+    bool DFinished;
+    // input offset of expat's byte 0, and the length of the synthetic tags
+    // parsed ahead of the real input after resuming from a checkpoint
+    std::uint64_t DBase;
+    std::uint64_t DPrefixLength;
+    // start tags of the synthetic prefix still to be swallowed
+    std::size_t DSuppress;
+    // bytes handed to expat since the reset, prefix included
+    std::uint64_t DParsed;
+    std::uint64_t DOffset;
+    bool DEmptyElement;
+
+    SImplementation(TEntityCallback callback, bool skipcdata)
+        : DCallback(std::move(callback)), DSkipCharData(skipcdata), DParser(XML_ParserCreate(nullptr)), DFailed(false), DFinished(false), DBase(0), DPrefixLength(0), DSuppress(0), DParsed(0), DOffset(0), DEmptyElement(false){
+        SetHandlers();
+    }
+
+    ~SImplementation(){
+        XML_ParserFree(DParser);
+    }
+
+    void SetHandlers(){
+        XML_SetUserData(DParser, this);
+        XML_SetElementHandler(DParser, StartElementHandler, EndElementHandler);
+        XML_SetCharacterDataHandler(DParser, CharDataHandler);
+    }
+
+    void Deliver(){
+        DSV_METRIC_ADD(EntitiesRead, 1);
+        DCallback(DEntity);
+    }
+
+    // maps a position in what expat has parsed to an input offset
+    void MarkOffset(std::uint64_t parsed){
+        DOffset = DBase + (parsed > DPrefixLength ? parsed - DPrefixLength : 0);
+    }
+
+    // the current event ends at its last byte, or starts there when before is set
+    void MarkEvent(bool before){
+        std::uint64_t Index = XML_GetCurrentByteIndex(DParser);
+        MarkOffset(before ? Index : Index + XML_GetCurrentByteCount(DParser));
+    }
+
+    void FlushCharData(){
+        if(DCharData.empty()){
+            return;
+        }
+        if(!DSkipCharData){
+            DEntity.DType = SXMLEntity::EType::CharData;
+            DEntity.DNameData.swap(DCharData);
+            DEntity.DAttributes.clear();
+            Deliver();
+        }
+        DCharData.clear();
+    }
+
+    static void StartElementHandler(void *userdata, const char *name, const char **attributes){
+        auto *Implementation = static_cast<SImplementation *>(userdata);
+        Implementation->MarkEvent(true);
+        Implementation->FlushCharData();
+        if(Implementation->DSuppress){
+            Implementation->DSuppress--;
+            return;
+        }
+        Implementation->MarkEvent(false);
+        Implementation->DEmptyElement = Implementation->SelfClosing();
+        SXMLEntity &Entity = Implementation->DEntity;
+        Entity.DType = SXMLEntity::EType::StartElement;
+        Entity.DNameData.assign(name);
+        // overwrite the previous pairs in place so their strings are reused
+        std::size_t Count = 0;
+        for(int Index = 0; attributes[Index]; Index += 2){
+            if(Count == Entity.DAttributes.size()){
+                Entity.DAttributes.emplace_back();
+            }
+            Entity.DAttributes[Count].first.assign(attributes[Index]);
+            Entity.DAttributes[Count].second.assign(attributes[Index + 1]);
+            Count++;
+        }
+        Entity.DAttributes.resize(Count);
+        Implementation->Deliver();
+    }
+
+    static void EndElementHandler(void *userdata, const char *name){
+        auto *Implementation = static_cast<SImplementation *>(userdata);
+        Implementation->MarkEvent(true);
+        Implementation->FlushCharData();
+        Implementation->MarkEvent(false);
+        Implementation->DEmptyElement = false;
+        SXMLEntity &Entity = Implementation->DEntity;
+        Entity.DType = SXMLEntity::EType::EndElement;
+        Entity.DNameData.assign(name);
+        Entity.DAttributes.clear();
+        Implementation->Deliver();
+    }
+
+    // whether the start tag being reported ends in "/>"; expat keeps the
+    // whole tag in its buffer while reporting it
+    bool SelfClosing() const{
+        int Offset, Size;
+        const char *Context = XML_GetInputContext(DParser, &Offset, &Size);
+        int Count = XML_GetCurrentByteCount(DParser);
+        return Context && Count >= 2 && Offset + Count <= Size && Context[Offset + Count - 2] == '/';
+    }
+
+    static void CharDataHandler(void *userdata, const char *data, int length){
+        static_cast<SImplementation *>(userdata)->DCharData.append(data, length);
+    }
+
+    bool Parse(const char *data, std::size_t length, bool final){
+        if(DFailed || DFinished){
+            return false;
+        }
+        DSV_METRIC_ADD(BytesRead, length);
+        DParsed += length;
+        // expat takes an int length, so very large buffers go in pieces
+        do{
+            int Piece = static_cast<int>(std::min<std::size_t>(length, INT_MAX));
+            bool Last = final && static_cast<std::size_t>(Piece) == length;
+            if(XML_Parse(DParser, data, Piece, Last) == XML_STATUS_ERROR){
+                DFailed = true;
+                return false;
+            }
+            data += Piece;
+            length -= Piece;
+        }while(length);
+        if(final){
+            MarkOffset(DParsed);
+            FlushCharData();
+            DFinished = true;
+        }
+        return true;
+    }
+
+    void Reset(const SXMLCheckpoint &checkpoint){
+        XML_ParserReset(DParser, nullptr);
+        SetHandlers();
+        DCharData.clear();
+        DFailed = false;
+        DFinished = false;
+        DBase = checkpoint.DOffset;
+        DOffset = checkpoint.DOffset;
+        DEmptyElement = false;
+        std::string Prefix;
+        for(auto &Name : checkpoint.DOpenElements){
+            Prefix += "<" + Name + ">";
+        }
+        DSuppress = checkpoint.DOpenElements.size();
+        if(checkpoint.DCloseInnermost && !checkpoint.DOpenElements.empty()){
+            Prefix += "</" + checkpoint.DOpenElements.back() + ">";
+        }
+        DPrefixLength = Prefix.size();
+        DParsed = Prefix.size();
+        if(!Prefix.empty() && XML_Parse(DParser, Prefix.data(), static_cast<int>(Prefix.size()), 0) == XML_STATUS_ERROR){
+            DFailed = true;
+        }
+        DSuppress = 0;
+    }
+};
+
+CXMLPushParser::CXMLPushParser(TEntityCallback callback, bool skipcdata)
+    : DImplementation(std::make_unique<SImplementation>(std::move(callback), skipcdata)){
+
+}
+
+CXMLPushParser::~CXMLPushParser() = default;
+
+bool CXMLPushParser::Feed(const char *data, std::size_t length){
+    return DImplementation->Parse(data, length, false);
+}
+
+bool CXMLPushParser::Finish(){
+    return DImplementation->Parse(nullptr, 0, true);
+}
+
+void CXMLPushParser::Reset(const SXMLCheckpoint &checkpoint){
+    DImplementation->Reset(checkpoint);
+}
+
+std::uint64_t CXMLPushParser::Offset() const noexcept{
+    return DImplementation->DOffset;
+}
+
+bool CXMLPushParser::EmptyElement() const noexcept{
+    return DImplementation->DEmptyElement;
+}
+
+bool CXMLPushParser::Failed() const noexcept{
+    return DImplementation->DFailed;
+}
+
+std::string CXMLPushParser::ErrorMessage() const{
+    if(!DImplementation->DFailed){
+        return std::string();
+    }
+    return XML_ErrorString(XML_GetErrorCode(DImplementation->DParser));
+}
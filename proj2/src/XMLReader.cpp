@@ -1,6 +1,6 @@
 #include "XMLReader.h" // includes the XMLReader class definition
+#include "Metrics.h"
 #include <expat.h>     // XML parsing library (Expat)
-#include <queue>       // std::queue for storing parsed XML entities
 #include <memory>      // for std::shared_ptr and std::unique_ptr
 #include <vector>      // for std::vector used to buffer data chunks
 
@@ -10,12 +10,56 @@ struct CXMLReader::SImplementation {
     std::shared_ptr<CDataSource> DataSource;
     // XML parser (from Expat) to handle parsing
     XML_Parser Parser;
-    // queue to store parsed XML entities for processing
-    std::queue<SXMLEntity> EntityQueue;
+    // a queued entity; its attributes live in AttributePool so reusing a slot
+    // for a different kind of entity never throws away attribute strings
+    struct SQueuedEntity {
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+        SXMLEntity::EType DType;
+        std::pmr::string DNameData;
+        size_t DFirstAttribute;
+        size_t DAttributeCount;
+        bool DPartial;
+
+        explicit SQueuedEntity(allocator_type alloc = {})
+            : DType(SXMLEntity::EType::CharData), DNameData(alloc), DFirstAttribute(0), DAttributeCount(0), DPartial(false) {}
+        SQueuedEntity(const SQueuedEntity& other, allocator_type alloc)
+            : DType(other.DType), DNameData(other.DNameData, alloc), DFirstAttribute(other.DFirstAttribute), DAttributeCount(other.DAttributeCount), DPartial(other.DPartial) {}
+        SQueuedEntity(SQueuedEntity&& other, allocator_type alloc)
+            : DType(other.DType), DNameData(std::move(other.DNameData), alloc), DFirstAttribute(other.DFirstAttribute), DAttributeCount(other.DAttributeCount), DPartial(other.DPartial) {}
+        SQueuedEntity(const SQueuedEntity& other) = default;
+        SQueuedEntity(SQueuedEntity&& other) noexcept = default;
+    };
+
+    // parsed XML entities waiting to be read; slots between QueueHead and
+    // QueueTail are pending. Drained slots and attribute pairs are reused
+    // rather than freed so their strings keep their capacity
+    std::pmr::vector<SQueuedEntity> EntityQueue;
+    std::pmr::vector<SPMRXMLEntity::TAttribute> AttributePool;
+    size_t QueueHead;
+    size_t QueueTail;
+    size_t AttributesUsed;
     // indicates the end of the data source
     bool IsEndOfData;
     // buffer to accumulate character data between XML tags
-    std::string CharDataBuffer;
+    std::pmr::string CharDataBuffer;
+    // chunk handed to the parser, kept between reads
+    std::vector<char> ReadBuffer;
+    static constexpr size_t ReadSize = 4096;
+    // longest CharData entity, 0 for no limit
+    size_t CharDataLimit;
+
+    // claims the next free queue slot
+    SQueuedEntity& PushEntity(SXMLEntity::EType type) {
+        if (QueueTail == EntityQueue.size()) {
+            EntityQueue.emplace_back();
+        }
+        SQueuedEntity& entity = EntityQueue[QueueTail++];
+        entity.DType = type;
+        entity.DFirstAttribute = AttributesUsed;
+        entity.DAttributeCount = 0;
+        entity.DPartial = false;
+        return entity;
+    }
 
     //handler for start element tags
     static void StartElementHandler(void* userData, const char* name, const char** attributes) {
@@ -24,22 +68,24 @@ struct CXMLReader::SImplementation {
         //flush any pending character data before handling the new element
         impl->FlushCharData();
 
-        // create a new entity for the start element
-        SXMLEntity entity;
-        entity.DType = SXMLEntity::EType::StartElement; //set entity type to StartElement
-        entity.DNameData = name; //assign element name
+        // fill the next queue slot as a start element
+        SQueuedEntity& entity = impl->PushEntity(SXMLEntity::EType::StartElement);
+        entity.DNameData.assign(name); //assign element name
 
-        //process attributes, if any
+        //process attributes, if any, overwriting old pairs in the pool in place
         if (attributes) {
             for (int i = 0; attributes[i]; i += 2) {
                 if (attributes[i + 1]) {
-                    entity.DAttributes.emplace_back(attributes[i], attributes[i + 1]); //add attribute name value pair
+                    if (impl->AttributesUsed == impl->AttributePool.size()) {
+                        impl->AttributePool.emplace_back();
+                    }
+                    auto& attribute = impl->AttributePool[impl->AttributesUsed++];
+                    attribute.first.assign(attributes[i]); //add attribute name value pair
+                    attribute.second.assign(attributes[i + 1]);
+                    entity.DAttributeCount++;
                 }
             }
         }
-
-        //add the entity to the queue
-        impl->EntityQueue.push(entity);
     }
 
     //handler for end element tags
@@ -48,13 +94,9 @@ struct CXMLReader::SImplementation {
         //flush any pending character data before handling the end element
         impl->FlushCharData();
 
-        //create a new entity for the end element
-        SXMLEntity entity;
-        entity.DType = SXMLEntity::EType::EndElement;
-        entity.DNameData = name;
-
-        //add the end element entity to the queue
-        impl->EntityQueue.push(entity);
+        //fill the next queue slot as an end element
+        SQueuedEntity& entity = impl->PushEntity(SXMLEntity::EType::EndElement);
+        entity.DNameData.assign(name);
     }
 
     //handler for character data between XML tags
@@ -63,12 +105,35 @@ struct CXMLReader::SImplementation {
         //append valid character data to the buffer
         if (data && length > 0) {
             impl->CharDataBuffer.append(data, length);
+            if (impl->CharDataLimit && impl->CharDataBuffer.size() > impl->CharDataLimit) {
+                impl->FlushCharDataChunks();
+            }
         }
     }
 
+    // queues whole chunks of an over-long text run as partial entities; at
+    // most CharDataLimit bytes stay buffered, so the end of the run is never
+    // an empty entity
+    void FlushCharDataChunks() {
+        size_t start = 0;
+        while (CharDataBuffer.size() - start > CharDataLimit) {
+            // cut before a UTF-8 continuation byte so characters stay whole
+            size_t cut = start + CharDataLimit;
+            while (cut > start + 1 && (static_cast<unsigned char>(CharDataBuffer[cut]) & 0xC0) == 0x80) {
+                cut--;
+            }
+            SQueuedEntity& entity = PushEntity(SXMLEntity::EType::CharData);
+            entity.DNameData.assign(CharDataBuffer, start, cut - start);
+            entity.DPartial = true;
+            start = cut;
+        }
+        CharDataBuffer.erase(0, start);
+    }
+
     //constructor to initialize the implementation
-    SImplementation(std::shared_ptr<CDataSource> src)
-        : DataSource(std::move(src)), IsEndOfData(false) {
+    SImplementation(std::shared_ptr<CDataSource> src, std::pmr::memory_resource* resource)
+        : DataSource(std::move(src)), EntityQueue(resource), AttributePool(resource), QueueHead(0), QueueTail(0), AttributesUsed(0), IsEndOfData(false), CharDataBuffer(resource), CharDataLimit(0) {
+        ReadBuffer.reserve(ReadSize);
         //create the XML parser
         Parser = XML_ParserCreate(nullptr);
 
@@ -86,76 +151,107 @@ struct CXMLReader::SImplementation {
     // flush accumulated character data into the entity queue
     void FlushCharData() {
         if (!CharDataBuffer.empty()) {
-            SXMLEntity entity;
-            entity.DType = SXMLEntity::EType::CharData; // set entity type to CharData
-            entity.DNameData = CharDataBuffer; // assign buffered data
+            SQueuedEntity& entity = PushEntity(SXMLEntity::EType::CharData); // set entity type to CharData
+            entity.DNameData.assign(CharDataBuffer); // assign buffered data
 
-            // add the entity to the queue and clear the buffer
-            EntityQueue.push(entity);
+            // clear the buffer, keeping its capacity
             CharDataBuffer.clear();
         }
     }
 
-    // read the next entity from the XML input
-    bool ReadEntity(SXMLEntity& entity, bool skipCharData) {
-        // read until an entity is available or end of input is reached
-        while (EntityQueue.empty() && !IsEndOfData) {
-            std::vector<char> buffer(4096); // buffer to hold data
-            size_t bytesRead = 0;
-
-            // fill the buffer with data from the data source
-            while (bytesRead < buffer.size() && !DataSource->End()) {
-                char ch;
-                if (DataSource->Get(ch)) {
-                    buffer[bytesRead++] = ch;
-                } else {
+    // true when nothing is queued
+    bool QueueEmpty() const {
+        return QueueHead == QueueTail;
+    }
+
+    // parse input until an entity is queued; returns the queued slot or nullptr
+    // at end of input, skipping character data if it is requested
+    SQueuedEntity* NextEntity(bool skipCharData) {
+        while (true) {
+            // read until an entity is available or end of input is reached
+            while (QueueEmpty() && !IsEndOfData) {
+                // everything has been read, so the slots can be reused from the start
+                QueueHead = QueueTail = AttributesUsed = 0;
+                // fill the buffer with one bulk read from the data source
+                size_t bytesRead = DataSource->Read(ReadBuffer, ReadSize) ? ReadBuffer.size() : 0;
+
+                // check if we've reached the end of the data source
+                if (bytesRead == 0) {
+                    IsEndOfData = true;
+                    XML_Parse(Parser, nullptr, 0, 1); // signal end of parsing
                     break;
                 }
-            }
 
-            // check if we've reached the end of the data source
-            if (bytesRead == 0) {
-                IsEndOfData = true;
-                XML_Parse(Parser, nullptr, 0, 1); // signal end of parsing
-                break;
+                DSV_METRIC_ADD(BytesRead, bytesRead);
+                // parse the data 
+                if (XML_Parse(Parser, ReadBuffer.data(), bytesRead, 0) == XML_STATUS_ERROR) {
+                    return nullptr; // parsing error
+                }
             }
 
-            // parse the data 
-            if (XML_Parse(Parser, buffer.data(), bytesRead, 0) == XML_STATUS_ERROR) {
-                return false; // parsing error
+            // no more entities to process
+            if (QueueEmpty()) {
+                return nullptr;
             }
-        }
-
-        // return the next available entity
-        if (!EntityQueue.empty()) {
-            entity = EntityQueue.front();
-            EntityQueue.pop();
 
+            SQueuedEntity* entity = &EntityQueue[QueueHead++];
             // skip character data if it is requested
-            if (skipCharData && entity.DType == SXMLEntity::EType::CharData) {
-                return ReadEntity(entity, skipCharData);
+            if (!(skipCharData && entity->DType == SXMLEntity::EType::CharData)) {
+                DSV_METRIC_ADD(EntitiesRead, 1);
+                return entity;
             }
+        }
+    }
 
-            return true;
+    // copies a queued entity out, reusing the destination's string capacity
+    template <typename TEntity>
+    void CopyEntity(const SQueuedEntity& from, TEntity& to) const {
+        to.DType = from.DType;
+        to.DPartial = from.DPartial;
+        to.DNameData.assign(from.DNameData.data(), from.DNameData.size());
+        to.DAttributes.resize(from.DAttributeCount);
+        for (size_t i = 0; i < from.DAttributeCount; i++) {
+            const auto& attribute = AttributePool[from.DFirstAttribute + i];
+            to.DAttributes[i].first.assign(attribute.first.data(), attribute.first.size());
+            to.DAttributes[i].second.assign(attribute.second.data(), attribute.second.size());
         }
+    }
 
-        return false; // no more entities to process
+    // read the next entity from the XML input
+    template <typename TEntity>
+    bool ReadEntity(TEntity& entity, bool skipCharData) {
+        SQueuedEntity* next = NextEntity(skipCharData);
+        if (!next) {
+            return false;
+        }
+        CopyEntity(*next, entity);
+        return true;
     }
 };
 
 // constructor for CXMLReader
-CXMLReader::CXMLReader(std::shared_ptr<CDataSource> src)
-    : DImplementation(std::make_unique<SImplementation>(std::move(src))) {}
+CXMLReader::CXMLReader(std::shared_ptr<CDataSource> src, std::pmr::memory_resource* resource)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), resource)) {}
 
 // destructor for CXMLReader
 CXMLReader::~CXMLReader() = default;
 
+// sets the longest character data entity, 0 for no limit
+void CXMLReader::SetCharDataLimit(std::size_t bytes) noexcept {
+    DImplementation->CharDataLimit = bytes;
+}
+
 // check if we've reached the end of the XML input
 bool CXMLReader::End() const {
-    return DImplementation->IsEndOfData && DImplementation->EntityQueue.empty();
+    return DImplementation->IsEndOfData && DImplementation->QueueEmpty();
 }
 
 // read the next entity from the XML input
 bool CXMLReader::ReadEntity(SXMLEntity& entity, bool skipCharData) {
     return DImplementation->ReadEntity(entity, skipCharData);
 }
+
+// read the next entity into arena backed strings
+bool CXMLReader::ReadEntity(SPMRXMLEntity& entity, bool skipCharData) {
+    return DImplementation->ReadEntity(entity, skipCharData);
+}
@@ -0,0 +1,360 @@
+#include "XMLRecordIndex.h"
+#include "XMLPushParser.h"
+#include <cstdio>
+#include <cstring>
+#include <expat.h>
+#include <unordered_map>
+
+namespace{
+
+const char IndexMagic[8] = {'X', 'M', 'L', 'R', 'I', 'D', 'X', '1'};
+
+void PutVarint(std::vector<char> &out, std::uint64_t value){
+    while(value >= 0x80){
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool GetVarint(const char *&position, const char *end, std::uint64_t &value){
+    value = 0;
+    for(unsigned Shift = 0; position < end && Shift < 64; Shift += 7){
+        unsigned char Byte = *position++;
+        value |= static_cast<std::uint64_t>(Byte & 0x7F) << Shift;
+        if(!(Byte & 0x80)){
+            return true;
+        }
+    }
+    return false;
+}
+
+void PutString(std::vector<char> &out, const std::string &str){
+    PutVarint(out, str.size());
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+bool GetString(const char *&position, const char *end, std::string &str){
+    std::uint64_t Length;
+    if(!GetVarint(position, end, Length) || Length > static_cast<std::uint64_t>(end - position)){
+        return false;
+    }
+    str.assign(position, Length);
+    position += Length;
+    return true;
+}
+
+// attribute value escaped for a double quoted attribute
+void AppendEscaped(std::string &out, const char *value){
+    for(; *value; value++){
+        switch(*value){
+            case '&':
+                out += "&amp;";
+                break;
+            case '<':
+                out += "&lt;";
+                break;
+            case '"':
+                out += "&quot;";
+                break;
+            default:
+                out += *value;
+        }
+    }
+}
+
+}
+
+struct CXMLRecordIndex::SImplementation{
+    // the elements open around one or more records
+    struct SContext{
+        std::string DTags;
+        std::size_t DDepth;
+    };
+
+    std::vector<SRecord> DRecords;
+    std::vector<SContext> DContexts;
+    std::string DEncoding;
+
+    // build state: only elements outside records are tracked by name
+    struct SBuild{
+        SImplementation *DIndex;
+        XML_Parser DParser;
+        std::string DMatch;
+        bool DMatchPath;
+        std::string DPath;
+        std::vector<std::size_t> DPathLengths;
+        std::vector<std::string> DTags;
+        std::unordered_map<std::string, std::uint32_t> DContextIds;
+        // the context of the last record, valid until an element outside
+        // the records opens or closes
+        std::uint32_t DContext;
+        bool DContextChanged;
+        // depth inside the current record, 0 outside of one
+        std::size_t DRecordDepth;
+
+        std::uint32_t CurrentContext(){
+            if(!DContextChanged){
+                return DContext;
+            }
+            std::string Tags;
+            for(auto &Tag : DTags){
+                Tags += Tag;
+            }
+            auto Inserted = DContextIds.emplace(Tags, static_cast<std::uint32_t>(DIndex->DContexts.size()));
+            if(Inserted.second){
+                DIndex->DContexts.push_back({std::move(Tags), DTags.size()});
+            }
+            DContext = Inserted.first->second;
+            DContextChanged = false;
+            return DContext;
+        }
+
+        static void StartElementHandler(void *userdata, const char *name, const char **attributes){
+            auto *Build = static_cast<SBuild *>(userdata);
+            if(Build->DRecordDepth){
+                Build->DRecordDepth++;
+                return;
+            }
+            std::size_t PathLength = Build->DPath.size();
+            Build->DPath += '/';
+            Build->DPath += name;
+            if(Build->DMatchPath ? Build->DPath == Build->DMatch : Build->DMatch == name){
+                Build->DPath.resize(PathLength);
+                Build->DRecordDepth = 1;
+                std::uint64_t Offset = XML_GetCurrentByteIndex(Build->DParser);
+                Build->DIndex->DRecords.push_back({Offset, 0, Build->CurrentContext()});
+                return;
+            }
+            Build->DPathLengths.push_back(PathLength);
+            std::string Tag = std::string("<") + name;
+            for(int Index = 0; attributes[Index]; Index += 2){
+                const char *Attribute = attributes[Index];
+                if(!std::strncmp(Attribute, "xmlns", 5) && (Attribute[5] == '\0' || Attribute[5] == ':')){
+                    Tag += ' ';
+                    Tag += Attribute;
+                    Tag += "=\"";
+                    AppendEscaped(Tag, attributes[Index + 1]);
+                    Tag += '"';
+                }
+            }
+            Tag += '>';
+            Build->DTags.push_back(std::move(Tag));
+            Build->DContextChanged = true;
+        }
+
+        static void EndElementHandler(void *userdata, const char *){
+            auto *Build = static_cast<SBuild *>(userdata);
+            if(Build->DRecordDepth){
+                if(!--Build->DRecordDepth){
+                    SRecord &Record = Build->DIndex->DRecords.back();
+                    Record.DLength = XML_GetCurrentByteIndex(Build->DParser) + XML_GetCurrentByteCount(Build->DParser) - Record.DOffset;
+                }
+                return;
+            }
+            Build->DPath.resize(Build->DPathLengths.back());
+            Build->DPathLengths.pop_back();
+            Build->DTags.pop_back();
+            Build->DContextChanged = true;
+        }
+
+        static void XmlDeclHandler(void *userdata, const XML_Char *, const XML_Char *encoding, int){
+            if(encoding){
+                static_cast<SBuild *>(userdata)->DIndex->DEncoding = encoding;
+            }
+        }
+    };
+
+    bool Build(CDataSource &src, const std::string &match){
+        DRecords.clear();
+        DContexts.clear();
+        DEncoding.clear();
+        SBuild State{this, XML_ParserCreate(nullptr), match, !match.empty() && match[0] == '/', std::string(), {}, {}, {}, 0, true, 0};
+        XML_SetUserData(State.DParser, &State);
+        XML_SetElementHandler(State.DParser, SBuild::StartElementHandler, SBuild::EndElementHandler);
+        XML_SetXmlDeclHandler(State.DParser, SBuild::XmlDeclHandler);
+        std::vector<char> Buffer;
+        bool Success = true;
+        while(Success && src.Read(Buffer, 1 << 20)){
+            Success = XML_Parse(State.DParser, Buffer.data(), static_cast<int>(Buffer.size()), 0) != XML_STATUS_ERROR;
+        }
+        Success = Success && XML_Parse(State.DParser, nullptr, 0, 1) != XML_STATUS_ERROR;
+        XML_ParserFree(State.DParser);
+        return Success;
+    }
+
+    bool Save(const std::string &filename) const{
+        std::vector<char> Data(IndexMagic, IndexMagic + sizeof(IndexMagic));
+        PutString(Data, DEncoding);
+        PutVarint(Data, DContexts.size());
+        for(auto &Context : DContexts){
+            PutVarint(Data, Context.DDepth);
+            PutString(Data, Context.DTags);
+        }
+        PutVarint(Data, DRecords.size());
+        std::uint64_t Previous = 0;
+        for(auto &Record : DRecords){
+            PutVarint(Data, Record.DOffset - Previous);
+            PutVarint(Data, Record.DLength);
+            PutVarint(Data, Record.DContext);
+            Previous = Record.DOffset;
+        }
+        FILE *File = std::fopen(filename.c_str(), "wb");
+        if(!File){
+            return false;
+        }
+        bool Success = std::fwrite(Data.data(), 1, Data.size(), File) == Data.size();
+        return std::fclose(File) == 0 && Success;
+    }
+
+    bool Load(const std::string &filename){
+        CFileDataSource Source(filename);
+        std::vector<char> Data, Chunk;
+        while(Source.Read(Chunk, 1 << 20)){
+            Data.insert(Data.end(), Chunk.begin(), Chunk.end());
+        }
+        DRecords.clear();
+        DContexts.clear();
+        if(Data.size() < sizeof(IndexMagic) || std::memcmp(Data.data(), IndexMagic, sizeof(IndexMagic))){
+            return false;
+        }
+        const char *Position = Data.data() + sizeof(IndexMagic);
+        const char *End = Data.data() + Data.size();
+        std::uint64_t Count;
+        if(!GetString(Position, End, DEncoding) || !GetVarint(Position, End, Count)){
+            return false;
+        }
+        for(std::uint64_t Index = 0; Index < Count; Index++){
+            SContext Context;
+            std::uint64_t Depth;
+            if(!GetVarint(Position, End, Depth) || !GetString(Position, End, Context.DTags)){
+                return false;
+            }
+            Context.DDepth = Depth;
+            DContexts.push_back(std::move(Context));
+        }
+        if(!GetVarint(Position, End, Count)){
+            return false;
+        }
+        std::uint64_t Offset = 0;
+        for(std::uint64_t Index = 0; Index < Count; Index++){
+            std::uint64_t Delta, Length, Context;
+            if(!GetVarint(Position, End, Delta) || !GetVarint(Position, End, Length) || !GetVarint(Position, End, Context) || Context >= DContexts.size()){
+                DRecords.clear();
+                return false;
+            }
+            Offset += Delta;
+            DRecords.push_back({Offset, Length, static_cast<std::uint32_t>(Context)});
+        }
+        return true;
+    }
+};
+
+CXMLRecordIndex::CXMLRecordIndex() : DImplementation(std::make_unique<SImplementation>()){
+
+}
+
+CXMLRecordIndex::~CXMLRecordIndex() = default;
+
+bool CXMLRecordIndex::Build(CDataSource &src, const std::string &match){
+    return DImplementation->Build(src, match);
+}
+
+bool CXMLRecordIndex::Save(const std::string &filename) const{
+    return DImplementation->Save(filename);
+}
+
+bool CXMLRecordIndex::Load(const std::string &filename){
+    return DImplementation->Load(filename);
+}
+
+std::size_t CXMLRecordIndex::RecordCount() const noexcept{
+    return DImplementation->DRecords.size();
+}
+
+const CXMLRecordIndex::SRecord &CXMLRecordIndex::Record(std::size_t index) const noexcept{
+    return DImplementation->DRecords[index];
+}
+
+std::size_t CXMLRecordIndex::Depth(std::size_t index) const noexcept{
+    return DImplementation->DContexts[DImplementation->DRecords[index].DContext].DDepth;
+}
+
+const std::string &CXMLRecordIndex::Context(std::size_t index) const noexcept{
+    return DImplementation->DContexts[DImplementation->DRecords[index].DContext].DTags;
+}
+
+const std::string &CXMLRecordIndex::Encoding() const noexcept{
+    return DImplementation->DEncoding;
+}
+
+struct CXMLRecordReader::SImplementation{
+    std::shared_ptr<CFileDataSource> DSource;
+    std::shared_ptr<const CXMLRecordIndex> DIndex;
+    std::vector<char> DBuffer;
+    std::string DPrefix;
+    std::vector<SXMLEntity> *DEntities;
+    // start tags of the context still to be dropped
+    std::size_t DSkip;
+    bool DSkipCharData;
+    CXMLPushParser DParser;
+
+    SImplementation(std::shared_ptr<CFileDataSource> src, std::shared_ptr<const CXMLRecordIndex> index)
+        : DSource(std::move(src)), DIndex(std::move(index)), DEntities(nullptr), DSkip(0), DSkipCharData(false), DParser([this](const SXMLEntity &entity){
+            Collect(entity);
+        }){
+
+    }
+
+    void Collect(const SXMLEntity &entity){
+        if(DSkip){
+            DSkip--;
+            return;
+        }
+        if(!(DSkipCharData && entity.DType == SXMLEntity::EType::CharData)){
+            DEntities->push_back(entity);
+        }
+    }
+
+    bool ReadRecord(std::size_t index, std::vector<SXMLEntity> &entities, bool skipcdata){
+        entities.clear();
+        if(index >= DIndex->RecordCount()){
+            return false;
+        }
+        const CXMLRecordIndex::SRecord &Record = DIndex->Record(index);
+        // a stale or damaged index may point past the end of the file
+        std::uint64_t FileSize;
+        if(!DSource->Size(FileSize) || Record.DOffset > FileSize || Record.DLength > FileSize - Record.DOffset){
+            return false;
+        }
+        if(!DSource->Seek(Record.DOffset) || !DSource->Read(DBuffer, Record.DLength) || DBuffer.size() != Record.DLength){
+            return false;
+        }
+        // the declaration and the context come first, as in the document
+        DPrefix.clear();
+        if(!DIndex->Encoding().empty()){
+            DPrefix = "<?xml version=\"1.0\" encoding=\"" + DIndex->Encoding() + "\"?>";
+        }
+        DPrefix += DIndex->Context(index);
+        DParser.Reset();
+        DEntities = &entities;
+        DSkip = DIndex->Depth(index);
+        DSkipCharData = skipcdata;
+        // the context's elements stay open, so the document never finishes;
+        // the record's last entity is its end tag, which needs no Finish
+        bool Success = DParser.Feed(DPrefix.data(), DPrefix.size()) && DParser.Feed(DBuffer.data(), DBuffer.size());
+        DEntities = nullptr;
+        return Success && !entities.empty() && entities.back().DType == SXMLEntity::EType::EndElement;
+    }
+};
+
+CXMLRecordReader::CXMLRecordReader(std::shared_ptr<CFileDataSource> src, std::shared_ptr<const CXMLRecordIndex> index)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), std::move(index))){
+
+}
+
+CXMLRecordReader::~CXMLRecordReader() = default;
+
+bool CXMLRecordReader::ReadRecord(std::size_t index, std::vector<SXMLEntity> &entities, bool skipcdata){
+    return DImplementation->ReadRecord(index, entities, skipcdata);
+}
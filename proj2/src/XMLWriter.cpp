@@ -1,10 +1,13 @@
 #include "XMLWriter.h"  //header for the XMLWriter class.
+#include "Metrics.h"    //counters for bytes, entities and escaping.
 #include <vector>       //used for managing the element stack as a vector.
 #include <string>       //provides the std::string type for handling XML strings.
+#include <cstring>      //strlen for the entity references.
 
 struct CXMLWriter::SImplementation {
     std::shared_ptr<CDataSink> DDataSink;   //data sink used for writing output.
     std::vector<std::string> DElementList;  //stores the stack of open elements.
+    std::vector<char> DEscaped;             //escaped text, reused between calls.
 
     //constructor initializes the data sink.
     SImplementation(std::shared_ptr<CDataSink> sink)
@@ -13,6 +16,7 @@ struct CXMLWriter::SImplementation {
     //writes a plain string to the data sink 
     //returns false if writing fails
     bool OutputString(const std::string& str) {
+        DSV_METRIC_ADD(BytesWritten, str.size());
         for (char ch : str) {
             if (!DDataSink->Put(ch)) {
                 return false;
@@ -22,42 +26,43 @@ struct CXMLWriter::SImplementation {
     }
 
     //writes an escaped version of the string (e.g., for special XML characters).
-    //used switch and case
+    //the text is escaped into a reused buffer and written in one go
     bool StringEscaped(const std::string& str) {
+        DSV_METRIC_ONLY(RecordEscaped(str));
+        DEscaped.clear();
+        CXMLWriter::AppendEscaped(str, DEscaped);
+        DSV_METRIC_ADD(BytesWritten, DEscaped.size());
+        if (DEscaped.empty()) {
+            return true;
+        }
+        return DDataSink->Write(DEscaped);
+    }
+
+#ifdef DSV_ENABLE_METRICS
+    //counts the bytes escaping adds in one go rather than per character;
+    //StringEscaped counts everything it writes itself
+    static void RecordEscaped(const std::string& str) {
+        size_t extra = 0;
         for (char ch : str) {
             switch (ch) {
                 case '<':
-                    if (!OutputString("&lt;")) {
-                        return false;
-                    }
-                    break;
                 case '>':
-                    if (!OutputString("&gt;")){
-                         return false;
-                    }
-                        break;
+                    extra += 3;
+                    break;
                 case '&':
-                    if (!OutputString("&amp;")){ 
-                        return false;
-                    }
-                        break;
-                case '\'':
-                    if (!OutputString("&apos;")) {
-                    return false;
-                    }
+                    extra += 4;
                     break;
+                case '\'':
                 case '"':
-                    if (!OutputString("&quot;")){
-                         return false;
-                    }
+                    extra += 5;
                     break;
                 default:
-                    if (!DDataSink->Put(ch)){ return false;
-                    }
+                    break;
             }
         }
-        return true;
+        DSV_METRIC_ADD(BytesEscaped, extra);
     }
+#endif
 
     //closes all remaining open tags
     //returns false if writing fails
@@ -75,6 +80,7 @@ struct CXMLWriter::SImplementation {
 
     // writes the provided XML entity to the output.
     bool OutputEntity(const SXMLEntity& entity) {
+        DSV_METRIC_ADD(EntitiesWritten, 1);
         switch (entity.DType) {
             case SXMLEntity::EType::StartElement:
                 // write the opening tag for the element.
@@ -159,3 +165,45 @@ bool CXMLWriter::Flush() {
 bool CXMLWriter::WriteEntity(const SXMLEntity& entity) {
     return DImplementation->OutputEntity(entity);
 }
+
+// appends text with the characters XML reserves replaced by entity
+// references, to a string or to a buffer a sink takes as it is
+template <typename TOut>
+static void AppendEscapedTo(std::string_view text, TOut& out) {
+    size_t start = 0;
+    for (size_t index = 0; index < text.size(); index++) {
+        const char* replacement;
+        switch (text[index]) {
+            case '<':
+                replacement = "&lt;";
+                break;
+            case '>':
+                replacement = "&gt;";
+                break;
+            case '&':
+                replacement = "&amp;";
+                break;
+            case '\'':
+                replacement = "&apos;";
+                break;
+            case '"':
+                replacement = "&quot;";
+                break;
+            default:
+                continue;
+        }
+        // copy the plain run before the replacement in one append
+        out.insert(out.end(), text.data() + start, text.data() + index);
+        out.insert(out.end(), replacement, replacement + std::strlen(replacement));
+        start = index + 1;
+    }
+    out.insert(out.end(), text.data() + start, text.data() + text.size());
+}
+
+void CXMLWriter::AppendEscaped(std::string_view text, std::string &out) {
+    AppendEscapedTo(text, out);
+}
+
+void CXMLWriter::AppendEscaped(std::string_view text, std::vector<char> &out) {
+    AppendEscapedTo(text, out);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "AsyncDataSink.h"
+#include "StringDataSink.h"
+#include "DSVWriter.h"
+
+namespace{
+
+// sink that starts failing after a number of bulk writes
+class CFailingDataSink : public CStringDataSink{
+    public:
+        int DWritesLeft;
+
+        CFailingDataSink(int writes) : DWritesLeft(writes){}
+
+        bool Write(const std::vector<char> &buf) noexcept override{
+            if(DWritesLeft-- <= 0){
+                return false;
+            }
+            return CStringDataSink::Write(buf);
+        }
+};
+
+}
+
+TEST(AsyncDataSink, PutWriteFlush){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CAsyncDataSink Async(Sink, 4);
+    std::string Expected;
+
+    for(char Ch : std::string("Hello")){
+        EXPECT_TRUE(Async.Put(Ch));
+    }
+    EXPECT_TRUE(Async.Write({' ', 'W', 'o', 'r', 'l', 'd'}));
+    EXPECT_TRUE(Async.Flush());
+    EXPECT_EQ(Sink->String(), "Hello World");
+    EXPECT_TRUE(Async.Put('!'));
+    EXPECT_TRUE(Async.Close());
+    EXPECT_EQ(Sink->String(), "Hello World!");
+    EXPECT_FALSE(Async.Put('?'));
+}
+
+TEST(AsyncDataSink, DSVWriterLargeOutput){
+    auto Sink = std::make_shared<CStringDataSink>();
+    auto Async = std::make_shared<CAsyncDataSink>(Sink, 1000);
+    CDSVWriter Writer(Async, ',');
+    std::string Expected;
+    for(int Index = 0; Index < 2000; Index++){
+        EXPECT_TRUE(Writer.WriteRow({std::to_string(Index), "a\"b"}));
+        Expected += std::to_string(Index) + ",\"a\"\"b\"\n";
+    }
+    EXPECT_TRUE(Async->Close());
+    EXPECT_EQ(Sink->String(), Expected);
+}
+
+TEST(AsyncDataSink, ErrorPropagates){
+    auto Sink = std::make_shared<CFailingDataSink>(1);
+    CAsyncDataSink Async(Sink, 8);
+    EXPECT_TRUE(Async.Write(std::vector<char>(8, 'a')));
+    EXPECT_TRUE(Async.Flush());
+    EXPECT_TRUE(Async.Write(std::vector<char>(8, 'b')));
+    EXPECT_FALSE(Async.Flush());
+    EXPECT_FALSE(Async.Put('c'));
+    EXPECT_FALSE(Async.Close());
+    EXPECT_EQ(Sink->String(), "aaaaaaaa");
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "AwaitableDSVReader.h"
+#include "AwaitableDSVWriter.h"
+#include "AwaitableFileDataSink.h"
+#include "AwaitableFileDataSource.h"
+#include "AwaitableXMLReader.h"
+#include "Reactor.h"
+#include <cstdio>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace{
+
+std::vector<std::string> SampleRow(int index){
+    return {std::to_string(index), "a,b", "say \"hi\"", std::string(index % 40, 'x')};
+}
+
+// gtest's ASSERT_* return from the function, which a coroutine cannot do,
+// so the coroutines only record what happened
+
+// closes fd once everything is written so the reader sees the end
+TTask<void> WriteRows(CAwaitableDSVWriter &writer, int rows, int fd, bool &success){
+    success = true;
+    for(int Index = 0; Index < rows; Index++){
+        success = co_await writer.WriteRowAsync(SampleRow(Index)) && success;
+    }
+    success = co_await writer.FlushAsync() && success;
+    close(fd);
+}
+
+// takes every write, then fails the first flush having written only part
+class CFailingAwaitableSink : public CAwaitableDataSink{
+    private:
+        std::size_t DBuffered = 0;
+        bool DFailed = false;
+
+    public:
+        bool Write(const char *, std::size_t length) noexcept override{
+            DBuffered += length;
+            return !DFailed;
+        }
+
+        std::size_t TryFlush() noexcept override{
+            DFailed = true;
+            DBuffered = 1;
+            return DBuffered;
+        }
+
+        bool Failed() const noexcept override{
+            return DFailed;
+        }
+
+        TTask<bool> Flush() override{
+            co_return !DFailed;
+        }
+};
+
+TTask<void> ReadRows(CAwaitableDSVReader &reader, int &rows, bool &matched){
+    std::vector<std::string> Row;
+    matched = true;
+    while(co_await reader.ReadRowAsync(Row)){
+        matched = matched && Row == SampleRow(rows);
+        rows++;
+    }
+}
+
+}
+
+// enough rows to fill the pipe many times over, so the writer and the
+// reader both have to suspend and hand over to each other
+TEST(AwaitableIO, DSVThroughPipe){
+    CEpollReactor Reactor;
+    ASSERT_TRUE(Reactor.IsOpen());
+    int Pipe[2];
+    ASSERT_EQ(pipe(Pipe), 0);
+    const int RowTotal = 20000;
+    CAwaitableDSVWriter Writer(std::make_shared<CAwaitableFileDataSink>(Reactor, Pipe[1]), ',', false, 4096);
+    CAwaitableDSVReader Reader(std::make_shared<CAwaitableFileDataSource>(Reactor, Pipe[0], true, 1024), ',');
+    bool Written = false;
+    bool Matched = false;
+    int Rows = 0;
+    Reactor.Spawn(WriteRows(Writer, RowTotal, Pipe[1], Written));
+    Reactor.Spawn(ReadRows(Reader, Rows, Matched));
+    EXPECT_TRUE(Reactor.Run());
+    EXPECT_TRUE(Written);
+    EXPECT_EQ(Rows, RowTotal);
+    EXPECT_TRUE(Matched);
+    EXPECT_TRUE(Reader.End());
+}
+
+// a write error during the flush at the high-water mark fails that row,
+// even though what is left is below the mark
+TEST(AwaitableIO, FlushErrorFailsTheWrite){
+    CAwaitableDSVWriter Writer(std::make_shared<CFailingAwaitableSink>(), ',', false, 8);
+    auto Below = Writer.WriteRowAsync({"a"});
+    ASSERT_TRUE(Below.await_ready());
+    EXPECT_TRUE(Below.await_resume());
+    auto Over = Writer.WriteRowAsync({"0123456789"});
+    ASSERT_TRUE(Over.await_ready());
+    EXPECT_FALSE(Over.await_resume());
+    auto Flushed = Writer.FlushAsync();
+    ASSERT_TRUE(Flushed.await_ready());
+    EXPECT_FALSE(Flushed.await_resume());
+}
+
+// rows already in the buffer come back without suspending; a regular file
+// cannot be watched by epoll and never suspends at all
+TEST(AwaitableIO, BufferedRowsCompleteSynchronously){
+    char Path[] = "/tmp/awaitableiotestXXXXXX";
+    int Descriptor = mkstemp(Path);
+    ASSERT_GE(Descriptor, 0);
+    std::string Text = "a,b\nc,d\ne,f\n";
+    ASSERT_EQ(write(Descriptor, Text.data(), Text.size()), static_cast<ssize_t>(Text.size()));
+    ASSERT_EQ(lseek(Descriptor, 0, SEEK_SET), 0);
+
+    CEpollReactor Reactor;
+    CAwaitableDSVReader Reader(std::make_shared<CAwaitableFileDataSource>(Reactor, Descriptor, true), ',');
+    std::vector<std::string> Row;
+    // nothing is buffered yet, so the first read needs the coroutine path
+    auto First = Reader.ReadRowAsync(Row);
+    EXPECT_FALSE(First.await_ready());
+    bool Ready = true;
+    int Rows = 0;
+    Reactor.Spawn([](TAwaitable<bool> first, CAwaitableDSVReader &reader, std::vector<std::string> &row, bool &ready, int &rows) -> TTask<void>{
+        if(co_await first){
+            rows++;
+        }
+        // the rest of the file arrived with the first read
+        auto Second = reader.ReadRowAsync(row);
+        ready = ready && Second.await_ready();
+        if(co_await Second){
+            rows++;
+        }
+        auto Third = reader.ReadRowAsync(row);
+        ready = ready && Third.await_ready();
+        if(co_await Third){
+            rows++;
+        }
+    }(std::move(First), Reader, Row, Ready, Rows));
+    EXPECT_TRUE(Reactor.Run());
+    EXPECT_TRUE(Ready);
+    EXPECT_EQ(Rows, 3);
+    EXPECT_EQ(Row, (std::vector<std::string>{"e", "f"}));
+    std::remove(Path);
+}
+
+// a thread trickles a document into a socket; the reader coroutine only
+// wakes when bytes arrive
+TEST(AwaitableIO, XMLFromSocket){
+    int Sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets), 0);
+    std::thread Sender([&]{
+        std::string Document = "<feed>";
+        for(int Index = 0; Index < 100; Index++){
+            Document += "<item n=\"" + std::to_string(Index) + "\">v" + std::to_string(Index) + "</item>";
+        }
+        Document += "</feed>";
+        for(std::size_t Position = 0; Position < Document.size(); Position += 37){
+            std::size_t Length = std::min<std::size_t>(37, Document.size() - Position);
+            EXPECT_EQ(write(Sockets[0], Document.data() + Position, Length), static_cast<ssize_t>(Length));
+            std::this_thread::yield();
+        }
+        close(Sockets[0]);
+    });
+
+    CEpollReactor Reactor;
+    CAwaitableXMLReader Reader(std::make_shared<CAwaitableFileDataSource>(Reactor, Sockets[1], true, 64));
+    int Items = 0;
+    bool InOrder = true;
+    Reactor.Spawn([](CAwaitableXMLReader &reader, int &items, bool &inorder) -> TTask<void>{
+        SXMLEntity Entity;
+        while(co_await reader.ReadEntityAsync(Entity, true)){
+            if(Entity.DType == SXMLEntity::EType::StartElement && Entity.DNameData == "item"){
+                inorder = inorder && Entity.AttributeValue("n") == std::to_string(items);
+                items++;
+            }
+        }
+    }(Reader, Items, InOrder));
+    EXPECT_TRUE(Reactor.Run());
+    Sender.join();
+    EXPECT_EQ(Items, 100);
+    EXPECT_TRUE(InOrder);
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(AwaitableIO, RunReportsStuckTasks){
+    CEpollReactor Reactor;
+    Reactor.Spawn([]() -> TTask<void>{
+        co_await std::suspend_always();
+    }());
+    EXPECT_FALSE(Reactor.Run());
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "ColumnarCache.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+#include "TempFile.h"
+#include <cstdio>
+
+TEST(ColumnarCache, ConvertAndRead){
+    std::string Text = "id,city,note\n";
+    for(int Index = 0; Index < 1000; Index++){
+        Text += std::to_string(Index) + "," + (Index % 3 ? "Davis" : "\"Sacramento, CA\"") + ",note " + std::to_string(Index * 7) + "\n";
+    }
+    CTempFile Temp("columnarcachetest");
+    const std::string &Path = Temp.Path();
+    CDSVReader Reader(std::make_shared<CStringDataSource>(Text), ',');
+    ASSERT_TRUE(CColumnarCacheWriter::Convert(Reader, Path, true, 16));
+
+    CColumnarCacheReader Cache(Path);
+    ASSERT_TRUE(Cache.IsOpen());
+    EXPECT_EQ(Cache.RowCount(), 1000u);
+    EXPECT_EQ(Cache.ColumnCount(), 3u);
+    EXPECT_EQ(Cache.ColumnNames(), std::vector<std::string_view>({"id", "city", "note"}));
+    EXPECT_EQ(Cache.ColumnIndex("note"), 2u);
+    EXPECT_EQ(Cache.ColumnIndex("missing"), 3u);
+
+    // only the city column is small enough for a dictionary
+    EXPECT_FALSE(Cache.IsDictionaryEncoded(0));
+    EXPECT_TRUE(Cache.IsDictionaryEncoded(1));
+    EXPECT_FALSE(Cache.IsDictionaryEncoded(2));
+    EXPECT_EQ(Cache.DictionarySize(1), 2u);
+    EXPECT_EQ(Cache.DictionaryValue(1, Cache.DictionaryCode(4, 1)), "Davis");
+
+    std::vector<std::string> Row;
+    for(std::size_t Index = 0; Index < Cache.RowCount(); Index++){
+        ASSERT_TRUE(Cache.ReadRow(Index, Row));
+        EXPECT_EQ(Row, std::vector<std::string>({std::to_string(Index), Index % 3 ? "Davis" : "Sacramento, CA", "note " + std::to_string(Index * 7)}));
+    }
+    EXPECT_FALSE(Cache.ReadRow(1000, Row));
+
+    std::vector<std::string_view> Column;
+    ASSERT_TRUE(Cache.ReadColumn(0, Column));
+    EXPECT_EQ(Column.size(), 1000u);
+    EXPECT_EQ(Column[999], "999");
+}
+
+TEST(ColumnarCache, RaggedRowsKeepTheirShape){
+    CTempFile Temp("columnarcachetest");
+    const std::string &Path = Temp.Path();
+    {
+        CColumnarCacheWriter Writer(Path, 0);
+        ASSERT_TRUE(Writer.IsOpen());
+        EXPECT_TRUE(Writer.WriteRow({"a"}));
+        EXPECT_TRUE(Writer.WriteRow({}));
+        EXPECT_TRUE(Writer.WriteRow({"b", "", "c"}));
+        EXPECT_FALSE(Writer.WriteHeader({"late"}));
+    }
+    CColumnarCacheReader Cache(Path);
+    ASSERT_TRUE(Cache.IsOpen());
+    EXPECT_EQ(Cache.RowCount(), 3u);
+    EXPECT_EQ(Cache.ColumnCount(), 3u);
+    EXPECT_EQ(Cache.ColumnNames(), std::vector<std::string_view>({"", "", ""}));
+    EXPECT_FALSE(Cache.IsDictionaryEncoded(2));
+    std::vector<std::string_view> Row;
+    ASSERT_TRUE(Cache.ReadRow(0, Row));
+    EXPECT_EQ(Row, std::vector<std::string_view>({"a"}));
+    ASSERT_TRUE(Cache.ReadRow(1, Row));
+    EXPECT_TRUE(Row.empty());
+    ASSERT_TRUE(Cache.ReadRow(2, Row));
+    EXPECT_EQ(Row, std::vector<std::string_view>({"b", "", "c"}));
+    EXPECT_EQ(Cache.Cell(0, 2), "");
+    EXPECT_EQ(Cache.Cell(2, 2), "c");
+}
+
+TEST(ColumnarCache, EmptyAndInvalidFiles){
+    CTempFile Temp("columnarcachetest");
+    const std::string &Path = Temp.Path();
+    {
+        CColumnarCacheWriter Writer(Path);
+        EXPECT_TRUE(Writer.Close());
+    }
+    CColumnarCacheReader Empty(Path);
+    EXPECT_TRUE(Empty.IsOpen());
+    EXPECT_EQ(Empty.RowCount(), 0u);
+    EXPECT_EQ(Empty.ColumnCount(), 0u);
+
+    // a DSV file is not a cache
+    FILE *File = std::fopen(Path.c_str(), "wb");
+    std::fputs("id,name\n1,two\n3,four\n5,six\n7,eight\n", File);
+    std::fclose(File);
+    CColumnarCacheReader NotACache(Path);
+    EXPECT_FALSE(NotACache.IsOpen());
+    EXPECT_EQ(NotACache.RowCount(), 0u);
+    EXPECT_EQ(NotACache.Cell(0, 0), "");
+
+    CColumnarCacheReader Missing("/nonexistent/cache.bin");
+    EXPECT_FALSE(Missing.IsOpen());
+}
+
+TEST(ColumnarCache, CorruptedFilesAreRejected){
+    CTempFile Temp("columnarcachetest");
+    const std::string &Path = Temp.Path();
+    {
+        CColumnarCacheWriter Writer(Path, 0);
+        ASSERT_TRUE(Writer.WriteRow({"aa"}));
+        ASSERT_TRUE(Writer.WriteRow({"bb"}));
+        ASSERT_TRUE(Writer.WriteRow({"cc"}));
+        ASSERT_TRUE(Writer.Close());
+    }
+    std::string Bytes;
+    {
+        FILE *File = std::fopen(Path.c_str(), "rb");
+        ASSERT_TRUE(File);
+        char Buffer[4096];
+        std::size_t Length;
+        while((Length = std::fread(Buffer, 1, sizeof(Buffer), File)) > 0){
+            Bytes.append(Buffer, Length);
+        }
+        std::fclose(File);
+    }
+    auto Rewrite = [&](const std::string &bytes){
+        FILE *File = std::fopen(Path.c_str(), "wb");
+        std::fwrite(bytes.data(), 1, bytes.size(), File);
+        std::fclose(File);
+    };
+    auto Words = [](std::vector<std::uint64_t> words){
+        return std::string(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(std::uint64_t));
+    };
+    // the heap offsets of the only column, and where its directory entry
+    // points at them: plain encoding, then the offsets and heap positions
+    std::size_t OffsetsPosition = Bytes.find(Words({0, 2, 4, 6}));
+    ASSERT_NE(OffsetsPosition, std::string::npos);
+    std::size_t EntryPosition = Bytes.find(Words({0, OffsetsPosition, OffsetsPosition + 32}));
+    ASSERT_LT(EntryPosition, OffsetsPosition);
+    EntryPosition += 8;
+
+    // offsets that run backwards or past the heap are only checked on
+    // lookup, so opening stays independent of the row count; the cells
+    // they bound read as empty
+    std::string Corrupt = Bytes;
+    Corrupt.replace(OffsetsPosition, 32, Words({0, 4, 2, 6}));
+    Rewrite(Corrupt);
+    {
+        CColumnarCacheReader Backwards(Path);
+        ASSERT_TRUE(Backwards.IsOpen());
+        EXPECT_EQ(Backwards.Cell(0, 0), "aabb");
+        EXPECT_EQ(Backwards.Cell(1, 0), "");
+        EXPECT_EQ(Backwards.Cell(2, 0), "bbcc");
+    }
+    Corrupt.replace(OffsetsPosition, 32, Words({0, 2, 9, 6}));
+    Rewrite(Corrupt);
+    {
+        CColumnarCacheReader PastHeap(Path);
+        ASSERT_TRUE(PastHeap.IsOpen());
+        EXPECT_EQ(PastHeap.Cell(0, 0), "aa");
+        EXPECT_EQ(PastHeap.Cell(1, 0), "");
+        EXPECT_EQ(PastHeap.Cell(2, 0), "");
+    }
+
+    // a last offset past the heap is caught at open
+    Corrupt.replace(OffsetsPosition, 32, Words({0, 2, 4, 7}));
+    Rewrite(Corrupt);
+    EXPECT_FALSE(CColumnarCacheReader(Path).IsOpen());
+
+    // a misaligned offsets section
+    Corrupt = Bytes;
+    Corrupt.replace(EntryPosition, 8, Words({OffsetsPosition + 1}));
+    Rewrite(Corrupt);
+    EXPECT_FALSE(CColumnarCacheReader(Path).IsOpen());
+
+    // cut off inside the column data
+    Rewrite(Bytes.substr(0, OffsetsPosition + 16));
+    EXPECT_FALSE(CColumnarCacheReader(Path).IsOpen());
+
+    Rewrite(Bytes);
+    CColumnarCacheReader Intact(Path);
+    ASSERT_TRUE(Intact.IsOpen());
+    EXPECT_EQ(Intact.Cell(2, 0), "cc");
+}
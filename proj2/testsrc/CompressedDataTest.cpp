@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "CompressedDataSource.h"
+#include "CompressedDataSink.h"
+#include "FileDataSource.h"
+#include "FileDataSink.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include "TempFile.h"
+#include "DSVReader.h"
+#include "DSVWriter.h"
+
+namespace{
+
+std::string SampleText(int lines){
+    std::string Text;
+    for(int Index = 0; Index < lines; Index++){
+        Text += std::to_string(Index) + ",name " + std::to_string(Index * 7) + ",\"quoted, value\"\n";
+    }
+    return Text;
+}
+
+std::string Compress(const std::string &text, std::size_t threads, std::size_t blocksize){
+    auto Sink = std::make_shared<CStringDataSink>();
+    {
+        CCompressingDataSink Compressor(Sink, ECompression::Gzip, 6, threads, blocksize);
+        EXPECT_TRUE(Compressor.Write(std::vector<char>(text.begin(), text.end())));
+        EXPECT_TRUE(Compressor.Close());
+    }
+    return Sink->String();
+}
+
+// takes writes until its limit is reached, then fails every one after;
+// the compressing sink only ever has one thread writing at a time
+class CFailingDataSink : public CDataSink{
+    private:
+        std::size_t DWritesLeft;
+
+    public:
+        explicit CFailingDataSink(std::size_t writes) : DWritesLeft(writes){
+
+        }
+
+        bool Put(const char &) noexcept override{
+            return Write(std::vector<char>(1));
+        }
+
+        bool Write(const std::vector<char> &) noexcept override{
+            if(!DWritesLeft){
+                return false;
+            }
+            DWritesLeft--;
+            return true;
+        }
+};
+
+std::string Decompress(const std::string &data, bool background){
+    CDecompressingDataSource Source(std::make_shared<CStringDataSource>(data), background, 1000);
+    std::string Output;
+    std::vector<char> Buffer;
+    while(Source.Read(Buffer, 333)){
+        Output.append(Buffer.begin(), Buffer.end());
+    }
+    EXPECT_FALSE(Source.Failed());
+    return Output;
+}
+
+}
+
+TEST(CompressedData, GzipRoundTrip){
+    std::string Text = SampleText(2000);
+    std::string Compressed = Compress(Text, 1, 1 << 20);
+    ASSERT_GE(Compressed.size(), 2);
+    EXPECT_EQ(static_cast<unsigned char>(Compressed[0]), 0x1F);
+    EXPECT_EQ(static_cast<unsigned char>(Compressed[1]), 0x8B);
+    EXPECT_LT(Compressed.size(), Text.size());
+    EXPECT_EQ(Decompress(Compressed, false), Text);
+    EXPECT_EQ(Decompress(Compressed, true), Text);
+}
+
+TEST(CompressedData, MultiThreadedMultiMember){
+    // small blocks across several threads give many members, still in order
+    std::string Text = SampleText(5000);
+    std::string Compressed = Compress(Text, 3, 4096);
+    EXPECT_EQ(Decompress(Compressed, true), Text);
+}
+
+TEST(CompressedData, SinkFailsDuringAppend){
+    // the workers hit the failing sink while the caller is still appending
+    // blocks; the caller must see the failure and stop, not race on it
+    CCompressingDataSink Compressor(std::make_shared<CFailingDataSink>(3), ECompression::None, 6, 4, 64);
+    std::vector<char> Block(64, 'x');
+    bool Failed = false;
+    for(int Index = 0; Index < 10000 && !Failed; Index++){
+        Failed = !Compressor.Write(Block);
+    }
+    EXPECT_TRUE(Failed);
+    EXPECT_FALSE(Compressor.Write(Block));
+    EXPECT_FALSE(Compressor.Flush());
+    EXPECT_FALSE(Compressor.Close());
+}
+
+TEST(CompressedData, EmptyAndPassThrough){
+    std::string Compressed = Compress("", 2, 1024);
+    EXPECT_FALSE(Compressed.empty());
+    EXPECT_EQ(Decompress(Compressed, false), "");
+
+    CDecompressingDataSource Plain(std::make_shared<CStringDataSource>("a,b\n"), false);
+    EXPECT_EQ(Plain.Format(), ECompression::None);
+    EXPECT_EQ(Decompress("a,b\nc,d\n", true), "a,b\nc,d\n");
+}
+
+TEST(CompressedData, TruncatedStreamFails){
+    std::string Compressed = Compress(SampleText(100), 1, 1 << 20);
+    CDecompressingDataSource Source(std::make_shared<CStringDataSource>(Compressed.substr(0, Compressed.size() / 2)), false);
+    EXPECT_EQ(Source.Format(), ECompression::Gzip);
+    std::vector<char> Buffer;
+    while(Source.Read(Buffer, 100)){
+    }
+    EXPECT_TRUE(Source.Failed());
+}
+
+TEST(CompressedData, DSVThroughCompressedFile){
+    CTempFile Temp("compresseddatatest");
+    const std::string &Path = Temp.Path();
+    ASSERT_FALSE(Path.empty());
+    {
+        auto File = std::make_shared<CFileDataSink>(Path);
+        auto Compressor = std::make_shared<CCompressingDataSink>(File, ECompression::Gzip, 1, 2, 512);
+        CDSVWriter Writer(Compressor, ',');
+        for(int Index = 0; Index < 300; Index++){
+            EXPECT_TRUE(Writer.WriteRow({std::to_string(Index), "x,y", "z"}));
+        }
+        EXPECT_TRUE(Compressor->Close());
+    }
+    auto Source = std::make_shared<CDecompressingDataSource>(std::make_shared<CFileDataSource>(Path));
+    EXPECT_EQ(Source->Format(), ECompression::Gzip);
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    int Rows = 0;
+    while(Reader.ReadRow(Row)){
+        EXPECT_EQ(Row, std::vector<std::string>({std::to_string(Rows), "x,y", "z"}));
+        Rows++;
+    }
+    EXPECT_EQ(Rows, 300);
+}
+
+#ifdef DSV_HAVE_ZSTD
+TEST(CompressedData, ZstdRoundTrip){
+    std::string Text = SampleText(3000);
+    auto Sink = std::make_shared<CStringDataSink>();
+    {
+        CCompressingDataSink Compressor(Sink, ECompression::Zstd, 3, 2, 8192);
+        EXPECT_TRUE(Compressor.Write(std::vector<char>(Text.begin(), Text.end())));
+        EXPECT_TRUE(Compressor.Close());
+    }
+    CDecompressingDataSource Source(std::make_shared<CStringDataSource>(Sink->String()));
+    EXPECT_EQ(Source.Format(), ECompression::Zstd);
+    EXPECT_EQ(Decompress(Sink->String(), false), Text);
+}
+#endif
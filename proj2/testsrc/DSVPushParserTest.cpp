@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "DSVPushParser.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+#include <random>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace{
+
+const std::string Awkward = "a,\"b,c\",\"say \"\"hi\"\"\"\r\n,,\n\n\"multi\r\nline\",x\"\"y\rlast,\"\",\"open";
+
+std::vector< std::vector<std::string> > PullRows(const std::string &text){
+    CDSVReader Reader(std::make_shared<CStringDataSource>(text), ',');
+    std::vector< std::vector<std::string> > Rows;
+    std::vector<std::string> Row;
+    while(!Reader.End()){
+        if(Reader.ReadRow(Row)){
+            Rows.push_back(Row);
+        }
+    }
+    return Rows;
+}
+
+}
+
+TEST(DSVPushParser, WholeInputMatchesReader){
+    CDSVPushParser Parser(',');
+    EXPECT_EQ(Parser.Feed(Awkward.data(), Awkward.size()), 4u);
+    EXPECT_EQ(Parser.Finish(), 1u);
+    std::vector< std::vector<std::string> > Rows;
+    EXPECT_EQ(Parser.TakeRows(Rows), 5u);
+    EXPECT_EQ(Rows, PullRows(Awkward));
+    EXPECT_EQ(Parser.RowCount(), 5u);
+}
+
+TEST(DSVPushParser, CallbackSeesOnlyTheRowsCells){
+    std::vector< std::vector<std::string> > Rows;
+    CDSVPushParser Parser(',', [&](std::span<const std::string> row){ Rows.emplace_back(row.begin(), row.end()); });
+    std::string Text = "a,b,c\nd\n\ne,f,g,h\n";
+    EXPECT_EQ(Parser.Feed(Text.data(), Text.size()), 4u);
+    EXPECT_EQ(Rows, (std::vector< std::vector<std::string> >{{"a", "b", "c"}, {"d"}, {}, {"e", "f", "g", "h"}}));
+}
+
+TEST(DSVPushParser, EverySplitPoint){
+    auto Expected = PullRows(Awkward);
+    for(std::size_t Split = 0; Split <= Awkward.size(); Split++){
+        CDSVPushParser Parser(',');
+        Parser.Feed(Awkward.data(), Split);
+        Parser.Feed(Awkward.data() + Split, Awkward.size() - Split);
+        Parser.Finish();
+        std::vector< std::vector<std::string> > Rows;
+        Parser.TakeRows(Rows);
+        EXPECT_EQ(Rows, Expected) << "split at " << Split;
+    }
+}
+
+TEST(DSVPushParser, RandomChunksWithCallback){
+    std::string Text;
+    for(int Index = 0; Index < 500; Index++){
+        Text += std::to_string(Index) + "|\"q|" + std::to_string(Index) + "\"\"\"|plain text\r\n";
+    }
+    std::string Piped = Text;
+    CDSVReader Reader(std::make_shared<CStringDataSource>(Piped), '|');
+    std::vector< std::vector<std::string> > Expected;
+    std::vector<std::string> Row;
+    while(Reader.ReadRow(Row)){
+        Expected.push_back(Row);
+    }
+
+    std::mt19937 Random(42);
+    std::vector< std::vector<std::string> > Rows;
+    CDSVPushParser Parser('|', [&](std::span<const std::string> row){ Rows.emplace_back(row.begin(), row.end()); });
+    for(std::size_t Position = 0; Position < Text.size();){
+        std::size_t Chunk = std::min<std::size_t>(Random() % 7 + 1, Text.size() - Position);
+        Parser.Feed(Text.data() + Position, Chunk);
+        Position += Chunk;
+    }
+    Parser.Finish();
+    EXPECT_EQ(Rows, Expected);
+}
+
+TEST(DSVPushParser, ResetDropsPartialRow){
+    CDSVPushParser Parser(',');
+    Parser.Feed("a,\"partial", 10);
+    Parser.Reset();
+    Parser.Feed("b,c\n", 4);
+    std::vector< std::vector<std::string> > Rows;
+    ASSERT_EQ(Parser.TakeRows(Rows), 1u);
+    EXPECT_EQ(Rows[0], (std::vector<std::string>{"b", "c"}));
+}
+
+// the sender waits for each row to be acknowledged before sending the next
+// one, so this only finishes if rows are emitted as soon as their last byte
+// arrives rather than when the input ends
+TEST(DSVPushParser, SocketPairRowLatency){
+    int Sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets), 0);
+    const int RowTotal = 200;
+    std::thread Sender([&]{
+        std::mt19937 Random(7);
+        for(int Index = 0; Index < RowTotal; Index++){
+            std::string Line = std::to_string(Index) + ",\"a,b\"\"c\"," + std::string(Index % 50, 'x') + "\n";
+            for(std::size_t Position = 0; Position < Line.size();){
+                std::size_t Chunk = std::min<std::size_t>(Random() % 5 + 1, Line.size() - Position);
+                ASSERT_EQ(write(Sockets[0], Line.data() + Position, Chunk), static_cast<ssize_t>(Chunk));
+                Position += Chunk;
+            }
+            char Ack;
+            ASSERT_EQ(read(Sockets[0], &Ack, 1), 1);
+        }
+        close(Sockets[0]);
+    });
+
+    int Received = 0;
+    CDSVPushParser Parser(',', [&](std::span<const std::string> row){
+        ASSERT_EQ(row.size(), 3u);
+        EXPECT_EQ(row[0], std::to_string(Received));
+        EXPECT_EQ(row[1], "a,b\"c");
+        Received++;
+        char Ack = 1;
+        EXPECT_EQ(write(Sockets[1], &Ack, 1), 1);
+    });
+    char Buffer[64];
+    ssize_t Length;
+    while((Length = read(Sockets[1], Buffer, sizeof(Buffer))) > 0){
+        Parser.Feed(Buffer, Length);
+    }
+    Parser.Finish();
+    Sender.join();
+    close(Sockets[1]);
+    EXPECT_EQ(Received, RowTotal);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "DSVReaderTemplate.h"
+#include "DSVReader.h"
+#include "FileDataSource.h"
+#include "StringDataSource.h"
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+
+namespace{
+
+// awkward input for the common dialects: quoted delimiters and newlines,
+// doubled quotes, all three line endings, empty cells and lines, and a last
+// row without a line ending
+std::string Awkward(char delimiter){
+    std::string Text = "a,\"b,c\",\"say \"\"hi\"\"\"\r\n,,\n\n\"multi\nline\",x\"\"y\rlast,\"\",\"open";
+    std::replace(Text.begin(), Text.end(), ',', delimiter);
+    return Text;
+}
+
+std::vector< std::vector<std::string> > ReadAll(CDSVReader &reader){
+    std::vector< std::vector<std::string> > Rows;
+    std::vector<std::string> Row;
+    while(!reader.End()){
+        if(reader.ReadRow(Row)){
+            Rows.push_back(Row);
+        }
+    }
+    return Rows;
+}
+
+template <typename TReader>
+std::vector< std::vector<std::string> > ReadAll(TReader &reader){
+    std::vector< std::vector<std::string> > Rows;
+    std::vector<std::string> Row;
+    while(!reader.End()){
+        if(reader.ReadRow(Row)){
+            Rows.push_back(Row);
+        }
+    }
+    return Rows;
+}
+
+// ':' is not a compiled dialect, so this goes through the runtime parser
+std::vector< std::vector<std::string> > RuntimeRows(std::string text, char delimiter){
+    std::replace(text.begin(), text.end(), delimiter, ':');
+    CDSVReader Reader(std::make_shared<CStringDataSource>(text), ':');
+    auto Rows = ReadAll(Reader);
+    for(auto &Row : Rows){
+        for(auto &Cell : Row){
+            std::replace(Cell.begin(), Cell.end(), ':', delimiter);
+        }
+    }
+    return Rows;
+}
+
+}
+
+TEST(DSVReaderTemplate, CommonDialectsMatchRuntimeParser){
+    for(char Delimiter : {',', '\t', '|', ';'}){
+        std::string Text = Awkward(Delimiter);
+        CDSVReader Reader(std::make_shared<CStringDataSource>(Text), Delimiter);
+        auto Rows = ReadAll(Reader);
+        EXPECT_EQ(Rows, RuntimeRows(Text, Delimiter)) << "delimiter " << int(Delimiter);
+        ASSERT_EQ(Rows.size(), 5u);
+        EXPECT_EQ(Rows[0], (std::vector<std::string>{"a", std::string("b") + Delimiter + "c", "say \"hi\""}));
+        EXPECT_EQ(Rows[1], (std::vector<std::string>{"", "", ""}));
+        EXPECT_TRUE(Rows[2].empty());
+        EXPECT_EQ(Rows[3], (std::vector<std::string>{"multi\nline", "x\"y"}));
+        // as in CDSVReader, a doubled quote is a literal quote even outside quotes
+        EXPECT_EQ(Rows[4], (std::vector<std::string>{"last", "\"", "open"}));
+    }
+}
+
+TEST(DSVReaderTemplate, FileSourceInstantiation){
+    char Path[] = "/tmp/dsvreadertemplatetestXXXXXX";
+    int Descriptor = mkstemp(Path);
+    ASSERT_GE(Descriptor, 0);
+    std::string Text = Awkward(',');
+    ASSERT_EQ(write(Descriptor, Text.data(), Text.size()), static_cast<ssize_t>(Text.size()));
+    close(Descriptor);
+
+    // a tiny buffer makes quotes and "\r\n" straddle refills
+    CDSVReader Reader(std::make_shared<CFileDataSource>(Path, 3), ',');
+    EXPECT_EQ(ReadAll(Reader), RuntimeRows(Text, ','));
+
+    TDSVReader<',', '"', EDSVLineEnding::Any, false, CFileDataSource> Direct(std::make_shared<CFileDataSource>(Path, 5));
+    std::vector<std::string_view> Views;
+    ASSERT_TRUE(Direct.ReadRow(Views));
+    ASSERT_EQ(Views.size(), 3u);
+    EXPECT_EQ(Views[2], "say \"hi\"");
+    std::remove(Path);
+}
+
+TEST(DSVReaderTemplate, CustomQuoteAndLineEnding){
+    TDSVReader<';', '\'', EDSVLineEnding::LF> Reader(std::make_shared<CStringDataSource>("'a;b';c\r\n'it''s'\n"));
+    auto Rows = ReadAll(Reader);
+    ASSERT_EQ(Rows.size(), 2u);
+    // with LF endings the '\r' stays in the cell
+    EXPECT_EQ(Rows[0], (std::vector<std::string>{"a;b", "c\r"}));
+    EXPECT_EQ(Rows[1], (std::vector<std::string>{"it's"}));
+}
+
+TEST(DSVReaderTemplate, Trim){
+    TDSVReader<',', '"', EDSVLineEnding::Any, true> Reader(std::make_shared<CStringDataSource>("  a ,\t\" b \" , c d\t\n   \n x"));
+    auto Rows = ReadAll(Reader);
+    ASSERT_EQ(Rows.size(), 3u);
+    EXPECT_EQ(Rows[0], (std::vector<std::string>{"a", " b ", "c d"}));
+    EXPECT_TRUE(Rows[1].empty());
+    EXPECT_EQ(Rows[2], (std::vector<std::string>{"x"}));
+}
+
+TEST(DSVReaderTemplate, PMRRows){
+    TDSVReader<'|'> Reader(std::make_shared<CStringDataSource>("1|\"2|3\"\n"));
+    std::pmr::vector<std::pmr::string> Row;
+    ASSERT_TRUE(Reader.ReadRow(Row));
+    ASSERT_EQ(Row.size(), 2u);
+    EXPECT_EQ(Row[1], "2|3");
+    EXPECT_FALSE(Reader.ReadRow(Row));
+    EXPECT_TRUE(Reader.End());
+}
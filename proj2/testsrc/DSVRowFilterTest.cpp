@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "DSVReader.h"
+#include "DSVRowFilter.h"
+#include "FileDataSource.h"
+#include "StringDataSource.h"
+#include <cstdio>
+#include <unistd.h>
+
+namespace{
+
+std::string Sample(){
+    std::string Text;
+    const char *Statuses[] = {"OK", "FAIL", "\"OK, mostly\"", "RETRY"};
+    for(int Index = 0; Index < 400; Index++){
+        Text += std::to_string(Index) + "," + Statuses[Index % 4] + "," + std::to_string(1000 + Index * 3) + ".5,\"note \"\"" + std::to_string(Index) + "\"\"\"\r\n";
+        if(Index % 50 == 0){
+            // short and empty rows
+            Text += "short\n\n";
+        }
+    }
+    return Text + "399,OK,2196.5,no newline at the end";
+}
+
+// what the filter should return: every row read, then checked
+std::vector< std::vector<std::string> > Expected(const std::string &text, const CDSVRowFilter &filter){
+    CDSVReader Reader(std::make_shared<CStringDataSource>(text), ',');
+    std::vector< std::vector<std::string> > Rows;
+    std::vector<std::string> Row;
+    while(!Reader.End()){
+        if(Reader.ReadRow(Row) && filter.Matches(Row)){
+            Rows.push_back(Row);
+        }
+    }
+    return Rows;
+}
+
+std::vector< std::vector<std::string> > Filtered(std::shared_ptr<CDataSource> source, const CDSVRowFilter &filter){
+    CDSVReader Reader(source, ',');
+    std::vector< std::vector<std::string> > Rows;
+    std::vector<std::string> Row;
+    while(Reader.ReadRow(Row, filter)){
+        Rows.push_back(Row);
+    }
+    EXPECT_TRUE(Reader.End());
+    return Rows;
+}
+
+}
+
+TEST(DSVRowFilter, Predicates){
+    CDSVRowFilter Filter;
+    Filter.Equals(0, "ab").Prefix(1, "x").Range(2, 1.5, 10).OneOf(3, {"p", "q"});
+    EXPECT_TRUE(Filter.Matches({"ab", "xyz", "2", "q"}));
+    EXPECT_TRUE(Filter.Matches({"ab", "x", " +10", "p", "extra"}));
+    EXPECT_FALSE(Filter.Matches({"abc", "xyz", "2", "q"}));
+    EXPECT_FALSE(Filter.Matches({"ab", "yx", "2", "q"}));
+    EXPECT_FALSE(Filter.Matches({"ab", "x", "10.5", "q"}));
+    EXPECT_FALSE(Filter.Matches({"ab", "x", "2 apples", "q"}));
+    EXPECT_FALSE(Filter.Matches({"ab", "x", "", "q"}));
+    EXPECT_FALSE(Filter.Matches({"ab", "x", "2", "r"}));
+    EXPECT_FALSE(Filter.Matches({"ab", "x", "2"}));
+    EXPECT_EQ(Filter.ColumnCount(), 4u);
+    EXPECT_FALSE(Filter.HasPredicates(4));
+}
+
+TEST(DSVRowFilter, ReaderMatchesReadThenFilter){
+    std::string Text = Sample();
+    std::vector<CDSVRowFilter> Filters(5);
+    Filters[0].Equals(1, "OK");
+    Filters[1].Equals(1, "OK, mostly");
+    Filters[2].Range(2, 1100, 1300).Prefix(3, "note \"1");
+    Filters[3].OneOf(1, {"FAIL", "RETRY"}).Equals(0, "7");
+    // Filters[4] has no predicates and keeps every row, short and empty ones too
+    for(auto &Filter : Filters){
+        auto Rows = Filtered(std::make_shared<CStringDataSource>(Text), Filter);
+        EXPECT_EQ(Rows, Expected(Text, Filter));
+    }
+    EXPECT_EQ(Filtered(std::make_shared<CStringDataSource>(Text), Filters[0]).size(), 101u);
+    EXPECT_EQ(Filtered(std::make_shared<CStringDataSource>(Text), Filters[3]).size(), 1u);
+}
+
+TEST(DSVRowFilter, FileSource){
+    char Path[] = "/tmp/dsvrowfiltertestXXXXXX";
+    int Descriptor = mkstemp(Path);
+    ASSERT_GE(Descriptor, 0);
+    std::string Text = Sample();
+    ASSERT_EQ(write(Descriptor, Text.data(), Text.size()), static_cast<ssize_t>(Text.size()));
+    close(Descriptor);
+
+    CDSVRowFilter Filter;
+    Filter.Prefix(3, "note \"3").Range(0, 0, 350);
+    // a small buffer so runs are split across refills
+    auto Rows = Filtered(std::make_shared<CFileDataSource>(Path, 7), Filter);
+    EXPECT_EQ(Rows, Expected(Text, Filter));
+    EXPECT_FALSE(Rows.empty());
+    std::remove(Path);
+}
+
+TEST(DSVRowFilter, MixedWithPlainReads){
+    CDSVReader Reader(std::make_shared<CStringDataSource>("h1,h2\na,1\nb,2\nc,1\n"), ',');
+    std::vector<std::string> Row;
+    ASSERT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, (std::vector<std::string>{"h1", "h2"}));
+    CDSVRowFilter Filter;
+    Filter.Equals(1, "1");
+    ASSERT_TRUE(Reader.ReadRow(Row, Filter));
+    EXPECT_EQ(Row[0], "a");
+    ASSERT_TRUE(Reader.ReadRow(Row, Filter));
+    EXPECT_EQ(Row[0], "c");
+    EXPECT_FALSE(Reader.ReadRow(Row, Filter));
+    EXPECT_TRUE(Row.empty());
+}
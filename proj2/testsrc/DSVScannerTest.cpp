@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "DSVReader.h"
+#include "DSVScanner.h"
+#include "StringDataSource.h"
+#include <cstdio>
+#include <random>
+#include <unistd.h>
+
+namespace{
+
+// what a full parse says about the same input
+SDSVScanStats ReaderStats(const std::string &text){
+    CDSVReader Reader(std::make_shared<CStringDataSource>(text), ',');
+    SDSVScanStats Stats;
+    std::vector<std::string> Row;
+    while(!Reader.End()){
+        if(Reader.ReadRow(Row)){
+            Stats.DRowCount++;
+            Stats.DFieldCountHistogram[Row.size()]++;
+            Stats.DMaxFieldCount = std::max(Stats.DMaxFieldCount, Row.size());
+        }
+    }
+    return Stats;
+}
+
+SDSVScanStats Scan(const std::string &text, std::size_t piece){
+    CDSVScanner Scanner(',');
+    for(std::size_t Offset = 0; Offset < text.size(); Offset += piece){
+        Scanner.Feed(text.data() + Offset, std::min(piece, text.size() - Offset));
+    }
+    return Scanner.Finish();
+}
+
+}
+
+TEST(DSVScanner, MatchesReaderOnRandomInput){
+    std::mt19937 Generator(46);
+    const char Alphabet[] = {'a', 'b', ',', '"', '\n', '\r'};
+    for(int Round = 0; Round < 200; Round++){
+        std::string Text;
+        std::size_t Length = Generator() % 300;
+        for(std::size_t Index = 0; Index < Length; Index++){
+            Text += Alphabet[Generator() % sizeof(Alphabet)];
+        }
+        SDSVScanStats Expected = ReaderStats(Text);
+        for(std::size_t Piece : {Text.size() + 1, std::size_t(1), std::size_t(7), std::size_t(64), std::size_t(65)}){
+            SDSVScanStats Stats = Scan(Text, Piece);
+            ASSERT_EQ(Stats.DRowCount, Expected.DRowCount) << Text;
+            ASSERT_EQ(Stats.DFieldCountHistogram, Expected.DFieldCountHistogram) << Text;
+            ASSERT_EQ(Stats.DMaxFieldCount, Expected.DMaxFieldCount);
+            ASSERT_EQ(Stats.DBytes, Text.size());
+        }
+    }
+}
+
+TEST(DSVScanner, FieldLengthsAndConsistency){
+    std::string Text = "id,name\r\n1,\"Smith, \"\"J\"\"\"\r\n\n2,x\n";
+    SDSVScanStats Stats = Scan(Text, 3);
+    EXPECT_EQ(Stats.DRowCount, 4u);
+    EXPECT_EQ(Stats.DMaxFieldCount, 2u);
+    // the quoted field as stored, quotes included
+    EXPECT_EQ(Stats.DMaxFieldLength, 14u);
+    EXPECT_EQ(Stats.DFieldCountHistogram, (std::map<std::size_t, std::uint64_t>{{0, 1}, {2, 3}}));
+    EXPECT_FALSE(Stats.Consistent());
+    EXPECT_EQ(Stats.DMalformedRowCount, 0u);
+    EXPECT_TRUE(Scan("a,b\nc,d", 64).Consistent());
+}
+
+TEST(DSVScanner, MalformedRowOffsets){
+    // a stray quote, text after a closing quote and a quote left open
+    std::string Text = "ok,\"fine\"\nab\"c\"d,e\n\"x\"y,z\nok,\"\"\n\"open,\nrow";
+    SDSVScanStats Stats = Scan(Text, 5);
+    EXPECT_EQ(Stats.DRowCount, 5u);
+    EXPECT_EQ(Stats.DMalformedRowCount, 3u);
+    EXPECT_EQ(Stats.DMalformedRowOffsets, (std::vector<std::uint64_t>{10, 19, 32}));
+
+    CDSVScanner Limited(',', 1);
+    Limited.Feed(Text.data(), Text.size());
+    EXPECT_EQ(Limited.Finish().DMalformedRowOffsets, (std::vector<std::uint64_t>{10}));
+    EXPECT_EQ(Limited.Stats().DMalformedRowCount, 3u);
+}
+
+TEST(DSVScanner, ScanFile){
+    char Path[] = "/tmp/dsvscannertestXXXXXX";
+    int Descriptor = mkstemp(Path);
+    ASSERT_GE(Descriptor, 0);
+    std::string Text;
+    for(int Index = 0; Index < 5000; Index++){
+        Text += std::to_string(Index) + "\t\"multi\nline\"\tend\n";
+    }
+    ASSERT_EQ(write(Descriptor, Text.data(), Text.size()), static_cast<ssize_t>(Text.size()));
+    close(Descriptor);
+    SDSVScanStats Stats;
+    ASSERT_TRUE(CDSVScanner::ScanFile(Path, '\t', Stats));
+    EXPECT_EQ(Stats.DRowCount, 5000u);
+    EXPECT_EQ(Stats.DFieldCountHistogram, (std::map<std::size_t, std::uint64_t>{{3, 5000}}));
+    EXPECT_EQ(Stats.DMaxFieldLength, 12u);
+    EXPECT_FALSE(CDSVScanner::ScanFile("/nonexistent/file", '\t', Stats));
+    std::remove(Path);
+}
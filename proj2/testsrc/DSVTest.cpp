@@ -122,3 +122,32 @@ TEST(DSVTest, ExtraWhitespaceHandling) {
 
     EXPECT_EQ(sink->String(), "  a , b ,c\n1,2 , 3\n");  // Expect the original spacing to be preserved.
 }
+
+TEST(DSVTest, ReusedRowShrinksAndGrows) {
+    std::shared_ptr<CStringDataSource> src = std::make_shared<CStringDataSource>("a,b,c,d\n\nx\n\"q\"\"\",\n");
+    CDSVReader reader(src, ',');
+
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"a", "b", "c", "d"}));
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_TRUE(row.empty());
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"x"}));
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"q\"", ""}));
+    EXPECT_TRUE(reader.End());
+}
+
+TEST(DSVTest, ReadRowAsViews) {
+    std::shared_ptr<CStringDataSource> src = std::make_shared<CStringDataSource>("a,\"b,c\"\n1\n");
+    CDSVReader reader(src, ',');
+
+    std::vector<std::string_view> row;
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string_view>({"a", "b,c"}));
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string_view>({"1"}));
+    EXPECT_FALSE(reader.ReadRow(row));
+    EXPECT_TRUE(row.empty());
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "ExternalSort.h"
+#include "SpillFile.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include <algorithm>
+
+namespace{
+
+std::vector< std::vector<std::string> > SortRows(const std::string &input, std::vector<SSortKey> keys, std::size_t budget, std::size_t *runs = nullptr){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVReader Reader(std::make_shared<CStringDataSource>(input), ',');
+    CDSVWriter Writer(Sink, ',');
+    CExternalSort Sorter(std::move(keys), budget, 3);
+    EXPECT_TRUE(Sorter.Sort(Reader, Writer));
+    if(runs){
+        *runs = Sorter.RunCount();
+    }
+    CDSVReader Output(std::make_shared<CStringDataSource>(Sink->String()), ',');
+    std::vector< std::vector<std::string> > Rows;
+    std::vector<std::string> Row;
+    while(Output.ReadRow(Row)){
+        Rows.push_back(Row);
+    }
+    return Rows;
+}
+
+std::string Sample(int rows){
+    std::string Text;
+    unsigned Seed = 12345;
+    for(int Index = 0; Index < rows; Index++){
+        Seed = Seed * 1103515245 + 12345;
+        Text += std::to_string(Index) + ",k" + std::to_string((Seed >> 8) % 50) + "," + std::to_string(static_cast<int>((Seed >> 4) % 2000) - 1000) + ".5,\"x, " + std::to_string(Index) + "\"\n";
+    }
+    return Text;
+}
+
+}
+
+TEST(ExternalSort, InMemoryAndSpilledAgree){
+    std::string Input = Sample(5000);
+    std::vector<SSortKey> Keys = {{1}, {2, true, true}};
+    std::size_t Runs;
+    auto InMemory = SortRows(Input, Keys, std::size_t(1) << 30, &Runs);
+    EXPECT_EQ(Runs, 0u);
+    // small budget forces hundreds of runs, more than one merge pass takes
+    auto Spilled = SortRows(Input, Keys, 2000, &Runs);
+    EXPECT_GT(Runs, 128u);
+    ASSERT_EQ(InMemory.size(), 5000u);
+    EXPECT_EQ(InMemory, Spilled);
+
+    // compare with a plain stable sort
+    CDSVReader Reader(std::make_shared<CStringDataSource>(Input), ',');
+    std::vector< std::vector<std::string> > Expected;
+    std::vector<std::string> Row;
+    while(Reader.ReadRow(Row)){
+        Expected.push_back(Row);
+    }
+    std::stable_sort(Expected.begin(), Expected.end(), [](const auto &left, const auto &right){
+        if(left[1] != right[1]){
+            return left[1] < right[1];
+        }
+        return std::stod(left[2]) > std::stod(right[2]);
+    });
+    EXPECT_EQ(InMemory, Expected);
+}
+
+TEST(ExternalSort, StableWithMissingAndNonNumericCells){
+    std::string Input = "b,10\na,x\nc\nd,2\ne,10\nf,-3\n";
+    std::size_t Runs;
+    auto Rows = SortRows(Input, {{1, true}}, 1, &Runs);
+    EXPECT_EQ(Runs, 6u);
+    std::vector<std::string> Order;
+    for(auto &Row : Rows){
+        Order.push_back(Row[0]);
+    }
+    // equal keys (10, and the two non-numbers) keep their input order
+    EXPECT_EQ(Order, std::vector<std::string>({"f", "d", "b", "e", "a", "c"}));
+    EXPECT_EQ(Rows[5], std::vector<std::string>({"c"}));
+}
+
+TEST(ExternalSort, EmptyInput){
+    EXPECT_TRUE(SortRows("", {{0}}, 100).empty());
+}
+
+TEST(ExternalSort, SpillFileEndIsNotAFailure){
+    CSpillFile File;
+    ASSERT_TRUE(File.Valid());
+    ASSERT_TRUE(File.Write(std::vector<std::string>{"a", ""}));
+    ASSERT_TRUE(File.Write(std::vector<std::string>{}));
+    ASSERT_TRUE(File.Rewind());
+    std::vector<std::string> Row;
+    ASSERT_TRUE(File.Read(Row));
+    EXPECT_EQ(Row, (std::vector<std::string>{"a", ""}));
+    ASSERT_TRUE(File.Read(Row));
+    EXPECT_TRUE(Row.empty());
+    EXPECT_FALSE(File.Read(Row));
+    EXPECT_FALSE(File.Failed());
+}
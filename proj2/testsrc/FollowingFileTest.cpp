@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "DSVReader.h"
+#include "FollowingDSVReader.h"
+#include "FollowingFileDataSource.h"
+#include "FollowingXMLReader.h"
+#include "TempFile.h"
+#include <chrono>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+
+namespace{
+
+// appends like a logging process would, with one write per call
+void Append(const std::string &path, const std::string &text){
+    int Descriptor = open(path.c_str(), O_WRONLY | O_APPEND);
+    ASSERT_GE(Descriptor, 0);
+    ASSERT_EQ(write(Descriptor, text.data(), text.size()), static_cast<ssize_t>(text.size()));
+    close(Descriptor);
+}
+
+}
+
+TEST(FollowingFileDataSource, WaitsForAppends){
+    CTempFile Temp("followingfiletest");
+    const std::string &Path = Temp.Path();
+    Append(Path, "abc");
+    CFollowingFileDataSource Source(Path, 1);
+    ASSERT_TRUE(Source.IsOpen());
+    EXPECT_EQ(Source.Buffered(), "bc");
+    Source.Consume(2);
+    EXPECT_EQ(Source.Offset(), 3u);
+    EXPECT_TRUE(Source.Buffered().empty());
+    EXPECT_FALSE(Source.Wait(20));
+
+    auto Start = std::chrono::steady_clock::now();
+    std::thread Writer([&]{
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Append(Path, "de");
+    });
+    char Char;
+    ASSERT_TRUE(Source.Get(Char));
+    EXPECT_EQ(Char, 'd');
+    // woken by the append, not by a timeout or a polling interval
+    EXPECT_LT(std::chrono::steady_clock::now() - Start, std::chrono::seconds(2));
+    Writer.join();
+    ASSERT_TRUE(Source.Get(Char));
+    EXPECT_EQ(Char, 'e');
+    EXPECT_EQ(Source.Offset(), 5u);
+
+    std::thread Stopper([&]{
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Source.Stop();
+    });
+    EXPECT_TRUE(Source.End());
+    Stopper.join();
+    EXPECT_FALSE(Source.Get(Char));
+}
+
+TEST(FollowingFileDataSource, BlockingReaderWithTimeout){
+    CTempFile Temp("followingfiletest");
+    const std::string &Path = Temp.Path();
+    Append(Path, "a,b\nc,d\n");
+    auto Source = std::make_shared<CFollowingFileDataSource>(Path);
+    Source->SetTimeout(10);
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    ASSERT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, (std::vector<std::string>{"a", "b"}));
+    ASSERT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, (std::vector<std::string>{"c", "d"}));
+    EXPECT_TRUE(Reader.End());
+    Append(Path, "e\n");
+    EXPECT_FALSE(Reader.End());
+    ASSERT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, (std::vector<std::string>{"e"}));
+}
+
+TEST(FollowingDSVReader, PartialRowAndResume){
+    CTempFile Temp("followingfiletest");
+    const std::string &Path = Temp.Path();
+    Append(Path, "a,b\r");
+    CFollowingDSVReader Reader(Path, ',');
+    ASSERT_TRUE(Reader.IsOpen());
+    std::vector<std::string> Row;
+    ASSERT_TRUE(Reader.ReadRow(Row, 0));
+    EXPECT_EQ(Row, (std::vector<std::string>{"a", "b"}));
+    SDSVCheckpoint Saved = Reader.Checkpoint();
+    EXPECT_EQ(Saved.DOffset, 4u);
+    EXPECT_TRUE(Saved.DPendingReturn);
+
+    // the '\n' finishing "\r\n" and a row cut off inside quotes
+    Append(Path, "\n\"x,");
+    EXPECT_FALSE(Reader.ReadRow(Row, 10));
+    std::thread Writer([&]{
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Append(Path, "y\",z\nnext\n");
+    });
+    ASSERT_TRUE(Reader.ReadRow(Row, 5000));
+    Writer.join();
+    EXPECT_EQ(Row, (std::vector<std::string>{"x,y", "z"}));
+
+    // a new reader from the saved checkpoint neither repeats a row nor sees
+    // a blank one for the '\n' after the '\r'
+    CFollowingDSVReader Resumed(Path, ',', Saved);
+    ASSERT_TRUE(Resumed.ReadRow(Row, 0));
+    EXPECT_EQ(Row, (std::vector<std::string>{"x,y", "z"}));
+    ASSERT_TRUE(Resumed.ReadRow(Row, 0));
+    EXPECT_EQ(Row, (std::vector<std::string>{"next"}));
+    EXPECT_FALSE(Resumed.ReadRow(Row, 0));
+    EXPECT_EQ(Resumed.Checkpoint().DOffset, 18u);
+}
+
+TEST(FollowingDSVReader, StopWakesReader){
+    CTempFile Temp("followingfiletest");
+    const std::string &Path = Temp.Path();
+    CFollowingDSVReader Reader(Path, ',');
+    std::thread Stopper([&]{
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Reader.Stop();
+    });
+    std::vector<std::string> Row;
+    EXPECT_FALSE(Reader.ReadRow(Row));
+    Stopper.join();
+}
+
+TEST(FollowingXMLReader, PartialElementAndResume){
+    CTempFile Temp("followingfiletest");
+    const std::string &Path = Temp.Path();
+    Append(Path, "<log><entry id=\"1\">one</entry><mark/><entry id=\"2");
+    CFollowingXMLReader Reader(Path);
+    ASSERT_TRUE(Reader.IsOpen());
+    SXMLEntity Entity;
+    std::vector<std::string> Seen;
+    while(Reader.ReadEntity(Entity, false, 0)){
+        Seen.push_back(Entity.DNameData);
+    }
+    EXPECT_EQ(Seen, (std::vector<std::string>{"log", "entry", "one", "entry", "mark", "mark"}));
+
+    CFollowingXMLReader Again(Path);
+    for(int Index = 0; Index < 5; Index++){
+        ASSERT_TRUE(Again.ReadEntity(Entity, false, 0));
+    }
+    // just after <mark/> was reported as a start element
+    SXMLCheckpoint Saved = Again.Checkpoint();
+    EXPECT_EQ(Saved.DOffset, 37u);
+    EXPECT_EQ(Saved.DOpenElements, (std::vector<std::string>{"log", "mark"}));
+    EXPECT_TRUE(Saved.DCloseInnermost);
+
+    Append(Path, "\">two</entry>");
+    ASSERT_TRUE(Reader.ReadEntity(Entity, false, 1000));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(Entity.AttributeValue("id"), "2");
+
+    CFollowingXMLReader Resumed(Path, Saved);
+    ASSERT_TRUE(Resumed.ReadEntity(Entity, false, 0));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(Entity.DNameData, "mark");
+    ASSERT_TRUE(Resumed.ReadEntity(Entity, true, 0));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(Entity.AttributeValue("id"), "2");
+    ASSERT_TRUE(Resumed.ReadEntity(Entity, true, 0));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(Resumed.Checkpoint().DOpenElements, (std::vector<std::string>{"log"}));
+    EXPECT_FALSE(Resumed.ReadEntity(Entity, false, 0));
+    EXPECT_FALSE(Resumed.Failed());
+}
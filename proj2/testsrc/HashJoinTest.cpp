@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "HashJoin.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include <algorithm>
+
+namespace{
+
+std::vector< std::vector<std::string> > RunJoin(const std::string &build, const std::string &probe, CHashJoin &join){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVReader Build(std::make_shared<CStringDataSource>(build), ',');
+    CDSVReader Probe(std::make_shared<CStringDataSource>(probe), ',');
+    CDSVWriter Writer(Sink, ',');
+    EXPECT_TRUE(join.Join(Build, Probe, Writer));
+    CDSVReader Output(std::make_shared<CStringDataSource>(Sink->String()), ',');
+    std::vector< std::vector<std::string> > Rows;
+    std::vector<std::string> Row;
+    while(Output.ReadRow(Row)){
+        Rows.push_back(Row);
+    }
+    EXPECT_EQ(Rows.size(), join.OutputRows());
+    return Rows;
+}
+
+}
+
+TEST(HashJoin, InnerAndLeft){
+    std::string Build = "1,Davis\n2,Sacramento\n2,\"Sac, CA\"\n4,Dixon\n";
+    std::string Probe = "a,1\nb,2\nc,3\nd,1\n";
+    CHashJoin Inner({0}, {1});
+    EXPECT_EQ(RunJoin(Build, Probe, Inner), std::vector< std::vector<std::string> >({
+        {"a", "1", "Davis"}, {"b", "2", "Sacramento"}, {"b", "2", "Sac, CA"}, {"d", "1", "Davis"}}));
+    EXPECT_FALSE(Inner.Spilled());
+
+    CHashJoin Left({0}, {1}, EJoinType::Left);
+    EXPECT_EQ(RunJoin(Build, Probe, Left), std::vector< std::vector<std::string> >({
+        {"a", "1", "Davis"}, {"b", "2", "Sacramento"}, {"b", "2", "Sac, CA"}, {"c", "3", ""}, {"d", "1", "Davis"}}));
+}
+
+TEST(HashJoin, MultiColumnKeysAndRaggedRows){
+    std::string Build = "x,1,first\nx,2,second,extra\ny,1\n";
+    std::string Probe = "1,x\n2,x\n1,y\n2,y\n";
+    CHashJoin Join({0, 1}, {1, 0}, EJoinType::Left);
+    EXPECT_EQ(RunJoin(Build, Probe, Join), std::vector< std::vector<std::string> >({
+        {"1", "x", "first", ""}, {"2", "x", "second", "extra"}, {"1", "y", "", ""}, {"2", "y", "", ""}}));
+}
+
+TEST(HashJoin, MismatchedKeyCountsFail){
+    // joining on a prefix of the keys would match rows that differ
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVReader Build(std::make_shared<CStringDataSource>("x,1\n"), ',');
+    CDSVReader Probe(std::make_shared<CStringDataSource>("x,2\n"), ',');
+    CDSVWriter Writer(Sink, ',');
+    CHashJoin Join({0, 1}, {0});
+    EXPECT_FALSE(Join.Join(Build, Probe, Writer));
+    EXPECT_EQ(Join.OutputRows(), 0u);
+    EXPECT_EQ(Sink->String(), "");
+}
+
+TEST(HashJoin, GraceModeMatchesInMemory){
+    std::string Build, Probe;
+    for(int Index = 0; Index < 3000; Index++){
+        Build += "k" + std::to_string(Index % 1000) + ",v" + std::to_string(Index) + "\n";
+    }
+    for(int Index = 0; Index < 2000; Index++){
+        Probe += std::to_string(Index) + ",k" + std::to_string(Index * 7 % 1500) + "\n";
+    }
+    for(EJoinType Type : {EJoinType::Inner, EJoinType::Left}){
+        CHashJoin InMemory({0}, {1}, Type);
+        auto Expected = RunJoin(Build, Probe, InMemory);
+        EXPECT_FALSE(InMemory.Spilled());
+        CHashJoin Grace({0}, {1}, Type, 16 * 1024, 8);
+        auto Actual = RunJoin(Build, Probe, Grace);
+        EXPECT_TRUE(Grace.Spilled());
+        // grace output is grouped by partition, so compare as sets
+        std::sort(Expected.begin(), Expected.end());
+        std::sort(Actual.begin(), Actual.end());
+        EXPECT_EQ(Actual, Expected);
+        EXPECT_EQ(Expected.size(), Type == EJoinType::Inner ? 4071u : 4714u);
+    }
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "MemoryArena.h"
+#include "DSVReader.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+
+namespace{
+
+// counts the calls that reach the underlying heap
+class CCountingResource : public std::pmr::memory_resource{
+    public:
+        std::size_t DAllocations = 0;
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override{
+            DAllocations++;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) override{
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override{
+            return this == &other;
+        }
+};
+
+}
+
+TEST(MemoryArena, AllocateAndReset){
+    CCountingResource Upstream;
+    CMemoryArena Arena(256, &Upstream);
+
+    void *First = Arena.allocate(10, 1);
+    void *Aligned = Arena.allocate(8, 8);
+    EXPECT_EQ(reinterpret_cast<std::size_t>(Aligned) % 8, 0);
+    EXPECT_NE(First, Aligned);
+    EXPECT_NE(Arena.allocate(1000, 16), nullptr);
+    EXPECT_EQ(Upstream.DAllocations, 2);
+    EXPECT_GE(Arena.BytesReserved(), 1256);
+
+    // the same pattern after a reset is served entirely from retained blocks
+    Arena.Reset();
+    EXPECT_EQ(Arena.BytesUsed(), 0);
+    EXPECT_EQ(Arena.allocate(10, 1), First);
+    EXPECT_EQ(Arena.allocate(8, 8), Aligned);
+    EXPECT_NE(Arena.allocate(1000, 16), nullptr);
+    EXPECT_EQ(Upstream.DAllocations, 2);
+    EXPECT_EQ(Arena.UpstreamAllocations(), 2);
+
+    Arena.Release();
+    EXPECT_EQ(Arena.BytesReserved(), 0);
+}
+
+TEST(MemoryArena, DSVRowsSteadyState){
+    std::string Input;
+    for(int Index = 0; Index < 200; Index++){
+        Input += "a fairly long first cell to avoid small string storage," + std::to_string(Index) + ",\"quoted, cell with a \"\"quote\"\" inside\"\n";
+    }
+    auto Source = std::make_shared<CStringDataSource>(Input);
+    CDSVReader Reader(Source, ',');
+    CCountingResource Upstream;
+    CMemoryArena Arena(4096, &Upstream);
+
+    std::size_t AllocationsAfterFirstBatch = 0;
+    int Rows = 0;
+    while(!Reader.End()){
+        {
+            // one batch of ten rows built in the arena
+            std::pmr::vector< std::pmr::vector< std::pmr::string > > Batch(&Arena);
+            for(int Index = 0; Index < 10 && !Reader.End(); Index++){
+                Batch.emplace_back();
+                ASSERT_TRUE(Reader.ReadRow(Batch.back()));
+                ASSERT_EQ(Batch.back().size(), 3);
+                EXPECT_EQ(std::string_view(Batch.back()[1]), std::to_string(Rows));
+                EXPECT_EQ(std::string_view(Batch.back()[2]), "quoted, cell with a \"quote\" inside");
+                Rows++;
+            }
+        }
+        Arena.Reset();
+        if(Rows == 10){
+            AllocationsAfterFirstBatch = Upstream.DAllocations;
+        }
+    }
+    EXPECT_EQ(Rows, 200);
+    EXPECT_EQ(Upstream.DAllocations, AllocationsAfterFirstBatch);
+}
+
+TEST(MemoryArena, XMLReaderResource){
+    std::string Input = "<root>";
+    for(int Index = 0; Index < 400; Index++){
+        Input += "<record identifier=\"a long attribute value number " + std::to_string(Index) + "\">some character data long enough to allocate</record>";
+    }
+    Input += "</root>";
+    CCountingResource Upstream;
+    CXMLReader Reader(std::make_shared<CStringDataSource>(Input), &Upstream);
+    CMemoryArena Arena(4096);
+    SPMRXMLEntity Entity(&Arena);
+
+    int Records = 0;
+    std::size_t AllocationsAfterFirstRecords = 0;
+    while(Reader.ReadEntity(Entity)){
+        if(Entity.DType == SXMLEntity::EType::StartElement && Entity.DNameData == "record"){
+            EXPECT_EQ(Entity.AttributeValue("identifier"), "a long attribute value number " + std::to_string(Records));
+            Records++;
+            if(Records == 200){
+                AllocationsAfterFirstRecords = Upstream.DAllocations;
+            }
+        }
+    }
+    EXPECT_EQ(Records, 400);
+    // internal queue slots and the text buffer are recycled once warmed up
+    EXPECT_EQ(Upstream.DAllocations, AllocationsAfterFirstRecords);
+}
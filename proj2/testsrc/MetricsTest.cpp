@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "Metrics.h"
+#include "DSVReader.h"
+#include "DSVWriter.h"
+#include "StringDataSink.h"
+#include "StringDataSource.h"
+#include "XMLReader.h"
+#include <atomic>
+#include <thread>
+
+TEST(Metrics, CounterNames){
+    EXPECT_STREQ(Metrics::CounterName(Metrics::ECounter::BytesRead), "BytesRead");
+    EXPECT_STREQ(Metrics::CounterName(Metrics::ECounter::SinkWaitNanoseconds), "SinkWaitNanoseconds");
+    EXPECT_STREQ(Metrics::CounterName(Metrics::ECounter::Count), "");
+}
+
+TEST(Metrics, EmptyTraceIsValidJSON){
+    Metrics::ClearTrace();
+    std::string Json = Metrics::ChromeTraceJSON();
+    EXPECT_EQ(Json.find("{\"traceEvents\":["), 0u);
+    EXPECT_NE(Json.find("]"), std::string::npos);
+}
+
+#ifdef DSV_ENABLE_METRICS
+
+TEST(Metrics, DSVReadAndWriteCounters){
+    Metrics::Reset();
+    auto Source = std::make_shared<CStringDataSource>("a,\"b,c\",d\n1,2,3\n");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    while(Reader.ReadRow(Row)){
+    }
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVWriter Writer(Sink, ',');
+    Writer.WriteRow({"x", "say \"hi\""});
+
+    Metrics::SSnapshot Snapshot = Metrics::Collect();
+    EXPECT_EQ(Snapshot[Metrics::ECounter::RowsRead], 2u);
+    EXPECT_EQ(Snapshot[Metrics::ECounter::CellsRead], 6u);
+    EXPECT_EQ(Snapshot[Metrics::ECounter::QuotedCellsRead], 1u);
+    EXPECT_EQ(Snapshot[Metrics::ECounter::BytesRead], 16u);
+    EXPECT_EQ(Snapshot[Metrics::ECounter::RowsWritten], 1u);
+    EXPECT_EQ(Snapshot[Metrics::ECounter::CellsWritten], 2u);
+    EXPECT_EQ(Snapshot[Metrics::ECounter::QuotedCellsWritten], 1u);
+    // two surrounding quotes plus two doubled ones
+    EXPECT_EQ(Snapshot[Metrics::ECounter::BytesEscaped], 4u);
+    EXPECT_EQ(Snapshot[Metrics::ECounter::BytesWritten], Sink->String().size());
+    EXPECT_DOUBLE_EQ(Snapshot.QuotedCellRatio(), 2.0 / 8.0);
+}
+
+TEST(Metrics, XMLEntities){
+    Metrics::Reset();
+    auto Source = std::make_shared<CStringDataSource>("<a x=\"1\">text<b/></a>");
+    CXMLReader Reader(Source);
+    SXMLEntity Entity;
+    while(Reader.ReadEntity(Entity)){
+    }
+    // <a>, text, <b>, </b>, </a>
+    EXPECT_EQ(Metrics::Collect()[Metrics::ECounter::EntitiesRead], 5u);
+}
+
+TEST(Metrics, ExitedThreadsAreKept){
+    Metrics::Reset();
+    std::thread Worker([]{
+        Metrics::Add(Metrics::ECounter::Allocations, 7);
+    });
+    Worker.join();
+    Metrics::Add(Metrics::ECounter::Allocations, 1);
+    EXPECT_EQ(Metrics::Collect()[Metrics::ECounter::Allocations], 8u);
+    Metrics::Reset();
+    EXPECT_EQ(Metrics::Collect()[Metrics::ECounter::Allocations], 0u);
+}
+
+TEST(Metrics, ResetWhileCounting){
+    Metrics::Reset();
+    std::atomic<bool> Stop(false);
+    std::thread Worker([&]{
+        while(!Stop.load()){
+            Metrics::Add(Metrics::ECounter::Allocations, 1);
+        }
+        Metrics::Add(Metrics::ECounter::Allocations, 1000000000);
+    });
+    // each reset starts the count over even though the worker never pauses
+    for(int Index = 0; Index < 100; Index++){
+        Metrics::Reset();
+        EXPECT_LT(Metrics::Collect()[Metrics::ECounter::Allocations], 1000000000u);
+    }
+    Metrics::Reset();
+    Stop.store(true);
+    Worker.join();
+    std::uint64_t Count = Metrics::Collect()[Metrics::ECounter::Allocations];
+    EXPECT_GE(Count, 1000000000u);
+    EXPECT_LT(Count, 2000000000u);
+}
+
+TEST(Metrics, TraceSpans){
+    Metrics::ClearTrace();
+    {
+        DSV_TRACE_SPAN("Untraced");
+    }
+    Metrics::StartTracing();
+    {
+        DSV_TRACE_SPAN("Outer");
+        std::thread Worker([]{
+            DSV_TRACE_SPAN("Inner");
+        });
+        Worker.join();
+    }
+    Metrics::StopTracing();
+    std::string Json = Metrics::ChromeTraceJSON();
+    EXPECT_EQ(Json.find("Untraced"), std::string::npos);
+    EXPECT_NE(Json.find("\"name\":\"Outer\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(Json.find("\"name\":\"Inner\""), std::string::npos);
+    Metrics::ClearTrace();
+    EXPECT_EQ(Metrics::ChromeTraceJSON().find("Outer"), std::string::npos);
+}
+
+#else
+
+TEST(Metrics, DisabledCollectsNothing){
+    Metrics::Add(Metrics::ECounter::RowsRead, 5);
+    auto Source = std::make_shared<CStringDataSource>("a,b\n");
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Metrics::Collect()[Metrics::ECounter::RowsRead], 0u);
+}
+
+#endif
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "ParallelDSVWriter.h"
+#include "DSVWriter.h"
+#include "DSVReader.h"
+#include "StringDataSink.h"
+#include "StringDataSource.h"
+#include <algorithm>
+#include <thread>
+
+namespace{
+
+std::vector<std::string> SampleRow(int index){
+    return {std::to_string(index), "a,b", "say \"hi\"", "", "plain"};
+}
+
+std::string Sequential(int rows, char delimiter, bool quoteall){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVWriter Writer(Sink, delimiter, quoteall);
+    for(int Index = 0; Index < rows; Index++){
+        Writer.WriteRow(SampleRow(Index));
+    }
+    return Sink->String();
+}
+
+}
+
+TEST(ParallelDSVWriter, FormatRowMatchesWriter){
+    std::vector<char> Buffer;
+    CDSVWriter::FormatRow({"x", "\"\"", "a|b", ""}, '|', false, Buffer);
+    EXPECT_EQ(std::string(Buffer.begin(), Buffer.end()), "x|\"\"\"\"\"\"|\"a|b\"|\n");
+    Buffer.clear();
+    CDSVWriter::FormatRow({"x", "y"}, ',', true, Buffer);
+    EXPECT_EQ(std::string(Buffer.begin(), Buffer.end()), "\"x\",\"y\"\n");
+}
+
+TEST(ParallelDSVWriter, OrderedMatchesSequential){
+    for(bool QuoteAll : {false, true}){
+        auto Sink = std::make_shared<CStringDataSink>();
+        {
+            CParallelDSVWriter Writer(Sink, ',', QuoteAll, 4, true, 7);
+            for(int Index = 0; Index < 1000; Index++){
+                EXPECT_TRUE(Writer.WriteRow(SampleRow(Index)));
+            }
+            EXPECT_TRUE(Writer.Close());
+            EXPECT_FALSE(Writer.WriteRow(SampleRow(0)));
+        }
+        EXPECT_EQ(Sink->String(), Sequential(1000, ',', QuoteAll));
+    }
+}
+
+TEST(ParallelDSVWriter, FlushWritesPartialBatch){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CParallelDSVWriter Writer(Sink, ',', false, 2, true, 100);
+    EXPECT_TRUE(Writer.WriteRow({"a", "b"}));
+    EXPECT_TRUE(Writer.Flush());
+    EXPECT_EQ(Sink->String(), "a,b\n");
+    EXPECT_TRUE(Writer.WriteRows({{"c"}, {"d"}}));
+    EXPECT_TRUE(Writer.Flush());
+    EXPECT_EQ(Sink->String(), "a,b\nc\nd\n");
+}
+
+TEST(ParallelDSVWriter, ManyProducers){
+    const int Producers = 8, Batches = 50, BatchRows = 20;
+    for(bool Ordered : {true, false}){
+        auto Sink = std::make_shared<CStringDataSink>();
+        {
+            CParallelDSVWriter Writer(Sink, ',', false, 4, Ordered);
+            std::vector<std::thread> Threads;
+            for(int Producer = 0; Producer < Producers; Producer++){
+                Threads.emplace_back([&, Producer]{
+                    for(int Batch = 0; Batch < Batches; Batch++){
+                        std::vector< std::vector<std::string> > Rows;
+                        for(int Row = 0; Row < BatchRows; Row++){
+                            Rows.push_back({std::to_string(Producer), std::to_string(Batch), std::to_string(Row), "x,y"});
+                        }
+                        EXPECT_TRUE(Writer.WriteRows(std::move(Rows)));
+                    }
+                });
+            }
+            for(auto &Thread : Threads){
+                Thread.join();
+            }
+        }
+        // batches are never split; when ordered, every producer's batches
+        // also keep the order they were submitted in
+        CDSVReader Reader(std::make_shared<CStringDataSource>(Sink->String()), ',');
+        std::vector<std::string> Row;
+        std::vector<int> NextBatch(Producers, 0);
+        int Rows = 0;
+        while(Reader.ReadRow(Row)){
+            ASSERT_EQ(Row.size(), 4u);
+            int Producer = std::stoi(Row[0]);
+            int Batch = std::stoi(Row[1]);
+            int Index = std::stoi(Row[2]);
+            EXPECT_EQ(Row[3], "x,y");
+            EXPECT_EQ(Rows % BatchRows, Index);
+            if(Index == 0){
+                if(Ordered){
+                    EXPECT_EQ(Batch, NextBatch[Producer]);
+                }
+                NextBatch[Producer]++;
+            }
+            Rows++;
+        }
+        EXPECT_EQ(Rows, Producers * Batches * BatchRows);
+    }
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "ParallelXMLReader.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include <cstdio>
+#include <unistd.h>
+
+namespace{
+
+class CTempFile{
+    public:
+        std::string DPath;
+
+        explicit CTempFile(const std::string &contents){
+            char Path[] = "/tmp/parallelxmlreadertestXXXXXX";
+            int Descriptor = mkstemp(Path);
+            EXPECT_GE(Descriptor, 0);
+            EXPECT_EQ(write(Descriptor, contents.data(), contents.size()), static_cast<ssize_t>(contents.size()));
+            close(Descriptor);
+            DPath = Path;
+        }
+
+        ~CTempFile(){
+            std::remove(DPath.c_str());
+        }
+};
+
+std::vector<SXMLEntity> Serial(const std::string &document, bool skipcdata){
+    CXMLReader Reader(std::make_shared<CStringDataSource>(document));
+    std::vector<SXMLEntity> Entities;
+    SXMLEntity Entity;
+    while(Reader.ReadEntity(Entity, skipcdata)){
+        Entities.push_back(Entity);
+    }
+    return Entities;
+}
+
+std::vector<SXMLEntity> Parallel(const std::string &path, std::size_t depth, std::size_t chunksize, bool skipcdata){
+    CParallelXMLReader Reader(path, depth, 3, chunksize);
+    EXPECT_TRUE(Reader.IsOpen());
+    std::vector<SXMLEntity> Entities;
+    SXMLEntity Entity;
+    while(Reader.ReadEntity(Entity, skipcdata)){
+        Entities.push_back(Entity);
+    }
+    EXPECT_TRUE(Reader.End());
+    EXPECT_FALSE(Reader.Failed());
+    return Entities;
+}
+
+void ExpectSame(const std::vector<SXMLEntity> &left, const std::vector<SXMLEntity> &right){
+    ASSERT_EQ(left.size(), right.size());
+    for(std::size_t Index = 0; Index < left.size(); Index++){
+        EXPECT_EQ(left[Index].DType, right[Index].DType) << Index;
+        EXPECT_EQ(left[Index].DNameData, right[Index].DNameData) << Index;
+        EXPECT_EQ(left[Index].DAttributes, right[Index].DAttributes) << Index;
+    }
+}
+
+// records full of markup that a naive scan for "<record" or ">" would trip on
+std::string TrickyDocument(int records){
+    std::string Document = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<!-- <record> in a comment -->\n<root kind=\"test\">\n";
+    for(int Index = 0; Index < records; Index++){
+        Document += "  <record id=\"" + std::to_string(Index) + "\" note='a > b /> &amp; &lt;record>'>";
+        Document += "<name>item " + std::to_string(Index) + "</name>";
+        Document += "<![CDATA[</record><record>]]><!-- </record> --><?pi <record>?>";
+        Document += "<empty/></record>\n";
+        if(Index % 10 == 0){
+            Document += "  <record id=\"short\"/>\n";
+        }
+    }
+    Document += "</root>\n";
+    return Document;
+}
+
+}
+
+TEST(ParallelXMLReader, MatchesSerialReader){
+    std::string Document = TrickyDocument(500);
+    CTempFile File(Document);
+    for(std::size_t ChunkSize : {std::size_t(1), std::size_t(100), std::size_t(4096), std::size_t(1) << 20}){
+        for(bool SkipCData : {false, true}){
+            ExpectSame(Parallel(File.DPath, 1, ChunkSize, SkipCData), Serial(Document, SkipCData));
+        }
+    }
+}
+
+TEST(ParallelXMLReader, DeeperRecords){
+    std::string Document = "<root>";
+    for(int Group = 0; Group < 20; Group++){
+        Document += "<group n=\"" + std::to_string(Group) + "\">";
+        for(int Index = 0; Index < 30; Index++){
+            Document += "<r>" + std::to_string(Index) + "</r>";
+        }
+        Document += "</group>\n";
+    }
+    Document += "</root>";
+    CTempFile File(Document);
+    ExpectSame(Parallel(File.DPath, 2, 64, false), Serial(Document, false));
+}
+
+TEST(ParallelXMLReader, ErrorsAndEdgeCases){
+    CTempFile Empty("");
+    CParallelXMLReader EmptyReader(Empty.DPath);
+    SXMLEntity Entity;
+    EXPECT_TRUE(EmptyReader.End());
+    EXPECT_FALSE(EmptyReader.ReadEntity(Entity));
+
+    CParallelXMLReader Missing("/nonexistent/parallel.xml");
+    EXPECT_FALSE(Missing.IsOpen());
+    EXPECT_TRUE(Missing.End());
+
+    // the broken record stops reading after the chunks before it
+    std::string Document = "<root>";
+    for(int Index = 0; Index < 100; Index++){
+        Document += Index == 60 ? "<record><oops></record>" : "<record>x</record>";
+    }
+    Document += "</root>";
+    CTempFile Broken(Document);
+    CParallelXMLReader Reader(Broken.DPath, 1, 2, 50);
+    int Records = 0;
+    while(Reader.ReadEntity(Entity)){
+        Records += Entity.DType == SXMLEntity::EType::StartElement && Entity.DNameData == "record";
+    }
+    EXPECT_TRUE(Reader.Failed());
+    EXPECT_LT(Records, 61);
+    EXPECT_GT(Records, 0);
+}
+
+TEST(ParallelXMLReader, InternalSubsetReadsWhole){
+    std::string Document = "<!DOCTYPE root [<!ENTITY who \"world\">]><root><record>hello &who;</record><record>again</record></root>";
+    CTempFile File(Document);
+    ExpectSame(Parallel(File.DPath, 1, 1, false), Serial(Document, false));
+}
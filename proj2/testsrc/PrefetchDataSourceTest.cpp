@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "PrefetchDataSource.h"
+#include "StringDataSource.h"
+#include "DSVReader.h"
+#include <thread>
+
+namespace{
+
+// string source that sleeps before each bulk read, like a slow disk
+class CSlowDataSource : public CStringDataSource{
+    public:
+        CSlowDataSource(const std::string &str) : CStringDataSource(str){}
+
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            return CStringDataSource::Read(buf, count);
+        }
+};
+
+}
+
+TEST(PrefetchDataSource, EmptyTest){
+    CPrefetchDataSource Source(std::make_shared<CStringDataSource>(""), 8, 2);
+    char TempCh = 'x';
+    std::vector<char> TempVector;
+
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Peek(TempCh));
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh, 'x');
+    EXPECT_FALSE(Source.Read(TempVector, 3));
+}
+
+TEST(PrefetchDataSource, GetPeekReadAcrossBuffers){
+    std::string Text;
+    for(int Index = 0; Index < 500; Index++){
+        Text += static_cast<char>('a' + Index % 26);
+    }
+    // tiny buffers so every call crosses buffer boundaries
+    CPrefetchDataSource Source(std::make_shared<CStringDataSource>(Text), 7, 3);
+    std::string Output;
+    std::vector<char> TempVector;
+    char TempCh;
+
+    while(!Source.End()){
+        ASSERT_TRUE(Source.Peek(TempCh));
+        char Next;
+        ASSERT_TRUE(Source.Get(Next));
+        EXPECT_EQ(TempCh, Next);
+        Output += Next;
+        if(Source.Read(TempVector, 11)){
+            Output.append(TempVector.begin(), TempVector.end());
+        }
+    }
+    EXPECT_EQ(Output, Text);
+    EXPECT_FALSE(Source.Get(TempCh));
+}
+
+TEST(PrefetchDataSource, DSVReaderThroughPrefetch){
+    std::string Text;
+    for(int Index = 0; Index < 100; Index++){
+        Text += std::to_string(Index) + ",\"x,y\",z\n";
+    }
+    auto Source = std::make_shared<CPrefetchDataSource>(std::make_shared<CStringDataSource>(Text), 64, 4);
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string> Row;
+    int Rows = 0;
+    while(!Reader.End()){
+        ASSERT_TRUE(Reader.ReadRow(Row));
+        EXPECT_EQ(Row, std::vector<std::string>({std::to_string(Rows), "x,y", "z"}));
+        Rows++;
+    }
+    EXPECT_EQ(Rows, 100);
+}
+
+TEST(PrefetchDataSource, ReportsConsumerStall){
+    CPrefetchDataSource Source(std::make_shared<CSlowDataSource>(std::string(100, 'q')), 10, 2);
+    std::vector<char> TempVector;
+    std::size_t Total = 0;
+    while(Source.Read(TempVector, 25)){
+        Total += TempVector.size();
+    }
+    EXPECT_EQ(Total, 100);
+    EXPECT_GT(Source.ConsumerStalls(), 0);
+    EXPECT_GT(Source.ConsumerStallTime().count(), 0);
+}
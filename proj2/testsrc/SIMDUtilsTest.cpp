@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "SIMDUtils.h"
+#include <string>
+
+TEST(SIMDUtils, InstructionSet){
+    std::string Name = SIMDUtils::ActiveInstructionSet();
+    EXPECT_TRUE(Name == "avx2" || Name == "sse2" || Name == "scalar");
+}
+
+TEST(SIMDUtils, CaseConversionAllLengths){
+    // cover every tail length around the 16 and 32 byte vector widths
+    std::string Alphabet = "@AZ[`az{ \x80\xC3\xA9 mIxEd 09";
+    for(size_t Length = 0; Length < 80; Length++){
+        std::string Input, Upper, Lower;
+        for(size_t Index = 0; Index < Length; Index++){
+            char Ch = Alphabet[Index % Alphabet.size()];
+            Input += Ch;
+            Upper += (Ch >= 'a' && Ch <= 'z') ? char(Ch - 32) : Ch;
+            Lower += (Ch >= 'A' && Ch <= 'Z') ? char(Ch + 32) : Ch;
+        }
+        std::string Output(Length, '\0');
+        SIMDUtils::UpperASCII(Input.data(), &Output[0], Length);
+        EXPECT_EQ(Output, Upper);
+        SIMDUtils::LowerASCII(Input.data(), &Output[0], Length);
+        EXPECT_EQ(Output, Lower);
+        EXPECT_EQ(SIMDUtils::MismatchIgnoreCaseASCII(Upper.data(), Lower.data(), Length), Length);
+    }
+}
+
+TEST(SIMDUtils, MismatchPosition){
+    std::string Left(70, 'k'), Right(70, 'K');
+    for(size_t Position : {0, 15, 16, 31, 32, 63, 69}){
+        std::string Changed = Right;
+        Changed[Position] = 'x';
+        EXPECT_EQ(SIMDUtils::MismatchIgnoreCaseASCII(Left.data(), Changed.data(), Left.size()), Position);
+    }
+}
+
+TEST(SIMDUtils, ASCIIAndCount){
+    std::string Text(100, 'a');
+    EXPECT_TRUE(SIMDUtils::IsASCII(Text.data(), Text.size()));
+    EXPECT_EQ(SIMDUtils::CountUTF8CodePoints(Text.data(), Text.size()), 100);
+    for(size_t Position : {0, 17, 40, 99}){
+        std::string Changed = Text;
+        Changed[Position] = '\xC3';
+        EXPECT_FALSE(SIMDUtils::IsASCII(Changed.data(), Changed.size()));
+    }
+    std::string Mixed;
+    for(int Index = 0; Index < 30; Index++){
+        Mixed += "\xC3\xA9x\xE2\x82\xAC";
+    }
+    EXPECT_EQ(SIMDUtils::CountUTF8CodePoints(Mixed.data(), Mixed.size()), 90);
+}
+
+TEST(SIMDUtils, DecodeTwoByteBlocks){
+    // 40 copies of U+00E9 covers whole 2-byte vector blocks plus a tail
+    std::string Text;
+    for(int Index = 0; Index < 40; Index++){
+        Text += "\xC3\xA9";
+    }
+    Text += "\xC1\x81";
+    std::u32string Output(Text.size(), U'\0');
+    size_t Count = SIMDUtils::DecodeUTF8(Text.data(), Text.size(), &Output[0]);
+    ASSERT_EQ(Count, 42);
+    for(int Index = 0; Index < 40; Index++){
+        EXPECT_EQ(Output[Index], U'é');
+    }
+    EXPECT_EQ(Output[40], U'�');
+    EXPECT_EQ(Output[41], U'�');
+}
+
+TEST(SIMDUtils, WhitespaceBounds){
+    for(size_t Leading = 0; Leading < 70; Leading += 7){
+        for(size_t Trailing = 0; Trailing < 70; Trailing += 9){
+            std::string Text = std::string(Leading, ' ') + "x\t \ty" + std::string(Trailing, '\n');
+            EXPECT_EQ(SIMDUtils::LeadingWhitespace(Text.data(), Text.size()), Leading);
+            EXPECT_EQ(SIMDUtils::TrimTrailingWhitespace(Text.data(), Text.size()), Leading + 5);
+        }
+    }
+    std::string Blank(50, '\r');
+    EXPECT_EQ(SIMDUtils::LeadingWhitespace(Blank.data(), Blank.size()), 50);
+    EXPECT_EQ(SIMDUtils::TrimTrailingWhitespace(Blank.data(), Blank.size()), 0);
+}
+
+TEST(SIMDUtils, ClassifyDSVBlocks){
+    std::string Text(128, 'x');
+    Text[0] = '"';
+    Text[31] = '\t';
+    Text[32] = '\n';
+    Text[63] = '\r';
+    Text[64] = '\t';
+    Text[127] = '"';
+    SIMDUtils::SDSVBlockMasks Masks[2];
+    SIMDUtils::ClassifyDSVBlocks(Text.data(), 2, '\t', Masks);
+    EXPECT_EQ(Masks[0].DQuote, 1ULL);
+    EXPECT_EQ(Masks[0].DDelimiter, 1ULL << 31);
+    EXPECT_EQ(Masks[0].DNewline, 1ULL << 32);
+    EXPECT_EQ(Masks[0].DReturn, 1ULL << 63);
+    EXPECT_EQ(Masks[1].DQuote, 1ULL << 63);
+    EXPECT_EQ(Masks[1].DDelimiter, 1ULL);
+    EXPECT_EQ(Masks[1].DNewline | Masks[1].DReturn, 0ULL);
+}
@@ -100,4 +100,102 @@ TEST(StringUtilsTest, EditDistance) {
     EXPECT_EQ(StringUtils::EditDistance("flaw", "lawn"), 2);
     EXPECT_EQ(StringUtils::EditDistance("same", "same"), 0);
     EXPECT_EQ(StringUtils::EditDistance("hello", "HELLO", true), 0);
-}
\ No newline at end of file
+}
+
+TEST(StringUtilsTest, InPlaceCase) {
+    std::string Text = "hELLO wORLD, 123!";
+    StringUtils::UpperInPlace(Text);
+    EXPECT_EQ(Text, "HELLO WORLD, 123!");
+    StringUtils::LowerInPlace(Text);
+    EXPECT_EQ(Text, "hello world, 123!");
+    StringUtils::CapitalizeInPlace(Text);
+    EXPECT_EQ(Text, "Hello world, 123!");
+    std::string Empty;
+    StringUtils::CapitalizeInPlace(Empty);
+    EXPECT_EQ(Empty, "");
+}
+
+TEST(StringUtilsTest, CompareIgnoreCase) {
+    EXPECT_EQ(StringUtils::CompareIgnoreCase("Hello", "hELLO"), 0);
+    EXPECT_LT(StringUtils::CompareIgnoreCase("apple", "BANANA"), 0);
+    EXPECT_GT(StringUtils::CompareIgnoreCase("Zebra", "apple"), 0);
+    EXPECT_LT(StringUtils::CompareIgnoreCase("abc", "ABCD"), 0);
+    EXPECT_EQ(StringUtils::CompareIgnoreCase("", ""), 0);
+    std::string Long1(100, 'q'), Long2(100, 'Q');
+    EXPECT_EQ(StringUtils::CompareIgnoreCase(Long1, Long2), 0);
+    Long2[77] = 'R';
+    EXPECT_LT(StringUtils::CompareIgnoreCase(Long1, Long2), 0);
+}
+
+TEST(StringUtilsTest, HashIgnoreCase) {
+    EXPECT_EQ(StringUtils::HashIgnoreCase("Customer_ID_Column"), StringUtils::HashIgnoreCase("customer_id_column"));
+    EXPECT_EQ(StringUtils::HashIgnoreCase("ab"), StringUtils::HashIgnoreCase("AB"));
+    EXPECT_NE(StringUtils::HashIgnoreCase("ab"), StringUtils::HashIgnoreCase("ac"));
+    EXPECT_NE(StringUtils::HashIgnoreCase("a"), StringUtils::HashIgnoreCase(std::string("a\0", 2)));
+    EXPECT_TRUE(StringUtils::SIgnoreCaseEqual()("MiXeD", "mixed"));
+    EXPECT_FALSE(StringUtils::SIgnoreCaseEqual()("mixed", "mixer"));
+}
+
+TEST(StringUtilsTest, UTF8Length) {
+    EXPECT_EQ(StringUtils::UTF8::Length("hello"), 5);
+    EXPECT_EQ(StringUtils::UTF8::Length("h\xC3\xA9llo"), 5);
+    EXPECT_EQ(StringUtils::UTF8::Length("\xE6\x97\xA5\xE6\x9C\xAC"), 2);
+    EXPECT_TRUE(StringUtils::UTF8::IsValid("gr\xC3\xBC\xC3\x9F"));
+    EXPECT_FALSE(StringUtils::UTF8::IsValid("bad \xC3"));
+    EXPECT_FALSE(StringUtils::UTF8::IsValid("\xC0\xAF"));
+}
+
+TEST(StringUtilsTest, UTF8Decode) {
+    // long enough to go through the vector ASCII and 2-byte paths
+    std::string Text = "plain ascii text!\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82\xD0\xBC\xD0\xB8\xD1\x80 \xF0\x9F\x98\x80";
+    std::u32string Decoded = StringUtils::UTF8::Decode(Text);
+    ASSERT_EQ(Decoded.size(), 28);
+    EXPECT_EQ(Decoded[0], U'p');
+    EXPECT_EQ(Decoded[17], U'П');
+    EXPECT_EQ(Decoded[25], U'р');
+    EXPECT_EQ(Decoded[27], U'\U0001F600');
+    EXPECT_EQ(StringUtils::UTF8::Encode(Decoded), Text);
+    EXPECT_EQ(StringUtils::UTF8::Decode("a\xFFz"), std::u32string(U"a�z"));
+}
+
+TEST(StringUtilsTest, UTF8Slice) {
+    EXPECT_EQ(StringUtils::UTF8::Slice("hello world", 0, 5), "hello");
+    EXPECT_EQ(StringUtils::UTF8::Slice("caf\xC3\xA9 au lait", 0, 4), "caf\xC3\xA9");
+    EXPECT_EQ(StringUtils::UTF8::Slice("caf\xC3\xA9 au lait", -4), "lait");
+    EXPECT_EQ(StringUtils::UTF8::Slice("\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E", 1, 2), "\xE6\x9C\xAC");
+    EXPECT_EQ(StringUtils::UTF8::Slice("abc", 5, 9), "");
+}
+
+TEST(StringUtilsTest, UTF8Justify) {
+    EXPECT_EQ(StringUtils::UTF8::Center("\xC3\xA9t\xC3\xA9", 7, '*'), "**\xC3\xA9t\xC3\xA9**");
+    EXPECT_EQ(StringUtils::UTF8::LJust("\xC3\xA9t\xC3\xA9", 5, '-'), "\xC3\xA9t\xC3\xA9--");
+    EXPECT_EQ(StringUtils::UTF8::RJust("\xC3\xA9t\xC3\xA9", 5, '-'), "--\xC3\xA9t\xC3\xA9");
+    EXPECT_EQ(StringUtils::UTF8::LJust("hello", 7, '_'), "hello__");
+    EXPECT_EQ(StringUtils::UTF8::ExpandTabs("\xC3\xA9\t|", 4), "\xC3\xA9   |");
+}
+
+TEST(StringUtilsTest, UTF8EditDistance) {
+    EXPECT_EQ(StringUtils::UTF8::EditDistance("kitten", "sitting"), 3);
+    EXPECT_EQ(StringUtils::UTF8::EditDistance("caf\xC3\xA9", "cafe"), 1);
+    EXPECT_EQ(StringUtils::UTF8::EditDistance("\xE6\x97\xA5\xE6\x9C\xAC", "\xE6\x97\xA5"), 1);
+    EXPECT_EQ(StringUtils::UTF8::EditDistance("CAF\xC3\xA9", "caf\xC3\xA9", true), 0);
+}
+
+TEST(StringUtilsTest, StripLongInput) {
+    // long enough for the whitespace scans to use whole vectors
+    std::string Padding = " \t\r\n \t\r\n \t\r\n \t\r\n \t\r\n \t\r\n \t\r\n \t\r\n \t";
+    std::string Body = "body text  with\tinner whitespace that is well over thirty two bytes";
+    EXPECT_EQ(StringUtils::Strip(Padding + Body + Padding), Body);
+    EXPECT_EQ(StringUtils::LStrip(Padding + Body + Padding), Body + Padding);
+    EXPECT_EQ(StringUtils::RStrip(Padding + Body + Padding), Padding + Body);
+    EXPECT_EQ(StringUtils::Strip(Padding + Padding), "");
+    EXPECT_EQ(StringUtils::Strip(Padding + "x" + Padding), "x");
+}
+
+TEST(StringUtilsTest, ExpandTabsRuns) {
+    EXPECT_EQ(StringUtils::ExpandTabs("a\tbc\tdef\tg", 4), "a   bc  def g");
+    EXPECT_EQ(StringUtils::ExpandTabs("\t\tx", 2), "    x");
+    EXPECT_EQ(StringUtils::ExpandTabs("no tabs here", 4), "no tabs here");
+    EXPECT_EQ(StringUtils::ExpandTabs("a\tb\t", 0), "ab");
+    EXPECT_EQ(StringUtils::ExpandTabs("", 4), "");
+}
@@ -0,0 +1,39 @@
+#ifndef TEMPFILE_H
+#define TEMPFILE_H
+
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+// An empty file under /tmp named after prefix, removed again when the
+// object goes out of scope, including when an ASSERT ends the test early.
+class CTempFile{
+    private:
+        std::string DPath;
+
+    public:
+        explicit CTempFile(const std::string &prefix){
+            std::string Template = "/tmp/" + prefix + "XXXXXX";
+            int Descriptor = mkstemp(Template.data());
+            if(Descriptor >= 0){
+                close(Descriptor);
+                DPath = Template;
+            }
+        }
+
+        CTempFile(const CTempFile &) = delete;
+        CTempFile &operator=(const CTempFile &) = delete;
+
+        ~CTempFile(){
+            if(!DPath.empty()){
+                unlink(DPath.c_str());
+            }
+        }
+
+        // empty when the file could not be created
+        const std::string &Path() const noexcept{
+            return DPath;
+        }
+};
+
+#endif
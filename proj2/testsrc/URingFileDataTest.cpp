@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "URingFileDataSource.h"
+#include "URingFileDataSink.h"
+#include "FileDataSource.h"
+#include "DSVReader.h"
+#include "DSVWriter.h"
+#include "TempFile.h"
+
+namespace{
+
+std::string SampleBytes(std::size_t length){
+    std::string Bytes(length, '\0');
+    for(std::size_t Index = 0; Index < length; Index++){
+        Bytes[Index] = static_cast<char>((Index * 131 + Index / 7) & 0xFF);
+    }
+    return Bytes;
+}
+
+void WriteFile(const std::string &path, const std::string &bytes, bool useuring, bool direct){
+    CURingFileDataSink Sink(path, false, 4096, 3, direct, useuring);
+    ASSERT_TRUE(Sink.IsOpen());
+    // mix single bytes with bulk writes so both paths cross buffer edges
+    std::size_t Index = 0;
+    while(Index < bytes.size()){
+        if(Index % 3 == 0){
+            EXPECT_TRUE(Sink.Put(bytes[Index++]));
+        }
+        else{
+            std::size_t Chunk = std::min<std::size_t>(bytes.size() - Index, 5000);
+            EXPECT_TRUE(Sink.Write(std::vector<char>(bytes.begin() + Index, bytes.begin() + Index + Chunk)));
+            Index += Chunk;
+        }
+    }
+    EXPECT_TRUE(Sink.Flush());
+}
+
+std::string ReadFile(const std::string &path, bool useuring, bool direct){
+    CURingFileDataSource Source(path, 4096, 3, direct, useuring);
+    EXPECT_TRUE(Source.IsOpen());
+    std::string Output;
+    std::vector<char> Buffer;
+    char Ch;
+    while(!Source.End()){
+        if(Output.size() % 2){
+            EXPECT_TRUE(Source.Get(Ch));
+            Output += Ch;
+        }
+        else if(Source.Read(Buffer, 3000)){
+            Output.append(Buffer.begin(), Buffer.end());
+        }
+    }
+    EXPECT_FALSE(Source.Get(Ch));
+    EXPECT_FALSE(Source.Failed());
+    return Output;
+}
+
+}
+
+TEST(URingFileData, RoundTrip){
+    CTempFile Temp("uringfiledatatest");
+    const std::string &Path = Temp.Path();
+    // exact multiples of the buffer size end on a zero length read
+    for(std::size_t Length : {std::size_t(0), std::size_t(1), std::size_t(4096), std::size_t(3 * 4096), std::size_t(100000)}){
+        std::string Bytes = SampleBytes(Length);
+        for(bool UseURing : {true, false}){
+            WriteFile(Path, Bytes, UseURing, false);
+            EXPECT_EQ(ReadFile(Path, UseURing, false), Bytes);
+            EXPECT_EQ(ReadFile(Path, !UseURing, false), Bytes);
+        }
+    }
+}
+
+TEST(URingFileData, DirectIO){
+    // O_DIRECT is dropped quietly when the filesystem refuses it, so this
+    // checks the data whichever way it went
+    CTempFile Temp("uringfiledatatest");
+    const std::string &Path = Temp.Path();
+    std::string Bytes = SampleBytes(5 * 4096 + 77);
+    WriteFile(Path, Bytes, true, true);
+    EXPECT_EQ(ReadFile(Path, true, true), Bytes);
+}
+
+TEST(URingFileData, AppendAndMissingFile){
+    CTempFile Temp("uringfiledatatest");
+    const std::string &Path = Temp.Path();
+    {
+        CURingFileDataSink Sink(Path);
+        EXPECT_TRUE(Sink.Write({'a', 'b', 'c'}));
+    }
+    {
+        CURingFileDataSink Sink(Path, true);
+        EXPECT_TRUE(Sink.Write({'d', 'e'}));
+    }
+    EXPECT_EQ(ReadFile(Path, true, false), "abcde");
+
+    CURingFileDataSource Missing("/nonexistent/uring/file");
+    EXPECT_FALSE(Missing.IsOpen());
+    EXPECT_TRUE(Missing.End());
+}
+
+TEST(URingFileData, DSVThroughURingFile){
+    CTempFile Temp("uringfiledatatest");
+    const std::string &Path = Temp.Path();
+    {
+        auto Sink = std::make_shared<CURingFileDataSink>(Path, false, 4096, 2);
+        CDSVWriter Writer(Sink, ',');
+        for(int Index = 0; Index < 2000; Index++){
+            EXPECT_TRUE(Writer.WriteRow({std::to_string(Index), "x,y", "z"}));
+        }
+    }
+    CDSVReader Reader(std::make_shared<CURingFileDataSource>(Path, 4096, 4), ',');
+    std::vector<std::string> Row;
+    int Rows = 0;
+    while(Reader.ReadRow(Row)){
+        EXPECT_EQ(Row, std::vector<std::string>({std::to_string(Rows), "x,y", "z"}));
+        Rows++;
+    }
+    EXPECT_EQ(Rows, 2000);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "StringDataSink.h"
+#include "StringDataSource.h"
+#include "XMLBinding.h"
+
+namespace{
+
+struct SItem{
+    std::string DSku;
+    int DQuantity = 0;
+    double DPrice = 0;
+    std::string DNote;
+};
+
+struct SOrder{
+    std::uint64_t DId = 0;
+    bool DRush = false;
+    std::string DCustomer;
+    std::vector<SItem> DItems;
+    std::vector<std::string> DTags;
+};
+
+}
+
+template <>
+struct SXMLBinding<SItem>{
+    static constexpr std::string_view Element = "item";
+    static constexpr auto Fields = std::make_tuple(
+        XMLBinding::Attribute("sku", &SItem::DSku),
+        XMLBinding::Attribute("qty", &SItem::DQuantity),
+        XMLBinding::Element("price", &SItem::DPrice),
+        XMLBinding::Text(&SItem::DNote));
+};
+
+template <>
+struct SXMLBinding<SOrder>{
+    static constexpr std::string_view Element = "order";
+    static constexpr auto Fields = std::make_tuple(
+        XMLBinding::Attribute("id", &SOrder::DId),
+        XMLBinding::Attribute("rush", &SOrder::DRush),
+        XMLBinding::Element("customer", &SOrder::DCustomer),
+        XMLBinding::Elements("line", &SOrder::DItems),
+        XMLBinding::Elements("tag", &SOrder::DTags));
+};
+
+TEST(XMLBinding, ReadsNestedStructs){
+    auto Source = std::make_shared<CStringDataSource>(
+        "<?xml version=\"1.0\"?>\n"
+        "<orders>\n"
+        " <order id=\"17\" rush=\"true\" unmapped=\"x\">\n"
+        "  <customer>Ann &amp; Bo</customer>\n"
+        "  <line sku=\"a1\" qty=\"2\"><price> 9.5 </price>gift <!-- c --><b>skipped</b>wrap</line>\n"
+        "  <notes><customer>not this one</customer></notes>\n"
+        "  <line sku=\"b2\" qty=\"-1\"/>\n"
+        "  <tag>x</tag><tag>y</tag>\n"
+        " </order>\n"
+        " <batch><order id=\"18\"/></batch>\n"
+        "</orders>\n");
+    TXMLBindingReader<SOrder> Reader(Source);
+    SOrder Order;
+    ASSERT_TRUE(Reader.Read(Order));
+    EXPECT_EQ(Order.DId, 17u);
+    EXPECT_TRUE(Order.DRush);
+    EXPECT_EQ(Order.DCustomer, "Ann & Bo");
+    ASSERT_EQ(Order.DItems.size(), 2u);
+    EXPECT_EQ(Order.DItems[0].DSku, "a1");
+    EXPECT_EQ(Order.DItems[0].DQuantity, 2);
+    EXPECT_DOUBLE_EQ(Order.DItems[0].DPrice, 9.5);
+    // text of the element itself, around the children
+    EXPECT_EQ(Order.DItems[0].DNote, "gift wrap");
+    EXPECT_EQ(Order.DItems[1].DQuantity, -1);
+    EXPECT_EQ(Order.DTags, (std::vector<std::string>{"x", "y"}));
+
+    // found wherever it is nested, and read into a fresh value
+    ASSERT_TRUE(Reader.Read(Order));
+    EXPECT_EQ(Order.DId, 18u);
+    EXPECT_FALSE(Order.DRush);
+    EXPECT_TRUE(Order.DItems.empty());
+    EXPECT_FALSE(Reader.Read(Order));
+    EXPECT_FALSE(Reader.Failed());
+}
+
+TEST(XMLBinding, BadValuesFail){
+    SOrder Order;
+    TXMLBindingReader<SOrder> BadNumber(std::make_shared<CStringDataSource>("<order id=\"12x\"/>"));
+    EXPECT_FALSE(BadNumber.Read(Order));
+    EXPECT_TRUE(BadNumber.Failed());
+    EXPECT_FALSE(BadNumber.ErrorMessage().empty());
+
+    TXMLBindingReader<SOrder> BadBool(std::make_shared<CStringDataSource>("<order rush=\"yes\"/>"));
+    EXPECT_FALSE(BadBool.Read(Order));
+    EXPECT_TRUE(BadBool.Failed());
+
+    TXMLBindingReader<SOrder> Truncated(std::make_shared<CStringDataSource>("<orders><order id=\"1\"/><order id=\"2\">"));
+    ASSERT_TRUE(Truncated.Read(Order));
+    EXPECT_EQ(Order.DId, 1u);
+    EXPECT_FALSE(Truncated.Read(Order));
+    EXPECT_TRUE(Truncated.Failed());
+}
+
+TEST(XMLBinding, WriteRoundTrips){
+    SOrder Order;
+    Order.DId = 5;
+    Order.DCustomer = "<Tom & \"Jerry\">";
+    Order.DItems.push_back(SItem{"it's", 3, 0.25, ""});
+    Order.DTags = {"a"};
+    auto Sink = std::make_shared<CStringDataSink>();
+    TXMLBindingWriter<SOrder> Writer(Sink);
+    ASSERT_TRUE(Writer.Write(Order));
+    EXPECT_EQ(Sink->String(),
+        "<order id=\"5\" rush=\"false\"><customer>&lt;Tom &amp; &quot;Jerry&quot;&gt;</customer>"
+        "<line sku=\"it&apos;s\" qty=\"3\"><price>0.25</price></line><tag>a</tag></order>");
+
+    // the escaping is the one CXMLWriter applies
+    auto EntitySink = std::make_shared<CStringDataSink>();
+    CXMLWriter EntityWriter(EntitySink);
+    SXMLEntity Entity;
+    Entity.DType = SXMLEntity::EType::CharData;
+    Entity.DNameData = Order.DCustomer;
+    ASSERT_TRUE(EntityWriter.WriteEntity(Entity));
+    std::string Escaped;
+    CXMLWriter::AppendEscaped(Order.DCustomer, Escaped);
+    EXPECT_EQ(EntitySink->String(), Escaped);
+
+    Order.DItems.push_back(SItem{"z", 0, -1e300, "n"});
+    ASSERT_TRUE(Writer.Write(Order));
+    TXMLBindingReader<SOrder> Reader(std::make_shared<CStringDataSource>("<all>" + Sink->String() + "</all>"));
+    SOrder Copy;
+    for(int Index = 0; Index < 2; Index++){
+        ASSERT_TRUE(Reader.Read(Copy));
+        EXPECT_EQ(Copy.DCustomer, Order.DCustomer);
+        EXPECT_EQ(Copy.DItems[0].DSku, "it's");
+        EXPECT_DOUBLE_EQ(Copy.DItems[0].DPrice, 0.25);
+    }
+    ASSERT_EQ(Copy.DItems.size(), 2u);
+    EXPECT_EQ(Copy.DItems[1].DPrice, -1e300);
+    EXPECT_EQ(Copy.DItems[1].DNote, "n");
+    EXPECT_EQ(Copy.DTags, Order.DTags);
+    EXPECT_FALSE(Reader.Read(Copy));
+}
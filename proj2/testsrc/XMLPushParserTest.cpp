@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "XMLPushParser.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+
+namespace{
+
+const std::string Document = "<?xml version=\"1.0\"?>\n<root a=\"1\" b=\"x &amp; y\">text &lt;here&gt;<child/><!-- note --><item id=\"7\">caf\xC3\xA9</item>\n</root>";
+
+std::string Describe(const SXMLEntity &entity){
+    std::string Text = std::to_string(static_cast<int>(entity.DType)) + ":" + entity.DNameData;
+    for(auto &Attribute : entity.DAttributes){
+        Text += " " + Attribute.first + "=" + Attribute.second;
+    }
+    return Text;
+}
+
+std::vector<std::string> PullEntities(const std::string &text){
+    CXMLReader Reader(std::make_shared<CStringDataSource>(text));
+    std::vector<std::string> Entities;
+    SXMLEntity Entity;
+    while(Reader.ReadEntity(Entity)){
+        Entities.push_back(Describe(Entity));
+    }
+    return Entities;
+}
+
+}
+
+TEST(XMLPushParser, EverySplitPointMatchesReader){
+    auto Expected = PullEntities(Document);
+    ASSERT_EQ(Expected.size(), 9u);
+    for(std::size_t Split = 0; Split <= Document.size(); Split++){
+        std::vector<std::string> Entities;
+        CXMLPushParser Parser([&](const SXMLEntity &entity){ Entities.push_back(Describe(entity)); });
+        EXPECT_TRUE(Parser.Feed(Document.data(), Split));
+        EXPECT_TRUE(Parser.Feed(Document.data() + Split, Document.size() - Split));
+        EXPECT_TRUE(Parser.Finish());
+        EXPECT_EQ(Entities, Expected) << "split at " << Split;
+    }
+}
+
+TEST(XMLPushParser, DeliversEntitiesAsSoonAsComplete){
+    std::vector<std::string> Entities;
+    CXMLPushParser Parser([&](const SXMLEntity &entity){ Entities.push_back(Describe(entity)); }, true);
+    Parser.Feed("<a><b x=", 8);
+    EXPECT_EQ(Entities, (std::vector<std::string>{"0:a"}));
+    Parser.Feed("\"1\">text", 8);
+    EXPECT_EQ(Entities.back(), "0:b x=1");
+    Parser.Feed("</b>", 4);
+    // skipped character data never shows up
+    EXPECT_EQ(Entities.size(), 3u);
+    EXPECT_EQ(Entities.back(), "1:b");
+}
+
+TEST(XMLPushParser, ErrorsAndReset){
+    int Count = 0;
+    CXMLPushParser Parser([&](const SXMLEntity &){ Count++; });
+    EXPECT_FALSE(Parser.Feed("<a></b>", 7));
+    EXPECT_TRUE(Parser.Failed());
+    EXPECT_FALSE(Parser.ErrorMessage().empty());
+    EXPECT_FALSE(Parser.Feed("<c/>", 4));
+
+    // each message on the pipe is its own document
+    Parser.Reset();
+    EXPECT_FALSE(Parser.Failed());
+    Count = 0;
+    EXPECT_TRUE(Parser.Feed("<m>1</m>", 8));
+    EXPECT_TRUE(Parser.Finish());
+    EXPECT_EQ(Count, 3);
+    EXPECT_FALSE(Parser.Feed("<m/>", 4));
+    Parser.Reset();
+    EXPECT_TRUE(Parser.Feed("<m/>", 4));
+    EXPECT_TRUE(Parser.Finish());
+    EXPECT_EQ(Count, 5);
+}
+
+// the writer waits for each record to be seen before writing the next one,
+// which only works when Feed delivers them without waiting for more input
+TEST(XMLPushParser, NonBlockingPipe){
+    int Pipe[2];
+    int Ack[2];
+    ASSERT_EQ(pipe(Pipe), 0);
+    ASSERT_EQ(pipe(Ack), 0);
+    ASSERT_EQ(fcntl(Pipe[0], F_SETFL, O_NONBLOCK), 0);
+    const int RecordTotal = 50;
+    std::thread Writer([&]{
+        ASSERT_EQ(write(Pipe[1], "<feed>", 6), 6);
+        for(int Index = 0; Index < RecordTotal; Index++){
+            std::string Record = "<record n=\"" + std::to_string(Index) + "\">v</record>";
+            for(char Char : Record){
+                ASSERT_EQ(write(Pipe[1], &Char, 1), 1);
+            }
+            char Byte;
+            ASSERT_EQ(read(Ack[0], &Byte, 1), 1);
+        }
+        ASSERT_EQ(write(Pipe[1], "</feed>", 7), 7);
+        close(Pipe[1]);
+    });
+
+    int Records = 0;
+    CXMLPushParser Parser([&](const SXMLEntity &entity){
+        if(entity.DType == SXMLEntity::EType::EndElement && entity.DNameData == "record"){
+            Records++;
+            char Byte = 1;
+            EXPECT_EQ(write(Ack[1], &Byte, 1), 1);
+        }
+    });
+    char Buffer[256];
+    while(true){
+        ssize_t Length = read(Pipe[0], Buffer, sizeof(Buffer));
+        if(Length > 0){
+            ASSERT_TRUE(Parser.Feed(Buffer, Length));
+        }
+        else if(Length == 0){
+            break;
+        }
+        else{
+            // nothing ready; an event loop would go back to epoll here
+            std::this_thread::yield();
+        }
+    }
+    EXPECT_TRUE(Parser.Finish());
+    Writer.join();
+    close(Pipe[0]);
+    close(Ack[0]);
+    close(Ack[1]);
+    EXPECT_EQ(Records, RecordTotal);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "StringDataSource.h"
+#include "TempFile.h"
+#include "XMLRecordIndex.h"
+#include <cstdio>
+
+namespace{
+
+void WriteFile(const std::string &path, const std::string &text){
+    FILE *File = std::fopen(path.c_str(), "wb");
+    ASSERT_TRUE(File);
+    ASSERT_EQ(std::fwrite(text.data(), 1, text.size(), File), text.size());
+    std::fclose(File);
+}
+
+const std::string Document =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<archive xmlns=\"urn:archive\" xmlns:m=\"urn:meta\" version=\"2\">\n"
+    " <batch id=\"a\">\n"
+    "  <record n=\"1\"><m:title>one &amp; only</m:title></record>\n"
+    "  <record n=\"2\"><record n=\"nested\"/></record>\n"
+    " </batch>\n"
+    " <batch id=\"b\" xmlns:x=\"urn:x\">\n"
+    "  <record n=\"3\"/>\n"
+    "  <other><record n=\"4\">deep</record></other>\n"
+    " </batch>\n"
+    "</archive>\n";
+
+}
+
+TEST(XMLRecordIndex, BuildByName){
+    CStringDataSource Source(Document);
+    CXMLRecordIndex Index;
+    ASSERT_TRUE(Index.Build(Source, "record"));
+    // outermost matches only, so the nested record is part of record 2
+    ASSERT_EQ(Index.RecordCount(), 4u);
+    EXPECT_EQ(Document.substr(Index.Record(0).DOffset, Index.Record(0).DLength), "<record n=\"1\"><m:title>one &amp; only</m:title></record>");
+    EXPECT_EQ(Document.substr(Index.Record(2).DOffset, Index.Record(2).DLength), "<record n=\"3\"/>");
+    EXPECT_EQ(Index.Depth(0), 2u);
+    EXPECT_EQ(Index.Depth(3), 3u);
+    EXPECT_EQ(Index.Record(0).DContext, Index.Record(1).DContext);
+    EXPECT_EQ(Index.Context(0), "<archive xmlns=\"urn:archive\" xmlns:m=\"urn:meta\"><batch>");
+    EXPECT_EQ(Index.Context(2), "<archive xmlns=\"urn:archive\" xmlns:m=\"urn:meta\"><batch xmlns:x=\"urn:x\">");
+    EXPECT_EQ(Index.Encoding(), "UTF-8");
+}
+
+TEST(XMLRecordIndex, BuildByPath){
+    CStringDataSource Source(Document);
+    CXMLRecordIndex Index;
+    ASSERT_TRUE(Index.Build(Source, "/archive/batch/record"));
+    EXPECT_EQ(Index.RecordCount(), 3u);
+
+    CStringDataSource Broken("<a><record></a>");
+    EXPECT_FALSE(Index.Build(Broken, "record"));
+}
+
+TEST(XMLRecordIndex, SidecarAndRandomReads){
+    CTempFile DataTemp("xmlrecordindextest");
+    const std::string &DataPath = DataTemp.Path();
+    CTempFile IndexTemp("xmlrecordindextest");
+    const std::string &IndexPath = IndexTemp.Path();
+    WriteFile(DataPath, Document);
+    {
+        CFileDataSource Source(DataPath);
+        CXMLRecordIndex Index;
+        ASSERT_TRUE(Index.Build(Source, "record"));
+        ASSERT_TRUE(Index.Save(IndexPath));
+    }
+    auto Index = std::make_shared<CXMLRecordIndex>();
+    ASSERT_TRUE(Index->Load(IndexPath));
+    ASSERT_EQ(Index->RecordCount(), 4u);
+    EXPECT_EQ(Index->Context(2), "<archive xmlns=\"urn:archive\" xmlns:m=\"urn:meta\"><batch xmlns:x=\"urn:x\">");
+
+    CXMLRecordReader Reader(std::make_shared<CFileDataSource>(DataPath), Index);
+    std::vector<SXMLEntity> Entities;
+    ASSERT_TRUE(Reader.ReadRecord(3, Entities));
+    ASSERT_EQ(Entities.size(), 3u);
+    EXPECT_EQ(Entities[0].AttributeValue("n"), "4");
+    EXPECT_EQ(Entities[1].DNameData, "deep");
+
+    ASSERT_TRUE(Reader.ReadRecord(0, Entities, true));
+    ASSERT_EQ(Entities.size(), 4u);
+    EXPECT_EQ(Entities[1].DNameData, "m:title");
+    EXPECT_EQ(Entities[3].DType, SXMLEntity::EType::EndElement);
+
+    ASSERT_TRUE(Reader.ReadRecord(0, Entities));
+    EXPECT_EQ(Entities[2].DNameData, "one & only");
+
+    ASSERT_TRUE(Reader.ReadRecord(1, Entities));
+    ASSERT_EQ(Entities.size(), 4u);
+    EXPECT_EQ(Entities[1].AttributeValue("n"), "nested");
+    EXPECT_FALSE(Reader.ReadRecord(4, Entities));
+
+    // the document shrank under the index
+    WriteFile(DataPath, Document.substr(0, Index->Record(3).DOffset + 4));
+    EXPECT_FALSE(Reader.ReadRecord(3, Entities));
+    ASSERT_TRUE(Reader.ReadRecord(0, Entities));
+
+    WriteFile(IndexPath, "not an index");
+    EXPECT_FALSE(Index->Load(IndexPath));
+}
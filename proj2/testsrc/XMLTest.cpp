@@ -105,3 +105,58 @@ TEST(XMLTest, SpecialCharacterEscaping) {
 
     EXPECT_EQ(sink->String(), "<tag>value &amp; more</tag>");
 }
+
+TEST(XMLTest, CharDataLimitChunks) {
+    // a large text run with multi-byte characters straddling the cut points
+    std::string payload;
+    for (int i = 0; i < 20000; i++) {
+        payload += (i % 7) ? "QUJD" : "\xC3\xA9\xE2\x82\xAC";
+    }
+    std::shared_ptr<CStringDataSource> src = std::make_shared<CStringDataSource>("<doc><payload>" + payload + "</payload><small>hi</small></doc>");
+    CXMLReader reader(src);
+    reader.SetCharDataLimit(1000);
+
+    SXMLEntity entity;
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    std::string joined;
+    size_t chunks = 0;
+    while (reader.ReadEntity(entity) && entity.DType == SXMLEntity::EType::CharData) {
+        EXPECT_LE(entity.DNameData.size(), 1000u);
+        EXPECT_NE(static_cast<unsigned char>(entity.DNameData[0]) & 0xC0, 0x80);
+        joined += entity.DNameData;
+        chunks++;
+        if (!entity.DPartial) {
+            break;
+        }
+    }
+    EXPECT_EQ(joined, payload);
+    EXPECT_GT(chunks, payload.size() / 1000);
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(entity.DNameData, "payload");
+
+    // short text is unaffected
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DNameData, "hi");
+    EXPECT_FALSE(entity.DPartial);
+}
+
+TEST(XMLTest, CharDataLimitExactMultiple) {
+    // text exactly twice the limit ends on a whole, non partial entity
+    std::shared_ptr<CStringDataSource> src = std::make_shared<CStringDataSource>("<a>" + std::string(64, 'x') + "</a>");
+    CXMLReader reader(src);
+    reader.SetCharDataLimit(32);
+
+    SPMRXMLEntity entity;
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DNameData.size(), 32u);
+    EXPECT_TRUE(entity.DPartial);
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DNameData.size(), 32u);
+    EXPECT_FALSE(entity.DPartial);
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DType, SXMLEntity::EType::EndElement);
+}
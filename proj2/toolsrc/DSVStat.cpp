@@ -0,0 +1,62 @@
+// Counts the rows of a delimiter-separated file and checks that they agree,
+// without parsing any cell.
+//   bin/DSVStat [-d delimiter] [-m offsets] [input]
+// Prints the row count, the rows per field count, the longest field and the
+// byte offsets of up to -m rows (default 20) whose quoting is broken. Exits
+// with 1 when rows disagree or any is malformed. Input defaults to stdin.
+#include "DSVScanner.h"
+#include "FileDataSource.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <unistd.h>
+
+namespace{
+
+void Usage(){
+    std::cerr << "usage: DSVStat [-d delimiter] [-m offsets] [input]" << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[]){
+    char Delimiter = ',';
+    std::size_t Offsets = 20;
+    int Option;
+    while((Option = getopt(argc, argv, "d:m:")) != -1){
+        switch(Option){
+            case 'd':
+                Delimiter = optarg[0] == '\\' && optarg[1] == 't' ? '\t' : optarg[0];
+                break;
+            case 'm':
+                Offsets = std::strtoul(optarg, nullptr, 10);
+                break;
+            default:
+                Usage();
+                return 2;
+        }
+    }
+    std::shared_ptr<CFileDataSource> Source = optind < argc ? std::make_shared<CFileDataSource>(argv[optind], 1 << 20) : std::make_shared<CFileDataSource>(STDIN_FILENO, false, 1 << 20);
+    if(!Source->IsOpen()){
+        std::cerr << "DSVStat: cannot open " << argv[optind] << std::endl;
+        return 1;
+    }
+    CDSVScanner Scanner(Delimiter, Offsets);
+    for(std::string_view Window = Source->Buffered(); !Window.empty(); Window = Source->Buffered()){
+        Scanner.Feed(Window.data(), Window.size());
+        Source->Consume(Window.size());
+    }
+    const SDSVScanStats &Stats = Scanner.Finish();
+    std::cout << "bytes " << Stats.DBytes << "\n";
+    std::cout << "rows " << Stats.DRowCount << "\n";
+    std::cout << "max fields " << Stats.DMaxFieldCount << "\n";
+    std::cout << "max field length " << Stats.DMaxFieldLength << "\n";
+    for(auto &Count : Stats.DFieldCountHistogram){
+        std::cout << "rows with " << Count.first << " fields " << Count.second << "\n";
+    }
+    std::cout << "malformed rows " << Stats.DMalformedRowCount << "\n";
+    for(auto Offset : Stats.DMalformedRowOffsets){
+        std::cout << "malformed row at byte " << Offset << "\n";
+    }
+    return Stats.Consistent() && !Stats.DMalformedRowCount ? 0 : 1;
+}